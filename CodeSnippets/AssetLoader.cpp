@@ -0,0 +1,206 @@
+/*
+ *  Carregamento assíncrono de assets: a janela abre e começa a desenhar
+ *  enquanto os modelos e texturas ainda estão sendo lidos.
+ *
+ *  Cada asset passa por decode (pool de threads), upload (thread própria com
+ *  um contexto OpenGL compartilhado, numa janela invisível) e finish (thread
+ *  principal). Depois do upload é criada uma fence; o poll() de cada quadro
+ *  testa as fences sem bloquear e só chama o finish quando a GPU já tem os
+ *  dados, então o laço de renderização desenha apenas o que está residente.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  AssetLoader loader(window);
+ *  AssetHandle h = loader.submit({ "Suzanne", decode, upload, finish });
+ *  while (...)
+ *  {
+ *      loader.poll();
+ *      if (loader.state(h) == AssetState::Ready) desenha...
+ *  }
+ */
+
+#include "AssetLoader.h"
+
+#include <iostream>
+
+AssetLoader::AssetLoader(GLFWwindow* mainWindow, unsigned decodeThreads)
+{
+    // Mesma versão/perfil do contexto principal
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, glfwGetWindowAttrib(mainWindow, GLFW_CONTEXT_VERSION_MAJOR));
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, glfwGetWindowAttrib(mainWindow, GLFW_CONTEXT_VERSION_MINOR));
+    glfwWindowHint(GLFW_OPENGL_PROFILE, glfwGetWindowAttrib(mainWindow, GLFW_OPENGL_PROFILE));
+    uploadWindow = glfwCreateWindow(1, 1, "upload", nullptr, mainWindow);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (!uploadWindow)
+    {
+        std::cerr << "Contexto compartilhado indisponivel: uploads na thread principal" << std::endl;
+    }
+
+    decodePool.reset(new ThreadPool(decodeThreads));
+    if (uploadWindow) uploadThread = std::thread([this]() { uploadLoop(); });
+}
+
+AssetLoader::~AssetLoader()
+{
+    // Espera os decodes em andamento, depois esvazia a fila de upload
+    decodePool.reset();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    uploadReady.notify_all();
+    if (uploadThread.joinable()) uploadThread.join();
+
+    for (Entry* entry : fenced)
+    {
+        if (entry->fence) glDeleteSync(entry->fence);
+    }
+    if (uploadWindow) glfwDestroyWindow(uploadWindow);
+}
+
+AssetHandle AssetLoader::submit(AssetJob job)
+{
+    Entry* entry;
+    AssetHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.emplace_back(new Entry());
+        entry = entries.back().get();
+        entry->job = std::move(job);
+        entry->submitted = std::chrono::steady_clock::now();
+        handle = static_cast<AssetHandle>(entries.size() - 1);
+    }
+    decodePool->submit([this, entry]() { decodeEntry(entry); });
+    return handle;
+}
+
+void AssetLoader::fail(Entry* entry, const char* stage)
+{
+    std::cerr << "Falha ao carregar " << entry->job.name << " (" << stage << ")" << std::endl;
+    std::lock_guard<std::mutex> lock(mutex);
+    entry->state = AssetState::Failed;
+    entry->done = std::chrono::steady_clock::now();
+}
+
+void AssetLoader::decodeEntry(Entry* entry)
+{
+    if (entry->job.decode && !entry->job.decode())
+    {
+        fail(entry, "decode");
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uploadQueue.push_back(entry);
+    }
+    uploadReady.notify_one();
+}
+
+void AssetLoader::uploadEntry(Entry* entry)
+{
+    if (entry->job.upload && !entry->job.upload())
+    {
+        fail(entry, "upload");
+        return;
+    }
+    // A fence marca o fim dos comandos deste asset; glFlush garante que ela
+    // chegue à GPU mesmo que este contexto fique parado
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+    std::lock_guard<std::mutex> lock(mutex);
+    entry->fence = fence;
+    fenced.push_back(entry);
+}
+
+void AssetLoader::uploadLoop()
+{
+    glfwMakeContextCurrent(uploadWindow);
+    for (;;)
+    {
+        Entry* entry;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            uploadReady.wait(lock, [this]() { return stopping || !uploadQueue.empty(); });
+            if (uploadQueue.empty()) break;
+            entry = uploadQueue.front();
+            uploadQueue.pop_front();
+        }
+        uploadEntry(entry);
+    }
+    glfwMakeContextCurrent(nullptr);
+}
+
+void AssetLoader::poll()
+{
+    // Sem contexto compartilhado: um upload por quadro aqui mesmo
+    if (!uploadWindow)
+    {
+        Entry* entry = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!uploadQueue.empty())
+            {
+                entry = uploadQueue.front();
+                uploadQueue.pop_front();
+            }
+        }
+        if (entry) uploadEntry(entry);
+    }
+
+    std::vector<Entry*> signaled;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < fenced.size();)
+        {
+            // Timeout 0: só consulta, nunca bloqueia o quadro
+            GLenum status = glClientWaitSync(fenced[i]->fence, 0, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+            {
+                signaled.push_back(fenced[i]);
+                fenced[i] = fenced.back();
+                fenced.pop_back();
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    for (Entry* entry : signaled)
+    {
+        glDeleteSync(entry->fence);
+        entry->fence = nullptr;
+        if (entry->job.finish) entry->job.finish();
+        std::lock_guard<std::mutex> lock(mutex);
+        entry->state = AssetState::Ready;
+        entry->done = std::chrono::steady_clock::now();
+    }
+}
+
+AssetState AssetLoader::state(AssetHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return handle < entries.size() ? entries[handle]->state : AssetState::Failed;
+}
+
+double AssetLoader::elapsedMs(AssetHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (handle >= entries.size()) return 0.0;
+    const Entry& entry = *entries[handle];
+    auto end = entry.state == AssetState::Loading ? std::chrono::steady_clock::now() : entry.done;
+    return std::chrono::duration<double, std::milli>(end - entry.submitted).count();
+}
+
+size_t AssetLoader::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const std::unique_ptr<Entry>& entry : entries)
+    {
+        if (entry->state == AssetState::Loading) ++count;
+    }
+    return count;
+}
@@ -0,0 +1,351 @@
+/*
+ *  Texturas pré-processadas (.mips) geradas pelo objbake ao lado de cada imagem.
+ *
+ *  O arquivo guarda a imagem já decodificada e toda a cadeia de mipmaps, então
+ *  em tempo de execução não há stbi_load nem glGenerateMipmap: basta mapear o
+ *  arquivo e enviar cada nível com glTexImage2D. Os níveis podem estar crus
+ *  ou em blocos BC1/BC3/BC7 (TextureCompress.cpp), enviados com
+ *  glCompressedTexImage2D (TextureUpload.cpp).
+ *
+ *  Forma de uso
+ *  -----------------
+ *  BakedTexture baked;
+ *  if (loadBakedTexture("../assets/Modelos3D/Cube.png", baked))
+ *      for (uint32_t i = 0; i < baked.header.levelCount; ++i)
+ *          glTexImage2D(GL_TEXTURE_2D, i, format, baked.header.levels[i].width,
+ *                       baked.header.levels[i].height, 0, format, GL_UNSIGNED_BYTE, baked.levelData(i));
+ *
+ *  Se a imagem mudar depois do bake, loadBakedTexture falha e o chamador volta
+ *  a decodificar a imagem normalmente até o próximo objbake.
+ */
+
+#include "BakedTexture.h"
+#include "FileStamp.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+static_assert(std::is_trivially_copyable<BakedTextureHeader>::value, "BakedTextureHeader precisa ser POD");
+
+namespace
+{
+    const char kMagic[4] = { 'T', 'X', 'M', 'P' };
+
+    inline size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Cabeçalho coerente com o tamanho do arquivo?
+    bool validLayout(const char* data, size_t size, BakedTextureHeader& h)
+    {
+        if (size < sizeof(BakedTextureHeader)) return false;
+        memcpy(&h, data, sizeof(h));
+        if (memcmp(h.magic, kMagic, 4) != 0 || h.version != kBakedTextureVersion) return false;
+        if (h.channels < 1 || h.channels > 4) return false;
+        if (h.levelCount == 0 || h.levelCount > kBakedTextureMaxLevels) return false;
+        TextureFormat format = static_cast<TextureFormat>(h.format);
+        if (format != TextureFormat::Raw && format != TextureFormat::BC1 && format != TextureFormat::BC3 &&
+            format != TextureFormat::BC7)
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < h.levelCount; ++i)
+        {
+            const BakedTextureLevel& level = h.levels[i];
+            if (level.size != textureLevelBytes(format, level.width, level.height, h.channels)) return false;
+            if (level.offset + level.size > size) return false;
+        }
+        return true;
+    }
+}
+
+size_t textureLevelBytes(TextureFormat format, uint32_t width, uint32_t height, uint32_t channels)
+{
+    size_t blocks = size_t((width + 3) / 4) * ((height + 3) / 4);
+    switch (format)
+    {
+    case TextureFormat::BC1: return blocks * 8;
+    case TextureFormat::BC3:
+    case TextureFormat::BC7: return blocks * 16;
+    default: return size_t(width) * height * channels;
+    }
+}
+
+const char* textureFormatName(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::BC1: return "BC1";
+    case TextureFormat::BC3: return "BC3";
+    case TextureFormat::BC7: return "BC7";
+    default: return "cru";
+    }
+}
+
+std::string bakedTexturePath(const std::string& imagePath)
+{
+    return imagePath + ".mips";
+}
+
+bool loadBakedTexture(const std::string& imagePath, BakedTexture& out)
+{
+    std::string path = bakedTexturePath(imagePath);
+    if (!out.file.open(path, true)) return false;
+
+    BakedTextureHeader h;
+    bool touched = false;
+    if (!validLayout(out.file.data, out.file.size, h) ||
+        !fileMatchesStamp(imagePath, h.srcSize, h.srcMtime, h.srcHash, touched))
+    {
+        out.file.close();
+        return false;
+    }
+
+    if (touched)
+    {
+        // Conteúdo igual com data nova: regrava só o cabeçalho
+        out.file.close();
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        file.close();
+        if (!out.file.open(path, true) || !validLayout(out.file.data, out.file.size, h))
+        {
+            out.file.close();
+            return false;
+        }
+    }
+
+    out.header = h;
+    return true;
+}
+
+namespace
+{
+    // Níveis menores que isso não compensam dividir entre threads
+    const size_t kParallelMipPixels = 256 * 256;
+    const int kRowsPerTask = 32;
+
+    // Executa rows(first, last) em faixas de linhas, no pool quando vale a pena
+    void forEachRowBlock(int height, size_t pixels, ThreadPool* pool, const std::function<void(int, int)>& rows)
+    {
+        if (!pool || pixels < kParallelMipPixels)
+        {
+            rows(0, height);
+            return;
+        }
+        size_t blocks = size_t(height + kRowsPerTask - 1) / kRowsPerTask;
+        pool->parallelFor(blocks, [&](size_t i) {
+            int first = int(i) * kRowsPerTask;
+            rows(first, std::min(height, first + kRowsPerTask));
+        });
+    }
+
+    void boxDownsample(const MipLevel& src, MipLevel& dst, int channels, ThreadPool* pool)
+    {
+        forEachRowBlock(dst.height, dst.pixels.size() / channels, pool, [&](int firstRow, int lastRow) {
+            for (int y = firstRow; y < lastRow; ++y)
+            {
+                // Em dimensões ímpares a última linha/coluna é repetida
+                int y0 = std::min(2 * y, src.height - 1);
+                int y1 = std::min(2 * y + 1, src.height - 1);
+                for (int x = 0; x < dst.width; ++x)
+                {
+                    int x0 = std::min(2 * x, src.width - 1);
+                    int x1 = std::min(2 * x + 1, src.width - 1);
+                    const unsigned char* p00 = &src.pixels[(size_t(y0) * src.width + x0) * channels];
+                    const unsigned char* p01 = &src.pixels[(size_t(y0) * src.width + x1) * channels];
+                    const unsigned char* p10 = &src.pixels[(size_t(y1) * src.width + x0) * channels];
+                    const unsigned char* p11 = &src.pixels[(size_t(y1) * src.width + x1) * channels];
+                    unsigned char* d = &dst.pixels[(size_t(y) * dst.width + x) * channels];
+                    for (int c = 0; c < channels; ++c)
+                    {
+                        d[c] = static_cast<unsigned char>((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+                    }
+                }
+            }
+        });
+    }
+
+    // Pesos dos 6 taps (offsets -2..3 a partir de 2x) da redução 2:1: sinc
+    // janelada por Kaiser (beta 4) com raio de 1,5 pixel do nível menor
+    const float* kaiserWeights()
+    {
+        static float weights[6];
+        static std::once_flag once;
+        std::call_once(once, []() {
+            auto besselI0 = [](double x) {
+                double sum = 1.0, term = 1.0;
+                for (int k = 1; k < 20; ++k)
+                {
+                    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                    sum += term;
+                }
+                return sum;
+            };
+            const double beta = 4.0, radius = 1.5, pi = 3.14159265358979323846;
+            double total = 0.0;
+            for (int k = -2; k <= 3; ++k)
+            {
+                double d = (k - 0.5) / 2.0;
+                double sinc = std::sin(pi * d) / (pi * d);
+                double t = d / radius;
+                double window = besselI0(beta * std::sqrt(1.0 - t * t)) / besselI0(beta);
+                weights[k + 2] = float(sinc * window);
+                total += sinc * window;
+            }
+            for (float& w : weights) w = float(w / total);
+        });
+        return weights;
+    }
+
+    // Separável: horizontal para um buffer em float, depois vertical.
+    // Eixo com tamanho 1 não é reduzido (só copia).
+    void kaiserDownsample(const MipLevel& src, MipLevel& dst, int channels, ThreadPool* pool)
+    {
+        const float* weights = kaiserWeights();
+        std::vector<float> rows(size_t(dst.width) * src.height * channels);
+
+        forEachRowBlock(src.height, rows.size() / channels, pool, [&](int firstRow, int lastRow) {
+            for (int y = firstRow; y < lastRow; ++y)
+            {
+                const unsigned char* line = &src.pixels[size_t(y) * src.width * channels];
+                float* out = &rows[size_t(y) * dst.width * channels];
+                for (int x = 0; x < dst.width; ++x)
+                {
+                    for (int c = 0; c < channels; ++c)
+                    {
+                        float sum = 0.0f;
+                        if (src.width == 1)
+                        {
+                            sum = line[c];
+                        }
+                        else
+                        {
+                            for (int k = -2; k <= 3; ++k)
+                            {
+                                int sx = std::min(std::max(2 * x + k, 0), src.width - 1);
+                                sum += weights[k + 2] * line[size_t(sx) * channels + c];
+                            }
+                        }
+                        out[size_t(x) * channels + c] = sum;
+                    }
+                }
+            }
+        });
+
+        forEachRowBlock(dst.height, dst.pixels.size() / channels, pool, [&](int firstRow, int lastRow) {
+            size_t stride = size_t(dst.width) * channels;
+            for (int y = firstRow; y < lastRow; ++y)
+            {
+                unsigned char* out = &dst.pixels[size_t(y) * stride];
+                for (size_t i = 0; i < stride; ++i)
+                {
+                    float sum = 0.0f;
+                    if (src.height == 1)
+                    {
+                        sum = rows[i];
+                    }
+                    else
+                    {
+                        for (int k = -2; k <= 3; ++k)
+                        {
+                            int sy = std::min(std::max(2 * y + k, 0), src.height - 1);
+                            sum += weights[k + 2] * rows[size_t(sy) * stride + i];
+                        }
+                    }
+                    // Os lóbulos negativos podem passar de [0, 255]
+                    out[i] = static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, sum + 0.5f)));
+                }
+            }
+        });
+    }
+}
+
+void generateMips(const unsigned char* pixels, int width, int height, int channels, std::vector<MipLevel>& out,
+                  MipFilter filter, ThreadPool* pool)
+{
+    out.clear();
+    out.emplace_back();
+    out[0].width = width;
+    out[0].height = height;
+    out[0].pixels.assign(pixels, pixels + size_t(width) * height * channels);
+
+    while ((out.back().width > 1 || out.back().height > 1) && out.size() < kBakedTextureMaxLevels)
+    {
+        const MipLevel& src = out.back();
+        MipLevel dst;
+        dst.width = std::max(1, src.width / 2);
+        dst.height = std::max(1, src.height / 2);
+        dst.pixels.resize(size_t(dst.width) * dst.height * channels);
+        if (filter == MipFilter::Kaiser)
+        {
+            kaiserDownsample(src, dst, channels, pool);
+        }
+        else
+        {
+            boxDownsample(src, dst, channels, pool);
+        }
+        out.push_back(std::move(dst));
+    }
+}
+
+bool writeBakedTexture(const std::string& imagePath, int channels, const std::vector<MipLevel>& levels,
+                       TextureFormat format)
+{
+    if (levels.empty() || levels.size() > kBakedTextureMaxLevels) return false;
+
+    BakedTextureHeader h = {};
+    memcpy(h.magic, kMagic, 4);
+    h.version = kBakedTextureVersion;
+    FileStamp src = fileStampOf(imagePath);
+    h.srcSize = src.size;
+    h.srcMtime = src.mtime;
+    h.srcHash = hashFileContents(imagePath);
+    h.channels = static_cast<uint32_t>(channels);
+    h.levelCount = static_cast<uint32_t>(levels.size());
+    h.format = static_cast<uint32_t>(format);
+
+    size_t offset = alignUp(sizeof(BakedTextureHeader), 16);
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        h.levels[i].width = static_cast<uint32_t>(levels[i].width);
+        h.levels[i].height = static_cast<uint32_t>(levels[i].height);
+        h.levels[i].offset = offset;
+        h.levels[i].size = levels[i].pixels.size();
+        if (h.levels[i].size != textureLevelBytes(format, h.levels[i].width, h.levels[i].height, h.channels)) return false;
+        offset = alignUp(offset + levels[i].pixels.size(), 16);
+    }
+
+    std::vector<char> bytes(offset, 0);
+    memcpy(bytes.data(), &h, sizeof(h));
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        memcpy(bytes.data() + h.levels[i].offset, levels[i].pixels.data(), levels[i].pixels.size());
+    }
+
+    // Grava num temporário e renomeia, para nunca deixar um arquivo pela metade
+    std::string path = bakedTexturePath(imagePath);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!file) return false;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    if (ec)
+    {
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
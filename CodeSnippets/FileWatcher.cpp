@@ -0,0 +1,164 @@
+/*
+ *  Observador de arquivos para o hot reload dos assets.
+ *
+ *  No Linux, um descritor inotify não bloqueante por processo e um watch por
+ *  pasta (IN_CLOSE_WRITE | IN_MOVED_TO): a pasta pega tanto quem grava o
+ *  arquivo direto quanto quem grava um temporário e renomeia por cima. Os
+ *  eventos de arquivos que ninguém pediu são ignorados. Sem inotify (outros
+ *  sistemas, ou limite de watches esgotado), o poll compara tamanho e data de
+ *  cada arquivo a cada 250 ms.
+ *
+ *  Cada mudança reinicia a espera do debounce; o arquivo só é entregue quando
+ *  parou de mudar e o tamanho/data realmente diferem do último entregue.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  FileWatcher watcher;
+ *  watcher.watch("../assets/Modelos3D/Suzanne.obj");
+ *  // a cada quadro
+ *  for (const std::string& path : watcher.poll())
+ *      recarregar(path);
+ */
+
+#include "FileWatcher.h"
+
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // "a/../b.obj", "./b.obj" e barras invertidas caem na mesma chave
+    std::string canonicalPath(const std::string& path)
+    {
+        std::error_code ec;
+        std::string canonical = fs::weakly_canonical(fs::path(path), ec).generic_string();
+        return (ec || canonical.empty()) ? path : canonical;
+    }
+
+    bool sameStamp(const FileStamp& a, const FileStamp& b)
+    {
+        return a.exists == b.exists && a.size == b.size && a.mtime == b.mtime;
+    }
+}
+
+FileWatcher::FileWatcher(int debounceMs)
+    : debounce(debounceMs), lastScan(Clock::now())
+{
+#ifdef __linux__
+    notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notifyFd < 0) std::cerr << "inotify indisponivel: hot reload por varredura das datas" << std::endl;
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (notifyFd >= 0) close(notifyFd);
+#endif
+}
+
+void FileWatcher::watch(const std::string& path)
+{
+    std::string key = canonicalPath(path);
+    if (files.count(key)) return;
+
+    Watched& watched = files[key];
+    watched.path = path;
+    watched.stamp = fileStampOf(key);
+
+#ifdef __linux__
+    if (notifyFd < 0) return;
+    std::string directory = fs::path(key).parent_path().generic_string();
+    for (const auto& entry : directories)
+    {
+        if (entry.second == directory) return;
+    }
+    int wd = inotify_add_watch(notifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0)
+    {
+        // Sem a pasta no inotify, o resto também passa a ser varrido
+        std::cerr << "inotify_add_watch falhou em " << directory << ": hot reload por varredura das datas" << std::endl;
+        close(notifyFd);
+        notifyFd = -1;
+        directories.clear();
+        return;
+    }
+    directories[wd] = directory;
+#endif
+}
+
+void FileWatcher::readEvents()
+{
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    for (;;)
+    {
+        ssize_t length = read(notifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        Clock::time_point now = Clock::now();
+        for (char* p = buffer; p < buffer + length;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+            auto directory = directories.find(event->wd);
+            if (event->len == 0 || directory == directories.end()) continue;
+
+            auto found = files.find(directory->second + "/" + event->name);
+            if (found == files.end()) continue;
+            found->second.changed = true;
+            found->second.changedAt = now;
+        }
+    }
+#endif
+}
+
+void FileWatcher::scanStamps()
+{
+    Clock::time_point now = Clock::now();
+    if (now - lastScan < scanInterval) return;
+    lastScan = now;
+
+    for (auto& entry : files)
+    {
+        Watched& watched = entry.second;
+        FileStamp stamp = fileStampOf(entry.first);
+        if (sameStamp(stamp, watched.stamp)) continue;
+        // Ainda gravando: a data muda a cada varredura e o debounce recomeça
+        watched.stamp = stamp;
+        watched.changed = true;
+        watched.changedAt = now;
+    }
+}
+
+std::vector<std::string> FileWatcher::poll()
+{
+    if (notifyFd >= 0) readEvents();
+    else scanStamps();
+
+    std::vector<std::string> settled;
+    Clock::time_point now = Clock::now();
+    for (auto& entry : files)
+    {
+        Watched& watched = entry.second;
+        if (!watched.changed || now - watched.changedAt < debounce) continue;
+        watched.changed = false;
+
+        // Apagado, ou aberto para escrita e fechado sem gravar: nada a recarregar
+        FileStamp stamp = fileStampOf(entry.first);
+        if (!stamp.exists) continue;
+        if (notifyFd >= 0 && sameStamp(stamp, watched.stamp)) continue;
+        watched.stamp = stamp;
+        settled.push_back(watched.path);
+    }
+    return settled;
+}
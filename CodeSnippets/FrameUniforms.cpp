@@ -0,0 +1,107 @@
+/*
+ *  Uniform buffer com as constantes do quadro e as luzes.
+ *
+ *  Os blocos Frame (view, projection, cameraPos, time) e Lights (até
+ *  MAX_LIGHTS luzes) moram no mesmo buffer, cada um no seu intervalo
+ *  (glBindBufferRange), ligados aos pontos FRAME_BLOCK_BINDING e
+ *  LIGHTS_BLOCK_BINDING. O GLSL 4.00 não tem layout(binding = N) em blocos,
+ *  então cada programa é ligado com glUniformBlockBinding (attach) depois do
+ *  link; os ids dos blocos saem da reflexão do ShaderProgram.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  ShaderProgram phong;
+ *  phong.build("phong", vs, fs);          // vs/fs com FRAME_UNIFORMS_GLSL
+ *  FrameUniforms::attach(phong);
+ *  FrameUniforms frameUniforms;
+ *  frameUniforms.lights.count = 1;
+ *  ...
+ *  // a cada quadro
+ *  frameUniforms.frame.view = camera.GetViewMatrix();
+ *  frameUniforms.upload();
+ *  // ou, com um PersistentRing, sem glBufferSubData:
+ *  frameUniforms.upload(ring.buffer(), ring.allocate(sizeof(FrameBlock), ring.bindAlignment()),
+ *                       ring.allocate(sizeof(LightsBlock), ring.bindAlignment()));
+ */
+
+#include "FrameUniforms.h"
+#include "ShaderProgram.h"
+#include "PersistentRing.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    bool attachBlock(ShaderProgram& program, const char* name, GLuint binding, size_t expectedSize)
+    {
+        const UniformBlockInfo* block = program.findBlock(name);
+        if (!block) return false;
+        if ((size_t)block->dataSize != expectedSize)
+        {
+            std::cerr << "Shader " << program.name() << ": bloco " << name << " tem " << block->dataSize
+                      << " bytes, esperado " << expectedSize << " (FrameUniforms.h)" << std::endl;
+        }
+        return program.bindBlock(name, binding);
+    }
+}
+
+FrameUniforms::FrameUniforms()
+{
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment <= 0) alignment = 256;
+    lightsOffset = (GLintptr)((sizeof(FrameBlock) + alignment - 1) / alignment * alignment);
+    staging.assign(lightsOffset + sizeof(LightsBlock), 0);
+
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)staging.size(), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, ubo, 0, sizeof(FrameBlock));
+    glBindBufferRange(GL_UNIFORM_BUFFER, LIGHTS_BLOCK_BINDING, ubo, lightsOffset, sizeof(LightsBlock));
+    upload();
+}
+
+FrameUniforms::~FrameUniforms()
+{
+    if (ubo) glDeleteBuffers(1, &ubo);
+}
+
+bool FrameUniforms::attach(ShaderProgram& program)
+{
+    bool frameBlock = attachBlock(program, "Frame", FRAME_BLOCK_BINDING, sizeof(FrameBlock));
+    bool lightsBlock = attachBlock(program, "Lights", LIGHTS_BLOCK_BINDING, sizeof(LightsBlock));
+    return frameBlock || lightsBlock;
+}
+
+void FrameUniforms::upload()
+{
+    std::memcpy(staging.data(), &frame, sizeof(FrameBlock));
+    std::memcpy(staging.data() + lightsOffset, &lights, sizeof(LightsBlock));
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, (GLsizeiptr)staging.size(), staging.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    if (ringBound)
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, ubo, 0, sizeof(FrameBlock));
+        glBindBufferRange(GL_UNIFORM_BUFFER, LIGHTS_BLOCK_BINDING, ubo, lightsOffset, sizeof(LightsBlock));
+        ringBound = false;
+    }
+}
+
+void FrameUniforms::upload(GLuint ringBuffer, const RingAllocation& frameRange, const RingAllocation& lightsRange)
+{
+    // Pedaço que não coube no anel: o caminho normal
+    if (!frameRange.data || !lightsRange.data)
+    {
+        upload();
+        return;
+    }
+    // Memória mapeada e coerente: visível para os draws seguintes sem flush
+    std::memcpy(frameRange.data, &frame, sizeof(FrameBlock));
+    std::memcpy(lightsRange.data, &lights, sizeof(LightsBlock));
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, ringBuffer, frameRange.offset, sizeof(FrameBlock));
+    glBindBufferRange(GL_UNIFORM_BUFFER, LIGHTS_BLOCK_BINDING, ringBuffer, lightsRange.offset, sizeof(LightsBlock));
+    ringBound = true;
+}
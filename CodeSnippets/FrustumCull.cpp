@@ -0,0 +1,188 @@
+/*
+ *  Descarte por frustum de muitas esferas envolventes de uma vez.
+ *
+ *  Uma esfera está fora quando fica inteira atrás de algum dos seis planos:
+ *  dot(plano.xyz, centro) + plano.w < -raio. Com as esferas em SoA
+ *  (SphereSet), oito centros entram num registrador AVX de 256 bits (ou em
+ *  dois SSE de 128) e cada plano custa três multiplicações, três somas e uma
+ *  comparação para as oito. A máscara final diz quais passaram; só elas viram
+ *  índices. O que sobra no fim (menos de 8) passa pelo teste escalar.
+ *
+ *  O caminho é escolhido na compilação: __AVX__ (-mavx, /arch:AVX) usa AVX,
+ *  qualquer x86-64 tem SSE2, e outras CPUs ficam com o laço escalar.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  Frustum frustum = extractFrustum(projection * view);
+ *  SphereSet spheres;
+ *  for (...) spheres.push(centroNoMundo, raioNoMundo);
+ *  std::vector<uint32_t> visible;
+ *  cullSpheres(frustum, spheres, visible, stats);
+ *  for (uint32_t i : visible) ... desenha o objeto i
+ *
+ *  // grupo de esferas dentro de uma maior: só testa uma a uma se ela cortar um plano
+ *  if (classifySphere(frustum, centroDoGrupo, raioDoGrupo) == 0) cullSpheres(...);
+ */
+
+#include "FrustumCull.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_CULL_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_CULL_SSE 1
+#endif
+
+#include <chrono>
+
+namespace
+{
+    bool sphereVisible(const Frustum& frustum, float x, float y, float z, float r)
+    {
+        for (const glm::vec4& plane : frustum.planes)
+        {
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w < -r) return false;
+        }
+        return true;
+    }
+
+    void appendMask(unsigned mask, uint32_t first, std::vector<uint32_t>& visible)
+    {
+        for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1)
+        {
+            if (mask & 1u) visible.push_back(first + lane);
+        }
+    }
+
+#if defined(FRUSTUM_CULL_SSE)
+    // Quatro esferas: bit i ligado se a esfera i está dentro
+    unsigned cullFour(const Frustum& frustum, const float* x, const float* y, const float* z, const float* r)
+    {
+        __m128 cx = _mm_loadu_ps(x);
+        __m128 cy = _mm_loadu_ps(y);
+        __m128 cz = _mm_loadu_ps(z);
+        __m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(r));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4& plane : frustum.planes)
+        {
+            __m128 d = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.w));
+            d = _mm_add_ps(d, _mm_mul_ps(cy, _mm_set1_ps(plane.y)));
+            d = _mm_add_ps(d, _mm_mul_ps(cz, _mm_set1_ps(plane.z)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+        }
+        return (unsigned)_mm_movemask_ps(inside);
+    }
+#endif
+}
+
+Frustum extractFrustum(const glm::mat4& matrix)
+{
+    glm::vec4 row0(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+    glm::vec4 row1(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+    glm::vec4 row2(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+    glm::vec4 row3(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+    Frustum frustum = { { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 } };
+    for (glm::vec4& plane : frustum.planes)
+    {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) plane /= length;
+    }
+    return frustum;
+}
+
+void SphereSet::clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+void SphereSet::reserve(size_t count)
+{
+    x.reserve(count);
+    y.reserve(count);
+    z.reserve(count);
+    radius.reserve(count);
+}
+
+void SphereSet::push(const glm::vec3& center, float r)
+{
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(r);
+}
+
+int classifySphere(const Frustum& frustum, const glm::vec3& center, float radius)
+{
+    int side = 1;
+    for (const glm::vec4& plane : frustum.planes)
+    {
+        float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+        if (distance < -radius) return -1;
+        if (distance < radius) side = 0;
+    }
+    return side;
+}
+
+size_t cullSpheres(const Frustum& frustum, const SphereSet& spheres, std::vector<uint32_t>& visible, FrustumCullStats& stats)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t before = visible.size();
+    size_t count = spheres.size();
+    const float* x = spheres.x.data();
+    const float* y = spheres.y.data();
+    const float* z = spheres.z.data();
+    const float* r = spheres.radius.data();
+
+    size_t i = 0;
+#if defined(FRUSTUM_CULL_AVX)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(x + i);
+        __m256 cy = _mm256_loadu_ps(y + i);
+        __m256 cz = _mm256_loadu_ps(z + i);
+        __m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(r + i));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4& plane : frustum.planes)
+        {
+            __m256 d = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane.x)), _mm256_set1_ps(plane.w));
+            d = _mm256_add_ps(d, _mm256_mul_ps(cy, _mm256_set1_ps(plane.y)));
+            d = _mm256_add_ps(d, _mm256_mul_ps(cz, _mm256_set1_ps(plane.z)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negR, _CMP_GE_OQ));
+        }
+        appendMask((unsigned)_mm256_movemask_ps(inside), (uint32_t)i, visible);
+    }
+#elif defined(FRUSTUM_CULL_SSE)
+    for (; i + 8 <= count; i += 8)
+    {
+        unsigned mask = cullFour(frustum, x + i, y + i, z + i, r + i);
+        mask |= cullFour(frustum, x + i + 4, y + i + 4, z + i + 4, r + i + 4) << 4;
+        appendMask(mask, (uint32_t)i, visible);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        if (sphereVisible(frustum, x[i], y[i], z[i], r[i])) visible.push_back((uint32_t)i);
+    }
+
+    size_t passed = visible.size() - before;
+    stats.tested += count;
+    stats.visible += passed;
+    stats.culled += count - passed;
+    stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return passed;
+}
+
+const char* frustumCullPath()
+{
+#if defined(FRUSTUM_CULL_AVX)
+    return "AVX";
+#elif defined(FRUSTUM_CULL_SSE)
+    return "SSE";
+#else
+    return "escalar";
+#endif
+}
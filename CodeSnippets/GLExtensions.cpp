@@ -0,0 +1,50 @@
+/*
+ *  Ponteiros das funções da OpenGL 4.3/4.4 usadas pelo GB.
+ *
+ *  O glad.c do projeto foi gerado para o núcleo 4.0. Em vez de regerar o
+ *  loader inteiro, as poucas funções mais novas são buscadas aqui pelo mesmo
+ *  GLADloadproc (glfwGetProcAddress), no mesmo esquema de nomes do glad:
+ *  o código chama glMultiDrawElementsIndirect como qualquer outra função.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+ *  if (!loadGLExtensions((GLADloadproc)glfwGetProcAddress)) ...   // driver sem 4.4
+ *  ...
+ *  glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, commandCount, 0);
+ *  glBufferStorage(GL_ARRAY_BUFFER, bytes, NULL, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+ */
+
+#include "GLExtensions.h"
+
+#include <iostream>
+
+#ifdef GL_EXTENSIONS_LOAD_4_3
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect = nullptr;
+#endif
+#ifdef GL_EXTENSIONS_LOAD_4_4
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = nullptr;
+#endif
+
+namespace
+{
+    template <typename Proc>
+    bool loadProc(GLADloadproc load, const char* name, Proc& proc)
+    {
+        proc = (Proc)load(name);
+        if (!proc) std::cerr << "OpenGL: " << name << " nao encontrada (precisa de contexto 4.4+)" << std::endl;
+        return proc != nullptr;
+    }
+}
+
+bool loadGLExtensions(GLADloadproc load)
+{
+    bool ok = true;
+#ifdef GL_EXTENSIONS_LOAD_4_3
+    ok &= loadProc(load, "glMultiDrawElementsIndirect", glad_glMultiDrawElementsIndirect);
+#endif
+#ifdef GL_EXTENSIONS_LOAD_4_4
+    ok &= loadProc(load, "glBufferStorage", glad_glBufferStorage);
+#endif
+    return ok;
+}
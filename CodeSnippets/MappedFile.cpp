@@ -0,0 +1,139 @@
+/*
+ *  Mapeamento de arquivos em memória usado pelos carregadores de malha.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  MappedFile file("../assets/Modelos3D/Suzanne.obj");
+ *  if (file.isOpen())
+ *      parse(file.data, file.data + file.size);
+ *
+ *  Arquivos vazios abrem com sucesso, com data apontando para "" e size 0.
+ */
+
+#include "MappedFile.h"
+
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        std::swap(opened, other.opened);
+#ifdef _WIN32
+        std::swap(fileHandle, other.fileHandle);
+        std::swap(mappingHandle, other.mappingHandle);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path, bool quiet)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        if (!quiet) std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    if (fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        data = "";
+        opened = true;
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        std::cerr << "Failed to map file: " << path << std::endl;
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const char*>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        if (!quiet) std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        std::cerr << "Failed to stat file: " << path << std::endl;
+        return false;
+    }
+    if (st.st_size == 0)
+    {
+        ::close(fd);
+        data = "";
+        opened = true;
+        return true;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // O mapeamento continua válido depois de fechar o descritor
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        std::cerr << "Failed to map file: " << path << std::endl;
+        return false;
+    }
+    madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    data = static_cast<const char*>(view);
+    size = static_cast<size_t>(st.st_size);
+#endif
+
+    opened = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (opened && size > 0)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#else
+        munmap(const_cast<char*>(data), size);
+#endif
+    }
+    data = nullptr;
+    size = 0;
+    opened = false;
+}
@@ -0,0 +1,96 @@
+/*
+ *  Tabela de materiais num shader storage buffer.
+ *
+ *  Cada trecho de malha guarda só o índice da sua vaga; o fragment shader
+ *  lê ka/kd/ks/q de materials[índice]. Trocar de material entre dois draws
+ *  deixa de ser uma série de glUniform* e vira um inteiro por draw, o que
+ *  também permite juntar objetos diferentes no mesmo draw mais tarde.
+ *
+ *  O glad do projeto é OpenGL 4.0, sem as constantes de SSBO da 4.3; elas
+ *  ficam em MaterialBuffer.h. glBindBufferBase já é da 3.0.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  MaterialBuffer materials;
+ *  submesh.materialIndex = materials.allocate(gpuMaterialOf(submesh));
+ *  ...
+ *  // a cada quadro, antes dos draws
+ *  materials.upload();
+ *  glVertexAttribI1ui(5, submesh.materialIndex);
+ */
+
+#include "MaterialBuffer.h"
+
+#include <algorithm>
+
+MaterialBuffer::MaterialBuffer()
+{
+    glGenBuffers(1, &ssbo);
+}
+
+MaterialBuffer::~MaterialBuffer()
+{
+    if (ssbo) glDeleteBuffers(1, &ssbo);
+}
+
+int MaterialBuffer::allocate(const GpuMaterial& material)
+{
+    int index;
+    if (!freeSlots.empty())
+    {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        index = (int)materials.size();
+        materials.emplace_back();
+    }
+    set(index, material);
+    return index;
+}
+
+void MaterialBuffer::set(int index, const GpuMaterial& material)
+{
+    if (index < 0 || index >= (int)materials.size()) return;
+    materials[index] = material;
+    if (dirtyEnd == 0)
+    {
+        dirtyBegin = (size_t)index;
+        dirtyEnd = (size_t)index + 1;
+    }
+    else
+    {
+        dirtyBegin = std::min(dirtyBegin, (size_t)index);
+        dirtyEnd = std::max(dirtyEnd, (size_t)index + 1);
+    }
+}
+
+void MaterialBuffer::release(int index)
+{
+    if (index < 0 || index >= (int)materials.size()) return;
+    // A vaga fica com o valor antigo até ser reaproveitada; ninguém mais aponta para ela
+    freeSlots.push_back(index);
+}
+
+void MaterialBuffer::upload()
+{
+    if (materials.size() <= capacity && dirtyEnd == 0) return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+    if (materials.size() > capacity)
+    {
+        // Cresce em dobro: recarregar um modelo não realoca a cada vez
+        capacity = std::max<size_t>(materials.size(), capacity * 2);
+        capacity = std::max<size_t>(capacity, 16);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, GLsizeiptr(capacity * sizeof(GpuMaterial)), NULL, GL_DYNAMIC_DRAW);
+        dirtyBegin = 0;
+        dirtyEnd = materials.size();
+        // A ligação continua valendo nos quadros seguintes
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_BUFFER_BINDING, ssbo);
+    }
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, GLintptr(dirtyBegin * sizeof(GpuMaterial)),
+                    GLsizeiptr((dirtyEnd - dirtyBegin) * sizeof(GpuMaterial)), &materials[dirtyBegin]);
+    dirtyBegin = dirtyEnd = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
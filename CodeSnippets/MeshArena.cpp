@@ -0,0 +1,158 @@
+/*
+ *  Buffers de vértices e índices compartilhados por todas as malhas.
+ *
+ *  Com um VBO/EBO por geometria, cada draw precisa trocar o VAO. Com todas as
+ *  malhas nos mesmos dois buffers, um VAO só serve a cena inteira e cada
+ *  malha é só um (baseVertex, firstIndex) dentro deles, que é exatamente o
+ *  que um DrawElementsIndirectCommand carrega: a cena cabe num
+ *  glMultiDrawElementsIndirect.
+ *
+ *  Os intervalos são dados por first-fit numa lista livre ordenada (vizinhos
+ *  livres se juntam na devolução). Sem espaço, o buffer é trocado por um com
+ *  o dobro do tamanho e o conteúdo copiado na GPU (glCopyBufferSubData);
+ *  generation() avisa quem guardou o nome antigo num VAO.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  MeshArena arena(8 * sizeof(float), GL_UNSIGNED_SHORT);   // malhas com até 65536 vértices
+ *  geom.arenaSlice = arena.add(vertices, vertexCount, indices, indexCount);
+ *  ...
+ *  if (arena.generation() != vaoGeneration) refazerVAO(arena.vertexBuffer(), arena.indexBuffer());
+ *  command.baseVertex = geom.arenaSlice.baseVertex;
+ *  command.firstIndex = geom.arenaSlice.firstIndex + range.firstIndex;
+ *  ...
+ *  arena.release(geom.arenaSlice);          // hot reload / geometria que sai
+ */
+
+#include "MeshArena.h"
+
+#include <algorithm>
+
+size_t MeshArena::RangeAllocator::allocate(size_t count)
+{
+    used += count;
+    for (size_t i = 0; i < freeRanges.size(); ++i)
+    {
+        Range& range = freeRanges[i];
+        if (range.count < count) continue;
+        size_t first = range.first;
+        range.first += count;
+        range.count -= count;
+        if (range.count == 0) freeRanges.erase(freeRanges.begin() + i);
+        return first;
+    }
+    size_t first = top;
+    top += count;
+    return first;
+}
+
+void MeshArena::RangeAllocator::release(size_t first, size_t count)
+{
+    if (count == 0) return;
+    used -= count;
+    auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), first,
+                                 [](const Range& range, size_t value) { return range.first < value; });
+    next = freeRanges.insert(next, Range{ first, count });
+
+    // Junta com o vizinho de cima e o de baixo
+    auto following = next + 1;
+    if (following != freeRanges.end() && next->first + next->count == following->first)
+    {
+        next->count += following->count;
+        freeRanges.erase(following);
+    }
+    if (next != freeRanges.begin())
+    {
+        auto previous = next - 1;
+        if (previous->first + previous->count == next->first)
+        {
+            previous->count += next->count;
+            next = freeRanges.erase(next) - 1;
+        }
+    }
+
+    // Intervalo livre encostado no topo volta a ser espaço nunca usado
+    if (next->first + next->count == top)
+    {
+        top = next->first;
+        freeRanges.erase(next);
+    }
+}
+
+MeshArena::MeshArena(GLsizei vertexStride, GLenum indexType)
+    : stride(vertexStride), type(indexType)
+{
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+}
+
+MeshArena::~MeshArena()
+{
+    if (vbo) glDeleteBuffers(1, &vbo);
+    if (ebo) glDeleteBuffers(1, &ebo);
+}
+
+void MeshArena::reserve(GLuint& buffer, size_t& capacity, size_t end, size_t elementSize)
+{
+    if (end <= capacity) return;
+
+    // Cresce em dobro: recarregar ou somar malhas não realoca a cada vez
+    size_t newCapacity = std::max<size_t>(end, capacity * 2);
+    GLuint grown;
+    glGenBuffers(1, &grown);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(newCapacity * elementSize), NULL, GL_STATIC_DRAW);
+    if (capacity > 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, GLsizeiptr(capacity * elementSize));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    buffer = grown;
+    capacity = newCapacity;
+    ++generationCount;
+}
+
+MeshSlice MeshArena::add(const void* vertices, GLuint vertexCount, const void* indices, GLuint indexCount)
+{
+    MeshSlice slice;
+    if (vertexCount == 0 || indexCount == 0) return slice;
+
+    slice.vertexCount = vertexCount;
+    slice.indexCount = indexCount;
+    slice.baseVertex = (GLint)vertexRanges.allocate(vertexCount);
+    slice.firstIndex = (GLuint)indexRanges.allocate(indexCount);
+    reserve(vbo, vertexCapacity, vertexRanges.top, (size_t)stride);
+    reserve(ebo, indexCapacity, indexRanges.top, indexSize());
+
+    // GL_COPY_WRITE_BUFFER: não mexe no GL_ELEMENT_ARRAY_BUFFER do VAO que estiver ligado
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(size_t(slice.baseVertex) * stride), GLsizeiptr(size_t(vertexCount) * stride), vertices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(size_t(slice.firstIndex) * indexSize()), GLsizeiptr(size_t(indexCount) * indexSize()), indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    ++meshCount;
+    return slice;
+}
+
+void MeshArena::release(const MeshSlice& slice)
+{
+    if (!slice.valid()) return;
+    vertexRanges.release((size_t)slice.baseVertex, slice.vertexCount);
+    indexRanges.release(slice.firstIndex, slice.indexCount);
+    --meshCount;
+}
+
+MeshArenaStats MeshArena::stats() const
+{
+    MeshArenaStats stats;
+    stats.meshes = meshCount;
+    stats.vertices = vertexRanges.used;
+    stats.indices = indexRanges.used;
+    stats.vertexBytes = vertexCapacity * stride;
+    stats.indexBytes = indexCapacity * indexSize();
+    stats.grows = generationCount;
+    return stats;
+}
@@ -0,0 +1,358 @@
+/*
+ *  Cache binário de malhas (.meshcache) gerado ao lado de cada .obj.
+ *
+ *  Na primeira execução o .obj é lido, soldado (buildIndexedMesh), reordenado
+ *  para o cache de vértices (optimizeMesh), simplificado em LODs
+ *  (buildLodChain) e cada usemtl resolvido no .mtl; o resultado é
+ *  gravado já no layout que vai para a GPU. Nas
+ *  execuções seguintes basta mapear o arquivo e entregar os ponteiros ao
+ *  glBufferData: um mmap e um upload, sem ler texto.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  CachedMesh mesh;
+ *  if (loadMeshCached("../assets/Modelos3D/Suzanne.obj", mesh))
+ *      glBufferData(GL_ARRAY_BUFFER, mesh.vertexBytes(), mesh.vertices, GL_STATIC_DRAW);
+ *
+ *  O cache é refeito sozinho quando a versão do formato muda ou quando o
+ *  .obj/.mtl muda. Tamanho e data iguais bastam; se a data mudou mas o hash
+ *  do conteúdo é o mesmo (ex.: checkout do git), só as datas são atualizadas.
+ */
+
+#include "MeshCache.h"
+#include "FileStamp.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+static_assert(std::is_trivially_copyable<MeshCacheHeader>::value, "MeshCacheHeader precisa ser POD");
+static_assert(std::is_trivially_copyable<MeshCacheMaterial>::value, "MeshCacheMaterial precisa ser POD");
+static_assert(sizeof(IndexedSubmesh) == 12, "IndexedSubmesh vai direto para o arquivo");
+
+namespace
+{
+    const char kMagic[4] = { 'M', 'S', 'H', 'C' };
+
+    std::string mtlPathFor(const std::string& objPath, const char* mtlLib)
+    {
+        return (fs::path(objPath).parent_path() / mtlLib).string();
+    }
+
+    template <size_t N>
+    void copyString(char (&dst)[N], const std::string& src)
+    {
+        memset(dst, 0, N);
+        memcpy(dst, src.data(), std::min(src.size(), N - 1));
+    }
+
+    inline void copyVec3(float dst[3], const glm::vec3& v)
+    {
+        dst[0] = v.x;
+        dst[1] = v.y;
+        dst[2] = v.z;
+    }
+
+    inline size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Cabeçalho coerente com o tamanho do arquivo?
+    bool validLayout(const char* data, size_t size)
+    {
+        if (size < sizeof(MeshCacheHeader)) return false;
+        MeshCacheHeader h;
+        memcpy(&h, data, sizeof(h));
+        if (memcmp(h.magic, kMagic, 4) != 0 || h.version != kMeshCacheVersion) return false;
+        if (h.floatsPerVertex != kObjFloatsPerVertex || (h.indexSize != 2 && h.indexSize != 4)) return false;
+        uint64_t vertexEnd = h.vertexOffset + uint64_t(h.vertexCount) * h.floatsPerVertex * sizeof(float);
+        uint64_t indexEnd = h.indexOffset + uint64_t(h.indexCount) * h.indexSize;
+        if (h.lodCount == 0 || h.lodCount > kMaxMeshLods || h.lodRatioCount > kMaxMeshLods) return false;
+        for (uint32_t i = 0; i < h.lodCount; ++i)
+        {
+            if (uint64_t(h.lods[i].firstIndex) + h.lods[i].indexCount > h.indexCount) return false;
+        }
+        uint64_t materialEnd = h.materialOffset + uint64_t(h.materialCount) * sizeof(MeshCacheMaterial);
+        uint64_t submeshEnd = h.submeshOffset + uint64_t(h.submeshCount) * h.lodCount * sizeof(IndexedSubmesh);
+        if (vertexEnd > size || indexEnd > size || materialEnd > size || submeshEnd > size) return false;
+        if (h.materialOffset % alignof(MeshCacheMaterial) != 0 || h.submeshOffset % alignof(IndexedSubmesh) != 0) return false;
+
+        // Trechos dentro dos índices e materiais existentes
+        const IndexedSubmesh* submeshes = reinterpret_cast<const IndexedSubmesh*>(data + h.submeshOffset);
+        for (size_t i = 0; i < size_t(h.submeshCount) * h.lodCount; ++i)
+        {
+            if (uint64_t(submeshes[i].firstIndex) + submeshes[i].indexCount > h.indexCount) return false;
+            if (submeshes[i].material >= h.materialCount) return false;
+        }
+        return true;
+    }
+
+    // LODs gerados com as mesmas frações pedidas agora?
+    bool sameLodRatios(const MeshCacheHeader& h, const std::vector<float>& ratios)
+    {
+        size_t count = std::min(ratios.size(), kMaxMeshLods - 1);
+        if (h.lodRatioCount != count) return false;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (h.lodRatios[i] != ratios[i]) return false;
+        }
+        return true;
+    }
+
+    void pointInto(CachedMesh& out, const char* base)
+    {
+        memcpy(&out.header, base, sizeof(MeshCacheHeader));
+        out.vertices = reinterpret_cast<const float*>(base + out.header.vertexOffset);
+        out.indices = base + out.header.indexOffset;
+        out.materials = reinterpret_cast<const MeshCacheMaterial*>(base + out.header.materialOffset);
+        out.submeshes = reinterpret_cast<const IndexedSubmesh*>(base + out.header.submeshOffset);
+    }
+
+    bool writeFile(const std::string& path, const std::vector<char>& bytes)
+    {
+        // Grava num temporário e renomeia, para nunca deixar um cache pela metade
+        std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+            file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            if (!file) return false;
+        }
+        std::error_code ec;
+        fs::rename(tmpPath, path, ec);
+        if (ec)
+        {
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
+    }
+}
+
+ObjMaterial CachedMesh::material(size_t index) const
+{
+    ObjMaterial mat;
+    if (index >= header.materialCount) return mat;
+    const MeshCacheMaterial& m = materials[index];
+    mat.name = m.name;
+    mat.diffuseMap = m.diffuseMap;
+    mat.ka = glm::vec3(m.ka[0], m.ka[1], m.ka[2]);
+    mat.kd = glm::vec3(m.kd[0], m.kd[1], m.kd[2]);
+    mat.ks = glm::vec3(m.ks[0], m.ks[1], m.ks[2]);
+    mat.ke = glm::vec3(m.ke[0], m.ke[1], m.ke[2]);
+    mat.shininess = m.shininess;
+    return mat;
+}
+
+std::string meshCachePath(const std::string& objPath)
+{
+    return objPath + ".meshcache";
+}
+
+void fillMeshCacheKeys(const std::string& objPath, const std::string& mtlLib, MeshCacheHeader& keys)
+{
+    FileStamp obj = fileStampOf(objPath);
+    keys.objSize = obj.size;
+    keys.objMtime = obj.mtime;
+    keys.objHash = hashFileContents(objPath);
+
+    copyString(keys.mtlLib, mtlLib);
+    keys.mtlSize = 0;
+    keys.mtlMtime = 0;
+    keys.mtlHash = 0;
+    if (!mtlLib.empty())
+    {
+        std::string mtlPath = mtlPathFor(objPath, keys.mtlLib);
+        FileStamp mtl = fileStampOf(mtlPath);
+        keys.mtlSize = mtl.size;
+        keys.mtlMtime = mtl.mtime;
+        keys.mtlHash = hashFileContents(mtlPath);
+    }
+}
+
+std::vector<char> serializeMeshCache(const MeshCacheHeader& keys, const IndexedMesh& mesh, const std::vector<ObjMaterial>& materials,
+                                     const MeshOptimizeStats* stats, const std::vector<MeshLod>& lods,
+                                     const std::vector<float>& lodRatios)
+{
+    MeshCacheHeader h = keys;
+    memcpy(h.magic, kMagic, 4);
+    h.version = kMeshCacheVersion;
+    h.floatsPerVertex = kObjFloatsPerVertex;
+    h.vertexCount = static_cast<uint32_t>(mesh.vertexCount());
+    h.indexCount = static_cast<uint32_t>(mesh.indices.size());
+    h.indexSize = mesh.fitsUint16() ? 2 : 4;
+    h.vertexOffset = alignUp(sizeof(MeshCacheHeader), 16);
+    h.indexOffset = alignUp(h.vertexOffset + mesh.vertices.size() * sizeof(float), 16);
+    copyVec3(h.boundsMin, mesh.boundsMin);
+    copyVec3(h.boundsMax, mesh.boundsMax);
+
+    if (lods.empty())
+    {
+        h.lodCount = 1;
+        h.lods[0] = { 0, h.indexCount, 1.0f, 0.0f };
+    }
+    else
+    {
+        h.lodCount = static_cast<uint32_t>(std::min(lods.size(), kMaxMeshLods));
+        std::copy_n(lods.begin(), h.lodCount, h.lods);
+    }
+    h.lodRatioCount = static_cast<uint32_t>(std::min(lodRatios.size(), kMaxMeshLods - 1));
+    std::copy_n(lodRatios.begin(), h.lodRatioCount, h.lodRatios);
+
+    if (stats)
+    {
+        h.acmrBefore = stats->before.acmr;
+        h.acmrAfter = stats->after.acmr;
+        h.atvrBefore = stats->before.atvr;
+        h.atvrAfter = stats->after.atvr;
+    }
+    else
+    {
+        // ACMR/ATVR medidos só no LOD 0
+        std::vector<uint32_t> baseIndices(mesh.indices.begin(), mesh.indices.begin() + h.lods[0].indexCount);
+        VertexCacheStats current = analyzeVertexCache(baseIndices, mesh.vertexCount());
+        h.acmrBefore = h.acmrAfter = current.acmr;
+        h.atvrBefore = h.atvrAfter = current.atvr;
+    }
+
+    // Sem trechos por material (malha montada à mão): um trecho por nível, com o primeiro material
+    std::vector<IndexedSubmesh> submeshes = mesh.submeshes;
+    h.submeshCount = static_cast<uint32_t>(std::max<size_t>(1, mesh.submeshCount()));
+    if (submeshes.size() != size_t(h.submeshCount) * h.lodCount)
+    {
+        submeshes.clear();
+        h.submeshCount = 1;
+        for (uint32_t i = 0; i < h.lodCount; ++i) submeshes.push_back({ h.lods[i].firstIndex, h.lods[i].indexCount, 0 });
+    }
+    std::vector<MeshCacheMaterial> records(std::max<size_t>(1, materials.size()));
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        ObjMaterial material = i < materials.size() ? materials[i] : ObjMaterial();
+        MeshCacheMaterial& m = records[i];
+        copyString(m.name, material.name);
+        copyString(m.diffuseMap, material.diffuseMap);
+        copyVec3(m.ka, material.ka);
+        copyVec3(m.kd, material.kd);
+        copyVec3(m.ks, material.ks);
+        copyVec3(m.ke, material.ke);
+        m.shininess = material.shininess;
+    }
+    for (IndexedSubmesh& submesh : submeshes) submesh.material = std::min<uint32_t>(submesh.material, uint32_t(records.size() - 1));
+    h.materialCount = static_cast<uint32_t>(records.size());
+    h.materialOffset = alignUp(h.indexOffset + size_t(h.indexCount) * h.indexSize, 16);
+    h.submeshOffset = alignUp(h.materialOffset + records.size() * sizeof(MeshCacheMaterial), 16);
+
+    std::vector<char> bytes(h.submeshOffset + submeshes.size() * sizeof(IndexedSubmesh), 0);
+    memcpy(bytes.data(), &h, sizeof(h));
+    memcpy(bytes.data() + h.vertexOffset, mesh.vertices.data(), mesh.vertices.size() * sizeof(float));
+    if (h.indexSize == 2)
+    {
+        std::vector<uint16_t> indices16;
+        packIndices16(mesh.indices, indices16);
+        memcpy(bytes.data() + h.indexOffset, indices16.data(), indices16.size() * sizeof(uint16_t));
+    }
+    else
+    {
+        memcpy(bytes.data() + h.indexOffset, mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+    }
+    memcpy(bytes.data() + h.materialOffset, records.data(), records.size() * sizeof(MeshCacheMaterial));
+    memcpy(bytes.data() + h.submeshOffset, submeshes.data(), submeshes.size() * sizeof(IndexedSubmesh));
+    return bytes;
+}
+
+bool loadMeshCached(const std::string& objPath, CachedMesh& out, const std::vector<float>& lodRatios)
+{
+    std::string cachePath = meshCachePath(objPath);
+
+    out.fromCache = false;
+    out.memory.clear();
+    if (out.file.open(cachePath, true) && validLayout(out.file.data, out.file.size))
+    {
+        MeshCacheHeader h;
+        memcpy(&h, out.file.data, sizeof(h));
+
+        bool touched = false;
+        bool valid = sameLodRatios(h, lodRatios) && fileMatchesStamp(objPath, h.objSize, h.objMtime, h.objHash, touched);
+        if (valid && h.mtlLib[0] != '\0')
+        {
+            valid = fileMatchesStamp(mtlPathFor(objPath, h.mtlLib), h.mtlSize, h.mtlMtime, h.mtlHash, touched);
+        }
+
+        if (valid)
+        {
+            if (touched)
+            {
+                // Conteúdo igual com data nova: regrava só o cabeçalho
+                out.file.close();
+                std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+                file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+                file.close();
+                if (!out.file.open(cachePath, true) || !validLayout(out.file.data, out.file.size)) valid = false;
+            }
+            if (valid)
+            {
+                pointInto(out, out.file.data);
+                out.fromCache = true;
+                return true;
+            }
+        }
+    }
+    out.file.close();
+
+    // Cache ausente ou velho: lê o texto e gera de novo
+    ObjData obj;
+    if (!parseObj(objPath.c_str(), obj, 0)) return false;
+
+    IndexedMesh mesh;
+    buildIndexedMesh(obj, mesh);
+    MeshOptimizeStats stats;
+    optimizeMesh(mesh, &stats);
+    std::vector<MeshLod> lods;
+    buildLodChain(mesh, lodRatios, lods);
+
+    std::vector<ObjMaterial> library;
+    if (!obj.mtlLib.empty())
+    {
+        std::string mtlPath = mtlPathFor(objPath, obj.mtlLib.c_str());
+        if (!parseMtlLibrary(mtlPath.c_str(), library))
+        {
+            std::cerr << "Failed to open MTL file: " << mtlPath << std::endl;
+        }
+    }
+
+    // Um material por nome de usemtl, na ordem dos trechos
+    std::vector<ObjMaterial> materials;
+    for (const std::string& name : mesh.materials)
+    {
+        const ObjMaterial* found = findMaterial(library, name);
+        if (!name.empty() && (!found || found->name != name))
+        {
+            std::cerr << "Material " << name << " nao encontrado em " << obj.mtlLib << std::endl;
+        }
+        materials.push_back(found ? *found : ObjMaterial());
+        if (!name.empty()) materials.back().name = name;
+    }
+
+    MeshCacheHeader keys = {};
+    fillMeshCacheKeys(objPath, obj.mtlLib, keys);
+    std::vector<char> bytes = serializeMeshCache(keys, mesh, materials, &stats, lods, lodRatios);
+
+    if (writeFile(cachePath, bytes) && out.file.open(cachePath, true) && validLayout(out.file.data, out.file.size))
+    {
+        pointInto(out, out.file.data);
+    }
+    else
+    {
+        std::cerr << "Nao foi possivel gravar o cache " << cachePath << ", usando copia em memoria" << std::endl;
+        out.file.close();
+        out.memory = std::move(bytes);
+        pointInto(out, out.memory.data());
+    }
+    return true;
+}
@@ -0,0 +1,326 @@
+/*
+ *  Otimização da ordem de triângulos e vértices das malhas indexadas.
+ *
+ *  Roda uma vez quando o .meshcache é gerado (setupGeometry na primeira
+ *  execução ou objbake), então o custo não aparece nas execuções seguintes.
+ *
+ *   1. optimizeVertexCache: Tipsify (Sander, Nehab, Barczak, "Fast Triangle
+ *      Reordering for Vertex Locality and Reduced Overdraw", 2007)
+ *   2. optimizeOverdraw: ordena os trechos gerados pelo Tipsify de fora para dentro
+ *   3. optimizeVertexFetch: renumera os vértices na ordem de uso
+ *
+ *  Forma de uso
+ *  -----------------
+ *  IndexedMesh mesh;
+ *  buildIndexedMesh(obj, mesh);
+ *  MeshOptimizeStats stats;
+ *  optimizeMesh(mesh, &stats);   // stats.before / stats.after: ACMR e ATVR
+ */
+
+#include "MeshOptimize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+    // Cache FIFO pós-transformação: devolve quantos vértices do triângulo não estavam no cache
+    struct FifoCache
+    {
+        std::vector<uint32_t> timestamps;
+        uint32_t time;
+        unsigned size;
+
+        FifoCache(size_t vertexCount, unsigned cacheSize)
+            : timestamps(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+
+        void reset() { time += size + 1; }
+
+        unsigned access(const uint32_t* triangle)
+        {
+            unsigned misses = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t v = triangle[k];
+                if (time - timestamps[v] > size)
+                {
+                    timestamps[v] = time++;
+                    ++misses;
+                }
+            }
+            return misses;
+        }
+    };
+
+    // Triângulos que usam cada vértice (lista compacta: offsets + dados)
+    struct Adjacency
+    {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+
+        Adjacency(const std::vector<uint32_t>& indices, size_t vertexCount)
+            : offsets(vertexCount + 1, 0), triangles(indices.size())
+        {
+            for (uint32_t v : indices) ++offsets[v + 1];
+            for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i) triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        uint32_t count(uint32_t v) const { return offsets[v + 1] - offsets[v]; }
+        const uint32_t* begin(uint32_t v) const { return triangles.data() + offsets[v]; }
+        const uint32_t* end(uint32_t v) const { return triangles.data() + offsets[v + 1]; }
+    };
+
+    inline glm::vec3 positionOf(const float* vertices, uint32_t v)
+    {
+        const float* p = vertices + size_t(v) * kObjFloatsPerVertex;
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+}
+
+VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned cacheSize)
+{
+    VertexCacheStats stats;
+    if (indices.empty() || vertexCount == 0) return stats;
+
+    FifoCache cache(vertexCount, cacheSize);
+    size_t misses = 0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) misses += cache.access(&indices[i]);
+
+    stats.acmr = float(misses) / float(indices.size() / 3);
+    stats.atvr = float(misses) / float(vertexCount);
+    return stats;
+}
+
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount,
+                         std::vector<uint32_t>* clusterStarts, unsigned cacheSize)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (clusterStarts) clusterStarts->clear();
+    if (triangleCount == 0 || vertexCount == 0) return;
+
+    Adjacency adjacency(indices, vertexCount);
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v) liveTriangles[v] = adjacency.count(v);
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    uint32_t time = cacheSize + 1;
+    uint32_t cursor = 0;
+    int fanning = 0;
+    if (clusterStarts) clusterStarts->push_back(0);
+
+    while (fanning >= 0)
+    {
+        // Emite todos os triângulos ainda vivos em volta do vértice atual
+        candidates.clear();
+        uint32_t f = static_cast<uint32_t>(fanning);
+        for (const uint32_t* t = adjacency.begin(f); t != adjacency.end(f); ++t)
+        {
+            if (emitted[*t]) continue;
+            emitted[*t] = true;
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t v = indices[size_t(*t) * 3 + k];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --liveTriangles[v];
+                if (time - cacheTime[v] > cacheSize) cacheTime[v] = time++;
+            }
+        }
+
+        // Próximo leque: o vizinho que ainda estará no cache e mais antigo nele
+        int next = -1;
+        int best = -1;
+        for (uint32_t v : candidates)
+        {
+            if (liveTriangles[v] == 0) continue;
+            int priority = 0;
+            if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize) priority = int(time - cacheTime[v]);
+            if (priority > best)
+            {
+                best = priority;
+                next = int(v);
+            }
+        }
+
+        if (next == -1)
+        {
+            // Beco sem saída: volta pela pilha de vértices recentes ou pega o próximo vivo
+            while (!deadEnd.empty() && next == -1)
+            {
+                uint32_t d = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[d] > 0) next = int(d);
+            }
+            while (next == -1 && cursor < vertexCount)
+            {
+                if (liveTriangles[cursor] > 0) next = int(cursor);
+                else ++cursor;
+            }
+            if (next != -1 && clusterStarts && result.size() < indices.size())
+            {
+                clusterStarts->push_back(static_cast<uint32_t>(result.size() / 3));
+            }
+        }
+        fanning = next;
+    }
+
+    indices.swap(result);
+}
+
+size_t optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusterStarts,
+                        const float* vertices, size_t vertexCount, float threshold, unsigned cacheSize)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return 0;
+
+    // Fronteiras duras (do Tipsify) + fronteiras suaves: dentro de cada trecho,
+    // corta assim que o pedaço acumulado tiver ACMR <= threshold * ACMR do trecho
+    std::vector<uint32_t> hard(clusterStarts);
+    if (hard.empty() || hard.front() != 0) hard.insert(hard.begin(), 0);
+    hard.push_back(static_cast<uint32_t>(triangleCount));
+
+    std::vector<uint32_t> starts;
+    FifoCache cache(vertexCount, cacheSize);
+    for (size_t c = 0; c + 1 < hard.size(); ++c)
+    {
+        uint32_t begin = hard[c], end = hard[c + 1];
+        if (begin >= end) continue;
+
+        cache.reset();
+        size_t clusterMisses = 0;
+        for (uint32_t t = begin; t < end; ++t) clusterMisses += cache.access(&indices[size_t(t) * 3]);
+        float target = threshold * float(clusterMisses) / float(end - begin);
+
+        starts.push_back(begin);
+        cache.reset();
+        size_t misses = 0;
+        uint32_t pieceStart = begin;
+        for (uint32_t t = begin; t < end; ++t)
+        {
+            misses += cache.access(&indices[size_t(t) * 3]);
+            if (t + 1 < end && float(misses) / float(t + 1 - pieceStart) <= target)
+            {
+                starts.push_back(t + 1);
+                pieceStart = t + 1;
+                misses = 0;
+                cache.reset();
+            }
+        }
+    }
+    starts.push_back(static_cast<uint32_t>(triangleCount));
+    size_t clusterCount = starts.size() - 1;
+
+    // Centro da malha ponderado por área
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        glm::vec3 a = positionOf(vertices, indices[t * 3]);
+        glm::vec3 b = positionOf(vertices, indices[t * 3 + 1]);
+        glm::vec3 c = positionOf(vertices, indices[t * 3 + 2]);
+        float area = glm::length(glm::cross(b - a, c - a));
+        meshCenter += (a + b + c) * (area / 3.0f);
+        meshArea += area;
+    }
+    if (meshArea > 0.0f) meshCenter /= meshArea;
+
+    // Chave de cada agrupamento: quão "para fora" ele está e está virado
+    std::vector<float> sortKey(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        glm::vec3 center(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (uint32_t t = starts[c]; t < starts[c + 1]; ++t)
+        {
+            glm::vec3 a = positionOf(vertices, indices[size_t(t) * 3]);
+            glm::vec3 b = positionOf(vertices, indices[size_t(t) * 3 + 1]);
+            glm::vec3 v = positionOf(vertices, indices[size_t(t) * 3 + 2]);
+            glm::vec3 n = glm::cross(b - a, v - a);
+            float triangleArea = glm::length(n);
+            center += (a + b + v) * (triangleArea / 3.0f);
+            normal += n;
+            area += triangleArea;
+        }
+        if (area > 0.0f) center /= area;
+        float normalLength = glm::length(normal);
+        sortKey[c] = normalLength > 0.0f ? glm::dot(center - meshCenter, normal / normalLength) : 0.0f;
+    }
+
+    std::vector<uint32_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (uint32_t c : order)
+    {
+        result.insert(result.end(), indices.begin() + size_t(starts[c]) * 3, indices.begin() + size_t(starts[c + 1]) * 3);
+    }
+    indices.swap(result);
+    return clusterCount;
+}
+
+void optimizeVertexFetch(std::vector<float>& vertices, std::vector<uint32_t>& indices)
+{
+    size_t vertexCount = vertices.size() / kObjFloatsPerVertex;
+    const uint32_t unused = UINT32_MAX;
+    std::vector<uint32_t> remap(vertexCount, unused);
+
+    uint32_t next = 0;
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == unused) remap[index] = next++;
+        index = remap[index];
+    }
+    // Vértices sem triângulo vão para o fim, na ordem original
+    for (uint32_t& r : remap)
+    {
+        if (r == unused) r = next++;
+    }
+
+    std::vector<float> reordered(vertices.size());
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        std::copy_n(vertices.begin() + v * kObjFloatsPerVertex, kObjFloatsPerVertex,
+                    reordered.begin() + size_t(remap[v]) * kObjFloatsPerVertex);
+    }
+    vertices.swap(reordered);
+}
+
+void optimizeMesh(IndexedMesh& mesh, MeshOptimizeStats* stats)
+{
+    size_t vertexCount = mesh.vertexCount();
+    if (stats) stats->before = analyzeVertexCache(mesh.indices, vertexCount);
+
+    // Triângulos só trocam de lugar dentro do trecho do próprio material
+    std::vector<IndexedSubmesh> ranges(mesh.submeshes.begin(), mesh.submeshes.begin() + mesh.submeshCount());
+    if (ranges.empty()) ranges.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()), 0 });
+
+    size_t clusters = 0;
+    std::vector<uint32_t> part;
+    std::vector<uint32_t> clusterStarts;
+    for (const IndexedSubmesh& range : ranges)
+    {
+        part.assign(mesh.indices.begin() + range.firstIndex, mesh.indices.begin() + range.firstIndex + range.indexCount);
+        optimizeVertexCache(part, vertexCount, &clusterStarts);
+        clusters += optimizeOverdraw(part, clusterStarts, mesh.vertices.data(), vertexCount);
+        std::copy(part.begin(), part.end(), mesh.indices.begin() + range.firstIndex);
+    }
+    optimizeVertexFetch(mesh.vertices, mesh.indices);
+
+    if (stats)
+    {
+        stats->after = analyzeVertexCache(mesh.indices, vertexCount);
+        stats->clusters = clusters;
+    }
+}
@@ -0,0 +1,506 @@
+/*
+ *  Simplificação de malhas por colapso de arestas com quádricas.
+ *
+ *  Cada vértice acumula a quádrica (soma das distâncias ao quadrado, ponderada
+ *  por área) dos planos dos triângulos em volta; colapsar u em v custa Q_u(v).
+ *  Os colapsos são feitos em passadas: todas as arestas candidatas são
+ *  ordenadas pelo custo e as mais baratas aplicadas, sem que um vértice mexa
+ *  duas vezes na mesma passada, até atingir o número de triângulos pedido.
+ *
+ *  Como os vértices soldados já separam posição/uv/normal, uma costura de UV
+ *  ou de normal aparece como dois vértices na mesma posição. Para não abrir
+ *  rachaduras nem borrar as costuras, cada vértice é classificado:
+ *   - manifold: pode colapsar em qualquer vizinho
+ *   - borda (aresta aberta da malha): só ao longo da própria borda
+ *   - costura (duas cópias na mesma posição): só ao longo da costura, e as
+ *     duas cópias colapsam juntas nos dois lados correspondentes
+ *   - travado (cantos, encontros de costuras): nunca se move
+ *
+ *  Forma de uso
+ *  -----------------
+ *  IndexedMesh mesh;
+ *  buildIndexedMesh(obj, mesh);
+ *  optimizeMesh(mesh);
+ *  vector<MeshLod> lods;
+ *  buildLodChain(mesh, defaultLodRatios(), lods);   // mesh.indices ganha os LODs no fim
+ *  glDrawElements(GL_TRIANGLES, lods[1].indexCount, type, (void*)(lods[1].firstIndex * indexSize));
+ */
+
+#include "MeshSimplify.h"
+#include "MeshOptimize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    enum VertexKind : uint8_t
+    {
+        kManifold,
+        kBorder,
+        kSeam,
+        kLocked
+    };
+
+    // Peso das quádricas que prendem as bordas abertas no lugar
+    const double kBorderWeight = 10.0;
+
+    struct Quadric
+    {
+        double a00 = 0, a11 = 0, a22 = 0, a10 = 0, a20 = 0, a21 = 0;
+        double b0 = 0, b1 = 0, b2 = 0, c = 0;
+        double w = 0;
+
+        // Plano n.x + d = 0 (n unitário) com peso weight
+        static Quadric plane(const glm::dvec3& n, double d, double weight)
+        {
+            Quadric q;
+            q.a00 = n.x * n.x * weight;
+            q.a11 = n.y * n.y * weight;
+            q.a22 = n.z * n.z * weight;
+            q.a10 = n.y * n.x * weight;
+            q.a20 = n.z * n.x * weight;
+            q.a21 = n.z * n.y * weight;
+            q.b0 = n.x * d * weight;
+            q.b1 = n.y * d * weight;
+            q.b2 = n.z * d * weight;
+            q.c = d * d * weight;
+            q.w = weight;
+            return q;
+        }
+
+        void operator+=(const Quadric& o)
+        {
+            a00 += o.a00; a11 += o.a11; a22 += o.a22;
+            a10 += o.a10; a20 += o.a20; a21 += o.a21;
+            b0 += o.b0; b1 += o.b1; b2 += o.b2;
+            c += o.c;
+            w += o.w;
+        }
+
+        // Distância ao quadrado média (pelos pesos) de p aos planos acumulados
+        double error(const glm::vec3& p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            double r = a00 * x * x + a11 * y * y + a22 * z * z
+                     + 2 * (a10 * x * y + a20 * x * z + a21 * y * z)
+                     + 2 * (b0 * x + b1 * y + b2 * z) + c;
+            return w > 0 ? std::fabs(r) / w : 0.0;
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    inline glm::vec3 positionOf(const float* vertices, uint32_t v)
+    {
+        const float* p = vertices + size_t(v) * kObjFloatsPerVertex;
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    inline uint64_t edgeKey(uint32_t a, uint32_t b)
+    {
+        return (uint64_t(a) << 32) | b;
+    }
+
+    struct PositionKey
+    {
+        uint32_t bits[3];
+        bool operator==(const PositionKey& o) const { return memcmp(bits, o.bits, sizeof(bits)) == 0; }
+    };
+
+    struct PositionHash
+    {
+        size_t operator()(const PositionKey& k) const
+        {
+            return (size_t(k.bits[0]) * 73856093u) ^ (size_t(k.bits[1]) * 19349663u) ^ (size_t(k.bits[2]) * 83492791u);
+        }
+    };
+
+    // Primeiro vértice com a mesma posição de cada vértice (cópias de costura)
+    std::vector<uint32_t> buildPositionRemap(const float* vertices, size_t vertexCount)
+    {
+        std::vector<uint32_t> remap(vertexCount);
+        std::unordered_map<PositionKey, uint32_t, PositionHash> firstWithPosition;
+        firstWithPosition.reserve(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            PositionKey key;
+            memcpy(key.bits, vertices + size_t(v) * kObjFloatsPerVertex, sizeof(key.bits));
+            remap[v] = firstWithPosition.emplace(key, v).first->second;
+        }
+        return remap;
+    }
+
+    // Arestas dirigidas dos triângulos atuais, nos índices e nas posições
+    struct EdgeSets
+    {
+        std::unordered_set<uint64_t> vertexEdges;
+        std::unordered_set<uint64_t> positionEdges;
+
+        EdgeSets(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& positionRemap)
+        {
+            vertexEdges.reserve(indices.size() * 2);
+            positionEdges.reserve(indices.size() * 2);
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    uint32_t a = indices[i + k], b = indices[i + (k + 1) % 3];
+                    vertexEdges.insert(edgeKey(a, b));
+                    positionEdges.insert(edgeKey(positionRemap[a], positionRemap[b]));
+                }
+            }
+        }
+
+        bool hasVertexEdge(uint32_t a, uint32_t b) const { return vertexEdges.count(edgeKey(a, b)) != 0; }
+        bool hasPositionEdge(uint32_t a, uint32_t b) const { return positionEdges.count(edgeKey(a, b)) != 0; }
+    };
+
+    // Triângulos que usam cada vértice (lista compacta: offsets + dados)
+    struct Adjacency
+    {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+
+        Adjacency(const std::vector<uint32_t>& indices, size_t vertexCount)
+            : offsets(vertexCount + 1, 0), triangles(indices.size())
+        {
+            for (uint32_t v : indices) ++offsets[v + 1];
+            for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i) triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        const uint32_t* begin(uint32_t v) const { return triangles.data() + offsets[v]; }
+        const uint32_t* end(uint32_t v) const { return triangles.data() + offsets[v + 1]; }
+    };
+
+    // Classifica pelas arestas sem par: aberta = sem par nem na posição, costura = com par só na posição
+    std::vector<VertexKind> classifyVertices(const std::vector<uint32_t>& indices, size_t vertexCount,
+                                             const std::vector<uint32_t>& positionRemap, const EdgeSets& edges)
+    {
+        std::vector<uint32_t> wedges(vertexCount, 0);
+        for (uint32_t v = 0; v < vertexCount; ++v) ++wedges[positionRemap[v]];
+
+        std::vector<uint8_t> openOut(vertexCount, 0), openIn(vertexCount, 0);
+        std::vector<uint8_t> seamOut(vertexCount, 0), seamIn(vertexCount, 0);
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t a = indices[i + k], b = indices[i + (k + 1) % 3];
+                if (edges.hasVertexEdge(b, a)) continue;
+                bool open = !edges.hasPositionEdge(positionRemap[b], positionRemap[a]);
+                std::vector<uint8_t>& out = open ? openOut : seamOut;
+                std::vector<uint8_t>& in = open ? openIn : seamIn;
+                out[a] = uint8_t(std::min(out[a] + 1, 255));
+                in[b] = uint8_t(std::min(in[b] + 1, 255));
+            }
+        }
+
+        std::vector<VertexKind> kinds(vertexCount, kLocked);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            uint32_t copies = wedges[positionRemap[v]];
+            bool hasOpen = openOut[v] + openIn[v] > 0;
+            bool hasSeam = seamOut[v] + seamIn[v] > 0;
+            if (copies == 1 && !hasOpen && !hasSeam) kinds[v] = kManifold;
+            else if (copies == 1 && !hasSeam && openOut[v] == 1 && openIn[v] == 1) kinds[v] = kBorder;
+            else if (copies == 2 && !hasOpen && seamOut[v] == 1 && seamIn[v] == 1) kinds[v] = kSeam;
+        }
+        return kinds;
+    }
+
+    // O colapso u -> v vira algum triângulo em volta de u (que continua existindo)?
+    bool flipsTriangle(const float* vertices, const std::vector<uint32_t>& indices, const Adjacency& adjacency,
+                       uint32_t u, uint32_t v)
+    {
+        glm::vec3 target = positionOf(vertices, v);
+        for (const uint32_t* t = adjacency.begin(u); t != adjacency.end(u); ++t)
+        {
+            const uint32_t* tri = &indices[size_t(*t) * 3];
+            if (tri[0] == v || tri[1] == v || tri[2] == v) continue;
+            glm::vec3 p[3], q[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                p[k] = positionOf(vertices, tri[k]);
+                q[k] = tri[k] == u ? target : p[k];
+            }
+            glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+            if (glm::dot(before, after) <= 0.0f) return true;
+        }
+        return false;
+    }
+}
+
+const std::vector<float>& defaultLodRatios()
+{
+    static const std::vector<float> ratios = { 0.5f, 0.25f, 0.125f };
+    return ratios;
+}
+
+float simplifyMesh(const float* vertices, size_t vertexCount, const std::vector<uint32_t>& indices,
+                   size_t targetIndexCount, std::vector<uint32_t>& out)
+{
+    out = indices;
+    if (out.size() <= targetIndexCount || vertexCount == 0) return 0.0f;
+
+    std::vector<uint32_t> positionRemap = buildPositionRemap(vertices, vertexCount);
+    std::vector<VertexKind> kinds;
+    {
+        EdgeSets edges(out, positionRemap);
+        kinds = classifyVertices(out, vertexCount, positionRemap, edges);
+    }
+
+    // Quádricas por posição: as cópias de uma costura compartilham a mesma superfície
+    std::vector<Quadric> quadrics(vertexCount);
+    {
+        EdgeSets edges(out, positionRemap);
+        for (size_t i = 0; i < out.size(); i += 3)
+        {
+            glm::dvec3 p[3];
+            for (int k = 0; k < 3; ++k) p[k] = glm::dvec3(positionOf(vertices, out[i + k]));
+            glm::dvec3 n = glm::cross(p[1] - p[0], p[2] - p[0]);
+            double area = glm::length(n);
+            if (area == 0.0) continue;
+            n /= area;
+            Quadric q = Quadric::plane(n, -glm::dot(n, p[0]), area);
+            for (int k = 0; k < 3; ++k) quadrics[positionRemap[out[i + k]]] += q;
+
+            // Bordas abertas: plano perpendicular ao triângulo passando pela aresta
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t a = out[i + k], b = out[i + (k + 1) % 3];
+                if (edges.hasPositionEdge(positionRemap[b], positionRemap[a])) continue;
+                glm::dvec3 edge = p[(k + 1) % 3] - p[k];
+                double length = glm::length(edge);
+                if (length == 0.0) continue;
+                glm::dvec3 side = glm::normalize(glm::cross(edge, n));
+                Quadric border = Quadric::plane(side, -glm::dot(side, p[k]), length * length * kBorderWeight);
+                quadrics[positionRemap[a]] += border;
+                quadrics[positionRemap[b]] += border;
+            }
+        }
+    }
+
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    std::vector<Collapse> collapses;
+    double maxError = 0.0;
+    bool capCost = true;
+
+    while (out.size() > targetIndexCount)
+    {
+        EdgeSets edges(out, positionRemap);
+        Adjacency adjacency(out, vertexCount);
+
+        // Para cada vértice de costura, a outra cópia (mesma posição, índice diferente)
+        std::unordered_map<uint32_t, std::vector<uint32_t>> copies;
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            uint32_t v = out[i];
+            if (kinds[v] != kSeam) continue;
+            std::vector<uint32_t>& list = copies[positionRemap[v]];
+            if (std::find(list.begin(), list.end(), v) == list.end()) list.push_back(v);
+        }
+        auto otherCopy = [&](uint32_t v) -> int64_t {
+            auto it = copies.find(positionRemap[v]);
+            if (it == copies.end() || it->second.size() != 2) return -1;
+            return it->second[0] == v ? it->second[1] : it->second[0];
+        };
+
+        // Candidatas: cada aresta nos dois sentidos, respeitando o tipo da origem
+        collapses.clear();
+        for (size_t i = 0; i < out.size(); i += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t a = out[i + k], b = out[i + (k + 1) % 3];
+                for (int dir = 0; dir < 2; ++dir)
+                {
+                    uint32_t u = dir == 0 ? a : b;
+                    uint32_t v = dir == 0 ? b : a;
+                    VertexKind kind = kinds[u];
+                    if (kind == kLocked) continue;
+                    if (positionRemap[u] == positionRemap[v]) continue;
+                    bool twin = edges.hasVertexEdge(b, a);
+                    if (kind == kBorder || kind == kSeam)
+                    {
+                        // Só ao longo da própria borda/costura
+                        if (twin || kinds[v] == kManifold) continue;
+                        bool open = !edges.hasPositionEdge(positionRemap[b], positionRemap[a]);
+                        if ((kind == kBorder) != open) continue;
+                    }
+                    collapses.push_back({ u, v, quadrics[positionRemap[u]].error(positionOf(vertices, v)) });
+                }
+            }
+        }
+        if (collapses.empty()) break;
+
+        // Só o colapso mais barato de cada vértice
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+            return x.from != y.from ? x.from < y.from : x.cost < y.cost;
+        });
+        collapses.erase(std::unique(collapses.begin(), collapses.end(),
+                                    [](const Collapse& x, const Collapse& y) { return x.from == y.from; }),
+                        collapses.end());
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        for (uint32_t v = 0; v < vertexCount; ++v) remap[v] = v;
+        std::fill(touched.begin(), touched.end(), false);
+
+        // Cada colapso tira ~2 triângulos (1 na borda); para quando já bastar.
+        // Colapsos mais caros que o necessário para a meta ficam para a próxima
+        // passada, quando os custos já refletem os colapsos desta
+        size_t trianglesToRemove = (out.size() - targetIndexCount) / 3;
+        size_t goal = std::min(collapses.size() - 1, std::max<size_t>(trianglesToRemove / 2, 1));
+        double costLimit = capCost ? collapses[goal].cost : std::numeric_limits<double>::max();
+        size_t removed = 0;
+        for (const Collapse& c : collapses)
+        {
+            if (removed >= trianglesToRemove || c.cost > costLimit) break;
+            uint32_t u = c.from, v = c.to;
+            if (touched[u] || touched[v]) continue;
+
+            // Costura: a outra cópia de u vai para a cópia de v do outro lado
+            int64_t u2 = -1, v2 = -1;
+            if (kinds[u] == kSeam)
+            {
+                u2 = otherCopy(u);
+                if (u2 < 0 || touched[u2]) continue;
+                for (const uint32_t* t = adjacency.begin(uint32_t(u2)); t != adjacency.end(uint32_t(u2)) && v2 < 0; ++t)
+                {
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        uint32_t w = out[size_t(*t) * 3 + k];
+                        if (w != uint32_t(u2) && w != v && positionRemap[w] == positionRemap[v]) v2 = w;
+                    }
+                }
+                if (v2 < 0 || touched[v2]) continue;
+            }
+
+            if (flipsTriangle(vertices, out, adjacency, u, v)) continue;
+            if (u2 >= 0 && flipsTriangle(vertices, out, adjacency, uint32_t(u2), uint32_t(v2))) continue;
+
+            remap[u] = v;
+            if (u2 >= 0) remap[u2] = uint32_t(v2);
+            quadrics[positionRemap[v]] += quadrics[positionRemap[u]];
+            maxError = std::max(maxError, c.cost);
+
+            // Vizinhos de u também ficam parados nesta passada (o teste de
+            // virada acima considerou as posições deles como fixas)
+            auto touchAround = [&](uint32_t w) {
+                for (const uint32_t* t = adjacency.begin(w); t != adjacency.end(w); ++t)
+                {
+                    for (int k = 0; k < 3; ++k) touched[out[size_t(*t) * 3 + k]] = true;
+                }
+            };
+            touchAround(u);
+            touched[v] = true;
+            if (u2 >= 0)
+            {
+                touchAround(uint32_t(u2));
+                touched[v2] = true;
+            }
+            removed += kinds[u] == kBorder ? 1 : 2;
+        }
+
+        // Aplica e remove os triângulos degenerados
+        size_t before = out.size();
+        size_t write = 0;
+        for (size_t i = 0; i < out.size(); i += 3)
+        {
+            uint32_t a = remap[out[i]], b = remap[out[i + 1]], c = remap[out[i + 2]];
+            if (a == b || b == c || a == c) continue;
+            out[write++] = a;
+            out[write++] = b;
+            out[write++] = c;
+        }
+        out.resize(write);
+
+        // Nada colapsou dentro do limite de custo: tenta uma passada sem limite antes de desistir
+        if (out.size() == before)
+        {
+            if (!capCost) break;
+            capCost = false;
+        }
+        else
+        {
+            capCost = true;
+        }
+    }
+
+    return static_cast<float>(std::sqrt(maxError));
+}
+
+void buildLodChain(IndexedMesh& mesh, const std::vector<float>& ratios, std::vector<MeshLod>& lods)
+{
+    lods.clear();
+    uint32_t baseCount = static_cast<uint32_t>(mesh.indices.size());
+    lods.push_back({ 0, baseCount, 1.0f, 0.0f });
+
+    // Cada material é simplificado sozinho: a fronteira entre dois materiais é
+    // borda aberta nos dois lados e só colapsa ao longo dela, sem rachaduras
+    size_t submeshCount = mesh.submeshCount();
+    if (submeshCount == 0)
+    {
+        mesh.materials.push_back(std::string());
+        mesh.submeshes.assign(1, { 0, baseCount, 0 });
+        submeshCount = 1;
+    }
+    mesh.submeshes.resize(submeshCount);
+    std::vector<IndexedSubmesh> base(mesh.submeshes.begin(), mesh.submeshes.end());
+
+    std::vector<uint32_t> part, simplified, level;
+    std::vector<IndexedSubmesh> previous = base;
+    std::vector<IndexedSubmesh> levelSubmeshes;
+    for (float ratio : ratios)
+    {
+        if (lods.size() == kMaxMeshLods) break;
+        level.clear();
+        levelSubmeshes.clear();
+        float error = lods.back().error;
+        for (size_t s = 0; s < submeshCount; ++s)
+        {
+            part.assign(mesh.indices.begin() + base[s].firstIndex, mesh.indices.begin() + base[s].firstIndex + base[s].indexCount);
+            size_t target = size_t(float(base[s].indexCount / 3) * ratio) * 3;
+            float partError = simplifyMesh(mesh.vertices.data(), mesh.vertexCount(), part, target, simplified);
+            if (simplified.empty() || simplified.size() >= previous[s].indexCount)
+            {
+                // Material que não reduz mais: repete o trecho do nível anterior
+                simplified.assign(mesh.indices.begin() + previous[s].firstIndex,
+                                  mesh.indices.begin() + previous[s].firstIndex + previous[s].indexCount);
+            }
+            else
+            {
+                // Cada nível é desenhado sozinho: ordem própria para o cache de vértices
+                optimizeVertexCache(simplified, mesh.vertexCount());
+                error = std::max(error, partError);
+            }
+            uint32_t first = static_cast<uint32_t>(mesh.indices.size() + level.size());
+            levelSubmeshes.push_back({ first, static_cast<uint32_t>(simplified.size()), base[s].material });
+            level.insert(level.end(), simplified.begin(), simplified.end());
+        }
+        if (level.empty() || level.size() >= lods.back().indexCount) continue;
+
+        MeshLod lod;
+        lod.firstIndex = static_cast<uint32_t>(mesh.indices.size());
+        lod.indexCount = static_cast<uint32_t>(level.size());
+        lod.ratio = ratio;
+        lod.error = error;
+        lods.push_back(lod);
+        mesh.indices.insert(mesh.indices.end(), level.begin(), level.end());
+        mesh.submeshes.insert(mesh.submeshes.end(), levelSubmeshes.begin(), levelSubmeshes.end());
+        previous = levelSubmeshes;
+    }
+}
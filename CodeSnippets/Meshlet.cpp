@@ -0,0 +1,260 @@
+/*
+ *  Meshlets: pedaços pequenos da malha que podem ser descartados inteiros.
+ *
+ *  Cada meshlet cresce a partir do próximo triângulo livre na ordem do Tipsify
+ *  (MeshOptimize.cpp), somando vizinhos que acrescentam poucos vértices e
+ *  mantêm as normais próximas, para que o cone de normais seja estreito o
+ *  bastante para descartar meshlets de costas. Os índices são regravados
+ *  meshlet a meshlet, então cada um é um trecho contínuo do EBO e cada
+ *  sequência visível vira um intervalo de glMultiDrawElements.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  vector<Meshlet> meshlets;
+ *  buildMeshlets(vertices, vertexCount, indices, meshlets);   // reordena indices
+ *  glBufferData(GL_ELEMENT_ARRAY_BUFFER, ..., indices.data(), ...);
+ *  ...
+ *  vector<MeshletRange> visible;
+ *  cullMeshlets(meshlets, projection * view * model, cameraEmEspacoDoObjeto, visible, stats);
+ */
+
+#include "Meshlet.h"
+#include "FrustumCull.h"
+#include "ObjLoader.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Menor cosseno aceito entre a normal de um triângulo e o eixo do meshlet (60 graus)
+    const float kConeAlignment = 0.5f;
+
+    inline glm::vec3 positionOf(const float* vertices, uint32_t v)
+    {
+        const float* p = vertices + size_t(v) * kObjFloatsPerVertex;
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    // Esfera e cone de um meshlet já delimitado
+    void computeBounds(const float* vertices, const uint32_t* indices, Meshlet& m)
+    {
+        glm::vec3 lo(positionOf(vertices, indices[m.firstIndex]));
+        glm::vec3 hi = lo;
+        size_t end = m.firstIndex + size_t(m.triangleCount) * 3;
+        for (size_t i = m.firstIndex; i < end; ++i)
+        {
+            glm::vec3 p = positionOf(vertices, indices[i]);
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+        m.center = 0.5f * (lo + hi);
+        m.radius = 0.0f;
+        for (size_t i = m.firstIndex; i < end; ++i)
+        {
+            glm::vec3 p = positionOf(vertices, indices[i]);
+            m.radius = std::max(m.radius, glm::length(p - m.center));
+        }
+
+        // Eixo do cone = média das normais dos triângulos (pela geometria, não pelas normais do .obj)
+        std::vector<glm::vec3> normals;
+        normals.reserve(m.triangleCount);
+        glm::vec3 axis(0.0f);
+        for (size_t i = m.firstIndex; i < end; i += 3)
+        {
+            glm::vec3 a = positionOf(vertices, indices[i]);
+            glm::vec3 b = positionOf(vertices, indices[i + 1]);
+            glm::vec3 c = positionOf(vertices, indices[i + 2]);
+            glm::vec3 n = glm::cross(b - a, c - a);
+            float length = glm::length(n);
+            if (length == 0.0f) continue;
+            normals.push_back(n / length);
+            axis += n / length;
+        }
+
+        m.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+        m.coneCutoff = 1.0f;
+        float axisLength = glm::length(axis);
+        if (normals.empty() || axisLength == 0.0f) return;
+        m.coneAxis = axis / axisLength;
+
+        float minDot = 1.0f;
+        for (const glm::vec3& n : normals) minDot = std::min(minDot, glm::dot(n, m.coneAxis));
+        // Abertura >= 90 graus: sempre há algum triângulo de frente
+        if (minDot <= 0.1f) return;
+
+        // Ápice recuado ao longo do eixo até ficar atrás do plano de todos os triângulos
+        float maxT = 0.0f;
+        size_t n = 0;
+        for (size_t i = m.firstIndex; i < end; i += 3)
+        {
+            glm::vec3 a = positionOf(vertices, indices[i]);
+            glm::vec3 b = positionOf(vertices, indices[i + 1]);
+            glm::vec3 c = positionOf(vertices, indices[i + 2]);
+            if (glm::length(glm::cross(b - a, c - a)) == 0.0f) continue;
+            const glm::vec3& normal = normals[n++];
+            maxT = std::max(maxT, glm::dot(a - m.center, normal) / glm::dot(m.coneAxis, normal));
+        }
+        m.coneApex = m.center - m.coneAxis * maxT;
+        m.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+
+void buildMeshlets(const float* vertices, size_t vertexCount, std::vector<uint32_t>& indices, std::vector<Meshlet>& out)
+{
+    out.clear();
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // Triângulos de cada vértice
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (uint32_t v : indices) ++adjacencyOffsets[v + 1];
+    for (size_t v = 0; v < vertexCount; ++v) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<glm::vec3> normals(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        glm::vec3 a = positionOf(vertices, indices[t * 3]);
+        glm::vec3 b = positionOf(vertices, indices[t * 3 + 1]);
+        glm::vec3 c = positionOf(vertices, indices[t * 3 + 2]);
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        normals[t] = length > 0.0f ? n / length : glm::vec3(0.0f);
+    }
+
+    std::vector<bool> used(triangleCount, false);
+    // Marca de qual meshlet cada vértice já faz parte (evita um set por meshlet)
+    std::vector<uint32_t> owner(vertexCount, UINT32_MAX);
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    std::vector<uint32_t> candidates;
+    size_t seed = 0;
+
+    auto newVerticesOf = [&](uint32_t t, uint32_t id) {
+        uint32_t count = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t v = indices[size_t(t) * 3 + k];
+            bool repeated = (k > 0 && v == indices[size_t(t) * 3]) || (k > 1 && v == indices[size_t(t) * 3 + 1]);
+            if (owner[v] != id && !repeated) ++count;
+        }
+        return count;
+    };
+
+    for (uint32_t id = 0; ; ++id)
+    {
+        // Semente: o próximo triângulo livre na ordem atual (a do Tipsify)
+        while (seed < triangleCount && used[seed]) ++seed;
+        if (seed == triangleCount) break;
+
+        Meshlet m = {};
+        m.firstIndex = static_cast<uint32_t>(result.size());
+        glm::vec3 axis(0.0f);
+        candidates.clear();
+        uint32_t next = static_cast<uint32_t>(seed);
+
+        while (true)
+        {
+            used[next] = true;
+            m.vertexCount += newVerticesOf(next, id);
+            ++m.triangleCount;
+            axis += normals[next];
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t v = indices[size_t(next) * 3 + k];
+                result.push_back(v);
+                if (owner[v] == id) continue;
+                owner[v] = id;
+                for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; ++a)
+                {
+                    if (!used[adjacency[a]]) candidates.push_back(adjacency[a]);
+                }
+            }
+            if (m.triangleCount == kMeshletMaxTriangles) break;
+
+            // Vizinho que menos acrescenta vértices e mais concorda com o cone atual;
+            // triângulos que abririam demais o cone ficam para outro meshlet
+            float axisLength = glm::length(axis);
+            glm::vec3 direction = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f);
+            int best = -1;
+            float bestScore = 0.0f;
+            for (size_t c = 0; c < candidates.size(); ++c)
+            {
+                uint32_t t = candidates[c];
+                if (used[t]) continue;
+                uint32_t extra = newVerticesOf(t, id);
+                if (m.vertexCount + extra > kMeshletMaxVertices) continue;
+                float alignment = glm::dot(normals[t], direction);
+                if (alignment < kConeAlignment) continue;
+                float score = float(extra) - 2.0f * alignment;
+                if (best == -1 || score < bestScore)
+                {
+                    best = int(c);
+                    bestScore = score;
+                }
+            }
+            if (best == -1) break;
+            next = candidates[best];
+            candidates[best] = candidates.back();
+            candidates.pop_back();
+        }
+
+        computeBounds(vertices, result.data(), m);
+        out.push_back(m);
+    }
+
+    indices.swap(result);
+}
+
+void cullMeshlets(const std::vector<Meshlet>& meshlets, const glm::mat4& mvp, const glm::vec3& cameraObject,
+                  std::vector<MeshletRange>& visible, MeshletCullStats& stats)
+{
+    // Planos do frustum em espaço do objeto
+    Frustum frustum = extractFrustum(mvp);
+
+    visible.clear();
+    for (const Meshlet& m : meshlets)
+    {
+        ++stats.meshlets;
+
+        bool outside = false;
+        for (const glm::vec4& plane : frustum.planes)
+        {
+            if (glm::dot(glm::vec3(plane), m.center) + plane.w < -m.radius)
+            {
+                outside = true;
+                break;
+            }
+        }
+        if (outside)
+        {
+            ++stats.culledFrustum;
+            stats.trianglesCulled += m.triangleCount;
+            continue;
+        }
+
+        glm::vec3 toApex = m.coneApex - cameraObject;
+        if (glm::dot(toApex, m.coneAxis) >= m.coneCutoff * glm::length(toApex))
+        {
+            ++stats.culledBackface;
+            stats.trianglesCulled += m.triangleCount;
+            continue;
+        }
+
+        stats.trianglesDrawn += m.triangleCount;
+        uint32_t indexCount = m.triangleCount * 3;
+        if (!visible.empty() && visible.back().firstIndex + visible.back().indexCount == m.firstIndex)
+        {
+            visible.back().indexCount += indexCount;
+        }
+        else
+        {
+            visible.push_back({ m.firstIndex, indexCount });
+        }
+    }
+}
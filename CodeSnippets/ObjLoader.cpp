@@ -0,0 +1,524 @@
+/*
+ *  Leitor de arquivos Wavefront .OBJ sem std::istringstream.
+ *
+ *  O arquivo é mapeado em memória (MappedFile) e percorrido in-place: cada
+ *  linha é delimitada com memchr e os números são convertidos com
+ *  std::from_chars, sem criar strings nem streams por linha. Os vetores de
+ *  saída são reservados numa pré-passada que só conta as linhas de cada tipo.
+ *
+ *  Forma de uso (mesma saída do loadObject dos exercícios)
+ *  -----------------
+ *  std::vector<glm::vec3> vert, normals;
+ *  std::vector<glm::vec2> uvs;
+ *  string mtlLib;
+ *  loadObjectMapped("../assets/Modelos3D/Suzanne.obj", vert, uvs, normals, mtlLib);
+ *
+ *  Aceita faces nos formatos v, v/vt, v//vn e v/vt/vn, índices negativos
+ *  (relativos) e polígonos com mais de 3 vértices (triangulados em leque).
+ *  Cada usemtl abre um trecho de cantos (ObjData::materialRanges); na solda
+ *  (buildIndexedMesh) os triângulos de cada material ficam contínuos, para
+ *  um VBO/EBO por .obj e um glDrawElements por material.
+ *
+ *  Leitura paralela
+ *  -----------------
+ *  Com threads != 1 o arquivo é dividido em blocos terminados em '\n', cada
+ *  bloco é lido por uma thread do ThreadPool em um ObjData próprio e os blocos
+ *  são costurados com uma soma de prefixos das contagens de v/vt/vn/cantos.
+ *  Índices positivos do OBJ já são globais; índices relativos são guardados
+ *  em relação ao bloco e rebaseados pelo prefixo na costura.
+ */
+
+#include "ObjLoader.h"
+#include "MappedFile.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+    // Abaixo disso a leitura automática (threads = 0) fica sequencial
+    const size_t kParallelThreshold = 1 << 20;
+    // Tamanho mínimo de cada bloco na leitura paralela
+    const size_t kMinChunkBytes = 64 << 10;
+    // Índice relativo ainda não rebaseado (só existe durante a leitura em blocos)
+    const int kRelativeBase = -(1 << 30);
+
+    inline bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline const char* skipBlanks(const char* p, const char* end)
+    {
+        while (p < end && isBlank(*p)) ++p;
+        return p;
+    }
+
+    inline const char* parseFloat(const char* p, const char* end, float& out)
+    {
+        p = skipBlanks(p, end);
+        if (p < end && *p == '+') ++p; // from_chars não aceita '+'
+        std::from_chars_result res = std::from_chars(p, end, out);
+        if (res.ec == std::errc::invalid_argument)
+        {
+            out = 0.0f;
+            return p;
+        }
+        return res.ptr;
+    }
+
+    inline const char* parseInt(const char* p, const char* end, int& out)
+    {
+        std::from_chars_result res = std::from_chars(p, end, out);
+        if (res.ec != std::errc()) out = 0;
+        return res.ptr;
+    }
+
+    // Índice OBJ (base 1, negativo = relativo, 0 = ausente) -> base 0 / -1
+    inline int resolveIndex(int raw, size_t count, bool deferRelative)
+    {
+        if (raw > 0) return raw - 1;
+        if (raw < 0)
+        {
+            int local = static_cast<int>(count) + raw;
+            return deferRelative ? kRelativeBase + local : local;
+        }
+        return -1;
+    }
+
+    inline int rebaseIndex(int index, size_t offset)
+    {
+        return index < -1 ? static_cast<int>(offset) + (index - kRelativeBase) : index;
+    }
+
+    // Lê um canto "v", "v/vt", "v//vn" ou "v/vt/vn"; devolve nullptr se não há mais cantos
+    inline const char* parseCorner(const char* p, const char* end, const ObjData& data, bool deferRelative, ObjCorner& corner)
+    {
+        p = skipBlanks(p, end);
+        if (p >= end || *p == '#') return nullptr;
+
+        int raw[3] = { 0, 0, 0 };
+        const char* start = p;
+        p = parseInt(p, end, raw[0]);
+        if (p < end && *p == '/')
+        {
+            ++p;
+            if (p < end && *p != '/') p = parseInt(p, end, raw[1]);
+            if (p < end && *p == '/') p = parseInt(p + 1, end, raw[2]);
+        }
+        // Token inválido: pula até o próximo espaço para não travar o laço
+        if (p == start)
+        {
+            while (p < end && !isBlank(*p)) ++p;
+        }
+
+        corner.v = resolveIndex(raw[0], data.positions.size(), deferRelative);
+        corner.vt = resolveIndex(raw[1], data.uvs.size(), deferRelative);
+        corner.vn = resolveIndex(raw[2], data.normals.size(), deferRelative);
+        return p;
+    }
+
+    void reserveFor(const char* p, const char* end, ObjData& out)
+    {
+        size_t nV = 0, nVT = 0, nVN = 0, nF = 0;
+        while (p < end)
+        {
+            const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+            if (!eol) eol = end;
+            if (eol - p >= 2)
+            {
+                if (p[0] == 'v')
+                {
+                    if (p[1] == ' ' || p[1] == '\t') ++nV;
+                    else if (p[1] == 't') ++nVT;
+                    else if (p[1] == 'n') ++nVN;
+                }
+                else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) ++nF;
+            }
+            p = eol + 1;
+        }
+        out.positions.reserve(out.positions.size() + nV);
+        out.uvs.reserve(out.uvs.size() + nVT);
+        out.normals.reserve(out.normals.size() + nVN);
+        out.corners.reserve(out.corners.size() + nF * 3);
+    }
+
+    void parseObjText(const char* p, const char* end, ObjData& out, bool deferRelative)
+    {
+        reserveFor(p, end, out);
+
+        while (p < end)
+        {
+            const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+            if (!eol) eol = end;
+
+            p = skipBlanks(p, eol);
+            if (p + 1 < eol)
+            {
+                if (p[0] == 'v' && isBlank(p[1]))
+                {
+                    glm::vec3 vertex;
+                    const char* q = parseFloat(p + 2, eol, vertex.x);
+                    q = parseFloat(q, eol, vertex.y);
+                    parseFloat(q, eol, vertex.z);
+                    out.positions.push_back(vertex);
+                }
+                else if (p[0] == 'v' && p[1] == 't' && p + 2 < eol && isBlank(p[2]))
+                {
+                    glm::vec2 uv;
+                    const char* q = parseFloat(p + 3, eol, uv.x);
+                    parseFloat(q, eol, uv.y);
+                    out.uvs.push_back(uv);
+                }
+                else if (p[0] == 'v' && p[1] == 'n' && p + 2 < eol && isBlank(p[2]))
+                {
+                    glm::vec3 normal;
+                    const char* q = parseFloat(p + 3, eol, normal.x);
+                    q = parseFloat(q, eol, normal.y);
+                    parseFloat(q, eol, normal.z);
+                    out.normals.push_back(normal);
+                }
+                else if (p[0] == 'f' && isBlank(p[1]))
+                {
+                    ObjCorner first, prev, cur;
+                    const char* q = p + 2;
+                    int count = 0;
+                    while ((q = parseCorner(q, eol, out, deferRelative, cur)) != nullptr)
+                    {
+                        if (count == 0) first = cur;
+                        else if (count >= 2)
+                        {
+                            out.corners.push_back(first);
+                            out.corners.push_back(prev);
+                            out.corners.push_back(cur);
+                        }
+                        prev = cur;
+                        ++count;
+                    }
+                }
+                else if (eol - p > 7 && memcmp(p, "mtllib", 6) == 0 && isBlank(p[6]))
+                {
+                    const char* q = skipBlanks(p + 7, eol);
+                    const char* nameEnd = q;
+                    while (nameEnd < eol && !isBlank(*nameEnd)) ++nameEnd;
+                    out.mtlLib.assign(q, nameEnd);
+                }
+                else if (eol - p > 7 && memcmp(p, "usemtl", 6) == 0 && isBlank(p[6]))
+                {
+                    const char* q = skipBlanks(p + 7, eol);
+                    const char* nameEnd = eol;
+                    while (nameEnd > q && isBlank(nameEnd[-1])) --nameEnd;
+                    out.materialRanges.push_back({ std::string(q, nameEnd), out.corners.size() });
+                }
+            }
+
+            p = eol + 1;
+        }
+    }
+
+    void parseObjChunks(const char* begin, const char* end, ObjData& out, unsigned threads)
+    {
+        size_t size = end - begin;
+        size_t chunkCount = std::min<size_t>(threads * 4, std::max<size_t>(1, size / kMinChunkBytes));
+
+        // Limites dos blocos, sempre logo após um '\n'
+        std::vector<const char*> bounds(chunkCount + 1, end);
+        bounds[0] = begin;
+        for (size_t i = 1; i < chunkCount; ++i)
+        {
+            const char* guess = std::max(begin + size * i / chunkCount, bounds[i - 1]);
+            const char* eol = static_cast<const char*>(memchr(guess, '\n', end - guess));
+            bounds[i] = eol ? eol + 1 : end;
+        }
+
+        ThreadPool pool(threads);
+        std::vector<ObjData> parts(chunkCount);
+        pool.parallelFor(chunkCount, [&](size_t i) {
+            parseObjText(bounds[i], bounds[i + 1], parts[i], true);
+        });
+
+        // Soma de prefixos: onde cada bloco começa nos vetores finais
+        std::vector<size_t> vOffset(chunkCount + 1, 0), vtOffset(chunkCount + 1, 0);
+        std::vector<size_t> vnOffset(chunkCount + 1, 0), cornerOffset(chunkCount + 1, 0);
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            vOffset[i + 1] = vOffset[i] + parts[i].positions.size();
+            vtOffset[i + 1] = vtOffset[i] + parts[i].uvs.size();
+            vnOffset[i + 1] = vnOffset[i] + parts[i].normals.size();
+            cornerOffset[i + 1] = cornerOffset[i] + parts[i].corners.size();
+            if (!parts[i].mtlLib.empty()) out.mtlLib = parts[i].mtlLib;
+        }
+
+        out.positions.resize(vOffset[chunkCount]);
+        out.uvs.resize(vtOffset[chunkCount]);
+        out.normals.resize(vnOffset[chunkCount]);
+        out.corners.resize(cornerOffset[chunkCount]);
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            // Um usemtl vale até o próximo, mesmo em outro bloco: basta concatenar
+            for (const ObjMaterialRange& range : parts[i].materialRanges)
+            {
+                out.materialRanges.push_back({ range.material, range.firstCorner + cornerOffset[i] });
+            }
+        }
+
+        pool.parallelFor(chunkCount, [&](size_t i) {
+            const ObjData& part = parts[i];
+            std::copy(part.positions.begin(), part.positions.end(), out.positions.begin() + vOffset[i]);
+            std::copy(part.uvs.begin(), part.uvs.end(), out.uvs.begin() + vtOffset[i]);
+            std::copy(part.normals.begin(), part.normals.end(), out.normals.begin() + vnOffset[i]);
+            ObjCorner* dst = out.corners.data() + cornerOffset[i];
+            for (const ObjCorner& c : part.corners)
+            {
+                dst->v = rebaseIndex(c.v, vOffset[i]);
+                dst->vt = rebaseIndex(c.vt, vtOffset[i]);
+                dst->vn = rebaseIndex(c.vn, vnOffset[i]);
+                ++dst;
+            }
+        });
+    }
+
+    // Chave da solda: os 8 floats do vértice comparados bit a bit
+    struct VertexKey
+    {
+        float v[kObjFloatsPerVertex];
+
+        bool operator==(const VertexKey& other) const
+        {
+            return memcmp(v, other.v, sizeof(v)) == 0;
+        }
+    };
+
+    struct VertexKeyHash
+    {
+        size_t operator()(const VertexKey& key) const
+        {
+            // FNV-1a sobre os bytes do vértice
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.v);
+            uint64_t hash = 1469598103934665603ull;
+            for (size_t i = 0; i < sizeof(key.v); ++i)
+            {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    template <typename T>
+    inline const T& fetch(const std::vector<T>& values, int index, const T& fallback, size_t& invalid)
+    {
+        if (index >= 0 && static_cast<size_t>(index) < values.size()) return values[index];
+        if (index >= 0) ++invalid;
+        return fallback;
+    }
+}
+
+bool parseObj(const char* path, ObjData& out, unsigned threads)
+{
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    out = ObjData();
+    if (threads == 0)
+    {
+        threads = file.size < kParallelThreshold ? 1 : ThreadPool::defaultThreadCount();
+    }
+    if (threads > 1 && file.size >= 2 * kMinChunkBytes)
+    {
+        parseObjChunks(file.data, file.data + file.size, out, threads);
+    }
+    else
+    {
+        parseObjText(file.data, file.data + file.size, out, false);
+    }
+    return true;
+}
+
+void expandObj(
+    const ObjData& data,
+    std::vector<glm::vec3>& out_vertices,
+    std::vector<glm::vec2>& out_uvs,
+    std::vector<glm::vec3>& out_normals)
+{
+    const glm::vec3 zero3(0.0f);
+    const glm::vec2 zero2(0.0f);
+    size_t invalid = 0;
+
+    out_vertices.reserve(out_vertices.size() + data.corners.size());
+    out_uvs.reserve(out_uvs.size() + data.corners.size());
+    out_normals.reserve(out_normals.size() + data.corners.size());
+    for (const ObjCorner& c : data.corners)
+    {
+        out_vertices.push_back(fetch(data.positions, c.v, zero3, invalid));
+        out_uvs.push_back(fetch(data.uvs, c.vt, zero2, invalid));
+        out_normals.push_back(fetch(data.normals, c.vn, zero3, invalid));
+    }
+
+    if (invalid > 0)
+    {
+        std::cerr << "OBJ: " << invalid << " indices fora do intervalo foram ignorados" << std::endl;
+    }
+}
+
+bool loadObjectMapped(
+    const char* path,
+    std::vector<glm::vec3>& out_vertices,
+    std::vector<glm::vec2>& out_uvs,
+    std::vector<glm::vec3>& out_normals,
+    std::string& out_mtlLib,
+    unsigned threads)
+{
+    ObjData data;
+    if (!parseObj(path, data, threads)) return false;
+    expandObj(data, out_vertices, out_uvs, out_normals);
+    if (!data.mtlLib.empty()) out_mtlLib = data.mtlLib;
+    return true;
+}
+
+bool parseMtlLibrary(const char* path, std::vector<ObjMaterial>& out)
+{
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    out.clear();
+    const char* p = file.data;
+    const char* end = file.data + file.size;
+    while (p < end)
+    {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+
+        p = skipBlanks(p, eol);
+        const char* keyEnd = p;
+        while (keyEnd < eol && !isBlank(*keyEnd)) ++keyEnd;
+        std::string_view key(p, keyEnd - p);
+
+        auto readVec3 = [&](glm::vec3& v) {
+            const char* q = parseFloat(keyEnd, eol, v.r);
+            q = parseFloat(q, eol, v.g);
+            parseFloat(q, eol, v.b);
+        };
+        auto readName = [&](std::string& name) {
+            const char* q = skipBlanks(keyEnd, eol);
+            const char* nameEnd = eol;
+            while (nameEnd > q && isBlank(nameEnd[-1])) --nameEnd;
+            name.assign(q, nameEnd);
+        };
+        // Cada palavra-chave sobrescreve a anterior dentro do bloco atual
+        auto current = [&]() -> ObjMaterial& {
+            if (out.empty()) out.emplace_back();
+            return out.back();
+        };
+
+        if (key == "newmtl")
+        {
+            out.emplace_back();
+            readName(out.back().name);
+        }
+        else if (key == "map_Kd") readName(current().diffuseMap);
+        else if (key == "Ka") readVec3(current().ka);
+        else if (key == "Kd") readVec3(current().kd);
+        else if (key == "Ks") readVec3(current().ks);
+        else if (key == "Ke") readVec3(current().ke);
+        else if (key == "Ns") parseFloat(keyEnd, eol, current().shininess);
+
+        p = eol + 1;
+    }
+    return true;
+}
+
+const ObjMaterial* findMaterial(const std::vector<ObjMaterial>& library, const std::string& name)
+{
+    for (const ObjMaterial& material : library)
+    {
+        if (!name.empty() && material.name == name) return &material;
+    }
+    return library.empty() ? nullptr : &library.front();
+}
+
+void buildIndexedMesh(const ObjData& data, IndexedMesh& out)
+{
+    const glm::vec3 zero3(0.0f);
+    const glm::vec2 zero2(0.0f);
+    size_t invalid = 0;
+
+    out.vertices.clear();
+    out.indices.clear();
+    out.boundsMin = out.boundsMax = glm::vec3(0.0f);
+    out.indices.reserve(data.corners.size());
+
+    std::unordered_map<VertexKey, uint32_t, VertexKeyHash> unique;
+    unique.reserve(data.corners.size());
+
+    // Material de cada triângulo: posição do nome em out.materials, na ordem do primeiro uso
+    out.materials.clear();
+    out.submeshes.clear();
+    std::vector<uint32_t> triangleMaterial(data.corners.size() / 3, 0);
+    std::unordered_map<std::string, uint32_t> materialIndex;
+    for (size_t r = 0; r <= data.materialRanges.size(); ++r)
+    {
+        size_t first = r == 0 ? 0 : data.materialRanges[r - 1].firstCorner;
+        size_t last = r < data.materialRanges.size() ? data.materialRanges[r].firstCorner : data.corners.size();
+        if (first / 3 >= last / 3) continue;
+        const std::string name = r == 0 ? std::string() : data.materialRanges[r - 1].material;
+        auto inserted = materialIndex.emplace(name, static_cast<uint32_t>(out.materials.size()));
+        if (inserted.second) out.materials.push_back(name);
+        std::fill(triangleMaterial.begin() + first / 3, triangleMaterial.begin() + last / 3, inserted.first->second);
+    }
+
+    for (const ObjCorner& c : data.corners)
+    {
+        const glm::vec3& p = fetch(data.positions, c.v, zero3, invalid);
+        const glm::vec2& t = fetch(data.uvs, c.vt, zero2, invalid);
+        const glm::vec3& n = fetch(data.normals, c.vn, zero3, invalid);
+        VertexKey key = { { p.x, p.y, p.z, t.x, t.y, n.x, n.y, n.z } };
+
+        auto inserted = unique.emplace(key, static_cast<uint32_t>(out.vertexCount()));
+        if (inserted.second)
+        {
+            out.vertices.insert(out.vertices.end(), key.v, key.v + kObjFloatsPerVertex);
+            out.boundsMin = out.vertexCount() == 1 ? p : glm::min(out.boundsMin, p);
+            out.boundsMax = out.vertexCount() == 1 ? p : glm::max(out.boundsMax, p);
+        }
+        out.indices.push_back(inserted.first->second);
+    }
+
+    // Ordenação estável por material (contagem): cada material vira um trecho contínuo
+    std::vector<uint32_t> firstTriangle(out.materials.size() + 1, 0);
+    for (uint32_t material : triangleMaterial) ++firstTriangle[material + 1];
+    for (size_t m = 0; m < out.materials.size(); ++m)
+    {
+        out.submeshes.push_back({ firstTriangle[m] * 3, firstTriangle[m + 1] * 3, static_cast<uint32_t>(m) });
+        firstTriangle[m + 1] += firstTriangle[m];
+    }
+    if (out.materials.size() > 1)
+    {
+        std::vector<uint32_t> sorted(out.indices.size());
+        std::vector<uint32_t> next(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (size_t t = 0; t < triangleMaterial.size(); ++t)
+        {
+            std::copy_n(&out.indices[t * 3], 3, &sorted[size_t(next[triangleMaterial[t]]++) * 3]);
+        }
+        out.indices.swap(sorted);
+    }
+
+    if (invalid > 0)
+    {
+        std::cerr << "OBJ: " << invalid << " indices fora do intervalo foram ignorados" << std::endl;
+    }
+}
+
+void packIndices16(const std::vector<uint32_t>& indices, std::vector<uint16_t>& out)
+{
+    out.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        out[i] = static_cast<uint16_t>(indices[i]);
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ *  Anel de buffers persistentes para os dados que mudam a cada quadro.
+ *
+ *  glBufferSubData num buffer que a GPU ainda está lendo obriga o driver a
+ *  copiar os dados para um lugar temporário ou a esperar; com glBufferData
+ *  (orphaning) ele troca o armazenamento por baixo. Aqui o buffer é criado
+ *  uma vez com glBufferStorage(MAP_WRITE | PERSISTENT | COHERENT), mapeado
+ *  uma vez, e a CPU escreve direto nele por ponteiro.
+ *
+ *  Para não sobrescrever o que a GPU ainda lê, o buffer tem RING_FRAMES
+ *  seções: o quadro N usa a seção N % 3 e termina com uma cerca. Antes de
+ *  reescrever a seção, três quadros depois, beginFrame espera aquela cerca.
+ *  Com a GPU até dois quadros atrás a espera não acontece; o tempo parado
+ *  em glClientWaitSync é somado em stats() e mostra quanto a CPU e a GPU
+ *  deixaram de trabalhar juntas.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  PersistentRing ring(64 * 1024);
+ *  ...
+ *  // a cada quadro
+ *  ring.beginFrame();
+ *  RingAllocation objects = ring.allocate(count * sizeof(SceneObject), ring.bindAlignment());
+ *  memcpy(objects.data, sceneObjects.data(), objects.size);
+ *  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, ring.buffer(), objects.offset, objects.size);
+ *  ... draws ...
+ *  ring.endFrame();
+ *  glfwSwapBuffers(window);
+ */
+
+#include "PersistentRing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+PersistentRing::PersistentRing(size_t sectionBytes)
+{
+    GLint uniformAlignment = 256, storageAlignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+    alignment = (size_t)std::max(std::max(uniformAlignment, storageAlignment), 16);
+    // Cada seção começa alinhada: os offsets dentro dela valem para qualquer alvo
+    sectionSize = (sectionBytes + alignment - 1) / alignment * alignment;
+
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &ringBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, ringBuffer);
+    glBufferStorage(GL_ARRAY_BUFFER, GLsizeiptr(sectionSize * RING_FRAMES), NULL, flags);
+    mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, GLsizeiptr(sectionSize * RING_FRAMES), flags);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (!mapped) std::cerr << "PersistentRing: glMapBufferRange falhou" << std::endl;
+}
+
+PersistentRing::~PersistentRing()
+{
+    for (GLsync& fence : fences)
+    {
+        if (fence) glDeleteSync(fence);
+    }
+    if (ringBuffer)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, ringBuffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glDeleteBuffers(1, &ringBuffer);
+    }
+}
+
+void PersistentRing::beginFrame()
+{
+    used = 0;
+    ++counters.frames;
+    GLsync& fence = fences[section];
+    if (!fence) return;
+
+    // Sem espera: a GPU já terminou o quadro que usou esta seção
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        auto start = std::chrono::steady_clock::now();
+        // O flush garante que a cerca chegou à GPU; depois, espera de 1 ms em 1 ms
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        do
+        {
+            status = glClientWaitSync(fence, flags, 1000000);
+            flags = 0;
+        } while (status == GL_TIMEOUT_EXPIRED);
+        double stalled = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++counters.stalledFrames;
+        counters.stallSeconds += stalled;
+        counters.maxStallSeconds = std::max(counters.maxStallSeconds, stalled);
+    }
+    if (status == GL_WAIT_FAILED) std::cerr << "PersistentRing: glClientWaitSync falhou" << std::endl;
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+RingAllocation PersistentRing::allocate(size_t bytes, size_t align)
+{
+    RingAllocation allocation;
+    size_t offset = (used + align - 1) / align * align;
+    if (!mapped || offset + bytes > sectionSize)
+    {
+        ++counters.overflows;
+        return allocation;
+    }
+    used = offset + bytes;
+    counters.peakBytes = std::max(counters.peakBytes, used);
+    allocation.offset = GLintptr(size_t(section) * sectionSize + offset);
+    allocation.data = mapped + allocation.offset;
+    allocation.size = (GLsizeiptr)bytes;
+    return allocation;
+}
+
+void PersistentRing::endFrame()
+{
+    fences[section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    section = (section + 1) % RING_FRAMES;
+}
@@ -0,0 +1,227 @@
+/*
+ *  Programas de shader com os uniforms resolvidos uma vez só.
+ *
+ *  build compila vertex e fragment shader, linka e lê a tabela de uniforms
+ *  ativos (nome, tipo, tamanho, localização, bloco e offset) e de blocos de
+ *  uniforms (tamanho e ponto de ligação). O glad do projeto é OpenGL 4.0,
+ *  então a reflexão usa glGetActiveUniform/glGetActiveUniformsiv/
+ *  glGetActiveUniformBlockiv no lugar da glGetProgramInterfaceiv da 4.3; a
+ *  tabela é a mesma.
+ *
+ *  Os handles (Uniform<T>) guardam só a localização: o quadro chama
+ *  glUniform* direto, sem nenhuma busca por nome. O tipo pedido é conferido
+ *  com o declarado no GLSL na hora de pegar o handle.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  ShaderProgram phong;
+ *  phong.build("phong", vertexShaderSource, fragmentShaderSource);
+ *  Uniform<glm::vec3> kd = phong.uniform<glm::vec3>("kd");    // uma vez
+ *  Uniform<int> colorBuffer = phong.uniform<int>("colorBuffer");
+ *  ...
+ *  phong.use();
+ *  kd.set(material.kd);                                       // a cada draw
+ */
+
+#include "ShaderProgram.h"
+
+#include <iostream>
+
+namespace
+{
+    GLuint compileStage(GLenum stage, const char* source, const std::string& program)
+    {
+        GLuint shader = glCreateShader(stage);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            GLint length = 0;
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+            std::string log(length > 0 ? length : 1, '\0');
+            glGetShaderInfoLog(shader, (GLsizei)log.size(), NULL, &log[0]);
+            std::cerr << "Shader " << program << " (" << (stage == GL_VERTEX_SHADER ? "vertex" : "fragment")
+                      << "): erro de compilacao\n" << log.c_str() << std::endl;
+        }
+        return shader;
+    }
+}
+
+bool isSamplerType(GLenum type)
+{
+    switch (type)
+    {
+    case GL_SAMPLER_1D:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_3D:
+    case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_2D_SHADOW:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_2D_ARRAY_SHADOW:
+    case GL_SAMPLER_BUFFER:
+    case GL_SAMPLER_2D_MULTISAMPLE:
+    case GL_INT_SAMPLER_2D:
+    case GL_INT_SAMPLER_2D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D:
+    case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        return true;
+    default:
+        return false;
+    }
+}
+
+const char* uniformTypeName(GLenum type)
+{
+    switch (type)
+    {
+    case GL_FLOAT: return "float";
+    case GL_FLOAT_VEC2: return "vec2";
+    case GL_FLOAT_VEC3: return "vec3";
+    case GL_FLOAT_VEC4: return "vec4";
+    case GL_INT: return "int";
+    case GL_UNSIGNED_INT: return "uint";
+    case GL_BOOL: return "bool";
+    case GL_FLOAT_MAT3: return "mat3";
+    case GL_FLOAT_MAT4: return "mat4";
+    case GL_SAMPLER_2D: return "sampler2D";
+    case GL_SAMPLER_2D_ARRAY: return "sampler2DArray";
+    case GL_UNSIGNED_INT_SAMPLER_2D: return "usampler2D";
+    default: return isSamplerType(type) ? "sampler" : "outro";
+    }
+}
+
+ShaderProgram::~ShaderProgram()
+{
+    if (program) glDeleteProgram(program);
+}
+
+bool ShaderProgram::build(const std::string& name, const char* vertexSource, const char* fragmentSource)
+{
+    if (program) glDeleteProgram(program);
+    label = name;
+    uniformList.clear();
+    blockList.clear();
+
+    GLuint vertexShader = compileStage(GL_VERTEX_SHADER, vertexSource, label);
+    GLuint fragmentShader = compileStage(GL_FRAGMENT_SHADER, fragmentSource, label);
+
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    // Os estágios ficam presos ao programa até ele ser apagado
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::string log(length > 0 ? length : 1, '\0');
+        glGetProgramInfoLog(program, (GLsizei)log.size(), NULL, &log[0]);
+        std::cerr << "Shader " << label << ": erro de link\n" << log.c_str() << std::endl;
+        return false;
+    }
+
+    reflect();
+    return true;
+}
+
+void ShaderProgram::reflect()
+{
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> name(maxLength > 0 ? maxLength : 1);
+    for (GLint i = 0; i < count; ++i)
+    {
+        UniformInfo info;
+        GLsizei length = 0;
+        glGetActiveUniform(program, (GLuint)i, (GLsizei)name.size(), &length, &info.size, &info.type, name.data());
+        info.name.assign(name.data(), length);
+        // O glGetUniformLocation só roda aqui, uma vez por uniform (membros de bloco não têm localização)
+        info.location = glGetUniformLocation(program, info.name.c_str());
+        if (info.name.size() > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0) info.name.resize(info.name.size() - 3);
+
+        GLuint index = (GLuint)i;
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &info.block);
+        if (info.block >= 0) glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &info.offset);
+        uniformList.push_back(info);
+    }
+
+    GLint blockCount = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    for (GLint i = 0; i < blockCount; ++i)
+    {
+        UniformBlockInfo block;
+        block.index = (GLuint)i;
+        GLint length = 0;
+        glGetActiveUniformBlockiv(program, block.index, GL_UNIFORM_BLOCK_NAME_LENGTH, &length);
+        std::string blockName(length > 0 ? length : 1, '\0');
+        glGetActiveUniformBlockName(program, block.index, (GLsizei)blockName.size(), NULL, &blockName[0]);
+        block.name = blockName.c_str();
+        glGetActiveUniformBlockiv(program, block.index, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+        glGetActiveUniformBlockiv(program, block.index, GL_UNIFORM_BLOCK_BINDING, &block.binding);
+        blockList.push_back(block);
+    }
+}
+
+const UniformInfo* ShaderProgram::find(const char* name) const
+{
+    for (const UniformInfo& info : uniformList)
+    {
+        if (info.name == name) return &info;
+    }
+    return nullptr;
+}
+
+const UniformBlockInfo* ShaderProgram::findBlock(const char* name) const
+{
+    for (const UniformBlockInfo& block : blockList)
+    {
+        if (block.name == name) return &block;
+    }
+    return nullptr;
+}
+
+bool ShaderProgram::bindBlock(const char* name, GLuint binding)
+{
+    for (UniformBlockInfo& block : blockList)
+    {
+        if (block.name != name) continue;
+        glUniformBlockBinding(program, block.index, binding);
+        block.binding = (GLint)binding;
+        return true;
+    }
+    return false;
+}
+
+void ShaderProgram::typeMismatch(const UniformInfo& info) const
+{
+    std::cerr << "Shader " << label << ": uniform " << info.name << " e " << uniformTypeName(info.type)
+              << ", pedido com outro tipo" << std::endl;
+}
+
+void ShaderProgram::printReflection() const
+{
+    std::cout << "Shader " << label << ": " << uniformList.size() << " uniforms, " << blockList.size() << " blocos\n";
+    for (const UniformInfo& info : uniformList)
+    {
+        std::cout << "  " << uniformTypeName(info.type) << " " << info.name;
+        if (info.size > 1) std::cout << "[" << info.size << "]";
+        if (info.block >= 0) std::cout << " (bloco " << blockList[info.block].name << ", offset " << info.offset << ")";
+        else std::cout << " (location " << info.location << ")";
+        std::cout << "\n";
+    }
+    for (const UniformBlockInfo& block : blockList)
+    {
+        std::cout << "  bloco " << block.name << ": " << block.dataSize << " bytes, binding " << block.binding << "\n";
+    }
+    std::cout << std::flush;
+}
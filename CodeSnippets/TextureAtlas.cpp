@@ -0,0 +1,373 @@
+/*
+ *  Atlas/array de texturas para desenhar materiais diferentes sem trocar de
+ *  textura entre os draws.
+ *
+ *  Tudo mora num GL_TEXTURE_2D_ARRAY RGBA8 de páginas pageSize x pageSize:
+ *   - textura do tamanho exato da página: ocupa uma camada inteira, com toda
+ *     a cadeia de mipmaps e o wrap do próprio sampler do array;
+ *   - textura menor: empacotada em prateleiras numa camada dividida, com
+ *     gutter de padding pixels em volta (cópia da borda, ou do lado oposto em
+ *     GL_REPEAT). As origens ficam múltiplas de padding, então o nível k de
+ *     cada textura cai em (x >> k, y >> k) sem invadir a vizinha até o nível
+ *     log2(padding); o shader limita o LOD a esse nível;
+ *   - textura maior que a página: entra a partir do primeiro mipmap que cabe.
+ *  Quando faltam camadas, o array dobra de tamanho e as páginas antigas são
+ *  copiadas na GPU (glCopyTexSubImage3D a partir de um framebuffer de leitura).
+ *
+ *  O shader recebe por draw a camada e o retângulo de uv (AtlasPlacement) e
+ *  amostra uvRect.zw + uv * uvRect.xy na camada.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  TextureAtlas atlas(1024);
+ *  int id = atlas.insert(data, params);                   // thread com contexto
+ *  AtlasPlacement where = atlas.placement(id);            // vai para o buffer por draw
+ *  glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.texture());  // um bind para todos os objetos
+ *  ...
+ *  if (!atlas.update(id, novaImagem, params))             // hot reload no mesmo lugar
+ *      ...                                                // senão remove + insert
+ *  atlas.remove(id);
+ */
+
+#include "TextureAtlas.h"
+#include "TextureCache.h"
+#include "TextureCompress.h"
+
+#include <algorithm>
+
+namespace
+{
+    int levelCount(const TextureData& data)
+    {
+        return data.fromBake ? int(data.baked.header.levelCount) : int(data.levels.size());
+    }
+
+    void levelSize(const TextureData& data, int level, int& width, int& height)
+    {
+        if (data.fromBake)
+        {
+            width = int(data.baked.header.levels[level].width);
+            height = int(data.baked.header.levels[level].height);
+        }
+        else
+        {
+            width = data.levels[level].width;
+            height = data.levels[level].height;
+        }
+    }
+
+    // Nível da imagem em RGBA 8 bits, qualquer que seja a origem
+    void levelRGBA(const TextureData& data, int level, std::vector<unsigned char>& rgba)
+    {
+        int width, height;
+        levelSize(data, level, width, height);
+        const unsigned char* pixels;
+        int channels = data.channels;
+        if (data.fromBake)
+        {
+            if (data.baked.format() != TextureFormat::Raw)
+            {
+                decompressTexture(data.baked.levelData(level), width, height, data.baked.format(), rgba);
+                return;
+            }
+            pixels = data.baked.levelData(level);
+            channels = int(data.baked.header.channels);
+        }
+        else
+        {
+            pixels = data.levels[level].pixels.data();
+        }
+
+        rgba.resize(size_t(width) * height * 4);
+        for (size_t i = 0, count = size_t(width) * height; i < count; ++i)
+        {
+            rgba[i * 4 + 0] = pixels[i * channels + 0];
+            rgba[i * 4 + 1] = pixels[i * channels + 1];
+            rgba[i * 4 + 2] = pixels[i * channels + 2];
+            rgba[i * 4 + 3] = channels == 4 ? pixels[i * channels + 3] : 255;
+        }
+    }
+
+    // Coordenada do gutter de volta para dentro da imagem
+    int wrapTexel(int i, int size, bool repeat)
+    {
+        if (repeat) return ((i % size) + size) % size;
+        return std::min(std::max(i, 0), size - 1);
+    }
+
+    int alignUp(int value, int alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    int log2Floor(int value)
+    {
+        int log = 0;
+        while (value > 1)
+        {
+            value >>= 1;
+            ++log;
+        }
+        return log;
+    }
+}
+
+TextureAtlas::TextureAtlas(int pageSize, int padding)
+    : size(pageSize), padding(padding), levels(log2Floor(pageSize) + 1)
+{
+    grow(2);
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    if (textureID) glDeleteTextures(1, &textureID);
+}
+
+void TextureAtlas::grow(int layers)
+{
+    GLuint next;
+    glGenTextures(1, &next);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, next);
+    for (int level = 0; level < levels; ++level)
+    {
+        int levelSize = std::max(1, size >> level);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, levelSize, levelSize, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // As páginas inteiras repetem pelo próprio sampler; as divididas, pelo gutter
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    if (textureID)
+    {
+        // Páginas já ocupadas: cópia na GPU, camada a camada, nível a nível
+        GLuint fbo;
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        for (int layer = 0; layer < (int)pages.size(); ++layer)
+        {
+            for (int level = 0; level < levels; ++level)
+            {
+                int levelSize = std::max(1, size >> level);
+                glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, textureID, level, layer);
+                glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, 0, 0, levelSize, levelSize);
+            }
+        }
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteTextures(1, &textureID);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    textureID = next;
+    capacity = layers;
+}
+
+int TextureAtlas::addPage()
+{
+    if ((int)pages.size() == capacity) grow(capacity * 2);
+    pages.push_back(Page());
+    return (int)pages.size() - 1;
+}
+
+// Prateleira de altura mais próxima que ainda tem espaço; senão uma nova
+// prateleira embaixo; senão outra página
+bool TextureAtlas::allocate(int width, int height, int& page, int& x, int& y)
+{
+    for (int p = 0; p < (int)pages.size(); ++p)
+    {
+        Page& candidate = pages[p];
+        if (candidate.whole) continue;
+
+        Shelf* best = nullptr;
+        for (Shelf& shelf : candidate.shelves)
+        {
+            if (shelf.height < height || shelf.x + width > size) continue;
+            if (!best || shelf.height < best->height) best = &shelf;
+        }
+        if (!best && candidate.nextY + height <= size)
+        {
+            candidate.shelves.push_back({ candidate.nextY, height, 0 });
+            candidate.nextY += height;
+            best = &candidate.shelves.back();
+        }
+        if (!best) continue;
+
+        page = p;
+        x = best->x;
+        y = best->y;
+        best->x += width;
+        return true;
+    }
+
+    page = addPage();
+    pages[page].shelves.push_back({ 0, height, width });
+    pages[page].nextY = height;
+    x = 0;
+    y = 0;
+    return true;
+}
+
+// Primeiro nível que cabe na página inteira, ou numa página dividida com o gutter; -1 se nenhum
+int TextureAtlas::fittingLevel(const TextureData& data, int& width, int& height) const
+{
+    int count = levelCount(data);
+    for (int base = 0; base < count; ++base)
+    {
+        levelSize(data, base, width, height);
+        if (width == size && height == size) return base;
+        if (width + 2 * padding <= size && height + 2 * padding <= size) return base;
+    }
+    return -1;
+}
+
+// Copia os níveis a partir de base para a área da entrada, com o gutter, e
+// atualiza o lugar gravado nela
+void TextureAtlas::writeLevels(Entry& entry, const TextureData& data, int base, const TextureParams& params)
+{
+    // Páginas divididas só até o nível em que o gutter ainda tem um texel
+    bool whole = pages[entry.page].whole;
+    bool repeat = params.wrap == GL_REPEAT;
+    int lastLevel = std::min(levelCount(data) - 1 - base, levels - 1);
+    if (!whole) lastLevel = std::min(lastLevel, log2Floor(padding));
+
+    std::vector<unsigned char> source, staging;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int level = 0; level <= lastLevel; ++level)
+    {
+        int levelWidth, levelHeight;
+        levelSize(data, base + level, levelWidth, levelHeight);
+        levelRGBA(data, base + level, source);
+
+        int gutter = whole ? 0 : padding >> level;
+        int stagingWidth = levelWidth + 2 * gutter;
+        int stagingHeight = levelHeight + 2 * gutter;
+        staging.resize(size_t(stagingWidth) * stagingHeight * 4);
+        for (int y = 0; y < stagingHeight; ++y)
+        {
+            int sy = wrapTexel(y - gutter, levelHeight, repeat);
+            for (int x = 0; x < stagingWidth; ++x)
+            {
+                int sx = wrapTexel(x - gutter, levelWidth, repeat);
+                std::copy_n(&source[(size_t(sy) * levelWidth + sx) * 4], 4, &staging[(size_t(y) * stagingWidth + x) * 4]);
+            }
+        }
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, (entry.x >> level) - gutter, (entry.y >> level) - gutter, entry.page,
+                        stagingWidth, stagingHeight, 1, GL_RGBA, GL_UNSIGNED_BYTE, staging.data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // Sem filtro de mipmap pedido, o objeto continua amostrando só o nível 0
+    bool mipmapped = params.minFilter != GL_LINEAR && params.minFilter != GL_NEAREST;
+    AtlasPlacement& placement = entry.placement;
+    placement.uvRect = glm::vec4(float(entry.width) / size, float(entry.height) / size, float(entry.x) / size, float(entry.y) / size);
+    placement.layer = float(entry.page);
+    placement.maxLod = mipmapped ? float(lastLevel) : 0.0f;
+    placement.repeat = repeat ? 1.0f : 0.0f;
+    entry.downscaled = base > 0;
+}
+
+int TextureAtlas::insert(const TextureData& data, const TextureParams& params)
+{
+    int width = 0, height = 0;
+    int base = fittingLevel(data, width, height);
+    if (base < 0) return -1;
+
+    Entry entry;
+    entry.width = width;
+    entry.height = height;
+    bool whole = width == size && height == size;
+    int originX = 0, originY = 0;
+    if (whole)
+    {
+        // Página vazia (liberada antes) ou uma nova
+        entry.page = -1;
+        for (int p = 0; p < (int)pages.size() && entry.page < 0; ++p)
+        {
+            if (pages[p].live == 0) entry.page = p;
+        }
+        if (entry.page < 0) entry.page = addPage();
+        pages[entry.page].whole = true;
+        entry.allocWidth = entry.allocHeight = size;
+    }
+    else
+    {
+        entry.allocWidth = alignUp(width + 2 * padding, padding);
+        entry.allocHeight = alignUp(height + 2 * padding, padding);
+        int allocX, allocY;
+        allocate(entry.allocWidth, entry.allocHeight, entry.page, allocX, allocY);
+        originX = allocX + padding;
+        originY = allocY + padding;
+    }
+    entry.x = originX;
+    entry.y = originY;
+    ++pages[entry.page].live;
+
+    writeLevels(entry, data, base, params);
+    entry.live = true;
+
+    entries.push_back(entry);
+    return (int)entries.size() - 1;
+}
+
+bool TextureAtlas::update(int id, const TextureData& data, const TextureParams& params)
+{
+    if (id < 0 || id >= (int)entries.size() || !entries[id].live) return false;
+    Entry& entry = entries[id];
+
+    // Só cabe no mesmo lugar com o mesmo tamanho (o que também mantém página inteira x dividida)
+    int width = 0, height = 0;
+    int base = fittingLevel(data, width, height);
+    if (base < 0 || width != entry.width || height != entry.height) return false;
+    writeLevels(entry, data, base, params);
+    return true;
+}
+
+void TextureAtlas::remove(int id)
+{
+    if (id < 0 || id >= (int)entries.size() || !entries[id].live) return;
+    Entry& entry = entries[id];
+    entry.live = false;
+
+    // A área de uma entrada no meio da prateleira só volta com a página inteira
+    Page& page = pages[entry.page];
+    if (--page.live == 0)
+    {
+        page.shelves.clear();
+        page.nextY = 0;
+        page.whole = false;
+    }
+}
+
+size_t TextureAtlas::entryBytes(int id) const
+{
+    const Entry& entry = entries[id];
+    return size_t(entry.allocWidth) * entry.allocHeight * 4 * 4 / 3;
+}
+
+TextureAtlasStats TextureAtlas::stats() const
+{
+    TextureAtlasStats stats;
+    stats.capacity = capacity;
+    size_t used = 0;
+    for (const Entry& entry : entries)
+    {
+        if (!entry.live) continue;
+        ++stats.entries;
+        if (pages[entry.page].whole) ++stats.wholePages;
+        else ++stats.packed;
+        if (entry.downscaled) ++stats.downscaled;
+        used += size_t(entry.width) * entry.height;
+    }
+    for (const Page& page : pages)
+    {
+        if (page.live > 0) ++stats.pages;
+    }
+    size_t pageArea = size_t(size) * size;
+    stats.fill = stats.pages ? float(double(used) / double(stats.pages * pageArea)) : 0.0f;
+    stats.bytes = size_t(capacity) * pageArea * 4 * 4 / 3;
+    return stats;
+}
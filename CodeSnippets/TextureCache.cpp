@@ -0,0 +1,535 @@
+/*
+ *  Cache de texturas compartilhado por todas as geometrias da cena.
+ *
+ *  Dois níveis de deduplicação:
+ *   - pelo caminho canônico + parâmetros (wrap/filtro): o mesmo map_Kd pedido
+ *     por vários objetos, ou o mesmo .obj carregado várias vezes, é decodificado
+ *     uma vez só e todos recebem o mesmo id de textura;
+ *   - pelo conteúdo: depois de decodificar, o hash FNV-1a dos pixels do nível 0
+ *     é comparado com as imagens já carregadas; arquivos diferentes com a mesma
+ *     imagem dividem a textura e o segundo decode é descartado.
+ *
+ *  Cada acquire conta uma referência e cada release solta uma; a textura da GPU
+ *  é apagada quando a última geometria que a usava é liberada.
+ *
+ *  Hot reload: decodeReload decodifica o arquivo alterado no pool e
+ *  commitReloads troca a imagem das entradas. Se a imagem é só daquela
+ *  entrada e o tamanho/formato não mudou, os texels são reescritos no mesmo
+ *  objeto (glTexSubImage2D, ou o mesmo lugar do atlas) e os ids continuam
+ *  valendo; senão a entrada passa para uma imagem nova e a antiga só é
+ *  apagada em deleteRetired, depois que as geometrias trocaram de id.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  TextureCache cache;
+ *  TextureHandle tex = cache.acquire("Cube.png");         // qualquer thread
+ *  geom.textureID = cache.upload(tex);                    // thread com contexto
+ *  ...
+ *  AtlasPlacement where = cache.place(tex, atlas);        // ou no atlas compartilhado
+ *  cache.release(tex);
+ *  TextureCacheStats stats = cache.stats();
+ *
+ *  // hot reload: Cube.png mudou no disco
+ *  cache.decodeReload("Cube.png");                        // qualquer thread
+ *  for (TextureHandle changed : cache.commitReloads())    // thread com contexto
+ *      geom.textureID = cache.upload(changed);
+ *  cache.deleteRetired();                                 // thread principal
+ */
+
+#include "TextureCache.h"
+#include "TextureUpload.h"
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <stb_image.h>
+
+// Imagem decodificada; pode ser dividida por várias entradas de caminho
+struct TextureImage
+{
+    TextureData data;
+    TextureCache::ContentKey key;
+    size_t bytes = 0;
+    int refs = 0;
+    // Entrada no atlas, no lugar de data.textureID
+    TextureAtlas* atlas = nullptr;
+    int atlasEntry = -1;
+};
+
+// Entrada por caminho canônico + parâmetros
+struct CachedTexture
+{
+    enum State
+    {
+        Decoding,
+        Ready,
+        Failed
+    };
+
+    std::string path;
+    TextureParams params;
+    State state = Decoding;
+    int refs = 0;
+    TextureImage* image = nullptr;
+};
+
+bool decodeTexture(const std::string& path, TextureData& data, MipFilter filter, ThreadPool* pool)
+{
+    data.path = path;
+
+    // Com o .mips do objbake a imagem já vem decodificada e com os mipmaps prontos
+    if (loadBakedTexture(path, data.baked))
+    {
+        data.fromBake = true;
+        data.width = data.baked.header.levels[0].width;
+        data.height = data.baked.header.levels[0].height;
+        data.channels = data.baked.header.channels;
+        return true;
+    }
+
+    // Mesmo critério do objbake: 3 canais vira GL_RGB, o resto GL_RGBA
+    unsigned char* pixels = stbi_load(path.c_str(), &data.width, &data.height, &data.channels, 0);
+    if (pixels && data.channels != 3 && data.channels != 4)
+    {
+        stbi_image_free(pixels);
+        pixels = stbi_load(path.c_str(), &data.width, &data.height, &data.channels, 4);
+        data.channels = 4;
+    }
+    if (!pixels)
+    {
+        std::cerr << "Failed to load texture: " << path << std::endl;
+        return false;
+    }
+
+    // Mipmaps aqui, fora da thread com contexto: o upload só copia os níveis
+    generateMips(pixels, data.width, data.height, data.channels, data.levels, filter, pool);
+    stbi_image_free(pixels);
+    return true;
+}
+
+bool uploadTexture(TextureData& data, const TextureParams& params)
+{
+    glGenTextures(1, &data.textureID);
+    glBindTexture(GL_TEXTURE_2D, data.textureID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, params.minFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    if (data.fromBake)
+    {
+        // Níveis prontos (crus ou BCn): nada de glGenerateMipmap
+        data.gpuBytes = uploadBakedLevels(data.baked);
+    }
+    else
+    {
+        // Imagem sem .mips (objbake ainda não rodou): níveis já gerados no decode
+        GLenum format = (data.channels == 3) ? GL_RGB : GL_RGBA;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (size_t level = 0; level < data.levels.size(); ++level)
+        {
+            const MipLevel& mip = data.levels[level];
+            glTexImage2D(GL_TEXTURE_2D, GLint(level), format, mip.width, mip.height, 0, format, GL_UNSIGNED_BYTE, mip.pixels.data());
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(data.levels.size()) - 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        data.gpuBytes = textureBytes(data);
+        data.levels.clear();
+        data.levels.shrink_to_fit();
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+size_t textureBytes(const TextureData& data)
+{
+    if (data.fromBake)
+    {
+        size_t bytes = 0;
+        for (uint32_t level = 0; level < data.baked.header.levelCount; ++level) bytes += data.baked.header.levels[level].size;
+        return bytes;
+    }
+
+    size_t bytes = 0;
+    for (const MipLevel& level : data.levels) bytes += level.pixels.size();
+    return bytes;
+}
+
+// FNV-1a de 64 bits, o mesmo hash das chaves de .meshcache/.mips
+static uint64_t hashPixels(const unsigned char* pixels, size_t size)
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ pixels[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static TextureCache::ContentKey contentKeyOf(const TextureData& data, const TextureParams& params)
+{
+    const unsigned char* pixels = data.fromBake ? data.baked.levelData(0) : data.levels[0].pixels.data();
+    size_t size = data.fromBake ? data.baked.header.levels[0].size : data.levels[0].pixels.size();
+    uint64_t hash = hashPixels(pixels, size);
+    return TextureCache::ContentKey(hash, data.width, data.height, data.channels, params.wrap, params.minFilter);
+}
+
+// "a/../b.png", "./b.png" e barras invertidas caem na mesma chave
+static std::string canonicalPath(const std::string& path)
+{
+    std::error_code ec;
+    std::string canonical = std::filesystem::weakly_canonical(std::filesystem::path(path), ec).generic_string();
+    return (ec || canonical.empty()) ? path : canonical;
+}
+
+// A textura criada com a imagem antiga aceita a nova só com glTexSubImage2D?
+static bool sameLayout(const TextureData& current, const TextureData& fresh)
+{
+    if (current.width != fresh.width || current.height != fresh.height || current.channels != fresh.channels) return false;
+    if (current.fromBake != fresh.fromBake) return false;
+    return !current.fromBake || (current.baked.format() == fresh.baked.format() &&
+                                 current.baked.header.levelCount == fresh.baked.header.levelCount);
+}
+
+// Reescreve todos os níveis na textura ligada, sem realocar
+static void updateTextureLevels(const TextureData& data)
+{
+    if (data.fromBake)
+    {
+        updateBakedLevels(data.baked);
+        return;
+    }
+    GLenum format = (data.channels == 3) ? GL_RGB : GL_RGBA;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t level = 0; level < data.levels.size(); ++level)
+    {
+        const MipLevel& mip = data.levels[level];
+        glTexSubImage2D(GL_TEXTURE_2D, GLint(level), 0, 0, mip.width, mip.height, format, GL_UNSIGNED_BYTE, mip.pixels.data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+TextureCache::~TextureCache()
+{
+    // Imagens trocadas por um reload de conteúdo repetido não estão em byContent
+    std::set<TextureImage*> images;
+    for (auto& entry : byPath)
+    {
+        if (entry.second->image) images.insert(entry.second->image);
+        delete entry.second;
+    }
+    for (auto& image : byContent) images.insert(image.second);
+    for (TextureImage* image : images)
+    {
+        if (image->data.textureID) glDeleteTextures(1, &image->data.textureID);
+        delete image;
+    }
+    for (const Retired& old : retired)
+    {
+        if (old.textureID) glDeleteTextures(1, &old.textureID);
+    }
+}
+
+TextureHandle TextureCache::acquire(const std::string& path, const TextureParams& params)
+{
+    std::string canonical = canonicalPath(path);
+    PathKey key(canonical, params.wrap, params.minFilter);
+
+    CachedTexture* entry;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ++counters.requests;
+        auto found = byPath.find(key);
+        if (found != byPath.end())
+        {
+            // Outra thread pode estar decodificando esta mesma chave agora
+            entry = found->second;
+            ++entry->refs;
+            decoded.wait(lock, [entry]() { return entry->state != CachedTexture::Decoding; });
+            if (entry->state == CachedTexture::Failed)
+            {
+                --entry->refs;
+                return nullptr;
+            }
+            ++counters.pathHits;
+            counters.bytesSaved += entry->image->bytes;
+            return entry;
+        }
+
+        entry = new CachedTexture();
+        entry->path = canonical;
+        entry->params = params;
+        entry->refs = 1;
+        byPath[key] = entry;
+        ++counters.decodes;
+    }
+
+    // Decodifica e calcula o hash fora do lock: outras chaves seguem em paralelo
+    std::unique_ptr<TextureImage> image(new TextureImage());
+    bool ok = decodeTexture(canonical, image->data, filter, pool);
+    ContentKey content;
+    if (ok)
+    {
+        content = contentKeyOf(image->data, params);
+        image->bytes = textureBytes(image->data);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!ok)
+    {
+        // A falha fica registrada: novos pedidos da chave não tentam de novo
+        entry->state = CachedTexture::Failed;
+        --entry->refs;
+        ++counters.failures;
+        decoded.notify_all();
+        return nullptr;
+    }
+
+    auto same = byContent.find(content);
+    if (same != byContent.end())
+    {
+        // Mesma imagem de outro arquivo: descarta este decode e divide a textura
+        entry->image = same->second;
+        ++entry->image->refs;
+        ++counters.contentHits;
+        counters.bytesSaved += entry->image->bytes;
+    }
+    else
+    {
+        image->key = content;
+        image->refs = 1;
+        entry->image = image.release();
+        byContent[content] = entry->image;
+    }
+    entry->state = CachedTexture::Ready;
+    decoded.notify_all();
+    return entry;
+}
+
+GLuint TextureCache::upload(TextureHandle handle)
+{
+    if (!handle) return 0;
+
+    // Depois de Ready, a imagem da entrada só muda no commitReloads, que segura o mesmo lock
+    std::lock_guard<std::mutex> uploading(uploadMutex);
+    TextureImage* image = handle->image;
+    if (image->data.textureID == 0)
+    {
+        uploadTexture(image->data, handle->params);
+        std::lock_guard<std::mutex> lock(mutex);
+        // Sem suporte ao formato comprimido a textura ocupa mais que o estimado no decode
+        image->bytes = image->data.gpuBytes;
+        ++counters.textures;
+        counters.bytesResident += image->bytes;
+    }
+    return image->data.textureID;
+}
+
+AtlasPlacement TextureCache::place(TextureHandle handle, TextureAtlas& atlas)
+{
+    if (!handle) return AtlasPlacement();
+
+    std::lock_guard<std::mutex> uploading(uploadMutex);
+    TextureImage* image = handle->image;
+    if (!image->atlas)
+    {
+        int entry = atlas.insert(image->data, handle->params);
+        if (entry < 0) return AtlasPlacement();
+        image->atlas = &atlas;
+        image->atlasEntry = entry;
+        // Os pixels já estão no array
+        image->data.levels.clear();
+        image->data.levels.shrink_to_fit();
+        std::lock_guard<std::mutex> lock(mutex);
+        image->bytes = atlas.entryBytes(entry);
+        ++counters.textures;
+        counters.bytesResident += image->bytes;
+    }
+    return image->atlas->placement(image->atlasEntry);
+}
+
+void TextureCache::release(TextureHandle handle)
+{
+    if (!handle) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--handle->refs > 0) return;
+    byPath.erase(PathKey(handle->path, handle->params.wrap, handle->params.minFilter));
+    TextureImage* image = handle->image;
+    delete handle;
+    releaseImage(image);
+}
+
+void TextureCache::releaseImage(TextureImage* image, bool retire)
+{
+    if (--image->refs > 0) return;
+    // Depois de um reload, outra imagem pode ter ficado com a chave
+    auto same = byContent.find(image->key);
+    if (same != byContent.end() && same->second == image) byContent.erase(same);
+    if (image->atlas)
+    {
+        if (retire) retired.push_back({ 0, image->atlas, image->atlasEntry });
+        else image->atlas->remove(image->atlasEntry);
+        --counters.textures;
+        counters.bytesResident -= image->bytes;
+    }
+    if (image->data.textureID)
+    {
+        if (retire) retired.push_back({ image->data.textureID, nullptr, -1 });
+        else glDeleteTextures(1, &image->data.textureID);
+        --counters.textures;
+        counters.bytesResident -= image->bytes;
+    }
+    delete image;
+}
+
+bool TextureCache::decodeReload(const std::string& path)
+{
+    std::string canonical = canonicalPath(path);
+    std::vector<PathKey> keys;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& entry : byPath)
+        {
+            if (std::get<0>(entry.first) == canonical && entry.second->state == CachedTexture::Ready) keys.push_back(entry.first);
+        }
+    }
+
+    // Um decode por combinação de parâmetros: cada uma vira uma imagem própria
+    for (const PathKey& key : keys)
+    {
+        std::unique_ptr<TextureData> data(new TextureData());
+        if (!decodeTexture(canonical, *data, filter, pool)) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        ++counters.decodes;
+        reloads[key] = std::move(data);
+    }
+    return !keys.empty();
+}
+
+std::vector<TextureHandle> TextureCache::commitReloads(TextureAtlas* atlas)
+{
+    std::vector<TextureHandle> changed;
+    // Os dois locks durante os envios: reloads são raros e acquires de outras threads só esperam um pouco
+    std::lock_guard<std::mutex> uploading(uploadMutex);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto pending = reloads.begin(); pending != reloads.end();)
+    {
+        auto found = byPath.find(pending->first);
+        if (found == byPath.end())
+        {
+            // A última geometria com a textura saiu enquanto o arquivo era decodificado
+            pending = reloads.erase(pending);
+            continue;
+        }
+        CachedTexture* entry = found->second;
+        TextureImage* image = entry->image;
+        if (image->atlas != atlas)
+        {
+            ++pending;
+            continue;
+        }
+        std::unique_ptr<TextureData> fresh = std::move(pending->second);
+        pending = reloads.erase(pending);
+        ContentKey content = contentKeyOf(*fresh, entry->params);
+        ++counters.reloads;
+        changed.push_back(entry);
+
+        // Imagem só desta entrada e do mesmo tamanho: mesmos ids, texels novos
+        bool inPlace = false;
+        if (image->refs == 1)
+        {
+            if (image->data.textureID && sameLayout(image->data, *fresh))
+            {
+                glBindTexture(GL_TEXTURE_2D, image->data.textureID);
+                updateTextureLevels(*fresh);
+                glBindTexture(GL_TEXTURE_2D, 0);
+                inPlace = true;
+            }
+            else if (image->atlas)
+            {
+                inPlace = image->atlas->update(image->atlasEntry, *fresh, entry->params);
+            }
+            else if (!image->data.textureID)
+            {
+                // Ainda não foi enviada: o upload/place vai usar a imagem nova
+                inPlace = true;
+            }
+        }
+
+        if (inPlace)
+        {
+            GLuint textureID = image->data.textureID;
+            size_t gpuBytes = image->data.gpuBytes;
+            image->data = std::move(*fresh);
+            image->data.textureID = textureID;
+            image->data.gpuBytes = gpuBytes;
+            if (textureID || image->atlas)
+            {
+                image->data.levels.clear();
+                image->data.levels.shrink_to_fit();
+            }
+            else
+            {
+                image->bytes = textureBytes(image->data);
+            }
+            auto same = byContent.find(image->key);
+            if (same != byContent.end() && same->second == image) byContent.erase(same);
+            image->key = content;
+            byContent.emplace(content, image);
+            ++counters.reloadsInPlace;
+            continue;
+        }
+
+        // Outro tamanho/formato, ou imagem dividida com outro arquivo: imagem
+        // nova para esta entrada, no mesmo tipo de destino da antiga
+        bool uploaded = image->data.textureID != 0;
+        TextureImage* next = new TextureImage();
+        next->data = std::move(*fresh);
+        next->key = content;
+        next->refs = 1;
+        next->bytes = textureBytes(next->data);
+        entry->image = next;
+        byContent.emplace(content, next);
+        releaseImage(image, true);
+
+        if (uploaded)
+        {
+            uploadTexture(next->data, entry->params);
+            next->bytes = next->data.gpuBytes;
+            ++counters.textures;
+            counters.bytesResident += next->bytes;
+        }
+        else if (atlas)
+        {
+            int atlasEntry = atlas->insert(next->data, entry->params);
+            if (atlasEntry < 0) continue;
+            next->atlas = atlas;
+            next->atlasEntry = atlasEntry;
+            next->data.levels.clear();
+            next->data.levels.shrink_to_fit();
+            next->bytes = atlas->entryBytes(atlasEntry);
+            ++counters.textures;
+            counters.bytesResident += next->bytes;
+        }
+    }
+    return changed;
+}
+
+void TextureCache::deleteRetired()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Retired& old : retired)
+    {
+        if (old.textureID) glDeleteTextures(1, &old.textureID);
+        if (old.atlas) old.atlas->remove(old.atlasEntry);
+    }
+    retired.clear();
+}
+
+TextureCacheStats TextureCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
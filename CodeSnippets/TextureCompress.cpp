@@ -0,0 +1,578 @@
+/*
+ *  Compressão de texturas em blocos 4x4 (BC1, BC3 e BC7) para o .mips do objbake.
+ *
+ *  Cada bloco de 16 pixels vira dois endpoints e um índice por pixel numa paleta
+ *  interpolada entre eles. Os endpoints partem do eixo principal das cores do
+ *  bloco (maior variância) e são refinados por mínimos quadrados com os índices
+ *  escolhidos, mantendo a melhor de algumas iterações.
+ *
+ *   BC1: endpoints RGB 565, 4 cores, 2 bits por pixel            ->  8 bytes
+ *   BC3: alfa com endpoints de 8 bits e 8 níveis + cor como BC1  -> 16 bytes
+ *   BC7: modo 6, endpoints RGBA 7 bits + bit p, 16 níveis        -> 16 bytes
+ *
+ *  A descompressão existe para o fallback: drivers sem S3TC/BPTC recebem os
+ *  níveis convertidos de volta para RGBA.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  vector<unsigned char> blocks;
+ *  compressTexture(pixels, width, height, 4, TextureFormat::BC3, blocks);
+ *  ...
+ *  vector<unsigned char> rgba;
+ *  decompressTexture(blocks.data(), width, height, TextureFormat::BC3, rgba);
+ */
+
+#include "TextureCompress.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    typedef float Block[16][4];
+
+    // Pesos do endpoint 1 na paleta de 4 bits do BC7 (em 64 avos)
+    const int kBC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Fração do endpoint 1 em cada índice da paleta de 4 cores do BC1
+    const float kBC1Weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    inline float clampByte(float v)
+    {
+        return std::min(255.0f, std::max(0.0f, v));
+    }
+
+    // Bloco 4x4 a partir de (bx, by); nas bordas repete a última linha/coluna
+    void loadBlock(const unsigned char* pixels, int width, int height, int channels, int bx, int by, Block block)
+    {
+        for (int y = 0; y < 4; ++y)
+        {
+            int sy = std::min(by * 4 + y, height - 1);
+            for (int x = 0; x < 4; ++x)
+            {
+                int sx = std::min(bx * 4 + x, width - 1);
+                const unsigned char* p = pixels + (size_t(sy) * width + sx) * channels;
+                float* d = block[y * 4 + x];
+                d[0] = p[0];
+                d[1] = p[1];
+                d[2] = p[2];
+                d[3] = channels == 4 ? p[3] : 255.0f;
+            }
+        }
+    }
+
+    // Média e eixo de maior variância das primeiras components componentes
+    void principalAxis(const Block block, int components, float mean[4], float axis[4])
+    {
+        float minV[4], maxV[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            mean[c] = 0.0f;
+            axis[c] = 0.0f;
+            minV[c] = 255.0f;
+            maxV[c] = 0.0f;
+        }
+        for (int i = 0; i < 16; ++i)
+        {
+            for (int c = 0; c < components; ++c)
+            {
+                mean[c] += block[i][c] / 16.0f;
+                minV[c] = std::min(minV[c], block[i][c]);
+                maxV[c] = std::max(maxV[c], block[i][c]);
+            }
+        }
+
+        float cov[4][4] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            for (int a = 0; a < components; ++a)
+            {
+                for (int b = 0; b < components; ++b)
+                {
+                    cov[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+                }
+            }
+        }
+
+        // Iteração de potência partindo da diagonal da caixa envolvente
+        for (int c = 0; c < components; ++c) axis[c] = maxV[c] - minV[c];
+        for (int iter = 0; iter < 8; ++iter)
+        {
+            float next[4] = {};
+            float length = 0.0f;
+            for (int a = 0; a < components; ++a)
+            {
+                for (int b = 0; b < components; ++b) next[a] += cov[a][b] * axis[b];
+                length += next[a] * next[a];
+            }
+            if (length < 1e-12f) break;
+            length = std::sqrt(length);
+            for (int c = 0; c < components; ++c) axis[c] = next[c] / length;
+        }
+    }
+
+    // Extremos das projeções no eixo: e0 no menor, e1 no maior
+    void axisEndpoints(const Block block, int components, const float mean[4], const float axis[4], float e0[4], float e1[4])
+    {
+        float tMin = std::numeric_limits<float>::max(), tMax = -std::numeric_limits<float>::max();
+        for (int i = 0; i < 16; ++i)
+        {
+            float t = 0.0f;
+            for (int c = 0; c < components; ++c) t += (block[i][c] - mean[c]) * axis[c];
+            tMin = std::min(tMin, t);
+            tMax = std::max(tMax, t);
+        }
+        for (int c = 0; c < 4; ++c)
+        {
+            e0[c] = clampByte(mean[c] + axis[c] * tMin);
+            e1[c] = clampByte(mean[c] + axis[c] * tMax);
+        }
+    }
+
+    // Mínimos quadrados: endpoints que melhor reproduzem o bloco com os índices fixos
+    bool refitEndpoints(const Block block, int components, const int indices[16], const float* weights, float e0[4], float e1[4])
+    {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[4] = {}, bx[4] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            float b = weights[indices[i]];
+            float a = 1.0f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < components; ++c)
+            {
+                ax[c] += a * block[i][c];
+                bx[c] += b * block[i][c];
+            }
+        }
+        float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f) return false;
+        for (int c = 0; c < components; ++c)
+        {
+            e0[c] = clampByte((ax[c] * bb - bx[c] * ab) / det);
+            e1[c] = clampByte((bx[c] * aa - ax[c] * ab) / det);
+        }
+        return true;
+    }
+
+    // === BC1 ===
+
+    uint16_t pack565(const float c[4])
+    {
+        int r = int(clampByte(c[0]) * 31.0f / 255.0f + 0.5f);
+        int g = int(clampByte(c[1]) * 63.0f / 255.0f + 0.5f);
+        int b = int(clampByte(c[2]) * 31.0f / 255.0f + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpack565(uint16_t v, int out[3])
+    {
+        int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+        out[0] = (r << 3) | (r >> 2);
+        out[1] = (g << 2) | (g >> 4);
+        out[2] = (b << 3) | (b >> 2);
+    }
+
+    // Paleta como o hardware decodifica: 4 cores se c0 > c1 (ou sempre, no BC3),
+    // senão 3 cores e preto transparente
+    void bc1Palette(uint16_t c0, uint16_t c1, bool fourColors, int palette[4][4])
+    {
+        unpack565(c0, palette[0]);
+        unpack565(c1, palette[1]);
+        palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+        for (int c = 0; c < 3; ++c)
+        {
+            if (fourColors || c0 > c1)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            else
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+        if (!fourColors && c0 <= c1) palette[3][3] = 0;
+    }
+
+    void encodeColorBlock(const Block block, unsigned char out[8])
+    {
+        float mean[4], axis[4], e0[4], e1[4];
+        principalAxis(block, 3, mean, axis);
+        axisEndpoints(block, 3, mean, axis, e0, e1);
+
+        float bestError = std::numeric_limits<float>::max();
+        uint16_t bestC0 = 0, bestC1 = 0;
+        int bestIndices[16] = {};
+        for (int iter = 0; iter < 3; ++iter)
+        {
+            // c0 > c1 seleciona o modo de 4 cores
+            uint16_t c0 = pack565(e0), c1 = pack565(e1);
+            if (c0 < c1)
+            {
+                std::swap(c0, c1);
+                for (int c = 0; c < 4; ++c) std::swap(e0[c], e1[c]);
+            }
+            int palette[4][4];
+            bc1Palette(c0, c1, true, palette);
+
+            // c0 == c1 cairia no modo de 3 cores: todos no índice 0
+            int indices[16];
+            float error = 0.0f;
+            for (int i = 0; i < 16; ++i)
+            {
+                float best = std::numeric_limits<float>::max();
+                indices[i] = 0;
+                for (int k = 0; k < (c0 == c1 ? 1 : 4); ++k)
+                {
+                    float d = 0.0f;
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        float diff = block[i][c] - palette[k][c];
+                        d += diff * diff;
+                    }
+                    if (d < best)
+                    {
+                        best = d;
+                        indices[i] = k;
+                    }
+                }
+                error += best;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                bestC0 = c0;
+                bestC1 = c1;
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+            if (error == 0.0f || !refitEndpoints(block, 3, indices, kBC1Weights, e0, e1)) break;
+        }
+
+        uint32_t bits = 0;
+        for (int i = 0; i < 16; ++i) bits |= uint32_t(bestIndices[i]) << (2 * i);
+        out[0] = static_cast<unsigned char>(bestC0 & 0xFF);
+        out[1] = static_cast<unsigned char>(bestC0 >> 8);
+        out[2] = static_cast<unsigned char>(bestC1 & 0xFF);
+        out[3] = static_cast<unsigned char>(bestC1 >> 8);
+        for (int b = 0; b < 4; ++b) out[4 + b] = static_cast<unsigned char>(bits >> (8 * b));
+    }
+
+    void decodeColorBlock(const unsigned char* in, bool fourColors, unsigned char out[16][4])
+    {
+        uint16_t c0 = static_cast<uint16_t>(in[0] | (in[1] << 8));
+        uint16_t c1 = static_cast<uint16_t>(in[2] | (in[3] << 8));
+        uint32_t bits = in[4] | (in[5] << 8) | (in[6] << 16) | (uint32_t(in[7]) << 24);
+        int palette[4][4];
+        bc1Palette(c0, c1, fourColors, palette);
+        for (int i = 0; i < 16; ++i)
+        {
+            const int* color = palette[(bits >> (2 * i)) & 3];
+            for (int c = 0; c < 4; ++c) out[i][c] = static_cast<unsigned char>(color[c]);
+        }
+    }
+
+    // === BC3 (alfa) ===
+
+    // Paleta de 8 níveis (a0 > a1) ou 6 níveis + 0 e 255 (a0 <= a1)
+    void alphaPalette(int a0, int a1, int palette[8])
+    {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1)
+        {
+            for (int k = 2; k < 8; ++k) palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+        }
+        else
+        {
+            for (int k = 2; k < 6; ++k) palette[k] = ((6 - k) * a0 + (k - 1) * a1) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void encodeAlphaBlock(const Block block, unsigned char out[8])
+    {
+        float aMin = 255.0f, aMax = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            aMin = std::min(aMin, block[i][3]);
+            aMax = std::max(aMax, block[i][3]);
+        }
+        int a0 = int(aMax + 0.5f), a1 = int(aMin + 0.5f);
+        int palette[8];
+        alphaPalette(a0, a1, palette);
+
+        uint64_t bits = 0;
+        if (a0 > a1)
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                int best = 0;
+                float bestDiff = std::numeric_limits<float>::max();
+                for (int k = 0; k < 8; ++k)
+                {
+                    float diff = std::fabs(block[i][3] - palette[k]);
+                    if (diff < bestDiff)
+                    {
+                        bestDiff = diff;
+                        best = k;
+                    }
+                }
+                bits |= uint64_t(best) << (3 * i);
+            }
+        }
+        out[0] = static_cast<unsigned char>(a0);
+        out[1] = static_cast<unsigned char>(a1);
+        for (int b = 0; b < 6; ++b) out[2 + b] = static_cast<unsigned char>(bits >> (8 * b));
+    }
+
+    void decodeAlphaBlock(const unsigned char* in, unsigned char out[16][4])
+    {
+        int palette[8];
+        alphaPalette(in[0], in[1], palette);
+        uint64_t bits = 0;
+        for (int b = 0; b < 6; ++b) bits |= uint64_t(in[2 + b]) << (8 * b);
+        for (int i = 0; i < 16; ++i) out[i][3] = static_cast<unsigned char>(palette[(bits >> (3 * i)) & 7]);
+    }
+
+    // === BC7 (modo 6) ===
+
+    // Bits em ordem crescente, a partir do bit 0 do primeiro byte
+    struct BitWriter
+    {
+        unsigned char* out;
+        int pos = 0;
+
+        void put(uint32_t value, int bits)
+        {
+            for (int i = 0; i < bits; ++i, ++pos)
+            {
+                if ((value >> i) & 1) out[pos >> 3] |= static_cast<unsigned char>(1 << (pos & 7));
+            }
+        }
+    };
+
+    struct BitReader
+    {
+        const unsigned char* in;
+        int pos = 0;
+
+        uint32_t get(int bits)
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < bits; ++i, ++pos) value |= uint32_t((in[pos >> 3] >> (pos & 7)) & 1) << i;
+            return value;
+        }
+    };
+
+    // 7 bits por componente + um bit p compartilhado: o valor final é (q << 1) | p
+    void quantizeBC7Endpoint(const float e[4], int q[4], int& p)
+    {
+        float bestError = std::numeric_limits<float>::max();
+        for (int bit = 0; bit < 2; ++bit)
+        {
+            int candidate[4];
+            float error = 0.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                candidate[c] = std::min(127, std::max(0, int(std::floor((e[c] - bit) / 2.0f + 0.5f))));
+                float diff = e[c] - float((candidate[c] << 1) | bit);
+                error += diff * diff;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                p = bit;
+                memcpy(q, candidate, sizeof(candidate));
+            }
+        }
+    }
+
+    void encodeBC7Block(const Block block, unsigned char out[16])
+    {
+        float weights[16];
+        for (int k = 0; k < 16; ++k) weights[k] = kBC7Weights[k] / 64.0f;
+
+        float mean[4], axis[4], e0[4], e1[4];
+        principalAxis(block, 4, mean, axis);
+        axisEndpoints(block, 4, mean, axis, e0, e1);
+
+        float bestError = std::numeric_limits<float>::max();
+        int bestQ0[4] = {}, bestQ1[4] = {}, bestP0 = 0, bestP1 = 0;
+        int bestIndices[16] = {};
+        for (int iter = 0; iter < 3; ++iter)
+        {
+            int q0[4], q1[4], p0, p1;
+            quantizeBC7Endpoint(e0, q0, p0);
+            quantizeBC7Endpoint(e1, q1, p1);
+            int palette[16][4];
+            for (int c = 0; c < 4; ++c)
+            {
+                int v0 = (q0[c] << 1) | p0, v1 = (q1[c] << 1) | p1;
+                for (int k = 0; k < 16; ++k) palette[k][c] = ((64 - kBC7Weights[k]) * v0 + kBC7Weights[k] * v1 + 32) >> 6;
+            }
+
+            int indices[16];
+            float error = 0.0f;
+            for (int i = 0; i < 16; ++i)
+            {
+                float best = std::numeric_limits<float>::max();
+                indices[i] = 0;
+                for (int k = 0; k < 16; ++k)
+                {
+                    float d = 0.0f;
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        float diff = block[i][c] - palette[k][c];
+                        d += diff * diff;
+                    }
+                    if (d < best)
+                    {
+                        best = d;
+                        indices[i] = k;
+                    }
+                }
+                error += best;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                memcpy(bestQ0, q0, sizeof(q0));
+                memcpy(bestQ1, q1, sizeof(q1));
+                bestP0 = p0;
+                bestP1 = p1;
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+            if (error == 0.0f || !refitEndpoints(block, 4, indices, weights, e0, e1)) break;
+        }
+
+        // O índice do pixel 0 é gravado com 3 bits: o bit alto tem de ser 0.
+        // A paleta é simétrica, então trocar os endpoints e inverter os índices não muda nada.
+        if (bestIndices[0] >= 8)
+        {
+            for (int c = 0; c < 4; ++c) std::swap(bestQ0[c], bestQ1[c]);
+            std::swap(bestP0, bestP1);
+            for (int i = 0; i < 16; ++i) bestIndices[i] = 15 - bestIndices[i];
+        }
+
+        memset(out, 0, 16);
+        BitWriter writer = { out };
+        writer.put(1u << 6, 7);
+        for (int c = 0; c < 4; ++c)
+        {
+            writer.put(bestQ0[c], 7);
+            writer.put(bestQ1[c], 7);
+        }
+        writer.put(bestP0, 1);
+        writer.put(bestP1, 1);
+        writer.put(bestIndices[0], 3);
+        for (int i = 1; i < 16; ++i) writer.put(bestIndices[i], 4);
+    }
+
+    bool decodeBC7Block(const unsigned char* in, unsigned char out[16][4])
+    {
+        BitReader reader = { in };
+        if (reader.get(7) != (1u << 6)) return false;
+        int q0[4], q1[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            q0[c] = reader.get(7);
+            q1[c] = reader.get(7);
+        }
+        int p0 = reader.get(1), p1 = reader.get(1);
+        for (int i = 0; i < 16; ++i)
+        {
+            int k = reader.get(i == 0 ? 3 : 4);
+            for (int c = 0; c < 4; ++c)
+            {
+                int v0 = (q0[c] << 1) | p0, v1 = (q1[c] << 1) | p1;
+                out[i][c] = static_cast<unsigned char>(((64 - kBC7Weights[k]) * v0 + kBC7Weights[k] * v1 + 32) >> 6);
+            }
+        }
+        return true;
+    }
+}
+
+void compressTexture(const unsigned char* pixels, int width, int height, int channels, TextureFormat format,
+                     std::vector<unsigned char>& out)
+{
+    out.assign(textureLevelBytes(format, width, height, channels), 0);
+    if (format == TextureFormat::Raw)
+    {
+        memcpy(out.data(), pixels, out.size());
+        return;
+    }
+
+    size_t blockBytes = format == TextureFormat::BC1 ? 8 : 16;
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    unsigned char* dst = out.data();
+    Block block;
+    for (int by = 0; by < blocksY; ++by)
+    {
+        for (int bx = 0; bx < blocksX; ++bx, dst += blockBytes)
+        {
+            loadBlock(pixels, width, height, channels, bx, by, block);
+            switch (format)
+            {
+            case TextureFormat::BC1:
+                encodeColorBlock(block, dst);
+                break;
+            case TextureFormat::BC3:
+                encodeAlphaBlock(block, dst);
+                encodeColorBlock(block, dst + 8);
+                break;
+            default:
+                encodeBC7Block(block, dst);
+                break;
+            }
+        }
+    }
+}
+
+bool decompressTexture(const unsigned char* blocks, int width, int height, TextureFormat format,
+                       std::vector<unsigned char>& rgba)
+{
+    if (format == TextureFormat::Raw) return false;
+
+    rgba.assign(size_t(width) * height * 4, 0);
+    size_t blockBytes = format == TextureFormat::BC1 ? 8 : 16;
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    const unsigned char* src = blocks;
+    unsigned char texels[16][4];
+    for (int by = 0; by < blocksY; ++by)
+    {
+        for (int bx = 0; bx < blocksX; ++bx, src += blockBytes)
+        {
+            switch (format)
+            {
+            case TextureFormat::BC1:
+                decodeColorBlock(src, false, texels);
+                break;
+            case TextureFormat::BC3:
+                decodeColorBlock(src + 8, true, texels);
+                decodeAlphaBlock(src, texels);
+                break;
+            default:
+                if (!decodeBC7Block(src, texels)) return false;
+                break;
+            }
+
+            // Blocos da borda passam da imagem: só os pixels dentro dela
+            for (int y = 0; y < 4 && by * 4 + y < height; ++y)
+            {
+                for (int x = 0; x < 4 && bx * 4 + x < width; ++x)
+                {
+                    memcpy(&rgba[(size_t(by * 4 + y) * width + bx * 4 + x) * 4], texels[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+    return true;
+}
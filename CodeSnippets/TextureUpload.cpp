@@ -0,0 +1,158 @@
+/*
+ *  Envio dos níveis de um .mips (BakedTexture.h) para a OpenGL.
+ *
+ *  Níveis crus vão com glTexImage2D; níveis BC1/BC3/BC7 vão com
+ *  glCompressedTexImage2D e ficam comprimidos na VRAM (4 a 8 vezes menos
+ *  memória que RGBA). Sem suporte do driver ao formato, cada nível é
+ *  descomprimido para RGBA (TextureCompress.cpp) antes do envio. Em todos os
+ *  casos a cadeia de mipmaps vem pronta do arquivo.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  BakedTexture baked;
+ *  if (loadBakedTexture(path, baked))
+ *  {
+ *      glBindTexture(GL_TEXTURE_2D, texID);
+ *      size_t bytes = uploadBakedLevels(baked);
+ *  }
+ *  // .mips refeito com o mesmo tamanho e formato: reescreve na mesma textura
+ *  updateBakedLevels(baked);
+ */
+
+#include "TextureUpload.h"
+#include "TextureCompress.h"
+
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Constantes das extensões, fora do glad gerado para o núcleo 4.0
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+namespace
+{
+    std::once_flag detectOnce;
+    bool hasS3TC = false;
+    bool hasBPTC = false;
+
+    void detectCompression()
+    {
+        GLint major = 0, minor = 0, count = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        hasBPTC = major > 4 || (major == 4 && minor >= 2);
+
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i)
+        {
+            const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (!name) continue;
+            if (strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) hasS3TC = true;
+            if (strcmp(name, "GL_ARB_texture_compression_bptc") == 0) hasBPTC = true;
+        }
+        if (!hasS3TC) std::cerr << "Driver sem S3TC: texturas BC1/BC3 descomprimidas para RGBA" << std::endl;
+        if (!hasBPTC) std::cerr << "Driver sem BPTC: texturas BC7 descomprimidas para RGBA" << std::endl;
+    }
+
+    GLenum compressedInternalFormat(TextureFormat format)
+    {
+        switch (format)
+        {
+        case TextureFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TextureFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        default: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        }
+    }
+}
+
+bool compressedFormatSupported(TextureFormat format)
+{
+    std::call_once(detectOnce, detectCompression);
+    switch (format)
+    {
+    case TextureFormat::BC1:
+    case TextureFormat::BC3: return hasS3TC;
+    case TextureFormat::BC7: return hasBPTC;
+    default: return false;
+    }
+}
+
+size_t uploadBakedLevels(const BakedTexture& baked)
+{
+    const BakedTextureHeader& header = baked.header;
+    TextureFormat format = baked.format();
+    bool compressed = format != TextureFormat::Raw;
+    bool native = compressed && compressedFormatSupported(format);
+
+    size_t bytes = 0;
+    std::vector<unsigned char> rgba;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (uint32_t level = 0; level < header.levelCount; ++level)
+    {
+        const BakedTextureLevel& mip = header.levels[level];
+        if (native)
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, compressedInternalFormat(format), mip.width, mip.height, 0,
+                                   static_cast<GLsizei>(mip.size), baked.levelData(level));
+            bytes += mip.size;
+        }
+        else if (compressed)
+        {
+            decompressTexture(baked.levelData(level), mip.width, mip.height, format, rgba);
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+            bytes += rgba.size();
+        }
+        else
+        {
+            GLenum pixelFormat = (header.channels == 3) ? GL_RGB : GL_RGBA;
+            glTexImage2D(GL_TEXTURE_2D, level, pixelFormat, mip.width, mip.height, 0, pixelFormat, GL_UNSIGNED_BYTE,
+                         baked.levelData(level));
+            bytes += mip.size;
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header.levelCount - 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return bytes;
+}
+
+void updateBakedLevels(const BakedTexture& baked)
+{
+    const BakedTextureHeader& header = baked.header;
+    TextureFormat format = baked.format();
+    bool compressed = format != TextureFormat::Raw;
+    bool native = compressed && compressedFormatSupported(format);
+
+    std::vector<unsigned char> rgba;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (uint32_t level = 0; level < header.levelCount; ++level)
+    {
+        const BakedTextureLevel& mip = header.levels[level];
+        if (native)
+        {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, compressedInternalFormat(format),
+                                      static_cast<GLsizei>(mip.size), baked.levelData(level));
+        }
+        else if (compressed)
+        {
+            decompressTexture(baked.levelData(level), mip.width, mip.height, format, rgba);
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        }
+        else
+        {
+            GLenum pixelFormat = (header.channels == 3) ? GL_RGB : GL_RGBA;
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, pixelFormat, GL_UNSIGNED_BYTE,
+                            baked.levelData(level));
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
@@ -0,0 +1,206 @@
+/*
+ *  Compactação de vértices para o pipeline Phong (16 bytes por vértice).
+ *
+ *  O vertex shader recebe os atributos normalizados pela própria OpenGL
+ *  (UNORM16/SNORM16 viram floats em [0, 1] / [-1, 1]) e só precisa:
+ *   - posição: positionOffset + position * positionScale (uniforms)
+ *   - normal:  octDecode(normal.xy), mesma fórmula de octDecode abaixo
+ *
+ *  Forma de uso
+ *  -----------------
+ *  QuantizedMesh packed;
+ *  quantizeVertices(mesh.vertices, mesh.header.vertexCount, mesh.boundsMin(), mesh.boundsMax(), packed);
+ *  glBufferData(GL_ARRAY_BUFFER, packed.bytes(), packed.vertices.data(), GL_STATIC_DRAW);
+ *  glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, position));
+ *  glVertexAttribPointer(1, 2, packed.halfUVs ? GL_HALF_FLOAT : GL_UNSIGNED_SHORT, !packed.halfUVs, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, uv));
+ *  glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, normal));
+ */
+
+#include "VertexQuantize.h"
+#include "ObjLoader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    inline uint16_t toUnorm16(float v)
+    {
+        return static_cast<uint16_t>(std::lround(std::min(std::max(v, 0.0f), 1.0f) * 65535.0f));
+    }
+
+    inline int16_t toSnorm16(float v)
+    {
+        return static_cast<int16_t>(std::lround(std::min(std::max(v, -1.0f), 1.0f) * 32767.0f));
+    }
+
+    inline float fromUnorm16(uint16_t v) { return v / 65535.0f; }
+
+    // Regra da OpenGL 4.2+ para SNORM: -32768 e -32767 valem -1
+    inline float fromSnorm16(int16_t v) { return std::max(v / 32767.0f, -1.0f); }
+
+    inline float signNotZero(float v) { return v >= 0.0f ? 1.0f : -1.0f; }
+}
+
+glm::vec2 octEncode(const glm::vec3& n)
+{
+    float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+    if (l1 == 0.0f) return glm::vec2(0.0f);
+    glm::vec2 e(n.x / l1, n.y / l1);
+    if (n.z < 0.0f)
+    {
+        // Hemisfério de baixo dobrado sobre os cantos do quadrado
+        e = glm::vec2((1.0f - std::fabs(e.y)) * signNotZero(e.x), (1.0f - std::fabs(e.x)) * signNotZero(e.y));
+    }
+    return e;
+}
+
+glm::vec3 octDecode(const glm::vec2& e)
+{
+    glm::vec3 n(e.x, e.y, 1.0f - std::fabs(e.x) - std::fabs(e.y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t exponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (exponent == 0xFFu) return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+
+    int halfExponent = static_cast<int>(exponent) - 127 + 15;
+    if (halfExponent >= 0x1F) return static_cast<uint16_t>(sign | 0x7C00u);
+    if (halfExponent <= 0)
+    {
+        // Subnormal (ou zero) em half
+        if (halfExponent < -10) return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1u);
+        uint32_t halfway = 1u << (shift - 1u);
+        if (rest > halfway || (rest == halfway && (half & 1u))) ++half;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFFu;
+    // Arredonda para o par mais próximo; o carry pode subir para o expoente (e virar infinito)
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) ++half;
+    return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t value)
+{
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+    uint32_t bits;
+
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // Subnormal: normaliza para o formato de 32 bits
+            int e = -1;
+            do { ++e; mantissa <<= 1; } while ((mantissa & 0x400u) == 0);
+            bits = sign | (static_cast<uint32_t>(127 - 15 - e) << 23) | ((mantissa & 0x3FFu) << 13);
+        }
+    }
+    else if (exponent == 0x1F)
+    {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+void quantizeVertices(const float* vertices, size_t vertexCount,
+                      const glm::vec3& boundsMin, const glm::vec3& boundsMax, QuantizedMesh& out)
+{
+    out.positionOffset = boundsMin;
+    out.positionScale = boundsMax - boundsMin;
+    // Eixo achatado (ex.: plano): evita divisão por zero, todos os valores viram 0
+    glm::vec3 inverseScale;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        inverseScale[axis] = out.positionScale[axis] > 0.0f ? 1.0f / out.positionScale[axis] : 0.0f;
+    }
+
+    out.halfUVs = false;
+    for (size_t i = 0; i < vertexCount && !out.halfUVs; ++i)
+    {
+        const float* v = vertices + i * kObjFloatsPerVertex;
+        out.halfUVs = v[3] < 0.0f || v[3] > 1.0f || v[4] < 0.0f || v[4] > 1.0f;
+    }
+
+    out.vertices.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const float* v = vertices + i * kObjFloatsPerVertex;
+        PackedVertex& p = out.vertices[i];
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            p.position[axis] = toUnorm16((v[axis] - boundsMin[axis]) * inverseScale[axis]);
+        }
+        p.position[3] = 0;
+
+        for (int c = 0; c < 2; ++c)
+        {
+            p.uv[c] = out.halfUVs ? floatToHalf(v[3 + c]) : toUnorm16(v[3 + c]);
+        }
+
+        glm::vec2 oct = octEncode(glm::vec3(v[5], v[6], v[7]));
+        p.normal[0] = toSnorm16(oct.x);
+        p.normal[1] = toSnorm16(oct.y);
+    }
+}
+
+QuantizationError measureQuantizationError(const float* vertices, size_t vertexCount, const QuantizedMesh& mesh)
+{
+    QuantizationError error;
+    for (size_t i = 0; i < vertexCount && i < mesh.vertices.size(); ++i)
+    {
+        const float* v = vertices + i * kObjFloatsPerVertex;
+        const PackedVertex& p = mesh.vertices[i];
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float decoded = mesh.positionOffset[axis] + fromUnorm16(p.position[axis]) * mesh.positionScale[axis];
+            error.position = std::max(error.position, std::fabs(decoded - v[axis]));
+        }
+
+        for (int c = 0; c < 2; ++c)
+        {
+            float decoded = mesh.halfUVs ? halfToFloat(p.uv[c]) : fromUnorm16(p.uv[c]);
+            error.uv = std::max(error.uv, std::fabs(decoded - v[3 + c]));
+        }
+
+        glm::vec3 original(v[5], v[6], v[7]);
+        if (glm::length(original) > 0.0f)
+        {
+            glm::vec3 decoded = octDecode(glm::vec2(fromSnorm16(p.normal[0]), fromSnorm16(p.normal[1])));
+            float cosine = std::min(std::max(glm::dot(glm::normalize(original), decoded), -1.0f), 1.0f);
+            error.normalDegrees = std::max(error.normalDegrees, glm::degrees(std::acos(cosine)));
+        }
+    }
+    return error;
+}
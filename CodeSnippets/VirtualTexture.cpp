@@ -0,0 +1,472 @@
+/*
+ *  Texturas virtuais com páginas carregadas sob demanda.
+ *
+ *  Em vez da imagem inteira com todos os mipmaps, a VRAM guarda:
+ *   - um cache físico de tamanho fixo (physicalTiles^2 vagas de
+ *     tileSize + 2 * borda texels), onde ficam as páginas visíveis;
+ *   - a tabela de páginas, uma textura RGBA8UI com um texel por página e
+ *     um nível por nível de mipmap da imagem: vaga no cache e nível da página
+ *     que está lá (a própria ou o ancestral residente mais próximo, então o
+ *     shader sempre tem algo para amostrar, só mais borrado).
+ *  A página do último nível (a imagem inteira numa página) é lida na abertura
+ *  e nunca sai do cache.
+ *
+ *  A cada quadro o passe de feedback (VirtualTextureFeedback) diz quais
+ *  páginas apareceram na tela; as que faltam são copiadas do .vtex mapeado
+ *  por tarefas no pool de threads (é lá que a leitura do disco acontece), e
+ *  o update() envia as que chegaram, despejando as vagas usadas há mais tempo.
+ *  Só os retângulos da tabela afetados por páginas que entraram ou saíram
+ *  são reenviados.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  VirtualTexture vt(pool, 8);
+ *  vt.open("Terreno.png");                    // precisa do Terreno.png.vtex (objbake --virtual)
+ *  VirtualTextureFeedback feedback(8);
+ *  while (...)
+ *  {
+ *      feedback.resolve({ &vt });             // pedidos do quadro anterior
+ *      vt.update();
+ *      ... desenha com vt.pageTable() / vt.physical() / sizeInfo() / physicalInfo()
+ *      feedback.begin(width, height);
+ *      ... desenha os objetos com o shader de feedback
+ *      feedback.end();
+ *  }
+ */
+
+#include "VirtualTexture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    // Leituras simultâneas no pool, para não encher a fila dos outros assets
+    const size_t kMaxInFlight = 32;
+
+    uint64_t tileKey(uint32_t level, uint32_t x, uint32_t y)
+    {
+        return (uint64_t(level) << 48) | (uint64_t(y) << 24) | uint64_t(x);
+    }
+
+    uint32_t keyLevel(uint64_t key) { return uint32_t(key >> 48) & 0xFF; }
+    uint32_t keyY(uint64_t key) { return uint32_t(key >> 24) & 0xFFFFFF; }
+    uint32_t keyX(uint64_t key) { return uint32_t(key) & 0xFFFFFF; }
+
+    uint32_t nextPowerOfTwo(uint32_t value)
+    {
+        uint32_t power = 1;
+        while (power < value) power <<= 1;
+        return power;
+    }
+}
+
+VirtualTexture::VirtualTexture(ThreadPool& pool, int physicalTiles)
+    : pool(pool), slotsPerSide(std::max(2, physicalTiles))
+{
+}
+
+VirtualTexture::~VirtualTexture()
+{
+    // As tarefas leem do arquivo mapeado
+    for (Load& load : loading) load.pixels.wait();
+    if (pageTableID) glDeleteTextures(1, &pageTableID);
+    if (physicalID) glDeleteTextures(1, &physicalID);
+}
+
+bool VirtualTexture::open(const std::string& path)
+{
+    imagePath = path;
+    if (!loadVirtualTextureFile(path, file))
+    {
+        std::cerr << "Textura virtual sem .vtex atualizado: " << path << std::endl;
+        return false;
+    }
+    const VirtualTextureHeader& h = file.header;
+    slots.assign(size_t(slotsPerSide) * slotsPerSide, Slot());
+
+    int side = slotsPerSide * int(file.slotSize());
+    glGenTextures(1, &physicalID);
+    glBindTexture(GL_TEXTURE_2D, physicalID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, side, side, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    // Base em potência de 2 para a cadeia da OpenGL cobrir as páginas de todos os níveis
+    uint32_t baseWidth = nextPowerOfTwo(h.levels[0].tilesX);
+    uint32_t baseHeight = nextPowerOfTwo(h.levels[0].tilesY);
+    pageEntries.resize(h.levelCount);
+    dirty.resize(h.levelCount);
+    glGenTextures(1, &pageTableID);
+    glBindTexture(GL_TEXTURE_2D, pageTableID);
+    for (uint32_t level = 0; level < h.levelCount; ++level)
+    {
+        int width = int(std::max(1u, baseWidth >> level));
+        int height = int(std::max(1u, baseHeight >> level));
+        pageEntries[level].assign(size_t(width) * height * 4, 0);
+        dirty[level] = glm::ivec4(0, 0, width, height);
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8UI, width, height, 0, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, nullptr);
+    }
+    // Texturas inteiras só são completas com filtro NEAREST; o shader usa texelFetch
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(h.levelCount) - 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Página de fallback, fixa
+    uint32_t last = h.levelCount - 1;
+    uploadTile(0, tileKey(last, 0, 0), file.tileData(last, 0, 0));
+    slots[0].pinned = true;
+    refreshPageTable();
+
+    counters.capacity = slots.size();
+    counters.physicalBytes = size_t(side) * side * 4;
+    counters.pageTableBytes = 0;
+    for (const std::vector<unsigned char>& level : pageEntries) counters.pageTableBytes += level.size();
+    counters.virtualBytes = 0;
+    for (uint32_t level = 0; level < h.levelCount; ++level)
+    {
+        counters.virtualBytes += uint64_t(h.levels[level].width) * h.levels[level].height * 4;
+    }
+    return true;
+}
+
+void VirtualTexture::request(uint32_t level, uint32_t x, uint32_t y)
+{
+    const VirtualTextureHeader& h = file.header;
+    if (level >= h.levelCount) return;
+    // A última página de cada eixo pode ser pedida um pouco além da borda (arredondamento dos níveis ímpares)
+    x = std::min(x, h.levels[level].tilesX - 1);
+    y = std::min(y, h.levels[level].tilesY - 1);
+
+    // Os ancestrais são o fallback enquanto a página não chega: também ficam em uso
+    for (;;)
+    {
+        if (!requests.insert(tileKey(level, x, y)).second) return;
+        if (level + 1 >= h.levelCount) return;
+        ++level;
+        x = std::min(x >> 1, h.levels[level].tilesX - 1);
+        y = std::min(y >> 1, h.levels[level].tilesY - 1);
+    }
+}
+
+int VirtualTexture::findSlot()
+{
+    int victim = -1;
+    for (int i = 0; i < (int)slots.size(); ++i)
+    {
+        const Slot& slot = slots[i];
+        if (!slot.used) return i;
+        // Não despeja o que o quadro atual está usando
+        if (slot.pinned || slot.lastUsed >= frame) continue;
+        if (victim < 0 || slot.lastUsed < slots[victim].lastUsed) victim = i;
+    }
+    if (victim < 0) return -1;
+
+    uint64_t old = slots[victim].key;
+    residentSlots.erase(old);
+    markDirty(keyLevel(old), keyX(old), keyY(old));
+    slots[victim].used = false;
+    ++counters.evictions;
+    return victim;
+}
+
+void VirtualTexture::uploadTile(int slot, uint64_t key, const unsigned char* pixels)
+{
+    int slotSize = int(file.slotSize());
+    glBindTexture(GL_TEXTURE_2D, physicalID);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, (slot % slotsPerSide) * slotSize, (slot / slotsPerSide) * slotSize, slotSize,
+                    slotSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    slots[slot].key = key;
+    slots[slot].used = true;
+    slots[slot].lastUsed = frame;
+    residentSlots[key] = slot;
+    markDirty(keyLevel(key), keyX(key), keyY(key));
+    ++counters.uploads;
+}
+
+// Entradas que podem apontar para esta página: ela mesma e todos os descendentes
+void VirtualTexture::markDirty(uint32_t level, uint32_t x, uint32_t y)
+{
+    for (int l = int(level); l >= 0; --l)
+    {
+        int shift = int(level) - l;
+        glm::ivec4& rect = dirty[l];
+        int width = int(std::max(1u, nextPowerOfTwo(file.header.levels[0].tilesX) >> l));
+        int height = int(std::max(1u, nextPowerOfTwo(file.header.levels[0].tilesY) >> l));
+        glm::ivec4 area(int(x) << shift, int(y) << shift, std::min(width, int(x + 1) << shift), std::min(height, int(y + 1) << shift));
+        if (area.x >= area.z || area.y >= area.w) continue;
+        if (rect.x >= rect.z) rect = area;
+        else rect = glm::ivec4(std::min(rect.x, area.x), std::min(rect.y, area.y), std::max(rect.z, area.z), std::max(rect.w, area.w));
+    }
+}
+
+void VirtualTexture::refreshPageTable()
+{
+    const VirtualTextureHeader& h = file.header;
+    uint32_t baseWidth = nextPowerOfTwo(h.levels[0].tilesX);
+    uint32_t baseHeight = nextPowerOfTwo(h.levels[0].tilesY);
+    std::vector<unsigned char> staging;
+    glBindTexture(GL_TEXTURE_2D, pageTableID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // Do mais grosso para o mais fino: cada entrada sem página herda a do pai, já atualizada
+    for (int level = int(h.levelCount) - 1; level >= 0; --level)
+    {
+        glm::ivec4& rect = dirty[level];
+        if (rect.x >= rect.z || rect.y >= rect.w) continue;
+
+        int width = int(std::max(1u, baseWidth >> level));
+        int parentWidth = int(std::max(1u, baseWidth >> (level + 1)));
+        int parentHeight = int(std::max(1u, baseHeight >> (level + 1)));
+        std::vector<unsigned char>& entries = pageEntries[level];
+        staging.resize(size_t(rect.z - rect.x) * (rect.w - rect.y) * 4);
+        for (int y = rect.y; y < rect.w; ++y)
+        {
+            for (int x = rect.x; x < rect.z; ++x)
+            {
+                unsigned char* entry = &entries[(size_t(y) * width + x) * 4];
+                bool inside = uint32_t(x) < h.levels[level].tilesX && uint32_t(y) < h.levels[level].tilesY;
+                auto found = inside ? residentSlots.find(tileKey(level, x, y)) : residentSlots.end();
+                if (found != residentSlots.end())
+                {
+                    entry[0] = (unsigned char)(found->second % slotsPerSide);
+                    entry[1] = (unsigned char)(found->second / slotsPerSide);
+                    entry[2] = (unsigned char)level;
+                    entry[3] = 255;
+                }
+                else if (level + 1 < int(h.levelCount))
+                {
+                    int px = std::min(x >> 1, parentWidth - 1);
+                    int py = std::min(y >> 1, parentHeight - 1);
+                    std::copy_n(&pageEntries[level + 1][(size_t(py) * parentWidth + px) * 4], 4, entry);
+                }
+                else
+                {
+                    // Último nível, fora da única página: aponta para ela (vaga fixa 0)
+                    entry[0] = entry[1] = 0;
+                    entry[2] = (unsigned char)level;
+                    entry[3] = 255;
+                }
+                std::copy_n(entry, 4, &staging[(size_t(y - rect.y) * (rect.z - rect.x) + (x - rect.x)) * 4]);
+            }
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, level, rect.x, rect.y, rect.z - rect.x, rect.w - rect.y, GL_RGBA_INTEGER,
+                        GL_UNSIGNED_BYTE, staging.data());
+        rect = glm::ivec4(0);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void VirtualTexture::update(int uploadBudget)
+{
+    if (!physicalID) return;
+    ++frame;
+    counters.requested = requests.size();
+
+    // Marca o uso das residentes e separa as que faltam, mais grossas primeiro
+    std::vector<uint64_t> missing;
+    for (uint64_t key : requests)
+    {
+        auto found = residentSlots.find(key);
+        if (found != residentSlots.end()) slots[found->second].lastUsed = frame;
+        else if (!loadingKeys.count(key)) missing.push_back(key);
+    }
+    requests.clear();
+    std::sort(missing.begin(), missing.end(), [](uint64_t a, uint64_t b) { return keyLevel(a) > keyLevel(b); });
+
+    for (uint64_t key : missing)
+    {
+        if (loading.size() >= kMaxInFlight) break;
+        const unsigned char* source = file.tileData(keyLevel(key), keyX(key), keyY(key));
+        size_t bytes = file.tileBytes();
+        loading.push_back({ key, pool.submit([source, bytes]() { return std::vector<unsigned char>(source, source + bytes); }) });
+        loadingKeys.insert(key);
+        ++counters.loads;
+    }
+
+    // Páginas que já chegaram, até o limite de envios do quadro
+    int uploads = 0;
+    for (size_t i = 0; i < loading.size() && uploads < uploadBudget;)
+    {
+        if (loading[i].pixels.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++i;
+            continue;
+        }
+        uint64_t key = loading[i].key;
+        std::vector<unsigned char> pixels = loading[i].pixels.get();
+        loading.erase(loading.begin() + i);
+        loadingKeys.erase(key);
+
+        int slot = findSlot();
+        if (slot < 0)
+        {
+            ++counters.dropped;
+            continue;
+        }
+        uploadTile(slot, key, pixels.data());
+        ++uploads;
+    }
+
+    refreshPageTable();
+    counters.pending = loading.size();
+    counters.resident = residentSlots.size();
+}
+
+glm::vec4 VirtualTexture::sizeInfo() const
+{
+    const VirtualTextureHeader& h = file.header;
+    return glm::vec4(float(h.width), float(h.height), float(h.tileSize), float(h.levelCount - 1));
+}
+
+glm::vec4 VirtualTexture::physicalInfo() const
+{
+    float slotSize = float(file.slotSize());
+    return glm::vec4(slotSize, float(file.header.border), slotSize * slotsPerSide, 0.0f);
+}
+
+VirtualTextureStats VirtualTexture::stats() const
+{
+    return counters;
+}
+
+VirtualTextureFeedback::VirtualTextureFeedback(int divisor)
+    : divisor(std::max(1, divisor))
+{
+}
+
+VirtualTextureFeedback::~VirtualTextureFeedback()
+{
+    destroy();
+}
+
+void VirtualTextureFeedback::create(int newWidth, int newHeight)
+{
+    windowWidth = newWidth;
+    windowHeight = newHeight;
+    width = std::max(1, newWidth / divisor);
+    height = std::max(1, newHeight / divisor);
+
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA16UI, width, height);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "Framebuffer de feedback incompleto" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenBuffers(2, pbo);
+    for (GLuint buffer : pbo)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size_t(width) * height * 4 * sizeof(GLushort), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void VirtualTextureFeedback::destroy()
+{
+    for (GLsync& fence : fences)
+    {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    if (color) glDeleteRenderbuffers(1, &color);
+    if (depth) glDeleteRenderbuffers(1, &depth);
+    if (pbo[0]) glDeleteBuffers(2, pbo);
+    fbo = color = depth = pbo[0] = pbo[1] = 0;
+}
+
+void VirtualTextureFeedback::begin(int newWidth, int newHeight)
+{
+    if (newWidth != windowWidth || newHeight != windowHeight)
+    {
+        destroy();
+        create(newWidth, newHeight);
+    }
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+    // 0 no canal do id = nenhum pedido
+    const GLuint none[4] = { 0, 0, 0, 0 };
+    const GLfloat far = 1.0f;
+    glClearBufferuiv(GL_COLOR, 0, none);
+    glClearBufferfv(GL_DEPTH, 0, &far);
+}
+
+void VirtualTextureFeedback::end()
+{
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[current]);
+    glReadPixels(0, 0, width, height, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (fences[current]) glDeleteSync(fences[current]);
+    fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    current ^= 1;
+}
+
+size_t VirtualTextureFeedback::resolve(const std::vector<VirtualTexture*>& textures)
+{
+    // Leitura do quadro anterior; se a GPU ainda não chegou lá, fica para depois
+    int previous = current ^ 1;
+    GLsync fence = fences[previous];
+    if (!fence) return 0;
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return 0;
+    glDeleteSync(fence);
+    fences[previous] = nullptr;
+
+    size_t count = size_t(width) * height;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[previous]);
+    const GLushort* texels = static_cast<const GLushort*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, count * 4 * sizeof(GLushort), GL_MAP_READ_BIT));
+    size_t requests = 0;
+    unique.clear();
+    if (texels)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const GLushort* t = &texels[i * 4];
+            if (t[3] == 0 || t[3] > textures.size() || !textures[t[3] - 1]) continue;
+            ++requests;
+            unique.push_back((uint64_t(t[3] - 1) << 56) | (uint64_t(t[2]) << 48) | (uint64_t(t[1]) << 24) | t[0]);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+    for (uint64_t key : unique)
+    {
+        textures[key >> 56]->request(uint32_t(key >> 48) & 0xFF, uint32_t(key) & 0xFFFFFF, uint32_t(key >> 24) & 0xFFFFFF);
+    }
+    return requests;
+}
+
+float VirtualTextureFeedback::lodBias() const
+{
+    return -std::log2(float(divisor));
+}
@@ -0,0 +1,187 @@
+/*
+ *  Texturas virtuais pré-cortadas em páginas (.vtex), geradas pelo objbake
+ *  para imagens grandes demais para ficar inteiras na VRAM.
+ *
+ *  Cada nível de mipmap vira uma grade de páginas de kVirtualTileSize texels
+ *  úteis mais kVirtualTileBorder texels de borda copiados das páginas
+ *  vizinhas, sempre RGBA. As páginas ficam em sequência no arquivo, então a
+ *  página (nível, x, y) está num deslocamento calculado direto do cabeçalho:
+ *  o carregador em tempo de execução (VirtualTexture.cpp) só mapeia o arquivo
+ *  e copia as páginas que o passe de feedback pediu.
+ *
+ *  Forma de uso
+ *  -----------------
+ *  // offline (objbake --virtual 4096)
+ *  writeVirtualTexture("Terreno.png", channels, levels);
+ *  // em tempo de execução
+ *  VirtualTextureFile vt;
+ *  if (loadVirtualTextureFile("Terreno.png", vt))
+ *      const unsigned char* page = vt.tileData(nivel, x, y);   // tileBytes() bytes RGBA
+ */
+
+#include "VirtualTextureFile.h"
+#include "FileStamp.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+static_assert(std::is_trivially_copyable<VirtualTextureHeader>::value, "VirtualTextureHeader precisa ser POD");
+
+namespace
+{
+    const char kMagic[4] = { 'V', 'T', 'E', 'X' };
+
+    inline size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Cabeçalho coerente com o tamanho do arquivo?
+    bool validLayout(const char* data, size_t size, VirtualTextureHeader& h)
+    {
+        if (size < sizeof(VirtualTextureHeader)) return false;
+        memcpy(&h, data, sizeof(h));
+        if (memcmp(h.magic, kMagic, 4) != 0 || h.version != kVirtualTextureVersion) return false;
+        if (h.tileSize == 0 || h.levelCount == 0 || h.levelCount > kVirtualTextureMaxLevels) return false;
+        size_t tileBytes = size_t(h.tileSize + 2 * h.border) * (h.tileSize + 2 * h.border) * 4;
+        for (uint32_t i = 0; i < h.levelCount; ++i)
+        {
+            const VirtualTextureLevel& level = h.levels[i];
+            if (level.tilesX != (level.width + h.tileSize - 1) / h.tileSize) return false;
+            if (level.tilesY != (level.height + h.tileSize - 1) / h.tileSize) return false;
+            if (level.offset + size_t(level.tilesX) * level.tilesY * tileBytes > size) return false;
+        }
+        // O último nível é a página sempre residente
+        const VirtualTextureLevel& last = h.levels[h.levelCount - 1];
+        return last.tilesX == 1 && last.tilesY == 1;
+    }
+}
+
+std::string virtualTexturePath(const std::string& imagePath)
+{
+    return imagePath + ".vtex";
+}
+
+bool loadVirtualTextureFile(const std::string& imagePath, VirtualTextureFile& out)
+{
+    std::string path = virtualTexturePath(imagePath);
+    if (!out.file.open(path, true)) return false;
+
+    VirtualTextureHeader h;
+    bool touched = false;
+    if (!validLayout(out.file.data, out.file.size, h) ||
+        !fileMatchesStamp(imagePath, h.srcSize, h.srcMtime, h.srcHash, touched))
+    {
+        out.file.close();
+        return false;
+    }
+
+    if (touched)
+    {
+        // Conteúdo igual com data nova: regrava só o cabeçalho
+        out.file.close();
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        file.close();
+        if (!out.file.open(path, true) || !validLayout(out.file.data, out.file.size, h))
+        {
+            out.file.close();
+            return false;
+        }
+    }
+
+    out.header = h;
+    return true;
+}
+
+bool writeVirtualTexture(const std::string& imagePath, int channels, const std::vector<MipLevel>& levels,
+                         uint32_t tileSize, uint32_t border)
+{
+    if (levels.empty() || tileSize == 0) return false;
+
+    VirtualTextureHeader h = {};
+    memcpy(h.magic, kMagic, 4);
+    h.version = kVirtualTextureVersion;
+    FileStamp src = fileStampOf(imagePath);
+    h.srcSize = src.size;
+    h.srcMtime = src.mtime;
+    h.srcHash = hashFileContents(imagePath);
+    h.width = static_cast<uint32_t>(levels[0].width);
+    h.height = static_cast<uint32_t>(levels[0].height);
+    h.tileSize = tileSize;
+    h.border = border;
+
+    uint32_t slot = tileSize + 2 * border;
+    size_t tileBytes = size_t(slot) * slot * 4;
+    size_t offset = alignUp(sizeof(VirtualTextureHeader), 16);
+    for (size_t i = 0; i < levels.size() && i < kVirtualTextureMaxLevels; ++i)
+    {
+        VirtualTextureLevel& level = h.levels[i];
+        level.width = static_cast<uint32_t>(levels[i].width);
+        level.height = static_cast<uint32_t>(levels[i].height);
+        level.tilesX = (level.width + tileSize - 1) / tileSize;
+        level.tilesY = (level.height + tileSize - 1) / tileSize;
+        level.offset = offset;
+        offset += size_t(level.tilesX) * level.tilesY * tileBytes;
+        ++h.levelCount;
+        if (level.tilesX == 1 && level.tilesY == 1) break;
+    }
+    const VirtualTextureLevel& last = h.levels[h.levelCount - 1];
+    if (last.tilesX != 1 || last.tilesY != 1) return false;
+
+    // Página a página direto no arquivo: a imagem inteira cortada não precisa caber na memória
+    std::string path = virtualTexturePath(imagePath);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        std::vector<char> header(alignUp(sizeof(VirtualTextureHeader), 16), 0);
+        memcpy(header.data(), &h, sizeof(h));
+        file.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+        std::vector<unsigned char> tile(tileBytes);
+        for (uint32_t i = 0; i < h.levelCount; ++i)
+        {
+            const MipLevel& mip = levels[i];
+            const VirtualTextureLevel& level = h.levels[i];
+            for (uint32_t ty = 0; ty < level.tilesY; ++ty)
+            {
+                for (uint32_t tx = 0; tx < level.tilesX; ++tx)
+                {
+                    // Borda e sobra da última página repetem a imagem, como o GL_REPEAT
+                    for (uint32_t y = 0; y < slot; ++y)
+                    {
+                        int sy = int(ty * tileSize + y) - int(border);
+                        sy = ((sy % mip.height) + mip.height) % mip.height;
+                        for (uint32_t x = 0; x < slot; ++x)
+                        {
+                            int sx = int(tx * tileSize + x) - int(border);
+                            sx = ((sx % mip.width) + mip.width) % mip.width;
+                            const unsigned char* p = &mip.pixels[(size_t(sy) * mip.width + sx) * channels];
+                            unsigned char* d = &tile[(size_t(y) * slot + x) * 4];
+                            d[0] = p[0];
+                            d[1] = p[1];
+                            d[2] = p[2];
+                            d[3] = channels == 4 ? p[3] : 255;
+                        }
+                    }
+                    file.write(reinterpret_cast<const char*>(tile.data()), static_cast<std::streamsize>(tile.size()));
+                }
+            }
+        }
+        if (!file) return false;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    if (ec)
+    {
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,97 @@
+// AssetLoader.h
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "ThreadPool.h"
+
+enum class AssetState
+{
+    Loading,
+    Ready,
+    Failed
+};
+
+using AssetHandle = uint32_t;
+
+// Etapas de um asset, cada uma na sua thread:
+//  decode: pool de threads, sem OpenGL (ler .obj/.meshcache, decodificar PNG...)
+//  upload: thread com o contexto compartilhado (glBufferData, glTexImage2D...)
+//  finish: thread principal, depois que a fence do upload sinalizou; cria o que
+//          não é compartilhado entre contextos (VAOs) e publica o asset na cena
+// Qualquer etapa pode ser vazia; decode/upload devolvem false em caso de erro.
+struct AssetJob
+{
+    std::string name;
+    std::function<bool()> decode;
+    std::function<bool()> upload;
+    std::function<void()> finish;
+};
+
+class AssetLoader
+{
+public:
+    // Cria uma janela invisível com contexto compartilhado com mainWindow (na
+    // thread principal, como o GLFW exige) e a thread que faz os uploads nela.
+    // Sem contexto compartilhado, os uploads rodam no poll() da thread principal.
+    explicit AssetLoader(GLFWwindow* mainWindow, unsigned decodeThreads = 0);
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Volta na hora; o asset fica Ready quando o finish rodar em algum poll()
+    AssetHandle submit(AssetJob job);
+
+    // Uma vez por quadro, na thread principal
+    void poll();
+
+    AssetState state(AssetHandle handle) const;
+    // Tempo do submit até ficar pronto (ou falhar), em ms
+    double elapsedMs(AssetHandle handle) const;
+    // Assets ainda carregando
+    size_t pending() const;
+    bool sharedContext() const { return uploadWindow != nullptr; }
+    // Pool dos decodes, para dividir um decode grande por dentro (parallelFor aninhado)
+    ThreadPool& pool() { return *decodePool; }
+
+private:
+    struct Entry
+    {
+        AssetJob job;
+        AssetState state = AssetState::Loading;
+        GLsync fence = nullptr;
+        std::chrono::steady_clock::time_point submitted;
+        std::chrono::steady_clock::time_point done;
+    };
+
+    void decodeEntry(Entry* entry);
+    void uploadEntry(Entry* entry);
+    void uploadLoop();
+    void fail(Entry* entry, const char* stage);
+
+    GLFWwindow* uploadWindow = nullptr;
+    std::unique_ptr<ThreadPool> decodePool;
+    std::thread uploadThread;
+
+    mutable std::mutex mutex;
+    std::condition_variable uploadReady;
+    bool stopping = false;
+    std::deque<std::unique_ptr<Entry>> entries;
+    std::deque<Entry*> uploadQueue;
+    std::vector<Entry*> fenced;
+};
+
+#endif
@@ -0,0 +1,108 @@
+// BakedTexture.h
+#ifndef BAKED_TEXTURE_H
+#define BAKED_TEXTURE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+class ThreadPool;
+
+// Mude ao alterar o layout do arquivo: texturas antigas são ignoradas
+const uint32_t kBakedTextureVersion = 2;
+const uint32_t kBakedTextureMaxLevels = 16;
+
+// Formato dos níveis: pixels crus (RGB/RGBA) ou blocos 4x4 comprimidos (TextureCompress.h)
+enum class TextureFormat : uint32_t
+{
+    Raw = 0,
+    BC1 = 1,
+    BC3 = 3,
+    BC7 = 7
+};
+
+struct BakedTextureLevel
+{
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+// Cabeçalho do .mips: imagem já decodificada (ou já em BCn) com toda a cadeia
+// de mipmaps, níveis em sequência, cada um alinhado em 16 bytes.
+struct BakedTextureHeader
+{
+    char magic[4];
+    uint32_t version;
+
+    // Chave da imagem de origem: tamanho, data de modificação e hash FNV-1a
+    uint64_t srcSize;
+    int64_t srcMtime;
+    uint64_t srcHash;
+
+    // Canais da imagem de origem (3 ou 4)
+    uint32_t channels;
+    uint32_t levelCount;
+    uint32_t format;
+    uint32_t reserved;
+    BakedTextureLevel levels[kBakedTextureMaxLevels];
+};
+
+// Nível de mipmap em memória, durante o bake.
+// pixels fica no formato passado a writeBakedTexture (crus ou blocos BCn).
+struct MipLevel
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+// Textura pronta para glTexImage2D nível a nível, lida do arquivo mapeado
+struct BakedTexture
+{
+    BakedTextureHeader header = {};
+    MappedFile file;
+
+    const unsigned char* levelData(uint32_t level) const
+    {
+        return reinterpret_cast<const unsigned char*>(file.data + header.levels[level].offset);
+    }
+
+    TextureFormat format() const { return static_cast<TextureFormat>(header.format); }
+};
+
+// Bytes de um nível: width * height * channels crus, ou blocos 4x4 de
+// 8 bytes (BC1) / 16 bytes (BC3, BC7) arredondando as bordas para cima
+size_t textureLevelBytes(TextureFormat format, uint32_t width, uint32_t height, uint32_t channels);
+
+const char* textureFormatName(TextureFormat format);
+
+// Caminho do bake ao lado da imagem ("Cube.png" -> "Cube.png.mips")
+std::string bakedTexturePath(const std::string& imagePath);
+
+// Mapeia o .mips da imagem. Falha (sem mensagem) se não existir, se a versão
+// for outra ou se a imagem mudou desde o bake; aí o chamador decodifica a imagem.
+bool loadBakedTexture(const std::string& imagePath, BakedTexture& out);
+
+// Filtro de redução dos mipmaps: caixa 2x2 ou Kaiser (sinc janelada, 6 taps por eixo,
+// mais nítido e com menos aliasing em texturas com detalhe fino)
+enum class MipFilter
+{
+    Box,
+    Kaiser
+};
+
+// Cadeia completa de mipmaps até 1x1; o nível 0 é a própria imagem.
+// Com pool, as linhas de cada nível grande são divididas entre as threads
+// (pode ser chamada de dentro de uma tarefa do mesmo pool).
+void generateMips(const unsigned char* pixels, int width, int height, int channels, std::vector<MipLevel>& out,
+                  MipFilter filter = MipFilter::Box, ThreadPool* pool = nullptr);
+
+// Grava o .mips da imagem a partir dos níveis já gerados (e já comprimidos em format)
+bool writeBakedTexture(const std::string& imagePath, int channels, const std::vector<MipLevel>& levels,
+                       TextureFormat format = TextureFormat::Raw);
+
+#endif
@@ -0,0 +1,59 @@
+// FileStamp.h
+#ifndef FILE_STAMP_H
+#define FILE_STAMP_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "MappedFile.h"
+
+// Identificação de um arquivo-fonte usada como chave dos caches (.meshcache, .mips)
+struct FileStamp
+{
+    bool exists = false;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+};
+
+inline FileStamp fileStampOf(const std::string& path)
+{
+    FileStamp stamp;
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec) return stamp;
+    std::filesystem::file_time_type time = std::filesystem::last_write_time(path, ec);
+    if (ec) return stamp;
+    stamp.exists = true;
+    stamp.size = size;
+    stamp.mtime = static_cast<int64_t>(time.time_since_epoch().count());
+    return stamp;
+}
+
+// Hash FNV-1a de 64 bits do conteúdo (0 se o arquivo não existir)
+inline uint64_t hashFileContents(const std::string& path)
+{
+    MappedFile file(path, true);
+    if (!file.isOpen()) return 0;
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < file.size; ++i)
+    {
+        hash = (hash ^ static_cast<unsigned char>(file.data[i])) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// A fonte ainda é a mesma da chave gravada? Tamanho e data iguais bastam;
+// se só a data mudou mas o hash confere, atualiza mtime e marca touched.
+inline bool fileMatchesStamp(const std::string& path, uint64_t size, int64_t& mtime, uint64_t hash, bool& touched)
+{
+    FileStamp stamp = fileStampOf(path);
+    if (!stamp.exists || stamp.size != size) return false;
+    if (stamp.mtime == mtime) return true;
+    if (hashFileContents(path) != hash) return false;
+    mtime = stamp.mtime;
+    touched = true;
+    return true;
+}
+
+#endif
@@ -0,0 +1,62 @@
+// FileWatcher.h
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FileStamp.h"
+
+// Avisa quando arquivos de asset mudam no disco (hot reload). No Linux usa
+// inotify nas pastas dos arquivos; nos outros sistemas compara tamanho e data
+// (FileStamp) de tempos em tempos. Só a thread principal usa o objeto.
+class FileWatcher
+{
+public:
+    // debounceMs: o arquivo só é entregue depois de ficar esse tempo sem
+    // mudar, para não pegar um PNG ou .obj pela metade enquanto o editor grava
+    explicit FileWatcher(int debounceMs = 150);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Observa a pasta do arquivo, não o arquivo: editores que gravam num
+    // temporário e renomeiam continuam sendo vistos. Repetir o caminho não faz nada.
+    void watch(const std::string& path);
+
+    // Uma vez por quadro; nunca bloqueia. Arquivos observados que mudaram e já
+    // assentaram, com o caminho do jeito que foi passado ao watch
+    std::vector<std::string> poll();
+
+    // false: sem inotify, varrendo as datas a cada scanInterval
+    bool usingNotify() const { return notifyFd >= 0; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Watched
+    {
+        std::string path;
+        FileStamp stamp;
+        // Última mudança vista e ainda não entregue
+        bool changed = false;
+        Clock::time_point changedAt;
+    };
+
+    void readEvents();
+    void scanStamps();
+
+    std::chrono::milliseconds debounce;
+    std::chrono::milliseconds scanInterval = std::chrono::milliseconds(250);
+    Clock::time_point lastScan;
+    // Chave: caminho canônico
+    std::map<std::string, Watched> files;
+    int notifyFd = -1;
+    // Descritor do inotify -> pasta canônica
+    std::map<int, std::string> directories;
+};
+
+#endif
@@ -0,0 +1,111 @@
+// FrameUniforms.h
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class ShaderProgram;
+struct RingAllocation;
+
+// Pontos de ligação fixos: todo programa que declara os blocos lê daqui
+const GLuint FRAME_BLOCK_BINDING = 0;
+const GLuint LIGHTS_BLOCK_BINDING = 1;
+// Tamanho do array lights[] em FRAME_UNIFORMS_GLSL
+const int MAX_LIGHTS = 4;
+
+// Espelho std140 do bloco Frame: constantes do quadro
+struct FrameBlock
+{
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    // vec3 + float dividem os mesmos 16 bytes no std140
+    glm::vec3 cameraPos = glm::vec3(0.0f);
+    float time = 0.0f;
+};
+
+// Espelho std140 do struct Light
+struct LightData
+{
+    // xyz: posição no mundo; w: 1 ligada, 0 desligada
+    glm::vec4 position = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    glm::vec4 color = glm::vec4(1.0f);
+    // 1 / (x + y * d + z * d²); (1, 0, 0) sem atenuação
+    glm::vec4 attenuation = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+};
+
+// Espelho std140 do bloco Lights: o array de structs começa alinhado a 16
+struct LightsBlock
+{
+    int count = 0;
+    int padding[3] = { 0, 0, 0 };
+    LightData lights[MAX_LIGHTS];
+};
+
+static_assert(sizeof(FrameBlock) == 144, "FrameBlock fora do layout std140");
+static_assert(sizeof(LightData) == 48, "LightData fora do layout std140");
+static_assert(sizeof(LightsBlock) == 16 + 48 * MAX_LIGHTS, "LightsBlock fora do layout std140");
+
+// Declaração GLSL dos dois blocos, colada nos shaders logo depois do #version:
+//   const GLchar* vs = "#version 400\n" FRAME_UNIFORMS_GLSL R"( ... )";
+#define FRAME_UNIFORMS_GLSL \
+    "layout (std140) uniform Frame\n" \
+    "{\n" \
+    "    mat4 view;\n" \
+    "    mat4 projection;\n" \
+    "    vec3 cameraPos;\n" \
+    "    float time;\n" \
+    "};\n" \
+    "struct Light\n" \
+    "{\n" \
+    "    vec4 position;\n" \
+    "    vec4 color;\n" \
+    "    vec4 attenuation;\n" \
+    "};\n" \
+    "layout (std140) uniform Lights\n" \
+    "{\n" \
+    "    int lightCount;\n" \
+    "    Light lights[4];\n" \
+    "};\n"
+
+// Um UBO com os blocos Frame e Lights em dois intervalos, ligados uma vez aos
+// pontos fixos. O quadro preenche frame/lights na CPU e chama upload: um
+// glBufferSubData no lugar das dezenas de glUniform* por programa.
+class FrameUniforms
+{
+public:
+    // Precisa do contexto corrente; os intervalos ficam ligados a partir daqui
+    FrameUniforms();
+    ~FrameUniforms();
+
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    // Liga os blocos Frame e Lights do programa (os que ele declarar) aos pontos
+    // fixos. Tamanho diferente do espelho C++ é avisado no console. false se o
+    // programa não usa nenhum dos dois.
+    static bool attach(ShaderProgram& program);
+
+    // Envia os dois blocos de uma vez
+    void upload();
+    // Grava os dois blocos direto em pedaços do anel persistente (PersistentRing.h,
+    // cada um com o tamanho do bloco e alinhado para UBO) e liga os pontos fixos a
+    // eles; o próximo upload() volta a ligar o UBO próprio
+    void upload(GLuint ringBuffer, const RingAllocation& frameRange, const RingAllocation& lightsRange);
+
+    FrameBlock frame;
+    LightsBlock lights;
+
+    GLuint buffer() const { return ubo; }
+
+private:
+    GLuint ubo = 0;
+    // Lights começa no próximo múltiplo de GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    GLintptr lightsOffset = 0;
+    std::vector<unsigned char> staging;
+    // true depois de um upload no anel: os pontos fixos apontam para outro buffer
+    bool ringBound = false;
+};
+
+#endif
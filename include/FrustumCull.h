@@ -0,0 +1,59 @@
+// FrustumCull.h
+#ifndef FRUSTUM_CULL_H
+#define FRUSTUM_CULL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Planos esquerdo, direito, de baixo, de cima, perto e longe, com a normal
+// para dentro e o xyz normalizado: dot(xyz, p) + w é a distância com sinal
+struct Frustum
+{
+    glm::vec4 planes[6];
+};
+
+// Planos de projection * view (em espaço do mundo) ou de um mvp (em espaço
+// do objeto), pelo método de Gribb-Hartmann
+Frustum extractFrustum(const glm::mat4& matrix);
+
+// Esferas em estrutura de arrays: o teste carrega 8 x, 8 y, 8 z e 8 raios
+// seguidos, sem embaralhar
+struct SphereSet
+{
+    std::vector<float> x, y, z, radius;
+
+    void clear();
+    void reserve(size_t count);
+    void push(const glm::vec3& center, float r);
+    size_t size() const { return x.size(); }
+};
+
+// Contagem de um quadro, acumulada por todos os testes
+struct FrustumCullStats
+{
+    size_t tested = 0;
+    size_t visible = 0;
+    size_t culled = 0;
+    // Tempo gasto nos testes, em segundos
+    double seconds = 0.0;
+
+    void reset() { *this = FrustumCullStats(); }
+};
+
+// Uma esfera só: -1 inteira fora, 1 inteira dentro dos seis planos, 0 cortada
+// por algum deles. Serve para decidir um grupo inteiro (a esfera que envolve
+// todas as cópias de um objeto) antes de testar esfera por esfera.
+int classifySphere(const Frustum& frustum, const glm::vec3& center, float radius);
+
+// Índices (em ordem crescente) das esferas que tocam o frustum, anexados a
+// visible; devolve quantos. Testa 8 esferas por passo contra os 6 planos: AVX
+// quando compilado com ele, duas metades SSE nos outros x86 e laço escalar no
+// resto. Acumula as contagens em stats.
+size_t cullSpheres(const Frustum& frustum, const SphereSet& spheres, std::vector<uint32_t>& visible, FrustumCullStats& stats);
+
+// Caminho escolhido na compilação ("AVX", "SSE" ou "escalar"), para o console
+const char* frustumCullPath();
+
+#endif
@@ -0,0 +1,52 @@
+// GLExtensions.h
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+
+// Funções de versões depois da 4.0 que o glad do projeto não traz. Os
+// programas pedem contexto 4.6, então elas existem no driver; só falta o
+// ponteiro. Com um glad regerado para 4.3+ os nomes já vêm dele.
+#ifndef GL_VERSION_4_3
+#define GL_VERSION_4_3 1
+// Os ponteiros abaixo são definidos e carregados por GLExtensions.cpp
+#define GL_EXTENSIONS_LOAD_4_3 1
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect;
+#define glMultiDrawElementsIndirect glad_glMultiDrawElementsIndirect
+#endif
+
+#ifndef GL_VERSION_4_4
+#define GL_VERSION_4_4 1
+#define GL_EXTENSIONS_LOAD_4_4 1
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+extern PFNGLBUFFERSTORAGEPROC glad_glBufferStorage;
+#define glBufferStorage glad_glBufferStorage
+#endif
+
+// Constante da 4.3 usada no alinhamento dos intervalos de SSBO
+#ifndef GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+#define GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT 0x90DF
+#endif
+
+// Um comando de glMultiDrawElementsIndirect, no layout que a OpenGL lê do
+// GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand fora do layout da OpenGL");
+
+// Carrega os ponteiros acima com o mesmo loader do gladLoadGLLoader. Chamar
+// depois dele, com o contexto corrente; false se alguma função faltou.
+bool loadGLExtensions(GLADloadproc load);
+
+#endif
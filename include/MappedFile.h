@@ -0,0 +1,37 @@
+// MappedFile.h
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Mapeia um arquivo inteiro em memória, somente leitura (mmap / MapViewOfFile).
+// O conteúdo fica acessível em [data, data + size) enquanto o objeto existir.
+struct MappedFile
+{
+    const char* data = nullptr;
+    size_t size = 0;
+
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path, bool quiet = false) { open(path, quiet); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // quiet: não avisa no console se o arquivo não existir
+    bool open(const std::string& path, bool quiet = false);
+    void close();
+    bool isOpen() const { return opened; }
+
+private:
+    bool opened = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+#endif
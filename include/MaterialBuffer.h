@@ -0,0 +1,79 @@
+// MaterialBuffer.h
+#ifndef MATERIAL_BUFFER_H
+#define MATERIAL_BUFFER_H
+
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Constante da 4.3, fora do glad gerado para o núcleo 4.0
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+
+// Ponto de ligação do shader storage buffer com a tabela de materiais
+const GLuint MATERIAL_BUFFER_BINDING = 0;
+
+// Espelho std430 do struct Material: quatro vec4, sem folgas
+struct GpuMaterial
+{
+    glm::vec4 ka = glm::vec4(0.0f);
+    glm::vec4 kd = glm::vec4(0.0f);
+    // a: expoente especular (q)
+    glm::vec4 ks = glm::vec4(0.0f);
+    glm::vec4 ke = glm::vec4(0.0f);
+};
+
+static_assert(sizeof(GpuMaterial) == 64, "GpuMaterial fora do layout std430");
+
+// Declaração GLSL da tabela (#version 430 ou mais). Cada draw carrega só o
+// índice do material; o shader lê o resto daqui.
+#define MATERIAL_BUFFER_GLSL \
+    "struct Material\n" \
+    "{\n" \
+    "    vec4 ka;\n" \
+    "    vec4 kd;\n" \
+    "    vec4 ks;\n" \
+    "    vec4 ke;\n" \
+    "};\n" \
+    "layout (std430, binding = 0) readonly buffer Materials\n" \
+    "{\n" \
+    "    Material materials[];\n" \
+    "};\n"
+
+// Todos os materiais da cena num shader storage buffer. As vagas são dadas
+// por allocate e devolvidas por release (hot reload, geometria que sai da
+// cena); set só marca a vaga, e upload envia o que mudou uma vez por quadro.
+// Só a thread principal usa o objeto.
+class MaterialBuffer
+{
+public:
+    // Precisa do contexto corrente
+    MaterialBuffer();
+    ~MaterialBuffer();
+
+    MaterialBuffer(const MaterialBuffer&) = delete;
+    MaterialBuffer& operator=(const MaterialBuffer&) = delete;
+
+    int allocate(const GpuMaterial& material);
+    void set(int index, const GpuMaterial& material);
+    void release(int index);
+
+    // Envia as vagas alteradas (ou o buffer inteiro se cresceu, religando em
+    // MATERIAL_BUFFER_BINDING); sem mudanças não faz nada
+    void upload();
+
+    GLuint buffer() const { return ssbo; }
+    int count() const { return (int)materials.size() - (int)freeSlots.size(); }
+
+private:
+    GLuint ssbo = 0;
+    // Capacidade do buffer na GPU, em materiais
+    size_t capacity = 0;
+    std::vector<GpuMaterial> materials;
+    std::vector<int> freeSlots;
+    // Faixa alterada desde o último upload (dirtyEnd == 0: nada)
+    size_t dirtyBegin = 0, dirtyEnd = 0;
+};
+
+#endif
@@ -0,0 +1,89 @@
+// MeshArena.h
+#ifndef MESH_ARENA_H
+#define MESH_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+
+// Lugar de uma malha nos buffers compartilhados, em vértices e índices (não
+// bytes): é o que vai direto no baseVertex/firstIndex do comando indireto
+struct MeshSlice
+{
+    GLint baseVertex = -1;
+    GLuint vertexCount = 0;
+    GLuint firstIndex = 0;
+    GLuint indexCount = 0;
+
+    bool valid() const { return baseVertex >= 0; }
+};
+
+struct MeshArenaStats
+{
+    size_t meshes = 0;
+    size_t vertices = 0, indices = 0;
+    // Capacidade dos buffers na GPU, em bytes
+    size_t vertexBytes = 0, indexBytes = 0;
+    // Vezes em que um dos buffers foi trocado por um maior
+    int grows = 0;
+};
+
+// Vértices de todas as malhas num VBO e índices (de 16 ou de 32 bits, um tipo
+// por arena: um glMultiDrawElementsIndirect só lê um) num EBO, com
+// intervalos dados por first-fit e devolvidos ao hot reload. Os índices de
+// cada malha continuam locais (0..vertexCount-1); o baseVertex do draw
+// desloca. Só a thread principal usa o objeto.
+class MeshArena
+{
+public:
+    // Precisa do contexto corrente; vertexStride em bytes, indexType
+    // GL_UNSIGNED_SHORT ou GL_UNSIGNED_INT
+    explicit MeshArena(GLsizei vertexStride, GLenum indexType = GL_UNSIGNED_INT);
+    ~MeshArena();
+
+    MeshArena(const MeshArena&) = delete;
+    MeshArena& operator=(const MeshArena&) = delete;
+
+    // Copia a malha para os buffers (crescendo se preciso); indices no tipo da arena
+    MeshSlice add(const void* vertices, GLuint vertexCount, const void* indices, GLuint indexCount);
+    void release(const MeshSlice& slice);
+
+    GLuint vertexBuffer() const { return vbo; }
+    GLuint indexBuffer() const { return ebo; }
+    GLsizei vertexStride() const { return stride; }
+    GLenum indexType() const { return type; }
+    size_t indexSize() const { return type == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t); }
+    // Muda quando um buffer é trocado por um maior: VAOs apontando para os
+    // buffers antigos precisam ser refeitos
+    int generation() const { return generationCount; }
+
+    MeshArenaStats stats() const;
+
+private:
+    // Lista livre ordenada de intervalos [first, first + count), em elementos
+    struct RangeAllocator
+    {
+        struct Range { size_t first, count; };
+        std::vector<Range> freeRanges;
+        // Primeiro elemento nunca entregue
+        size_t top = 0;
+        size_t used = 0;
+
+        size_t allocate(size_t count);
+        void release(size_t first, size_t count);
+    };
+
+    // Garante capacidade para end elementos; copia o conteúdo para um buffer novo se crescer
+    void reserve(GLuint& buffer, size_t& capacity, size_t end, size_t elementSize);
+
+    GLsizei stride;
+    GLenum type;
+    GLuint vbo = 0, ebo = 0;
+    size_t vertexCapacity = 0, indexCapacity = 0;
+    RangeAllocator vertexRanges, indexRanges;
+    size_t meshCount = 0;
+    int generationCount = 0;
+};
+
+#endif
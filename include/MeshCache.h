@@ -0,0 +1,129 @@
+// MeshCache.h
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "MappedFile.h"
+#include "ObjLoader.h"
+#include "MeshOptimize.h"
+#include "MeshSimplify.h"
+
+// Mude ao alterar o layout do arquivo: caches antigos são regerados
+const uint32_t kMeshCacheVersion = 4;
+
+// Material já resolvido a partir do .mtl, como fica no arquivo
+struct MeshCacheMaterial
+{
+    char name[64];
+    char diffuseMap[256];
+    float ka[3];
+    float kd[3];
+    float ks[3];
+    float ke[3];
+    float shininess;
+};
+
+// Cabeçalho do .meshcache. Logo depois vêm os vértices intercalados
+// (vertexOffset), os índices de 16 ou 32 bits (indexOffset): os do LOD 0
+// seguidos pelos de cada LOD simplificado (tabela lods), os materiais
+// (materialOffset) e os trechos por material de cada LOD (submeshOffset,
+// submeshCount por nível, na ordem dos níveis).
+struct MeshCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+
+    // Chave das fontes: tamanho, data de modificação e hash FNV-1a
+    uint64_t objSize;
+    int64_t objMtime;
+    uint64_t objHash;
+    uint64_t mtlSize;
+    int64_t mtlMtime;
+    uint64_t mtlHash;
+    char mtlLib[256];
+
+    uint32_t floatsPerVertex;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    float boundsMin[3];
+    float boundsMax[3];
+
+    // Cache pós-transformação antes/depois de optimizeMesh (MeshOptimize.h)
+    float acmrBefore;
+    float acmrAfter;
+    float atvrBefore;
+    float atvrAfter;
+
+    // Níveis de detalhe sobre o mesmo vertex buffer (lods[0] = malha original)
+    // e as frações pedidas na geração, que fazem parte da chave do cache
+    uint32_t lodCount;
+    MeshLod lods[kMaxMeshLods];
+    uint32_t lodRatioCount;
+    float lodRatios[kMaxMeshLods];
+
+    // Um material por usemtl distinto do .obj
+    uint32_t materialCount;
+    uint32_t submeshCount;
+    uint64_t materialOffset;
+    uint64_t submeshOffset;
+};
+
+// Malha pronta para o glBufferData, lida do cache mapeado em memória
+struct CachedMesh
+{
+    MeshCacheHeader header = {};
+    const float* vertices = nullptr;
+    const void* indices = nullptr;
+    const MeshCacheMaterial* materials = nullptr;
+    const IndexedSubmesh* submeshes = nullptr;
+    // true = cache válido encontrado, o .obj não foi lido nesta execução
+    bool fromCache = false;
+
+    size_t vertexBytes() const { return size_t(header.vertexCount) * header.floatsPerVertex * sizeof(float); }
+    // Todos os LODs: um único EBO serve a cadeia inteira
+    size_t indexBytes() const { return size_t(header.indexCount) * header.indexSize; }
+    size_t lodCount() const { return header.lodCount; }
+    const MeshLod& lod(size_t level) const { return header.lods[level]; }
+    glm::vec3 boundsMin() const { return glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]); }
+    glm::vec3 boundsMax() const { return glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]); }
+    // Exercícios de um material só usam o primeiro
+    size_t materialCount() const { return header.materialCount; }
+    ObjMaterial material(size_t index = 0) const;
+    // Trechos de um nível, já ordenados por material (submesh.material indexa material())
+    size_t submeshCount() const { return header.submeshCount; }
+    const IndexedSubmesh& submesh(size_t level, size_t index) const { return submeshes[level * header.submeshCount + index]; }
+
+    MappedFile file;
+    // Cópia em memória, usada só quando não foi possível gravar o cache
+    std::vector<char> memory;
+};
+
+// Caminho do cache ao lado do .obj ("Suzanne.obj" -> "Suzanne.obj.meshcache")
+std::string meshCachePath(const std::string& objPath);
+
+// Mapeia o cache do .obj; se não existir ou estiver desatualizado (tamanho,
+// data ou hash do .obj/.mtl diferentes, ou outras frações de LOD), lê o .obj,
+// solda, otimiza a ordem dos triângulos/vértices (optimizeMesh), gera os LODs
+// em lodRatios (buildLodChain) e grava de novo
+bool loadMeshCached(const std::string& objPath, CachedMesh& out,
+                    const std::vector<float>& lodRatios = defaultLodRatios());
+
+// Gera o conteúdo de um .meshcache (cabeçalho + vértices + índices + materiais).
+// keys deve vir com as chaves das fontes preenchidas; stats pode ser nulo.
+// mesh.indices deve conter todos os níveis descritos em lods (vazio = só o LOD 0)
+// e materials um material para cada nome de mesh.materials.
+std::vector<char> serializeMeshCache(const MeshCacheHeader& keys, const IndexedMesh& mesh, const std::vector<ObjMaterial>& materials,
+                                     const MeshOptimizeStats* stats = nullptr,
+                                     const std::vector<MeshLod>& lods = {}, const std::vector<float>& lodRatios = {});
+
+// Preenche as chaves (tamanho, data, hash) do .obj e do seu .mtl
+void fillMeshCacheKeys(const std::string& objPath, const std::string& mtlLib, MeshCacheHeader& keys);
+
+#endif
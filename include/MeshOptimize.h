@@ -0,0 +1,55 @@
+// MeshOptimize.h
+#ifndef MESH_OPTIMIZE_H
+#define MESH_OPTIMIZE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ObjLoader.h"
+
+// Tamanho do cache FIFO pós-transformação usado na otimização e nas medições
+const unsigned kVertexCacheSize = 16;
+
+// Eficiência do cache pós-transformação para uma ordem de índices
+//  ACMR: vértices transformados por triângulo (0.5 é o ideal em malhas grandes, 3 o pior)
+//  ATVR: vértices transformados por vértice único (1.0 é o ideal)
+struct VertexCacheStats
+{
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+
+struct MeshOptimizeStats
+{
+    VertexCacheStats before;
+    VertexCacheStats after;
+    // Agrupamentos ordenados pelo passo de overdraw
+    size_t clusters = 0;
+};
+
+// Simula um cache FIFO de cacheSize entradas sobre a lista de triângulos
+VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount,
+                                    unsigned cacheSize = kVertexCacheSize);
+
+// Reordena os triângulos para o cache pós-transformação (Tipsify, Sander et al. 2007).
+// Se clusterStarts não for nulo, recebe o primeiro triângulo de cada trecho
+// contínuo (fronteiras em que o algoritmo precisou recomeçar longe do cache).
+void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount,
+                         std::vector<uint32_t>* clusterStarts = nullptr, unsigned cacheSize = kVertexCacheSize);
+
+// Reordena os trechos do Tipsify para desenhar primeiro o que está mais para fora
+// e virado para fora, reduzindo overdraw. Trechos longos são subdivididos enquanto
+// o ACMR de cada pedaço ficar abaixo de threshold vezes o do trecho.
+// Devolve o número de agrupamentos ordenados.
+size_t optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusterStarts,
+                        const float* vertices, size_t vertexCount, float threshold = 1.05f,
+                        unsigned cacheSize = kVertexCacheSize);
+
+// Renumera os vértices na ordem do primeiro uso pelos índices (leitura sequencial do VBO)
+void optimizeVertexFetch(std::vector<float>& vertices, std::vector<uint32_t>& indices);
+
+// As três etapas acima, na ordem: cache de vértices, overdraw, leitura de vértices
+void optimizeMesh(IndexedMesh& mesh, MeshOptimizeStats* stats = nullptr);
+
+#endif
@@ -0,0 +1,43 @@
+// MeshSimplify.h
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ObjLoader.h"
+
+// Níveis por malha, contando o original (LOD 0)
+const size_t kMaxMeshLods = 8;
+
+// Frações de triângulos dos LODs gerados por padrão: 50%, 25% e 12,5%
+const std::vector<float>& defaultLodRatios();
+
+// Um nível de detalhe: trecho do buffer de índices sobre o mesmo vertex buffer
+struct MeshLod
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    // Fração de triângulos pedida (1 no LOD 0)
+    float ratio;
+    // Erro geométrico em unidades do objeto: distância RMS às superfícies originais
+    float error;
+};
+
+// Colapsa arestas pela métrica de quádricas (Garland e Heckbert, 1997) até
+// sobrar no máximo targetIndexCount índices ou não haver colapso possível.
+// Os vértices não se movem nem são criados: out indexa o mesmo vertex buffer.
+// Costuras de UV/normal (vértices com a mesma posição) e bordas abertas só
+// colapsam ao longo delas mesmas. Devolve o erro geométrico do resultado.
+// vertices segue o layout x y z | s t | nx ny nz.
+float simplifyMesh(const float* vertices, size_t vertexCount, const std::vector<uint32_t>& indices,
+                   size_t targetIndexCount, std::vector<uint32_t>& out);
+
+// Acrescenta a mesh.indices um LOD para cada fração de ratios (a partir do
+// original) já otimizado para o cache de vértices. lods recebe o LOD 0 e os
+// gerados; níveis que não reduzem mais a malha são descartados. Cada material
+// é simplificado no seu trecho e mesh.submeshes ganha os trechos de cada nível.
+void buildLodChain(IndexedMesh& mesh, const std::vector<float>& ratios, std::vector<MeshLod>& lods);
+
+#endif
@@ -0,0 +1,64 @@
+// Meshlet.h
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Limites por meshlet (os mesmos recomendados para mesh shaders)
+const uint32_t kMeshletMaxVertices = 64;
+const uint32_t kMeshletMaxTriangles = 124;
+
+// Trecho contínuo do buffer de índices com no máximo kMeshletMaxVertices
+// vértices distintos e kMeshletMaxTriangles triângulos, em espaço do objeto
+struct Meshlet
+{
+    uint32_t firstIndex;
+    uint32_t triangleCount;
+    uint32_t vertexCount;
+
+    // Esfera envolvente
+    glm::vec3 center;
+    float radius;
+
+    // Cone das normais: o meshlet está todo de costas quando
+    // dot(coneApex - camera, coneAxis) >= coneCutoff * |coneApex - camera|.
+    // coneCutoff = 1 desliga o teste (normais espalhadas demais).
+    glm::vec3 coneApex;
+    glm::vec3 coneAxis;
+    float coneCutoff;
+};
+
+// Intervalo de índices a desenhar (meshlets visíveis vizinhos já unidos)
+struct MeshletRange
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+// Contagem de um quadro, acumulada por todas as malhas desenhadas
+struct MeshletCullStats
+{
+    size_t meshlets = 0;
+    size_t culledFrustum = 0;
+    size_t culledBackface = 0;
+    size_t trianglesDrawn = 0;
+    size_t trianglesCulled = 0;
+
+    void reset() { *this = MeshletCullStats(); }
+};
+
+// Agrupa os triângulos em meshlets (vizinhos com normais parecidas) e calcula
+// esfera e cone de cada um. indices é reescrito na ordem dos meshlets.
+// vertices segue o layout x y z | s t | nx ny nz.
+void buildMeshlets(const float* vertices, size_t vertexCount, std::vector<uint32_t>& indices, std::vector<Meshlet>& out);
+
+// Descarta meshlets fora do frustum de mvp (projection * view * model) ou de
+// costas para cameraObject (posição da câmera em espaço do objeto).
+// Devolve os intervalos a desenhar e acumula as contagens em stats.
+void cullMeshlets(const std::vector<Meshlet>& meshlets, const glm::mat4& mvp, const glm::vec3& cameraObject,
+                  std::vector<MeshletRange>& visible, MeshletCullStats& stats);
+
+#endif
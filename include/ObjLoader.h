@@ -0,0 +1,121 @@
+// ObjLoader.h
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Índices de um canto de face, já convertidos para base 0 (-1 = atributo ausente)
+struct ObjCorner
+{
+    int v;
+    int vt;
+    int vn;
+};
+
+// Linha usemtl: o material vale do canto firstCorner até a próxima troca
+struct ObjMaterialRange
+{
+    std::string material;
+    size_t firstCorner;
+};
+
+// Conteúdo de um .obj antes de desenrolar as faces: atributos únicos e os
+// cantos de cada triângulo (polígonos maiores são triangulados em leque)
+struct ObjData
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjCorner> corners;
+    std::string mtlLib;
+    // Trocas de material na ordem do arquivo (vazio = sem usemtl)
+    std::vector<ObjMaterialRange> materialRanges;
+};
+
+// Floats por vértice intercalado: x y z | s t | nx ny nz
+const int kObjFloatsPerVertex = 8;
+
+// Trecho do buffer de índices desenhado com um material só
+struct IndexedSubmesh
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    // Posição em IndexedMesh::materials
+    uint32_t material;
+};
+
+// Malha indexada: vértices únicos (soldados) no layout intercalado de
+// setupGeometry e uma lista de índices, 3 por triângulo, agrupados por material
+struct IndexedMesh
+{
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    // Nomes do usemtl na ordem do primeiro uso ("" = faces antes de qualquer usemtl)
+    std::vector<std::string> materials;
+    // Um trecho por material do LOD 0; buildLodChain acrescenta os de cada LOD
+    // gerado, na mesma ordem (submeshCount() por nível)
+    std::vector<IndexedSubmesh> submeshes;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+
+    size_t vertexCount() const { return vertices.size() / kObjFloatsPerVertex; }
+    // Índices cabem em GL_UNSIGNED_SHORT?
+    bool fitsUint16() const { return vertexCount() <= 65536; }
+    // Trechos por nível de detalhe
+    size_t submeshCount() const { return materials.size(); }
+};
+
+// Material de um bloco newmtl do .mtl
+struct ObjMaterial
+{
+    std::string name;
+    glm::vec3 ka = glm::vec3(0.0f);
+    glm::vec3 kd = glm::vec3(1.0f);
+    glm::vec3 ks = glm::vec3(0.0f);
+    glm::vec3 ke = glm::vec3(0.0f);
+    float shininess = 32.0f;
+    std::string diffuseMap;
+};
+
+// Lê o .obj via mapeamento em memória, sem alocações por linha.
+// threads: 1 = sequencial, N > 1 = blocos lidos em N threads,
+// 0 = automático (paralelo apenas para arquivos grandes)
+bool parseObj(const char* path, ObjData& out, unsigned threads = 1);
+
+// Desenrola os cantos em três listas paralelas (mesmo formato de loadObject)
+void expandObj(
+    const ObjData& data,
+    std::vector<glm::vec3>& out_vertices,
+    std::vector<glm::vec2>& out_uvs,
+    std::vector<glm::vec3>& out_normals);
+
+// Substituto direto de loadObject: mesma saída, devolvendo também o mtllib.
+// threads segue a regra de parseObj (padrão: automático)
+bool loadObjectMapped(
+    const char* path,
+    std::vector<glm::vec3>& out_vertices,
+    std::vector<glm::vec2>& out_uvs,
+    std::vector<glm::vec3>& out_normals,
+    std::string& out_mtlLib,
+    unsigned threads = 0);
+
+// Lê todos os blocos newmtl do .mtl, na ordem do arquivo. Palavras-chave antes
+// do primeiro newmtl vão para um material sem nome.
+bool parseMtlLibrary(const char* path, std::vector<ObjMaterial>& out);
+
+// Material do usemtl name na biblioteca; sem nome ou não encontrado, o primeiro
+// (arquivos com um material só nem sempre usam usemtl)
+const ObjMaterial* findMaterial(const std::vector<ObjMaterial>& library, const std::string& name);
+
+// Solda cantos com a mesma posição/uv/normal (tabela hash sobre os 8 floats) e
+// agrupa os triângulos por material (um IndexedSubmesh por usemtl distinto).
+// Também calcula a caixa envolvente das posições usadas.
+void buildIndexedMesh(const ObjData& data, IndexedMesh& out);
+
+// Converte os índices para 16 bits (usar só quando mesh.fitsUint16())
+void packIndices16(const std::vector<uint32_t>& indices, std::vector<uint16_t>& out);
+
+#endif
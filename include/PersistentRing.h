@@ -0,0 +1,74 @@
+// PersistentRing.h
+#ifndef PERSISTENT_RING_H
+#define PERSISTENT_RING_H
+
+#include <cstddef>
+#include "GLExtensions.h"
+
+// Quadros em voo: a CPU escreve o quadro N+2 enquanto a GPU lê o N
+const int RING_FRAMES = 3;
+
+// Pedaço do quadro atual: ponteiro para escrever e offset para glBindBufferRange
+struct RingAllocation
+{
+    void* data = nullptr;
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;
+};
+
+struct PersistentRingStats
+{
+    int frames = 0;
+    // Quadros em que a seção ainda estava com a GPU e a CPU teve de esperar
+    int stalledFrames = 0;
+    double stallSeconds = 0.0;
+    double maxStallSeconds = 0.0;
+    // Maior uso de uma seção, em bytes
+    size_t peakBytes = 0;
+    // Pedidos que não couberam na seção
+    int overflows = 0;
+};
+
+// Buffer com armazenamento imutável (glBufferStorage) mapeado uma vez só,
+// persistente e coerente, dividido em RING_FRAMES seções. Cada quadro
+// escreve na sua seção por ponteiro; a seção só volta a ser escrita depois
+// que a cerca (glFenceSync) do quadro que a usou foi sinalizada.
+class PersistentRing
+{
+public:
+    // Precisa do contexto corrente e de glBufferStorage (loadGLExtensions)
+    explicit PersistentRing(size_t sectionBytes);
+    ~PersistentRing();
+
+    PersistentRing(const PersistentRing&) = delete;
+    PersistentRing& operator=(const PersistentRing&) = delete;
+
+    // Espera a GPU liberar a seção do quadro (contando o tempo parado) e
+    // recomeça a alocação nela
+    void beginFrame();
+    // Pedaço da seção atual; data == nullptr se não coube (contado em overflows)
+    RingAllocation allocate(size_t bytes, size_t alignment);
+    // Cerca depois do último comando que lê a seção; chamar antes do swap
+    void endFrame();
+
+    GLuint buffer() const { return ringBuffer; }
+    size_t sectionBytes() const { return sectionSize; }
+    // Alinhamento que serve para UBO e SSBO (o maior dos dois)
+    size_t bindAlignment() const { return alignment; }
+
+    // Estatísticas desde o último resetStats
+    const PersistentRingStats& stats() const { return counters; }
+    void resetStats() { counters = PersistentRingStats(); }
+
+private:
+    GLuint ringBuffer = 0;
+    unsigned char* mapped = nullptr;
+    size_t sectionSize = 0;
+    size_t alignment = 256;
+    int section = 0;
+    size_t used = 0;
+    GLsync fences[RING_FRAMES] = {};
+    PersistentRingStats counters;
+};
+
+#endif
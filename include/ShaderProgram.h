@@ -0,0 +1,179 @@
+// ShaderProgram.h
+#ifndef SHADER_PROGRAM_H
+#define SHADER_PROGRAM_H
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Uniform ativo do programa, lido uma vez depois do link
+struct UniformInfo
+{
+    // Arrays aparecem sem o "[0]"
+    std::string name;
+    GLint location = -1;
+    GLenum type = 0;
+    GLint size = 1;
+    // Bloco de uniforms que contém o membro (-1: uniform solto, com location)
+    GLint block = -1;
+    // Posição dentro do bloco (std140), -1 fora de bloco
+    GLint offset = -1;
+};
+
+struct UniformBlockInfo
+{
+    std::string name;
+    GLuint index = 0;
+    GLint dataSize = 0;
+    GLint binding = 0;
+};
+
+// Samplers (sampler2D, usampler2D, sampler2DArray...) recebem a unidade como int
+bool isSamplerType(GLenum type);
+const char* uniformTypeName(GLenum type);
+
+// Tipo C++ de cada uniform: que tipos GLSL aceita e qual glUniform* usa
+template <typename T>
+struct UniformTraits;
+
+template <>
+struct UniformTraits<float>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT; }
+    static void set(GLint location, float value) { glUniform1f(location, value); }
+};
+
+template <>
+struct UniformTraits<int>
+{
+    static bool accepts(GLenum type) { return type == GL_INT || type == GL_BOOL || isSamplerType(type); }
+    static void set(GLint location, int value) { glUniform1i(location, value); }
+};
+
+template <>
+struct UniformTraits<bool>
+{
+    static bool accepts(GLenum type) { return type == GL_BOOL; }
+    static void set(GLint location, bool value) { glUniform1i(location, value ? 1 : 0); }
+};
+
+template <>
+struct UniformTraits<GLuint>
+{
+    static bool accepts(GLenum type) { return type == GL_UNSIGNED_INT; }
+    static void set(GLint location, GLuint value) { glUniform1ui(location, value); }
+};
+
+template <>
+struct UniformTraits<glm::vec2>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT_VEC2; }
+    static void set(GLint location, const glm::vec2& value) { glUniform2fv(location, 1, glm::value_ptr(value)); }
+};
+
+template <>
+struct UniformTraits<glm::vec3>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT_VEC3; }
+    static void set(GLint location, const glm::vec3& value) { glUniform3fv(location, 1, glm::value_ptr(value)); }
+};
+
+template <>
+struct UniformTraits<glm::vec4>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT_VEC4; }
+    static void set(GLint location, const glm::vec4& value) { glUniform4fv(location, 1, glm::value_ptr(value)); }
+};
+
+template <>
+struct UniformTraits<glm::mat3>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT_MAT3; }
+    static void set(GLint location, const glm::mat3& value) { glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+};
+
+template <>
+struct UniformTraits<glm::mat4>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT_MAT4; }
+    static void set(GLint location, const glm::mat4& value) { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+};
+
+// Uniform com a localização já resolvida: set é um glUniform* direto, sem
+// busca por nome. Vale para o programa em uso (glUseProgram). Sem o uniform
+// no shader (ou removido pelo linker), location fica -1 e set não faz nada.
+template <typename T>
+struct Uniform
+{
+    GLint location = -1;
+
+    void set(const T& value) const
+    {
+        if (location >= 0) UniformTraits<T>::set(location, value);
+    }
+    explicit operator bool() const { return location >= 0; }
+};
+
+// Programa vertex + fragment compilado e linkado uma vez. Depois do link os
+// uniforms e blocos ativos são lidos (glGetActiveUniform / glGetActiveUniformBlockiv)
+// e os handles tipados saem dessa tabela, sem glGetUniformLocation no quadro.
+class ShaderProgram
+{
+public:
+    ShaderProgram() = default;
+    // Precisa do contexto ainda vivo
+    ~ShaderProgram();
+
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    // Compila os dois estágios, linka e reflete. Erros de compilação e link vão
+    // para o console com o nome do programa; false se o link falhou.
+    bool build(const std::string& name, const char* vertexSource, const char* fragmentSource);
+
+    GLuint id() const { return program; }
+    const std::string& name() const { return label; }
+    void use() const { glUseProgram(program); }
+
+    // Handle tipado do uniform. Tipo diferente do declarado no shader é avisado
+    // no console e devolve um handle vazio; nome ausente devolve vazio em silêncio
+    // (o linker remove uniforms que o shader não usa).
+    template <typename T>
+    Uniform<T> uniform(const char* name) const
+    {
+        Uniform<T> handle;
+        const UniformInfo* info = find(name);
+        if (!info || info->location < 0) return handle;
+        if (!UniformTraits<T>::accepts(info->type))
+        {
+            typeMismatch(*info);
+            return handle;
+        }
+        handle.location = info->location;
+        return handle;
+    }
+
+    const UniformInfo* find(const char* name) const;
+    const std::vector<UniformInfo>& uniforms() const { return uniformList; }
+    const std::vector<UniformBlockInfo>& blocks() const { return blockList; }
+    const UniformBlockInfo* findBlock(const char* name) const;
+
+    // Liga o bloco de uniforms ao ponto de ligação dos UBOs (glUniformBlockBinding)
+    bool bindBlock(const char* name, GLuint binding);
+
+    // Tabela de uniforms e blocos no console (depuração)
+    void printReflection() const;
+
+private:
+    void reflect();
+    void typeMismatch(const UniformInfo& info) const;
+
+    GLuint program = 0;
+    std::string label;
+    std::vector<UniformInfo> uniformList;
+    std::vector<UniformBlockInfo> blockList;
+};
+
+#endif
@@ -0,0 +1,115 @@
+// TextureAtlas.h
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <cstddef>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+struct TextureData;
+struct TextureParams;
+
+// Onde a textura ficou no array, no layout lido pelo vertex shader (dois vec4
+// por draw, atributo com divisor 1): uv' = uvRect.zw + uv * uvRect.xy na camada layer
+struct AtlasPlacement
+{
+    glm::vec4 uvRect = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+    // -1: sem textura, o shader usa branco
+    float layer = -1.0f;
+    // Níveis acima deste já misturam texels de vizinhos no atlas
+    float maxLod = 0.0f;
+    // 1 = GL_REPEAT (fract no shader), 0 = GL_CLAMP_TO_EDGE
+    float repeat = 0.0f;
+    float unused = 0.0f;
+};
+
+struct TextureAtlasStats
+{
+    size_t pages = 0;
+    size_t capacity = 0;
+    size_t entries = 0;
+    // Texturas que dividem página com outras / que ocupam a página inteira
+    size_t packed = 0;
+    size_t wholePages = 0;
+    // Texturas maiores que a página, reduzidas para o primeiro mipmap que cabe
+    size_t downscaled = 0;
+    // Área ocupada pelas texturas (sem gutter) sobre a área das páginas em uso
+    float fill = 0.0f;
+    size_t bytes = 0;
+};
+
+// Texturas de material num único GL_TEXTURE_2D_ARRAY RGBA8 de páginas
+// quadradas: as do tamanho da página ocupam uma camada inteira, as menores
+// dividem camadas (empacotamento em prateleiras, com gutter repetindo a borda
+// ou o lado oposto conforme o wrap). Todos os objetos amostram o mesmo array,
+// então trocar de material não troca de textura.
+class TextureAtlas
+{
+public:
+    // padding: gutter em pixels no nível 0 (potência de 2); limita os mipmaps
+    // usáveis das texturas que dividem página a log2(padding)
+    explicit TextureAtlas(int pageSize = 1024, int padding = 8);
+    // Precisa do contexto ainda vivo
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // Thread com contexto. Copia todos os níveis da imagem decodificada (crus,
+    // .mips cru ou BCn descomprimido) para o array. Devolve o id da entrada, ou -1.
+    int insert(const TextureData& data, const TextureParams& params);
+    // Hot reload: regrava a entrada no mesmo lugar se a imagem nova ocupa o
+    // mesmo tamanho; false se não couber (aí remove + insert)
+    bool update(int id, const TextureData& data, const TextureParams& params);
+    // Libera a área; a página volta a ficar livre quando a última entrada sai
+    void remove(int id);
+
+    const AtlasPlacement& placement(int id) const { return entries[id].placement; }
+    // Bytes da área reservada à entrada (com gutter e mipmaps)
+    size_t entryBytes(int id) const;
+
+    GLuint texture() const { return textureID; }
+    int pageSize() const { return size; }
+    TextureAtlasStats stats() const;
+
+private:
+    struct Shelf
+    {
+        int y, height, x;
+    };
+
+    struct Page
+    {
+        std::vector<Shelf> shelves;
+        int nextY = 0;
+        int live = 0;
+        bool whole = false;
+    };
+
+    struct Entry
+    {
+        AtlasPlacement placement;
+        int page = -1;
+        int x = 0, y = 0, width = 0, height = 0;
+        int allocWidth = 0, allocHeight = 0;
+        bool live = false;
+        bool downscaled = false;
+    };
+
+    int fittingLevel(const TextureData& data, int& width, int& height) const;
+    void writeLevels(Entry& entry, const TextureData& data, int base, const TextureParams& params);
+    bool allocate(int width, int height, int& page, int& x, int& y);
+    int addPage();
+    void grow(int layers);
+
+    int size;
+    int padding;
+    int levels;
+    int capacity = 0;
+    GLuint textureID = 0;
+    std::vector<Page> pages;
+    std::vector<Entry> entries;
+};
+
+#endif
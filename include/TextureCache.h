@@ -0,0 +1,163 @@
+// TextureCache.h
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <glad/glad.h>
+
+#include "BakedTexture.h"
+#include "TextureAtlas.h"
+
+// Estado do objeto de textura; faz parte da chave, porque vive na própria textura
+struct TextureParams
+{
+    GLint wrap = GL_REPEAT;
+    GLint minFilter = GL_LINEAR_MIPMAP_LINEAR;
+
+    bool operator<(const TextureParams& other) const
+    {
+        return std::tie(wrap, minFilter) < std::tie(other.wrap, other.minFilter);
+    }
+};
+
+// Imagem decodificada fora do contexto OpenGL: .mips do objbake, ou PNG via
+// stb_image com os mipmaps gerados na CPU
+struct TextureData
+{
+    std::string path;
+    BakedTexture baked;
+    bool fromBake = false;
+    std::vector<MipLevel> levels;
+    int width = 0, height = 0, channels = 0;
+    GLuint textureID = 0;
+    // Preenchido por uploadTexture
+    size_t gpuBytes = 0;
+};
+
+// Decodifica sem OpenGL; qualquer thread. 1 e 2 canais viram RGBA.
+// Sem .mips, gera a cadeia de mipmaps com filter, dividindo as linhas no pool.
+bool decodeTexture(const std::string& path, TextureData& data, MipFilter filter = MipFilter::Box,
+                   ThreadPool* pool = nullptr);
+// Cria a textura com todos os níveis e libera os pixels; precisa de um contexto atual
+bool uploadTexture(TextureData& data, const TextureParams& params);
+// Bytes na GPU com a cadeia de mipmaps (níveis BCn contados comprimidos)
+size_t textureBytes(const TextureData& data);
+
+struct TextureCacheStats
+{
+    size_t requests = 0;
+    // Arquivos realmente decodificados
+    size_t decodes = 0;
+    // Pedidos atendidos pelo caminho (sem decodificar de novo)
+    size_t pathHits = 0;
+    // Arquivos diferentes com a mesma imagem: decodificados, mas sem segunda textura
+    size_t contentHits = 0;
+    size_t failures = 0;
+    // Texturas vivas na GPU e seus bytes
+    size_t textures = 0;
+    size_t bytesResident = 0;
+    // Bytes de textura que cada pedido teria alocado sem o cache
+    size_t bytesSaved = 0;
+    // Hot reload: imagens trocadas e, delas, as reescritas na mesma textura/área do atlas
+    size_t reloads = 0;
+    size_t reloadsInPlace = 0;
+};
+
+struct CachedTexture;
+struct TextureImage;
+using TextureHandle = CachedTexture*;
+
+// Texturas compartilhadas entre todas as geometrias. A chave é o caminho
+// canônico mais os parâmetros; depois de decodificar, a imagem ainda é
+// comparada pelo hash do conteúdo, e arquivos idênticos dividem a textura.
+// Cada acquire conta uma referência; a textura é apagada no último release.
+class TextureCache
+{
+public:
+    // caminho canônico, wrap, minFilter
+    using PathKey = std::tuple<std::string, GLint, GLint>;
+    // hash, largura, altura, canais, wrap, minFilter
+    using ContentKey = std::tuple<uint64_t, int, int, int, GLint, GLint>;
+
+    // pool e filter valem para as imagens sem .mips: mipmaps gerados na CPU,
+    // com as linhas dos níveis grandes divididas entre as threads do pool
+    explicit TextureCache(ThreadPool* pool = nullptr, MipFilter filter = MipFilter::Box)
+        : pool(pool), filter(filter)
+    {
+    }
+    // Apaga as texturas que sobraram: destruir com o contexto ainda vivo
+    ~TextureCache();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // Qualquer thread. O primeiro pedido de uma chave decodifica; os outros
+    // esperam por ele e recebem a mesma entrada. nullptr se a imagem falhar.
+    TextureHandle acquire(const std::string& path, const TextureParams& params = TextureParams());
+
+    // Thread com contexto OpenGL (compartilhado ou o principal): cria a
+    // textura na primeira chamada e devolve o id nas seguintes
+    GLuint upload(TextureHandle handle);
+
+    // Alternativa ao upload: copia a imagem para o atlas (uma vez por imagem,
+    // mesmo com vários caminhos) e devolve onde ela ficou. Thread do contexto
+    // do atlas; o atlas precisa viver mais que o cache.
+    AtlasPlacement place(TextureHandle handle, TextureAtlas& atlas);
+
+    // Solta uma referência; no último release da imagem apaga a textura
+    // (precisa de contexto atual)
+    void release(TextureHandle handle);
+
+    // Hot reload, em duas etapas como o carregamento. decodeReload (qualquer
+    // thread) decodifica o arquivo de novo para as entradas com esse caminho;
+    // elas continuam com a imagem antiga até o commit. false se nenhuma
+    // entrada usa o arquivo ou se o decode falhou.
+    bool decodeReload(const std::string& path);
+    // Troca as imagens decodificadas. Com o mesmo tamanho e formato, numa
+    // imagem só desta entrada, os texels são reescritos na mesma textura
+    // (glTexSubImage2D) ou no mesmo lugar do atlas; senão a entrada ganha uma
+    // imagem nova e a antiga fica aposentada até deleteRetired. Sem atlas,
+    // trata as imagens fora de atlas (thread com contexto, pode ser a
+    // compartilhada); com atlas, só as que estão nele (thread do atlas).
+    // Devolve as entradas trocadas: upload/place delas dão o id ou lugar novo.
+    std::vector<TextureHandle> commitReloads(TextureAtlas* atlas = nullptr);
+    // Apaga as texturas e áreas do atlas aposentadas pelo commitReloads; chamar
+    // na thread principal depois que as geometrias trocaram para as novas
+    void deleteRetired();
+
+    TextureCacheStats stats() const;
+
+private:
+    struct Retired
+    {
+        GLuint textureID;
+        TextureAtlas* atlas;
+        int atlasEntry;
+    };
+
+    void releaseImage(TextureImage* image, bool retire = false);
+
+    ThreadPool* pool;
+    MipFilter filter;
+
+    mutable std::mutex mutex;
+    std::condition_variable decoded;
+    // Só um upload por vez; decodes e acquires seguem enquanto isso
+    std::mutex uploadMutex;
+    std::map<PathKey, CachedTexture*> byPath;
+    std::map<ContentKey, TextureImage*> byContent;
+    // Imagens decodificadas pelo decodeReload esperando o commit, e o que ele aposentou
+    std::map<PathKey, std::unique_ptr<TextureData>> reloads;
+    std::vector<Retired> retired;
+    TextureCacheStats counters;
+};
+
+#endif
@@ -0,0 +1,22 @@
+// TextureCompress.h
+#ifndef TEXTURE_COMPRESS_H
+#define TEXTURE_COMPRESS_H
+
+#include <vector>
+
+#include "BakedTexture.h"
+
+// Comprime uma imagem RGB/RGBA em blocos 4x4, linha de blocos por linha de blocos.
+//  BC1: RGB em 4 bits por pixel (alfa ignorado)
+//  BC3: BC1 na cor + alfa interpolado em 8 níveis, 8 bits por pixel
+//  BC7: só o modo 6 (RGBA, 16 níveis por bloco), 8 bits por pixel
+// out recebe textureLevelBytes(format, width, height, channels) bytes.
+void compressTexture(const unsigned char* pixels, int width, int height, int channels, TextureFormat format,
+                     std::vector<unsigned char>& out);
+
+// Volta para RGBA 8 bits (fallback quando o driver não aceita o formato).
+// No BC7 só decodifica o modo 6, o único que compressTexture gera.
+bool decompressTexture(const unsigned char* blocks, int width, int height, TextureFormat format,
+                       std::vector<unsigned char>& rgba);
+
+#endif
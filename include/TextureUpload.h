@@ -0,0 +1,26 @@
+// TextureUpload.h
+#ifndef TEXTURE_UPLOAD_H
+#define TEXTURE_UPLOAD_H
+
+#include <cstddef>
+#include <glad/glad.h>
+
+#include "BakedTexture.h"
+
+// O driver aceita o formato comprimido? BC1/BC3 pedem S3TC, BC7 pede BPTC
+// (núcleo desde o OpenGL 4.2). Consulta as extensões na primeira chamada,
+// que precisa de um contexto atual.
+bool compressedFormatSupported(TextureFormat format);
+
+// Envia todos os níveis do .mips para a textura ligada em GL_TEXTURE_2D:
+// blocos BCn direto com glCompressedTexImage2D quando o driver aceita o
+// formato, senão convertidos para RGBA na CPU. Nunca chama glGenerateMipmap.
+// Devolve os bytes ocupados na GPU.
+size_t uploadBakedLevels(const BakedTexture& baked);
+
+// Hot reload: a textura ligada já tem os mesmos níveis, tamanhos e formato
+// (criada por uploadBakedLevels com um .mips igual no layout). Só troca os
+// texels com glTexSubImage2D / glCompressedTexSubImage2D, sem realocar.
+void updateBakedLevels(const BakedTexture& baked);
+
+#endif
@@ -0,0 +1,133 @@
+// ThreadPool.h
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Pool fixo de threads com fila de tarefas.
+// submit() devolve um std::future; parallelFor() bloqueia até terminar o laço.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threadCount = 0)
+    {
+        if (threadCount == 0) threadCount = defaultThreadCount();
+        for (unsigned i = 0; i < threadCount; ++i)
+        {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    template <typename F>
+    auto submit(F&& fn) -> std::future<typename std::invoke_result<F>::type>
+    {
+        using Result = typename std::invoke_result<F>::type;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+        std::future<Result> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace([task]() { (*task)(); });
+        }
+        wakeUp.notify_one();
+        return result;
+    }
+
+    // Executa fn(i) para i em [0, count), distribuindo os índices entre as threads.
+    // A thread que chama também pega índices, então dá para chamar de dentro de
+    // uma tarefa do próprio pool (laços aninhados) sem travar com os workers ocupados.
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn)
+    {
+        if (count == 0) return;
+
+        struct Loop
+        {
+            const std::function<void(size_t)>* fn;
+            size_t count;
+            std::atomic<size_t> next{ 0 };
+            size_t remaining;
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        auto loop = std::make_shared<Loop>();
+        loop->fn = &fn;
+        loop->count = count;
+        loop->remaining = count;
+
+        // Ajudantes que começarem depois do fim não encontram mais índices
+        auto run = [loop]() {
+            for (;;)
+            {
+                size_t i = loop->next.fetch_add(1);
+                if (i >= loop->count) return;
+                (*loop->fn)(i);
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                if (--loop->remaining == 0) loop->finished.notify_all();
+            }
+        };
+        size_t helpers = std::min(count - 1, workers.size());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < helpers; ++i) tasks.emplace(run);
+        }
+        wakeUp.notify_all();
+
+        run();
+        std::unique_lock<std::mutex> lock(loop->mutex);
+        loop->finished.wait(lock, [&loop]() { return loop->remaining == 0; });
+    }
+
+    static unsigned defaultThreadCount()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+private:
+    void workerLoop()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,58 @@
+// VertexQuantize.h
+#ifndef VERTEX_QUANTIZE_H
+#define VERTEX_QUANTIZE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Vértice compacto de 16 bytes (contra 32 do layout x y z | s t | nx ny nz):
+//  - posição em UNORM16 relativa à caixa envolvente da malha (w é preenchimento)
+//  - normal em octaédrico, 2 x SNORM16
+//  - uv em UNORM16, ou half-float se algum uv sair de [0, 1]
+struct PackedVertex
+{
+    uint16_t position[4];
+    int16_t normal[2];
+    uint16_t uv[2];
+};
+
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex deve ter 16 bytes");
+
+// Vértices compactados e o que o vertex shader precisa para voltar ao float:
+// posição = positionOffset + position * positionScale
+struct QuantizedMesh
+{
+    std::vector<PackedVertex> vertices;
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    glm::vec3 positionScale = glm::vec3(1.0f);
+    // false = uv em GL_UNSIGNED_SHORT normalizado, true = GL_HALF_FLOAT
+    bool halfUVs = false;
+
+    size_t bytes() const { return vertices.size() * sizeof(PackedVertex); }
+};
+
+// Maior erro introduzido pela compactação (posição e uv em unidades do modelo, normal em graus)
+struct QuantizationError
+{
+    float position = 0.0f;
+    float normalDegrees = 0.0f;
+    float uv = 0.0f;
+};
+
+// Compacta vértices no layout de kObjFloatsPerVertex floats (x y z | s t | nx ny nz)
+void quantizeVertices(const float* vertices, size_t vertexCount,
+                      const glm::vec3& boundsMin, const glm::vec3& boundsMax, QuantizedMesh& out);
+
+// Decodifica de volta e compara com os floats originais
+QuantizationError measureQuantizationError(const float* vertices, size_t vertexCount, const QuantizedMesh& mesh);
+
+// Codificação octaédrica de uma normal em [-1, 1]^2 (e a inversa, igual à do shader)
+glm::vec2 octEncode(const glm::vec3& n);
+glm::vec3 octDecode(const glm::vec2& e);
+
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+#endif
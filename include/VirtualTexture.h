@@ -0,0 +1,156 @@
+// VirtualTexture.h
+#ifndef VIRTUAL_TEXTURE_H
+#define VIRTUAL_TEXTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "ThreadPool.h"
+#include "VirtualTextureFile.h"
+
+struct VirtualTextureStats
+{
+    // Páginas distintas pedidas pelo feedback no último update
+    size_t requested = 0;
+    size_t resident = 0;
+    size_t capacity = 0;
+    // Leituras em andamento no pool
+    size_t pending = 0;
+    // Totais desde a abertura
+    size_t loads = 0;
+    size_t uploads = 0;
+    size_t evictions = 0;
+    // Páginas lidas que não acharam vaga (todas em uso no quadro) e serão pedidas de novo
+    size_t dropped = 0;
+    // VRAM fixa (cache físico + tabela de páginas) x a cadeia inteira em RGBA
+    size_t physicalBytes = 0;
+    size_t pageTableBytes = 0;
+    uint64_t virtualBytes = 0;
+};
+
+// Textura virtual: só as páginas visíveis ficam na VRAM, num cache físico de
+// tamanho fixo. A tabela de páginas (um texel RGBA8UI por página, com
+// mipmaps) diz em que vaga do cache está cada página, ou a do ancestral mais
+// próximo que já está residente. A página do último nível fica fixa no cache.
+class VirtualTexture
+{
+public:
+    // physicalTiles: vagas por lado do cache físico (a VRAM usada não depende da imagem)
+    explicit VirtualTexture(ThreadPool& pool, int physicalTiles = 8);
+    // Espera as leituras em andamento; precisa do contexto ainda vivo
+    ~VirtualTexture();
+
+    VirtualTexture(const VirtualTexture&) = delete;
+    VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+    // Thread com contexto: mapeia o .vtex da imagem e cria as texturas
+    bool open(const std::string& imagePath);
+    const std::string& path() const { return imagePath; }
+
+    // Página vista neste quadro (vinda do feedback); os ancestrais contam como usados
+    void request(uint32_t level, uint32_t x, uint32_t y);
+
+    // Uma vez por quadro, na thread com contexto: começa as leituras que
+    // faltam (as mais grossas primeiro), envia até uploadBudget páginas que
+    // já chegaram, despejando as menos usadas, e atualiza a tabela de páginas
+    void update(int uploadBudget = 16);
+
+    GLuint pageTable() const { return pageTableID; }
+    GLuint physical() const { return physicalID; }
+    // (largura, altura, tileSize, último nível): uniform vtSize dos shaders
+    glm::vec4 sizeInfo() const;
+    // (lado da vaga, borda, lado da textura física, 0): uniform vtPhysical
+    glm::vec4 physicalInfo() const;
+
+    VirtualTextureStats stats() const;
+
+private:
+    struct Slot
+    {
+        uint64_t key = 0;
+        bool used = false;
+        bool pinned = false;
+        uint64_t lastUsed = 0;
+    };
+
+    struct Load
+    {
+        uint64_t key;
+        std::future<std::vector<unsigned char>> pixels;
+    };
+
+    int findSlot();
+    void uploadTile(int slot, uint64_t key, const unsigned char* pixels);
+    void markDirty(uint32_t level, uint32_t x, uint32_t y);
+    void refreshPageTable();
+
+    ThreadPool& pool;
+    std::string imagePath;
+    VirtualTextureFile file;
+    int slotsPerSide;
+    GLuint pageTableID = 0;
+    GLuint physicalID = 0;
+
+    uint64_t frame = 0;
+    std::vector<Slot> slots;
+    std::unordered_map<uint64_t, int> residentSlots;
+    std::unordered_set<uint64_t> requests;
+    std::vector<Load> loading;
+    std::unordered_set<uint64_t> loadingKeys;
+
+    // Espelho da tabela na CPU (RGBA8UI: vaga x, vaga y, nível residente, válido)
+    // e retângulo sujo de cada nível, em páginas
+    std::vector<std::vector<unsigned char>> pageEntries;
+    std::vector<glm::ivec4> dirty;
+
+    VirtualTextureStats counters;
+};
+
+// Passe de feedback: a cena é desenhada num framebuffer RGBA16UI reduzido
+// com (página x, página y, nível, id + 1) por pixel. A leitura vai para um
+// PBO e só é consumida no quadro seguinte, quando a fence já passou, então a
+// CPU nunca espera a GPU por causa do feedback.
+class VirtualTextureFeedback
+{
+public:
+    // divisor: framebuffer de feedback com 1/divisor da resolução em cada eixo
+    explicit VirtualTextureFeedback(int divisor = 8);
+    ~VirtualTextureFeedback();
+
+    VirtualTextureFeedback(const VirtualTextureFeedback&) = delete;
+    VirtualTextureFeedback& operator=(const VirtualTextureFeedback&) = delete;
+
+    // Liga o framebuffer reduzido (recriado se a janela mudou de tamanho) e limpa
+    void begin(int width, int height);
+    // Copia para o PBO do quadro e volta ao framebuffer da janela
+    void end();
+    // Entrega os pedidos da leitura anterior, se a GPU já terminou, a
+    // textures[id]; devolve quantos pixels tinham pedido
+    size_t resolve(const std::vector<VirtualTexture*>& textures);
+
+    // Soma ao LOD no shader de feedback: as derivadas lá são divisor vezes maiores
+    float lodBias() const;
+
+private:
+    void create(int width, int height);
+    void destroy();
+
+    int divisor;
+    int windowWidth = 0, windowHeight = 0;
+    int width = 0, height = 0;
+    GLint viewport[4] = {};
+    GLuint fbo = 0, color = 0, depth = 0;
+    GLuint pbo[2] = {};
+    GLsync fences[2] = {};
+    int current = 0;
+    std::vector<uint64_t> unique;
+};
+
+#endif
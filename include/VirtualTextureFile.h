@@ -0,0 +1,82 @@
+// VirtualTextureFile.h
+#ifndef VIRTUAL_TEXTURE_FILE_H
+#define VIRTUAL_TEXTURE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BakedTexture.h"
+#include "MappedFile.h"
+
+// Mude ao alterar o layout do arquivo: arquivos antigos são ignorados
+const uint32_t kVirtualTextureVersion = 1;
+const uint32_t kVirtualTextureMaxLevels = 16;
+// Texels úteis por lado de cada página e borda copiada das vizinhas (para o bilinear)
+const uint32_t kVirtualTileSize = 128;
+const uint32_t kVirtualTileBorder = 4;
+
+struct VirtualTextureLevel
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t tilesX;
+    uint32_t tilesY;
+    // Primeira página do nível; as demais seguem linha a linha
+    uint64_t offset;
+};
+
+// Cabeçalho do .vtex: cada nível de mipmap cortado em páginas de
+// (tileSize + 2 * border)^2 texels RGBA, até o nível que cabe numa página só
+struct VirtualTextureHeader
+{
+    char magic[4];
+    uint32_t version;
+
+    // Chave da imagem de origem, como no .mips
+    uint64_t srcSize;
+    int64_t srcMtime;
+    uint64_t srcHash;
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint32_t border;
+    uint32_t levelCount;
+    uint32_t reserved;
+    VirtualTextureLevel levels[kVirtualTextureMaxLevels];
+};
+
+// Arquivo mapeado: as páginas são lidas sob demanda (a thread que copia a
+// página é a que espera o disco)
+struct VirtualTextureFile
+{
+    VirtualTextureHeader header = {};
+    MappedFile file;
+
+    uint32_t slotSize() const { return header.tileSize + 2 * header.border; }
+    size_t tileBytes() const { return size_t(slotSize()) * slotSize() * 4; }
+
+    const unsigned char* tileData(uint32_t level, uint32_t x, uint32_t y) const
+    {
+        const VirtualTextureLevel& l = header.levels[level];
+        size_t index = size_t(y) * l.tilesX + x;
+        return reinterpret_cast<const unsigned char*>(file.data + l.offset + index * tileBytes());
+    }
+};
+
+// Caminho ao lado da imagem ("Terreno.png" -> "Terreno.png.vtex")
+std::string virtualTexturePath(const std::string& imagePath);
+
+// Mapeia o .vtex. Falha (sem mensagem) se não existir, se a versão for outra
+// ou se a imagem mudou desde o bake.
+bool loadVirtualTextureFile(const std::string& imagePath, VirtualTextureFile& out);
+
+// Offline: corta a cadeia de mipmaps crua (generateMips, 3 ou 4 canais) em
+// páginas com borda, repetindo a imagem nas beiradas (GL_REPEAT), e grava o .vtex.
+// Só os níveis até o primeiro que cabe numa página entram no arquivo.
+bool writeVirtualTexture(const std::string& imagePath, int channels, const std::vector<MipLevel>& levels,
+                         uint32_t tileSize = kVirtualTileSize, uint32_t border = kVirtualTileBorder);
+
+#endif
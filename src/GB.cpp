@@ -9,39 +9,172 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "MeshCache.h"
+#include "BakedTexture.h"
+#include "VertexQuantize.h"
+#include "Meshlet.h"
+#include "AssetLoader.h"
+#include "TextureCache.h"
+#include "TextureAtlas.h"
+#include "VirtualTexture.h"
+#include "FileWatcher.h"
+#include "ShaderProgram.h"
+#include "FrameUniforms.h"
+#include "MaterialBuffer.h"
+#include "GLExtensions.h"
+#include "MeshArena.h"
+#include "PersistentRing.h"
+#include "FrustumCull.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include <map>
 #include <random>
 #include <algorithm>
+#include <memory>
+#include <sstream>
+#include <limits>
+#include <cstring>
 
 using namespace std;
 
-struct Geometry
+// Trecho da malha com um material (um usemtl do .obj); todos os trechos
+// compartilham o VAO/VBO/EBO da geometria e viram um draw de intervalo cada
+struct GeometrySubmesh
 {
-    GLuint VAO;
-    GLuint vertexCount;
-    GLuint textureID = 0;
-    string textureFilePath;
-    glm::vec3 position;
     glm::vec3 ka;
     glm::vec3 kd;
     glm::vec3 ks;
     glm::vec3 ke;
-    float scaleFactor = 0.4;
     float shininess = 32.0f;
+    // Nome do usemtl, para achar o material de novo quando o .mtl muda
+    string material;
+    // Vaga na tabela de materiais (MaterialBuffer); o draw só carrega esse índice
+    int materialIndex = -1;
+    GLuint textureID = 0;
+    // Referência no TextureCache, solta quando a geometria sai da cena
+    TextureHandle texture = nullptr;
+    string textureFilePath;
+    // Com texturas no atlas: camada e retângulo de uv
+    AtlasPlacement atlasPlacement;
+    // Índice da textura virtual (imagem com .vtex), -1 se usa textura comum
+    int virtualTexture = -1;
+    // Intervalo no EBO em cada LOD (ranges[0] = malha completa)
+    vector<IndexedSubmesh> ranges;
+    // Pedaços de até 64 vértices / 124 triângulos do LOD 0, descartados na CPU antes do draw
+    vector<Meshlet> meshlets;
 };
 
-struct Material
+struct Geometry
 {
-    glm::vec3 ka;
-    glm::vec3 kd;
-    glm::vec3 ks;
-    glm::vec3 ke;
-    float shininess;
-    string texturePath;
+    GLuint VAO;
+    // Buffers próprios da malha (0 se ela mora na arena) e os tamanhos deles: o hot
+    // reload reescreve no lugar se a malha nova tem os mesmos, senão troca e apaga
+    GLuint VBO = 0, EBO = 0;
+    size_t vertexBytes = 0, indexBytes = 0;
+    // Arquivos observados: .obj e .mtl (vazio se não há)
+    string path, mtlPath;
+    GLuint indexCount;
+    GLenum indexType;
+    glm::vec3 position;
+    float scaleFactor = 0.4;
+    // Um por material, ordenados pela textura para pular binds repetidos
+    vector<GeometrySubmesh> submeshes;
+    // Vértices no layout compacto: o shader reconstrói a posição com offset/scale
+    bool quantized = false;
+    bool halfUVs = false;
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    glm::vec3 positionScale = glm::vec3(1.0f);
+    // Níveis de detalhe no mesmo EBO (lods[0] = malha completa, ver MeshSimplify.h)
+    vector<MeshLod> lods;
+    int currentLod = 0;
+    // Caixa e esfera envolventes em espaço do objeto, tiradas da caixa do .meshcache;
+    // a esfera dá a distância da escolha do LOD e é o volume do descarte por frustum
+    glm::vec3 boundsMin = glm::vec3(0.0f), boundsMax = glm::vec3(0.0f);
+    glm::vec3 boundsCenter = glm::vec3(0.0f);
+    float boundsRadius = 0.0f;
+    GLuint indexSize = 4;
+    // false até o AssetLoader terminar o upload e o VAO existir
+    bool resident = false;
+    // Matriz do último draw, reaproveitada no passe de feedback
+    glm::mat4 model = glm::mat4(1.0f);
+    // Lugar da malha nos buffers compartilhados (MeshArena) quando o envio indireto
+    // pode desenhá-la: aí o VAO aponta para lá e não há VBO/EBO próprios
+    MeshSlice arenaSlice;
 };
 
+// Geometria em carregamento: decodeGeometry preenche os dados na CPU,
+// uploadGeometry cria VBO/EBO (se a malha não mora na arena) e texturas e
+// finishGeometry põe a malha na arena e cria o VAO
+struct GeometryLoad
+{
+    string path;
+    // Cache compartilhado por todas as geometrias da cena
+    TextureCache* textures = nullptr;
+    // Com textureBatching: atlas e vaga da geometria no buffer de dados por draw
+    TextureAtlas* atlas = nullptr;
+    GLuint drawBuffer = 0;
+    // Tabela de materiais da cena: o finish dá uma vaga a cada trecho
+    MaterialBuffer* materials = nullptr;
+    // Cópias no caminho (PathInstance), as mesmas para todas as geometrias
+    GLuint instanceBuffer = 0;
+    // VBO/EBO da cena inteira, [0] com índices de 16 bits e [1] de 32 (arenaIndex):
+    // o finish põe a malha na do tipo dela se arenaResident
+    MeshArena* arenas[2] = {};
+    // Decidido no decode: malhas que o envio indireto desenha (atlas, sem textura
+    // virtual) vão só para a arena, sem VBO/EBO próprios
+    bool arenaResident = false;
+    int drawSlot = 0;
+    // Imagens com .vtex (uma por trecho, vazia se não há): abertas no finish
+    // como textura virtual, no lugar do cache
+    vector<string> virtualTexturePaths;
+    std::vector<std::unique_ptr<VirtualTexture>>* virtualTextures = nullptr;
+    ThreadPool* pool = nullptr;
+    Geometry geom;
+    CachedMesh mesh;
+    QuantizedMesh packed;
+    vector<uint32_t> indices;
+    vector<uint16_t> shortIndices;
+    GLuint VBO = 0, EBO = 0;
+    // Hot reload: buffers da versão em cena. Com os mesmos tamanhos, o upload não
+    // cria buffers e o finish reescreve estes (inPlace), no mesmo passo da troca
+    GLuint previousVBO = 0, previousEBO = 0;
+    size_t previousVertexBytes = 0, previousIndexBytes = 0;
+    bool inPlace = false;
+};
+
+// Cópia de uma malha ao longo da curva, lida pelo vertex shader como atributo
+// por instância (divisor 1); a posição na curva sai do SSBO com os pontos
+struct PathInstance
+{
+    // xyz: desvio em torno do ponto da curva; w: escala da cópia
+    glm::vec4 offset;
+    // Posição inicial no caminho, em segmentos da curva
+    float start;
+};
+
+// Espelhos std430 dos buffers do envio indireto. DrawRecord: um por comando,
+// lido com gl_DrawID; SceneObject: um por objeto, reescrito a cada quadro
+struct DrawRecord
+{
+    GLuint materialIndex;
+    GLuint object;
+    GLuint padding[2];
+    AtlasPlacement atlas;
+};
+
+struct SceneObject
+{
+    glm::mat4 model;
+    // x: posição do objeto no caminho (pathTime); y: 1 se os uvs são half-float
+    glm::vec4 path;
+    // Decodificação da posição compacta (xyz; w sem uso)
+    glm::vec4 positionOffset;
+    glm::vec4 positionScale;
+};
+
+static_assert(sizeof(DrawRecord) == 48, "DrawRecord fora do layout std430");
+static_assert(sizeof(SceneObject) == 112, "SceneObject fora do layout std430");
+
 struct Camera
 {
     glm::vec3 Position;
@@ -99,90 +232,347 @@ struct Camera
     }
 };
 
+// Uniforms de cada programa, resolvidos uma vez depois do link (ShaderProgram.h);
+// o quadro só chama set, sem glGetUniformLocation
+struct PhongUniforms
+{
+    Uniform<glm::mat4> model;
+    Uniform<bool> quantized;
+    Uniform<glm::vec3> positionOffset, positionScale;
+    Uniform<int> colorBuffer, colorArray, pageTable, physicalCache;
+    Uniform<bool> textureArray, virtualTextured;
+    Uniform<bool> pathInstanced;
+    Uniform<float> pathTime;
+    Uniform<int> pathSegments;
+    Uniform<glm::vec4> vtSize, vtPhysical;
+
+    void resolve(const ShaderProgram& program)
+    {
+        model = program.uniform<glm::mat4>("model");
+        quantized = program.uniform<bool>("quantized");
+        positionOffset = program.uniform<glm::vec3>("positionOffset");
+        positionScale = program.uniform<glm::vec3>("positionScale");
+        colorBuffer = program.uniform<int>("colorBuffer");
+        colorArray = program.uniform<int>("colorArray");
+        pageTable = program.uniform<int>("pageTable");
+        physicalCache = program.uniform<int>("physicalCache");
+        textureArray = program.uniform<bool>("textureArray");
+        virtualTextured = program.uniform<bool>("virtualTextured");
+        pathInstanced = program.uniform<bool>("pathInstanced");
+        pathTime = program.uniform<float>("pathTime");
+        pathSegments = program.uniform<int>("pathSegments");
+        vtSize = program.uniform<glm::vec4>("vtSize");
+        vtPhysical = program.uniform<glm::vec4>("vtPhysical");
+    }
+};
+
+struct FeedbackUniforms
+{
+    Uniform<glm::mat4> model;
+    Uniform<bool> quantized;
+    Uniform<glm::vec3> positionOffset, positionScale;
+    Uniform<glm::vec4> vtSize;
+    Uniform<GLuint> vtId;
+    Uniform<float> lodBias;
+
+    void resolve(const ShaderProgram& program)
+    {
+        model = program.uniform<glm::mat4>("model");
+        quantized = program.uniform<bool>("quantized");
+        positionOffset = program.uniform<glm::vec3>("positionOffset");
+        positionScale = program.uniform<glm::vec3>("positionScale");
+        vtSize = program.uniform<glm::vec4>("vtSize");
+        vtId = program.uniform<GLuint>("vtId");
+        lodBias = program.uniform<float>("lodBias");
+    }
+};
+
+struct IndirectUniforms
+{
+    Uniform<bool> quantized;
+    Uniform<int> colorArray;
+    Uniform<bool> textureArray, virtualTextured;
+    Uniform<int> pathSegments;
+    Uniform<int> drawOffset;
+
+    void resolve(const ShaderProgram& program)
+    {
+        quantized = program.uniform<bool>("quantized");
+        drawOffset = program.uniform<int>("drawOffset");
+        colorArray = program.uniform<int>("colorArray");
+        textureArray = program.uniform<bool>("textureArray");
+        virtualTextured = program.uniform<bool>("virtualTextured");
+        pathSegments = program.uniform<int>("pathSegments");
+    }
+};
+
+struct CurveUniforms
+{
+    Uniform<glm::vec4> finalColor;
+
+    void resolve(const ShaderProgram& program)
+    {
+        finalColor = program.uniform<glm::vec4>("finalColor");
+    }
+};
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 void continous_key_press(GLFWwindow* window, Camera& camera, float currentTime);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
-int setupShader();
-int setupBackgroundShader();
-int setupCurveShader();
-Geometry setupGeometry(const char* filepath);
-bool loadObject(
-    const char* path,
-    std::vector<glm::vec3>& out_vertices,
-    std::vector<glm::vec2>& out_uvs,
-    std::vector<glm::vec3>& out_normals);
-int loadTexture(const string& path);
-Material loadMTL(const string& path);
-GLuint setupBg(GLuint& bgVAO, GLuint& bgVBO, const char* texturePath);
+bool decodeGeometry(GeometryLoad& load);
+bool uploadGeometry(GeometryLoad& load);
+void uploadMeshBuffers(GeometryLoad& load);
+void meshBufferData(const GeometryLoad& load, const void*& vertices, size_t& vertexBytes, const void*& indices, size_t& indexBytes);
+void finishGeometry(GeometryLoad& load);
+int arenaIndex(const Geometry& geom);
+GLuint createGeometryVAO(const Geometry& geom, const MeshArena* arena, GLuint drawBuffer, int drawSlot, GLuint instanceBuffer);
+const void* indexOffset(const Geometry& geom, GLuint firstIndex);
+GpuMaterial gpuMaterialOf(const GeometrySubmesh& submesh);
+int selectLod(const Geometry& geom, float scale, float distance, float pixelsPerUnit);
+void computeBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, Geometry& geom);
+void setupBg(GLuint& bgVAO, GLuint& bgVBO);
 vector<glm::vec3> generateControlPointsSet(int nPoints);
 vector<glm::vec3> generateControlPointsSet();
 std::vector<glm::vec3> generatePointsSet();
 std::vector<glm::vec3> generateBezierCurve(const std::vector<glm::vec3>& controlPoints, int numPoints);
+glm::vec3 pathPosition(const std::vector<glm::vec3>& curve, float t);
+std::vector<PathInstance> generatePathInstances(int count, float pathLength);
 
-const GLchar *vertexShaderSource = R"(
-	#version 400
+const GLchar *vertexShaderSource = "#version 460\n" FRAME_UNIFORMS_GLSL R"(
 	layout (location = 0) in vec3 position;
 	layout (location = 1) in vec2 tex_coord;
 	layout (location = 2) in vec3 normal;
+	// Dados por draw (divisor 1): retângulo de uv e camada no atlas (TextureAtlas.h)
+	layout (location = 3) in vec4 atlasRect;
+	layout (location = 4) in vec4 atlasLayer;
+	// Valor constante por draw (glVertexAttribI1ui): vaga na tabela de materiais
+	layout (location = 5) in uint materialIndex;
+	// Por instância: desvio + escala e posição inicial da cópia no caminho (PathInstance)
+	layout (location = 6) in vec4 instanceOffset;
+	layout (location = 7) in float instanceStart;
 	out vec2 texCoord;
 	out vec3 fragPos;
 	out vec3 fragNormal;
+	flat out vec4 texRect;
+	flat out vec4 texLayer;
+	flat out uint materialId;
 	uniform mat4 model;
-	uniform mat4 view;
-	uniform mat4 projection;
+	// Layout compacto (VertexQuantize.h): posição UNORM16 na caixa da malha, normal octaédrica
+	uniform bool quantized;
+	uniform vec3 positionOffset;
+	uniform vec3 positionScale;
+	// Cópias ao longo da curva: cada instância anda pelos pontos da curva a partir do seu início
+	layout (std430, binding = 1) readonly buffer PathPoints
+	{
+		vec4 pathPoints[];
+	};
+	uniform bool pathInstanced;
+	uniform float pathTime;
+	uniform int pathSegments;
+	vec3 octDecode(vec2 e)
+	{
+			vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+			float t = max(-n.z, 0.0);
+			n.x += n.x >= 0.0 ? -t : t;
+			n.y += n.y >= 0.0 ? -t : t;
+			return normalize(n);
+	}
 	void main()
 	{
-			vec4 worldPos = model * vec4(position, 1.0);
+			vec3 objPos = quantized ? positionOffset + position * positionScale : position;
+			vec3 objNormal = quantized ? octDecode(normal.xy) : normal;
+			mat4 world = model;
+			if (pathInstanced) {
+				float t = mod(pathTime + instanceStart, float(pathSegments));
+				int index = min(int(t), pathSegments - 1);
+				vec3 onPath = mix(pathPoints[index].xyz, pathPoints[index + 1].xyz, t - float(index));
+				mat4 placement = mat4(instanceOffset.w);
+				placement[3] = vec4(onPath + instanceOffset.xyz, 1.0);
+				world = placement * model;
+			}
+			vec4 worldPos = world * vec4(objPos, 1.0);
 			gl_Position = projection * view * worldPos;
 			texCoord = vec2(tex_coord.x, 1.0 - tex_coord.y);
 			fragPos = vec3(worldPos);
-			fragNormal = mat3(transpose(inverse(model))) * normal;
+			fragNormal = mat3(transpose(inverse(world))) * objNormal;
+			texRect = atlasRect;
+			texLayer = atlasLayer;
+			materialId = materialIndex;
 	}
 )";
 
-const GLchar *fragmentShaderSource = R"(
-	#version 400
+const GLchar *fragmentShaderSource = "#version 460\n" FRAME_UNIFORMS_GLSL MATERIAL_BUFFER_GLSL R"(
 	in vec3 fragNormal;
 	in vec3 fragPos;
 	in vec2 texCoord;
-	uniform vec3 ka;
-	uniform vec3 kd;
-	uniform vec3 ks;
-	uniform float q;
-	uniform vec3 lightPos;
-	uniform vec3 lightColor;
-	uniform vec3 cameraPos;
+	flat in vec4 texRect;
+	flat in vec4 texLayer;
+	flat in uint materialId;
 	uniform sampler2D colorBuffer;
+	// Texturas de todos os objetos num array só: camada texLayer.x, uv dentro de texRect
+	uniform bool textureArray;
+	uniform sampler2DArray colorArray;
+	// Textura virtual (VirtualTexture.h): tabela de páginas + cache físico das páginas residentes
+	uniform bool virtualTextured;
+	uniform usampler2D pageTable;
+	uniform sampler2D physicalCache;
+	uniform vec4 vtSize;      // largura, altura, texels por página, último nível
+	uniform vec4 vtPhysical;  // lado da vaga, borda, lado do cache físico
 	out vec4 color;
+	vec3 virtualColor(vec2 uv)
+	{
+		vec2 texel = uv * vtSize.xy;
+		vec2 dx = dFdx(texel);
+		vec2 dy = dFdy(texel);
+		float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy)));
+		int level = int(clamp(floor(lod), 0.0, vtSize.w));
+		vec2 wrapped = fract(uv) * vtSize.xy;
+		ivec2 tile = min(ivec2(wrapped / (vtSize.z * exp2(float(level)))), textureSize(pageTable, level) - 1);
+		// Página pedida ou o ancestral residente mais próximo; entry.z é o nível dela
+		uvec4 entry = texelFetch(pageTable, tile, level);
+		vec2 local = fract(wrapped / (vtSize.z * exp2(float(entry.z))));
+		vec2 physical = (vec2(entry.xy) * vtPhysical.x + vtPhysical.y + local * vtSize.z) / vtPhysical.z;
+		return textureLod(physicalCache, physical, 0.0).rgb;
+	}
 	void main()
 	{
+		Material material = materials[materialId];
+		vec3 ka = material.ka.rgb;
+		vec3 kd = material.kd.rgb;
+		vec3 ks = material.ks.rgb;
+		float q = material.ks.a;
+
 		vec3 N = normalize(fragNormal);
-		vec3 L = normalize(lightPos - fragPos);
 		vec3 V = normalize(cameraPos - fragPos);
-		vec3 R = reflect(-L, N);
-		float distance = length(lightPos - fragPos);
-		float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * distance * distance);
 
 		vec3 texColor = vec3(1.0); // fallback branco
+		if (virtualTextured) {
+			texColor = virtualColor(texCoord);
+		}
+		else if (textureArray) {
+			if (texLayer.x >= 0.0) {
+				// Wrap dentro do retângulo; em clamp, meio texel para dentro para o bilinear não sair dele
+				vec2 halfTexel = 0.5 / (texRect.xy * vec2(textureSize(colorArray, 0).xy));
+				vec2 local = texLayer.z > 0.5 ? fract(texCoord) : clamp(texCoord, halfTexel, 1.0 - halfTexel);
+				// LOD pelo uv contínuo (o fract criaria uma costura), limitado ao gutter do atlas
+				float lod = clamp(textureQueryLod(colorArray, texRect.zw + texCoord * texRect.xy).y, 0.0, texLayer.y);
+				texColor = textureLod(colorArray, vec3(texRect.zw + local * texRect.xy, texLayer.x), lod).rgb;
+			}
+		}
 		// Só usa a textura se a textura tem tamanho válido
-		if (textureSize(colorBuffer, 0).x > 0) {
+		else if (textureSize(colorBuffer, 0).x > 0) {
 			texColor = texture(colorBuffer, texCoord).rgb;
 		}
 
-		vec3 ambient  = ka * lightColor * texColor * 0.2;
-		float diff    = max(dot(N, L), 0.0);
-		vec3 diffuse  = diff * kd * lightColor * texColor * attenuation;
-		vec3 specular = vec3(0.0);
-		if (diff > 0.0) {
-			float spec = pow(max(dot(R, V), 0.0), q);
-			specular = spec * ks * lightColor * attenuation;
+		// Luzes do bloco Lights (FrameUniforms.h)
+		vec3 result = vec3(0.0);
+		for (int i = 0; i < lightCount; ++i) {
+			if (lights[i].position.w == 0.0) continue;
+			vec3 lightColor = lights[i].color.rgb;
+			vec3 L = normalize(lights[i].position.xyz - fragPos);
+			vec3 R = reflect(-L, N);
+			float distance = length(lights[i].position.xyz - fragPos);
+			vec3 k = lights[i].attenuation.xyz;
+			float attenuation = 1.0 / (k.x + k.y * distance + k.z * distance * distance);
+
+			vec3 ambient  = ka * lightColor * texColor * 0.2;
+			float diff    = max(dot(N, L), 0.0);
+			vec3 diffuse  = diff * kd * lightColor * texColor * attenuation;
+			vec3 specular = vec3(0.0);
+			if (diff > 0.0) {
+				float spec = pow(max(dot(R, V), 0.0), q);
+				specular = spec * ks * lightColor * attenuation;
+			}
+			result += ambient + diffuse + specular;
 		}
-		vec3 result = ambient + diffuse + specular;
 		color = vec4(result, 1.0);
 	}
 )";
 
+// Envio indireto: a cena inteira num glMultiDrawElementsIndirect sobre os buffers
+// compartilhados (MeshArena.h, no mesmo layout dos VBOs próprios). Tudo o que o loop passa por uniform
+// ou atributo constante vem do registro do draw (gl_DrawID) e do objeto dele
+const GLchar *indirectVertexShaderSource = "#version 460\n" FRAME_UNIFORMS_GLSL R"(
+	layout (location = 0) in vec3 position;
+	// uv como bits: float (layout de 8 floats), UNORM16 ou half-float, conforme a malha
+	layout (location = 1) in uvec2 packedUV;
+	layout (location = 2) in vec3 normal;
+	layout (location = 6) in vec4 instanceOffset;
+	layout (location = 7) in float instanceStart;
+	out vec2 texCoord;
+	out vec3 fragPos;
+	out vec3 fragNormal;
+	flat out vec4 texRect;
+	flat out vec4 texLayer;
+	flat out uint materialId;
+	struct DrawRecord
+	{
+		uvec4 ids;          // x: material, y: objeto
+		vec4 atlasRect;
+		vec4 atlasLayer;
+	};
+	layout (std430, binding = 2) readonly buffer DrawRecords
+	{
+		DrawRecord records[];
+	};
+	struct SceneObject
+	{
+		mat4 model;
+		vec4 path;          // x: posição no caminho, y: uv em half-float
+		vec4 positionOffset;
+		vec4 positionScale;
+	};
+	layout (std430, binding = 3) readonly buffer SceneObjects
+	{
+		SceneObject sceneObjects[];
+	};
+	layout (std430, binding = 1) readonly buffer PathPoints
+	{
+		vec4 pathPoints[];
+	};
+	uniform int pathSegments;
+	// Registro do primeiro comando deste glMultiDrawElementsIndirect (gl_DrawID recomeça em cada um)
+	uniform int drawOffset;
+	// Layout da arena: compacto (VertexQuantize.h) ou 8 floats, o mesmo para todas as malhas
+	uniform bool quantized;
+	vec3 octDecode(vec2 e)
+	{
+			vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+			float t = max(-n.z, 0.0);
+			n.x += n.x >= 0.0 ? -t : t;
+			n.y += n.y >= 0.0 ? -t : t;
+			return normalize(n);
+	}
+	vec2 decodeUV(uvec2 uv, bool halfUVs)
+	{
+			if (!quantized) return uintBitsToFloat(uv);
+			if (halfUVs) return unpackHalf2x16(uv.x | (uv.y << 16));
+			return vec2(uv) / 65535.0;
+	}
+	void main()
+	{
+			DrawRecord record = records[drawOffset + gl_DrawID];
+			SceneObject object = sceneObjects[record.ids.y];
+			float t = mod(object.path.x + instanceStart, float(pathSegments));
+			int index = min(int(t), pathSegments - 1);
+			vec3 onPath = mix(pathPoints[index].xyz, pathPoints[index + 1].xyz, t - float(index));
+			mat4 placement = mat4(instanceOffset.w);
+			placement[3] = vec4(onPath + instanceOffset.xyz, 1.0);
+			mat4 world = placement * object.model;
+			vec3 objPos = quantized ? object.positionOffset.xyz + position * object.positionScale.xyz : position;
+			vec3 objNormal = quantized ? octDecode(normal.xy) : normal;
+			vec2 uv = decodeUV(packedUV, object.path.y > 0.5);
+			vec4 worldPos = world * vec4(objPos, 1.0);
+			gl_Position = projection * view * worldPos;
+			texCoord = vec2(uv.x, 1.0 - uv.y);
+			fragPos = vec3(worldPos);
+			fragNormal = mat3(transpose(inverse(world))) * objNormal;
+			texRect = record.atlasRect;
+			texLayer = record.atlasLayer;
+			materialId = record.ids.x;
+	}
+)";
+
 const GLchar *bgVertexShader = R"(
 	#version 400
 	layout(location = 0) in vec2 aPos;
@@ -206,11 +596,8 @@ const GLchar *bgFragmentShader = R"(
 	}
 )";
 
-const GLchar *curveVertexShader = R"(
-	#version 400
+const GLchar *curveVertexShader = "#version 400\n" FRAME_UNIFORMS_GLSL R"(
 	layout (location = 0) in vec3 position;
-	uniform mat4 view;
-	uniform mat4 projection;
 	void main()
 	{
 			gl_Position = projection * view * vec4(position, 1.0);
@@ -227,6 +614,27 @@ const GLchar *curveFragmentShader = R"(
 	}
 )";
 
+// Passe de feedback da textura virtual: página e nível que cada pixel precisa
+const GLchar *feedbackFragmentShader = R"(
+	#version 460
+	in vec2 texCoord;
+	uniform vec4 vtSize;
+	uniform uint vtId;
+	uniform float lodBias;
+	out uvec4 feedback;
+	void main()
+	{
+			vec2 texel = texCoord * vtSize.xy;
+			vec2 dx = dFdx(texel);
+			vec2 dy = dFdy(texel);
+			float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + lodBias;
+			int level = int(clamp(floor(lod), 0.0, vtSize.w));
+			vec2 wrapped = fract(texCoord) * vtSize.xy;
+			uvec2 tile = uvec2(wrapped / (vtSize.z * exp2(float(level))));
+			feedback = uvec4(tile, uint(level), vtId + 1u);
+	}
+)";
+
 const GLuint WIDTH = 600, HEIGHT = 600;
 int selectedObject;
 std::map<int, glm::vec3> objectOffsets;   
@@ -234,8 +642,46 @@ std::map<int, float> objectScales;
 glm::vec3 tempOffset(0.0f);   
 float tempScaleOffset = 0.0f;
 bool rotateX=false, rotateY=false, rotateZ=false;
+// true = vértices de 16 bytes (VertexQuantize.h), false = 8 floats por vértice
+bool quantizedVertices = true;
+// true = texturas dos materiais num GL_TEXTURE_2D_ARRAY (TextureAtlas.h), ligado uma
+// vez por quadro; false = um GL_TEXTURE_2D por objeto, ligado antes de cada draw
+bool textureBatching = true;
+int textureBinds = 0;
+// Draws de intervalo no último quadro (um por material visível de cada objeto)
+int drawCalls = 0;
+// true = imagens com .vtex (objbake --virtual) viram texturas virtuais: só as
+// páginas visíveis ficam na VRAM, num cache de tamanho fixo
+bool virtualTexturing = true;
+// Descarte de meshlets por frustum e cone de normais (tecla M alterna)
+bool meshletCulling = true;
+MeshletCullStats meshletStats;
+// LOD pelo erro projetado na tela (tecla L alterna); limite em pixels e folga da histerese
+bool lodSelection = true;
+float lodPixelThreshold = 1.0f;
+float lodHysteresis = 0.25f;
+size_t lodTrianglesFull = 0, lodTrianglesDrawn = 0;
+// Cópias de cada malha ao longo da curva: tecla K passa por pathStressCopies;
+// tecla B troca o envio entre o loop por objeto (renderGeometry por cópia), o
+// instanciado (um draw por trecho para todas as cópias) e o indireto (um
+// glMultiDrawElementsIndirect para a cena inteira). Só o loop passa por
+// selectLod e pelo descarte de meshlets; os outros desenham o LOD 0 inteiro
+enum PathSubmission { PathLoop, PathInstanced, PathIndirect };
+PathSubmission pathSubmission = PathLoop;
+// false se o driver não deu glMultiDrawElementsIndirect: B só alterna os outros dois
+bool indirectAvailable = true;
+// true = câmera, luzes e objetos do envio indireto escritos no anel persistente
+// (PersistentRing.h, tecla R alterna); false = glBufferSubData nos buffers próprios
+bool persistentUpload = true;
+int pathStress = 0;
+const int pathStressCopies[] = { 1, 10000, 50000 };
+// Cópias fora do frustum da câmera ficam fora dos draws (tecla F alterna); contagem do último quadro
+bool frustumCulling = true;
+FrustumCullStats frustumStats;
+// Objetos decididos pela esfera de todas as cópias (inteira dentro ou fora, sem teste
+// nem envio por cópia) e os cortados por um plano, testados cópia a cópia
+int pathObjectsInside = 0, pathObjectsOutside = 0, pathObjectsSplit = 0;
 glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f);
-string mtlFilePath = "";
 glm::vec3 cameraPos   = glm::vec3(0.0f, 0.0f, 15.0f); 
 glm::vec3 ambientColor(0.4f), diffuseColor(0.2f), specularColor(1.5f), emissiveColor(1.0f);
 Camera camera(
@@ -254,6 +700,7 @@ float t = 0.0f;
 int main()
 {
     glfwInit();
+    double startTime = glfwGetTime();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -268,6 +715,10 @@ int main()
         std::cerr << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    // Funções da 4.3+ fora do glad 4.0 (GLExtensions.h)
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    indirectAvailable = glMultiDrawElementsIndirect != nullptr;
+    if (!indirectAvailable && pathSubmission == PathIndirect) pathSubmission = PathInstanced;
 
     std::cout << "Renderer: " << glGetString(GL_RENDERER) << std::endl;
     std::cout << "OpenGL version: " << glGetString(GL_VERSION) << std::endl;
@@ -276,47 +727,448 @@ int main()
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
 
-    GLuint shaderID = setupShader();
-    glUseProgram(shaderID);
+    // === Shaders ===
+    // Compilados, linkados e refletidos uma vez; apagados antes do glfwTerminate
+    std::unique_ptr<ShaderProgram> phong(new ShaderProgram);
+    std::unique_ptr<ShaderProgram> bgProgram(new ShaderProgram);
+    std::unique_ptr<ShaderProgram> curveProgram(new ShaderProgram);
+    std::unique_ptr<ShaderProgram> feedbackProgram(new ShaderProgram);
+    std::unique_ptr<ShaderProgram> indirectProgram(new ShaderProgram);
+    // O feedback usa o mesmo vertex shader dos objetos: a geometria cobre os mesmos pixels
+    if (!phong->build("phong", vertexShaderSource, fragmentShaderSource) ||
+        !bgProgram->build("background", bgVertexShader, bgFragmentShader) ||
+        !curveProgram->build("curve", curveVertexShader, curveFragmentShader) ||
+        !feedbackProgram->build("feedback", vertexShaderSource, feedbackFragmentShader) ||
+        !indirectProgram->build("indirect", indirectVertexShaderSource, fragmentShaderSource)) {
+        std::cerr << "Erro ao compilar os shaders" << std::endl;
+        return -1;
+    }
+    PhongUniforms phongUniforms;
+    phongUniforms.resolve(*phong);
+    FeedbackUniforms feedbackUniforms;
+    feedbackUniforms.resolve(*feedbackProgram);
+    CurveUniforms curveUniforms;
+    curveUniforms.resolve(*curveProgram);
+    IndirectUniforms indirectUniforms;
+    indirectUniforms.resolve(*indirectProgram);
+
+    // Câmera e luzes num UBO só, lido por todos os programas (FrameUniforms.h)
+    FrameUniforms::attach(*phong);
+    FrameUniforms::attach(*curveProgram);
+    FrameUniforms::attach(*feedbackProgram);
+    FrameUniforms::attach(*indirectProgram);
+    std::unique_ptr<FrameUniforms> frameUniforms(new FrameUniforms);
+    frameUniforms->lights.count = 1;
+    frameUniforms->lights.lights[0].position = glm::vec4(0.0f, 2.0f, 0.0f, 1.0f);
+    frameUniforms->lights.lights[0].color = glm::vec4(1.3f, 1.3f, 1.3f, 1.0f);
+    frameUniforms->lights.lights[0].attenuation = glm::vec4(1.0f, 0.09f, 0.032f, 0.0f);
+    // Dados que mudam a cada quadro: três seções, a CPU escreve o quadro N+2 enquanto a GPU lê o N
+    std::unique_ptr<PersistentRing> ring;
+    // (4 MB por seção: as cópias visíveis de 2 x 50000 cópias cabem)
+    if (glBufferStorage != nullptr) ring.reset(new PersistentRing(4 * 1024 * 1024));
+    phong->use();
+
+    // === Carregamento assíncrono ===
+    // Arquivos lidos no pool de threads e enviados à GPU por um contexto
+    // compartilhado; a cena desenha o que já estiver pronto
+    std::unique_ptr<AssetLoader> loader(new AssetLoader(window));
+    // Texturas compartilhadas por caminho e por conteúdo entre todos os assets;
+    // imagens sem .mips têm os mipmaps gerados no mesmo pool dos decodes
+    std::unique_ptr<TextureCache> textures(new TextureCache(&loader->pool()));
+    // Páginas de 1024: Suzanne.png ocupa uma camada inteira, Cube.png divide uma com outras texturas pequenas
+    std::unique_ptr<TextureAtlas> atlas(new TextureAtlas(1024));
+    // ka/kd/ks/q de todos os trechos num SSBO; cada draw leva só o índice
+    std::unique_ptr<MaterialBuffer> materials(new MaterialBuffer);
+    // Vértices e índices das malhas do envio indireto em buffers compartilhados, no layout
+    // dos VBOs próprios (16 bytes compactados ou 8 floats). Duas arenas: as malhas com
+    // índices de 16 bits não dobram o EBO por causa das de 32 (arenaIndex)
+    GLsizei arenaStride = quantizedVertices ? (GLsizei)sizeof(PackedVertex) : GLsizei(8 * sizeof(GLfloat));
+    std::unique_ptr<MeshArena> arenas[2] = {
+        std::unique_ptr<MeshArena>(new MeshArena(arenaStride, GL_UNSIGNED_SHORT)),
+        std::unique_ptr<MeshArena>(new MeshArena(arenaStride, GL_UNSIGNED_INT))
+    };
+    // Texturas virtuais abertas pelos finish, e o feedback que pede as páginas delas
+    std::vector<std::unique_ptr<VirtualTexture>> virtualTextures;
+    std::unique_ptr<VirtualTextureFeedback> feedback(new VirtualTextureFeedback(8));
 
 		// === Background ===
 		GLuint bgVAO, bgVBO;
-		GLuint bgTexture = setupBg(bgVAO, bgVBO, "D:/ComputacaoGrafica/RepoAulas/repo-prof/CGCCHibrido/assets/Modelos3D/floor.png");
-		if (bgTexture == 0) {
-			std::cerr << "Erro ao carregar textura background" << std::endl;
-			return -1;
-		}
-
-		GLuint bgShaderID = setupBackgroundShader();
-		if (bgShaderID == 0) {
-			std::cerr << "Erro ao compilar shader background" << std::endl;
-			return -1;
-		}
+		setupBg(bgVAO, bgVBO);
+		GLuint bgTexture = 0;
+		TextureHandle bgHandle = nullptr;
+		auto bgUploaded = std::make_shared<GLuint>(0);
+		string bgPath = "D:/ComputacaoGrafica/RepoAulas/repo-prof/CGCCHibrido/assets/Modelos3D/floor.png";
+		TextureParams bgParams;
+		bgParams.wrap = GL_CLAMP_TO_EDGE;
+		TextureCache* cache = textures.get();
+		loader->submit({ "background",
+			[cache, bgPath, bgParams, &bgHandle]() { bgHandle = cache->acquire(bgPath, bgParams); return bgHandle != nullptr; },
+			[cache, bgUploaded, &bgHandle]() { *bgUploaded = cache->upload(bgHandle); return true; },
+			[bgUploaded, &bgTexture]() { bgTexture = *bgUploaded; } });
+
+		bgProgram->use();
+		bgProgram->uniform<int>("background").set(0);
+		phong->use();
 
     // === Geometrias ===
-		std::vector<Geometry> objects;
-
-    Geometry suzzane = setupGeometry("D:/ComputacaoGrafica/RepoAulas/repo-prof/CGCCHibrido/assets/Modelos3D/SuzanneSubdiv1.obj");
-		Geometry cube = setupGeometry("D:/ComputacaoGrafica/RepoAulas/repo-prof/CGCCHibrido/assets/Modelos3D/Cube.obj");
-
-		objects = { suzzane, cube };
-
-    // === Uniform Locations ===
-    GLint modelLoc = glGetUniformLocation(shaderID, "model");
-    GLint viewLoc  = glGetUniformLocation(shaderID, "view");
-    GLint projLoc  = glGetUniformLocation(shaderID, "projection");
+		// Vagas fixas: o finish de cada modelo grava na sua quando ele fica residente
+		const char* modelPaths[] = {
+			"D:/ComputacaoGrafica/RepoAulas/repo-prof/CGCCHibrido/assets/Modelos3D/SuzanneSubdiv1.obj",
+			"D:/ComputacaoGrafica/RepoAulas/repo-prof/CGCCHibrido/assets/Modelos3D/Cube.obj"
+		};
+		std::vector<Geometry> objects(2);
+
+		// Dados de textura por draw, uma vaga por objeto; sem textura até o finish gravar a vaga
+		GLuint drawBuffer;
+		std::vector<AtlasPlacement> emptyPlacements(objects.size());
+		glGenBuffers(1, &drawBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, drawBuffer);
+		glBufferData(GL_ARRAY_BUFFER, emptyPlacements.size() * sizeof(AtlasPlacement), emptyPlacements.data(), GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		// Cópias no caminho: o VAO de cada geometria aponta para este buffer (atributos 6 e 7),
+		// preenchido junto com a curva e refeito quando a tecla K muda a quantidade
+		GLuint pathInstanceBuffer;
+		glGenBuffers(1, &pathInstanceBuffer);
+
+		// Muda a cada geometria que entra ou é recarregada e a cada textura que muda de
+		// lugar no atlas: só então os comandos indiretos são refeitos
+		int sceneRevision = 0;
+
+		// === Hot reload ===
+		// .obj/.mtl/imagens alterados no disco voltam pelo mesmo AssetLoader;
+		// a versão em cena continua sendo desenhada até o finish da nova
+		FileWatcher watcher;
+		watcher.watch(bgPath);
+		// Por objeto: recarga no loader, e outra pedida enquanto ela não terminou
+		std::vector<AssetHandle> geometryJobs(objects.size());
+		std::vector<bool> reloading(objects.size(), false), reloadQueued(objects.size(), false);
+
+		auto submitGeometry = [&](size_t i) {
+			auto load = std::make_shared<GeometryLoad>();
+			load->path = modelPaths[i];
+			load->textures = cache;
+			load->atlas = atlas.get();
+			load->drawBuffer = drawBuffer;
+			load->drawSlot = (int)i;
+			load->materials = materials.get();
+			load->instanceBuffer = pathInstanceBuffer;
+			load->arenas[0] = arenas[0].get();
+			load->arenas[1] = arenas[1].get();
+			load->virtualTextures = &virtualTextures;
+			load->pool = &loader->pool();
+			if (objects[i].resident) {
+				load->previousVBO = objects[i].VBO;
+				load->previousEBO = objects[i].EBO;
+				load->previousVertexBytes = objects[i].vertexBytes;
+				load->previousIndexBytes = objects[i].indexBytes;
+			}
+			reloading[i] = true;
+			geometryJobs[i] = loader->submit({ load->path,
+				[load]() { return decodeGeometry(*load); },
+				[load]() { return uploadGeometry(*load); },
+				[load, &objects, &reloading, &watcher, &materials, &arenas, &sceneRevision, cache, i]() {
+					finishGeometry(*load);
+					// Troca num passo só, entre dois quadros: a versão em cena é desenhada
+					// com os buffers dela até aqui; o finish acabou de reescrevê-los (mesmo
+					// tamanho) ou eles são apagados agora
+					Geometry previous = objects[i];
+					objects[i] = load->geom;
+					reloading[i] = false;
+					++sceneRevision;
+					if (previous.resident) {
+						glDeleteVertexArrays(1, &previous.VAO);
+						if (previous.arenaSlice.valid()) arenas[arenaIndex(previous)]->release(previous.arenaSlice);
+						if (previous.VBO != objects[i].VBO) glDeleteBuffers(1, &previous.VBO);
+						if (previous.EBO != objects[i].EBO) glDeleteBuffers(1, &previous.EBO);
+						for (const GeometrySubmesh& submesh : previous.submeshes) {
+							cache->release(submesh.texture);
+							materials->release(submesh.materialIndex);
+						}
+					}
+					watcher.watch(objects[i].path);
+					if (!objects[i].mtlPath.empty()) watcher.watch(objects[i].mtlPath);
+					for (const GeometrySubmesh& submesh : objects[i].submeshes) {
+						if (!submesh.textureFilePath.empty()) watcher.watch(submesh.textureFilePath);
+					}
+				} });
+		};
+		for (size_t i = 0; i < objects.size(); ++i) submitGeometry(i);
+
+		// .mtl alterado: só o .mtl é lido de novo; com o mesmo map_Kd, as cores mudam sem tocar nos buffers
+		auto reloadMaterials = [&](size_t i) {
+			auto library = std::make_shared<std::vector<ObjMaterial>>();
+			string mtlPath = objects[i].mtlPath;
+			loader->submit({ mtlPath,
+				[library, mtlPath]() { return parseMtlLibrary(mtlPath.c_str(), *library); },
+				nullptr,
+				[library, &objects, &reloadQueued, &materials, i]() {
+					Geometry& geom = objects[i];
+					string basePath = geom.path.substr(0, geom.path.find_last_of("/"));
+					for (GeometrySubmesh& submesh : geom.submeshes) {
+						const ObjMaterial* mat = findMaterial(*library, submesh.material);
+						if (!mat) continue;
+						// Outra imagem no material: a geometria inteira é refeita com a textura nova
+						string texturePath = mat->diffuseMap.empty() ? string() : basePath + "/" + mat->diffuseMap;
+						if (texturePath != submesh.textureFilePath) reloadQueued[i] = true;
+						submesh.ka = mat->ka;
+						submesh.kd = mat->kd;
+						submesh.ks = mat->ks;
+						submesh.ke = mat->ke;
+						submesh.shininess = mat->shininess;
+						materials->set(submesh.materialIndex, gpuMaterialOf(submesh));
+					}
+				} });
+		};
+
+		// Imagem alterada: decode no pool, texels reescritos na mesma textura
+		// (ou no mesmo lugar do atlas) quando o tamanho não mudou
+		auto reloadTexture = [&](const string& path) {
+			auto changed = std::make_shared<std::vector<TextureHandle>>();
+			loader->submit({ path,
+				[cache, path]() { return cache->decodeReload(path); },
+				[cache, changed]() { *changed = cache->commitReloads(); return true; },
+				[&, changed]() {
+					if (textureBatching) {
+						std::vector<TextureHandle> placed = textures->commitReloads(atlas.get());
+						changed->insert(changed->end(), placed.begin(), placed.end());
+					}
+					auto reloaded = [&](TextureHandle handle) {
+						return handle && std::find(changed->begin(), changed->end(), handle) != changed->end();
+					};
+					for (size_t i = 0; i < objects.size(); ++i) {
+						Geometry& geom = objects[i];
+						for (GeometrySubmesh& submesh : geom.submeshes) {
+							if (!reloaded(submesh.texture)) continue;
+							if (!textureBatching) {
+								submesh.textureID = textures->upload(submesh.texture);
+								continue;
+							}
+							submesh.atlasPlacement = textures->place(submesh.texture, *atlas);
+							if (geom.submeshes.size() == 1) {
+								glBindBuffer(GL_ARRAY_BUFFER, drawBuffer);
+								glBufferSubData(GL_ARRAY_BUFFER, GLintptr(i * sizeof(AtlasPlacement)), sizeof(AtlasPlacement), &submesh.atlasPlacement);
+								glBindBuffer(GL_ARRAY_BUFFER, 0);
+							}
+						}
+					}
+					if (reloaded(bgHandle)) bgTexture = textures->upload(bgHandle);
+					++sceneRevision;
+					// Nenhuma geometria aponta mais para os ids antigos
+					textures->deleteRetired();
+				} });
+		};
 
     // === Matriz de projeção inicial ===
     glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / height, 0.1f, 100.0f);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+    frameUniforms->frame.projection = projection;
+
+    // Unidades fixas: sampler2D e sampler2DArray não podem dividir a mesma unidade
+    phongUniforms.colorBuffer.set(0);
+    phongUniforms.colorArray.set(1);
+    phongUniforms.textureArray.set(textureBatching);
+    phongUniforms.pageTable.set(2);
+    phongUniforms.physicalCache.set(3);
+    indirectProgram->use();
+    indirectUniforms.quantized.set(quantizedVertices);
+    indirectUniforms.colorArray.set(1);
+    indirectUniforms.textureArray.set(textureBatching);
+    indirectUniforms.virtualTextured.set(false);
+    phong->use();
 
 		// === Curva parametrica
 		std::vector<glm::vec3> controlPoints = generatePointsSet();
 		std::vector<glm::vec3> bezierCurve = generateBezierCurve(controlPoints, 100);
 
-		GLuint curveShaderID = setupCurveShader();
 		std::vector<glm::vec3> curvePoints = generatePointsSet();
 
+		// Pontos da curva num SSBO (vec4 no std430), lidos pelas cópias instanciadas
+		std::vector<glm::vec4> pathPoints;
+		for (const glm::vec3& point : bezierCurve) pathPoints.push_back(glm::vec4(point, 1.0f));
+		GLuint pathPointBuffer;
+		glGenBuffers(1, &pathPointBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, pathPointBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, pathPoints.size() * sizeof(glm::vec4), pathPoints.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, pathPointBuffer);
+		phongUniforms.pathSegments.set((int)bezierCurve.size() - 1);
+		indirectProgram->use();
+		indirectUniforms.pathSegments.set((int)bezierCurve.size() - 1);
+		phong->use();
+
+		// Esfera que contém a curva inteira (os trechos entre os pontos também)
+		glm::vec3 pathLow = bezierCurve[0], pathHigh = bezierCurve[0];
+		for (const glm::vec3& point : bezierCurve) {
+			pathLow = glm::min(pathLow, point);
+			pathHigh = glm::max(pathHigh, point);
+		}
+		glm::vec3 pathCenter = 0.5f * (pathLow + pathHigh);
+		float pathRadius = 0.0f;
+		for (const glm::vec3& point : bezierCurve) pathRadius = std::max(pathRadius, glm::length(point - pathCenter));
+
+		// Todas as cópias, na CPU para o descarte e no pathInstanceBuffer para os draws sem ele;
+		// maior desvio e maior escala entre elas, para a esfera que envolve todas
+		int pathCopies = 0;
+		std::vector<PathInstance> pathInstances;
+		float copyReach = 0.0f, copyMaxScale = 0.0f;
+		auto resizePath = [&](int copies) {
+			pathInstances = generatePathInstances(copies, (float)bezierCurve.size() - 1);
+			glBindBuffer(GL_ARRAY_BUFFER, pathInstanceBuffer);
+			glBufferData(GL_ARRAY_BUFFER, pathInstances.size() * sizeof(PathInstance), pathInstances.data(), GL_STATIC_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			copyReach = copyMaxScale = 0.0f;
+			for (const PathInstance& copy : pathInstances) {
+				copyReach = std::max(copyReach, glm::length(glm::vec3(copy.offset)));
+				copyMaxScale = std::max(copyMaxScale, copy.offset.w);
+			}
+			pathCopies = copies;
+		};
+		resizePath(1);
+
+		// Tempo médio do quadro e da CPU nos draws da cena, por modo de envio (PathSubmission)
+		struct PathTiming { double frame = 0.0, cpu = 0.0; int frames = 0; double lastFrame = 0.0, lastCpu = 0.0; };
+		PathTiming pathTiming[3];
+
+		// === Envio indireto ===
+		// Um VAO sobre os buffers de cada MeshArena (refeito, com os VAOs das geometrias
+		// que moram nela, quando ela cresce), comandos
+		// e registros por draw refeitos só quando a cena muda, e um SceneObject por
+		// objeto reescrito a cada quadro: o custo na CPU não depende das cópias
+		GLuint arenaVAO[2] = { 0, 0 };
+		int arenaGeneration[2] = { -1, -1 };
+		GLuint commandBuffer, drawRecordBuffer, sceneObjectBuffer;
+		glGenBuffers(1, &commandBuffer);
+		glGenBuffers(1, &drawRecordBuffer);
+		glGenBuffers(1, &sceneObjectBuffer);
+		std::vector<SceneObject> sceneObjects(objects.size());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, sceneObjectBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sceneObjects.size() * sizeof(SceneObject), NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, sceneObjectBuffer);
+		GLsizei commandCount = 0;
+		// sceneRevision dos comandos atuais; -1: nunca montados
+		int commandRevision = -1;
+		// Comandos montados e o objeto de cada um: instanceCount/baseInstance mudam a cada
+		// quadro com as cópias visíveis
+		std::vector<DrawElementsIndirectCommand> indirectCommands;
+		std::vector<int> commandObjects;
+		// Objetos que o envio indireto desenha (os outros voltam para renderInstanced)
+		std::vector<bool> drawnIndirect(objects.size(), false);
+		auto drawsIndirect = [&](const Geometry& geom) {
+			// Texturas virtuais e texturas soltas (sem atlas) precisam de binds por trecho
+			if (!geom.resident || !geom.arenaSlice.valid() || !textureBatching) return false;
+			for (const GeometrySubmesh& submesh : geom.submeshes) {
+				if (submesh.virtualTexture >= 0) return false;
+			}
+			return true;
+		};
+		auto rebuildArenaVAO = [&](int k) {
+			const MeshArena& arena = *arenas[k];
+			if (arenaVAO[k]) glDeleteVertexArrays(1, &arenaVAO[k]);
+			glGenVertexArrays(1, &arenaVAO[k]);
+			glBindVertexArray(arenaVAO[k]);
+			glBindBuffer(GL_ARRAY_BUFFER, arena.vertexBuffer());
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.indexBuffer());
+			// O uv entra como bits (glVertexAttribIPointer): half ou UNORM16 muda de malha
+			// para malha e o shader decodifica pelo SceneObject
+			if (quantizedVertices) {
+				glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, arenaStride, (GLvoid*)offsetof(PackedVertex, position));
+				glVertexAttribIPointer(1, 2, GL_UNSIGNED_SHORT, arenaStride, (GLvoid*)offsetof(PackedVertex, uv));
+				glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, arenaStride, (GLvoid*)offsetof(PackedVertex, normal));
+			}
+			else {
+				glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, arenaStride, (GLvoid*)0);
+				glVertexAttribIPointer(1, 2, GL_UNSIGNED_INT, arenaStride, (GLvoid*)(3 * sizeof(GLfloat)));
+				glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, arenaStride, (GLvoid*)(5 * sizeof(GLfloat)));
+			}
+			glEnableVertexAttribArray(0);
+			glEnableVertexAttribArray(1);
+			glEnableVertexAttribArray(2);
+			// Cópias no caminho: baseInstance 0, a instância i lê a PathInstance i
+			glBindBuffer(GL_ARRAY_BUFFER, pathInstanceBuffer);
+			glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(PathInstance), (GLvoid*)offsetof(PathInstance, offset));
+			glEnableVertexAttribArray(6);
+			glVertexAttribDivisor(6, 1);
+			glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, sizeof(PathInstance), (GLvoid*)offsetof(PathInstance, start));
+			glEnableVertexAttribArray(7);
+			glVertexAttribDivisor(7, 1);
+			glBindVertexArray(0);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+			// Os VAOs das geometrias na arena ainda apontam para os buffers trocados
+			for (size_t i = 0; i < objects.size(); ++i) {
+				Geometry& geom = objects[i];
+				if (!geom.resident || !geom.arenaSlice.valid() || arenaIndex(geom) != k) continue;
+				glDeleteVertexArrays(1, &geom.VAO);
+				geom.VAO = createGeometryVAO(geom, &arena, drawBuffer, (int)i, pathInstanceBuffer);
+			}
+			arenaGeneration[k] = arena.generation();
+		};
+		// Um comando por trecho (LOD 0) de cada objeto desenhado, as cópias como instâncias;
+		// primeiro os da arena de 16 bits, depois os da de 32 (um draw por tipo de índice)
+		auto rebuildCommands = [&]() {
+			std::vector<DrawElementsIndirectCommand>& commands = indirectCommands;
+			std::vector<DrawRecord> records;
+			commands.clear();
+			commandObjects.clear();
+			for (size_t n = 0; n < 2 * objects.size(); ++n) {
+				size_t i = n % objects.size();
+				const Geometry& geom = objects[i];
+				drawnIndirect[i] = drawsIndirect(geom);
+				if (!drawnIndirect[i] || arenaIndex(geom) != int(n / objects.size())) continue;
+				for (const GeometrySubmesh& submesh : geom.submeshes) {
+					const IndexedSubmesh& range = submesh.ranges[0];
+					if (range.indexCount == 0) continue;
+					DrawElementsIndirectCommand command;
+					command.count = range.indexCount;
+					command.instanceCount = (GLuint)pathCopies;
+					command.firstIndex = geom.arenaSlice.firstIndex + range.firstIndex;
+					command.baseVertex = geom.arenaSlice.baseVertex;
+					command.baseInstance = 0;
+					commands.push_back(command);
+					commandObjects.push_back((int)i);
+					DrawRecord record = {};
+					record.materialIndex = (GLuint)submesh.materialIndex;
+					record.object = (GLuint)i;
+					record.atlas = submesh.atlasPlacement;
+					records.push_back(record);
+				}
+			}
+			commandCount = (GLsizei)commands.size();
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+			glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STATIC_DRAW);
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawRecordBuffer);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, records.size() * sizeof(DrawRecord), records.data(), GL_STATIC_DRAW);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawRecordBuffer);
+			commandRevision = sceneRevision;
+		};
+
+		// === Descarte por frustum ===
+		// Primeiro uma esfera com todas as cópias de cada objeto: inteira dentro ou fora,
+		// as cópias são lidas direto do pathInstanceBuffer (copiesInPlace). Só um objeto
+		// cortado por um plano ganha uma esfera por cópia; as visíveis dele ficam seguidas
+		// em visibleInstances (copyFirst/copyCount) e o VAO passa a ler as cópias de lá
+		SphereSet copySpheres;
+		std::vector<uint32_t> visibleCopies;
+		std::vector<PathInstance> visibleInstances;
+		std::vector<int> copyFirst(objects.size(), 0), copyCount(objects.size(), 0);
+		std::vector<bool> copiesInPlace(objects.size(), true);
+		std::vector<float> pathTimes(objects.size(), 0.0f);
+		// Cópias visíveis quando o anel está desligado ou cheio (orphaning a cada quadro)
+		GLuint visibleInstanceBuffer;
+		glGenBuffers(1, &visibleInstanceBuffer);
+		// Atributos 6 e 7 (PathInstance por instância) de um VAO apontados para outro buffer
+		auto pointInstances = [&](GLuint vao, GLuint buffer, GLintptr offset) {
+			glBindVertexArray(vao);
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(PathInstance), (GLvoid*)(offset + offsetof(PathInstance, offset)));
+			glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, sizeof(PathInstance), (GLvoid*)(offset + offsetof(PathInstance, start)));
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glBindVertexArray(0);
+		};
+
 		GLuint curveVAO, curveVBO;
 		glGenVertexArrays(1, &curveVAO);
 		glGenBuffers(1, &curveVBO);
@@ -346,32 +1198,124 @@ int main()
 				glfwPollEvents();
 				continous_key_press(window, camera, deltaTime);
 
+				// Assets cujo upload terminou entram na cena neste quadro
+				loader->poll();
+				for (int k = 0; k < 2; ++k) {
+					if (arenaGeneration[k] != arenas[k]->generation()) rebuildArenaVAO(k);
+				}
+
+				// Hot reload: só o arquivo que mudou é lido de novo, fora desta thread
+				for (const string& changedPath : watcher.poll()) {
+					bool texture = changedPath == bgPath;
+					for (size_t i = 0; i < objects.size(); ++i) {
+						const Geometry& geom = objects[i];
+						if (changedPath == geom.path) reloadQueued[i] = true;
+						else if (changedPath == geom.mtlPath) reloadMaterials(i);
+						for (const GeometrySubmesh& submesh : geom.submeshes) {
+							if (changedPath != submesh.textureFilePath) continue;
+							if (submesh.virtualTexture >= 0) std::cout << "Textura virtual " << changedPath << " mudou: rode o objbake para refazer o .vtex" << std::endl;
+							else texture = true;
+						}
+					}
+					std::cout << "Recarregando " << changedPath << std::endl;
+					if (texture) reloadTexture(changedPath);
+				}
+				for (size_t i = 0; i < objects.size(); ++i) {
+					// Decode falhou (arquivo ainda pela metade, .obj inválido): a versão em cena fica
+					if (reloading[i] && loader->state(geometryJobs[i]) == AssetState::Failed) reloading[i] = false;
+					if (reloadQueued[i] && !reloading[i] && objects[i].resident) {
+						reloadQueued[i] = false;
+						submitGeometry(i);
+					}
+				}
+
+				// Páginas pedidas pelo feedback do quadro anterior: leitura no pool, envio aqui
+				std::vector<VirtualTexture*> virtualList;
+				for (const auto& vt : virtualTextures) virtualList.push_back(vt.get());
+				if (!virtualList.empty()) {
+					feedback->resolve(virtualList);
+					for (VirtualTexture* vt : virtualList) vt->update();
+				}
+
+				// Resumo do cache de texturas quando o último asset termina
+				static bool texturesReported = false;
+				if (!texturesReported && loader->pending() == 0) {
+					texturesReported = true;
+					TextureCacheStats stats = textures->stats();
+					std::cout << "Texturas: " << stats.requests << " pedidos, " << stats.decodes << " decodificadas ("
+					          << stats.pathHits << " evitadas pelo caminho, " << stats.contentHits << " imagens repetidas), "
+					          << stats.textures << " na GPU (" << stats.bytesResident / 1024.0 << " KB), "
+					          << stats.bytesSaved / 1024.0 << " KB economizados" << std::endl;
+					if (textureBatching) {
+						TextureAtlasStats atlasStats = atlas->stats();
+						std::cout << "Atlas: " << atlasStats.entries << " texturas em " << atlasStats.pages << " paginas de "
+						          << atlas->pageSize() << "x" << atlas->pageSize() << " (" << atlasStats.wholePages << " inteiras, "
+						          << atlasStats.packed << " divididas, " << atlasStats.downscaled << " reduzidas), ocupacao "
+						          << atlasStats.fill * 100.0f << "%, " << atlasStats.bytes / (1024.0 * 1024.0) << " MB" << std::endl;
+					}
+				}
+
 				// === Limpa a tela (ANTES de desenhar) ===
 				glClearColor(0.05f, 0.05f, 0.1f, 1.0f);
 				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 				// === Renderiza background ===
 				glDisable(GL_DEPTH_TEST);
-				glUseProgram(bgShaderID);
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, bgTexture);
-				GLint loc = glGetUniformLocation(bgShaderID, "background");
-				glBindVertexArray(bgVAO);
-				glDrawArrays(GL_TRIANGLES, 0, 6);
-				glBindVertexArray(0);
+				if (bgTexture != 0) {
+					bgProgram->use();
+					glActiveTexture(GL_TEXTURE0);
+					glBindTexture(GL_TEXTURE_2D, bgTexture);
+					glBindVertexArray(bgVAO);
+					glDrawArrays(GL_TRIANGLES, 0, 6);
+					glBindVertexArray(0);
+				}
 
 				// === Renderiza objetos 3D ===
-				glUseProgram(shaderID);
+				phong->use();
+
+				// Seção do anel deste quadro; a espera pela GPU (se houver) acontece aqui
+				bool ringFrame = ring && persistentUpload;
+				if (ringFrame) ring->beginFrame();
 
+				// Câmera do quadro: um envio para todos os programas
 				glm::mat4 view = camera.GetViewMatrix();
-				glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+				frameUniforms->frame.view = view;
+				frameUniforms->frame.cameraPos = camera.Position;
+				frameUniforms->frame.time = currentFrame;
+				if (ringFrame) {
+					frameUniforms->upload(ring->buffer(), ring->allocate(sizeof(FrameBlock), ring->bindAlignment()),
+					                      ring->allocate(sizeof(LightsBlock), ring->bindAlignment()));
+				}
+				else {
+					frameUniforms->upload();
+				}
+
+				// Materiais novos ou alterados (finish, .mtl recarregado) num envio só
+				materials->upload();
+
+				// Um bind para todos os objetos; cada draw escolhe a camada pelo atributo por draw
+				if (textureBatching) {
+					glActiveTexture(GL_TEXTURE1);
+					glBindTexture(GL_TEXTURE_2D_ARRAY, atlas->texture());
+					++textureBinds;
+				}
+
+				// Texturas ligadas por último, para pular binds repetidos entre os trechos
+				GLuint boundTexture = 0;
+				int boundVirtualTexture = -1;
 
-				auto renderGeometry = [&](const Geometry& geom, int geomId) {
+				// Intervalos visíveis do quadro (reaproveitados entre as malhas)
+				std::vector<MeshletRange> visibleRanges;
+				std::vector<GLsizei> rangeCounts;
+				std::vector<const void*> rangeOffsets;
+
+				// Transformação própria do objeto (teclas W/A/S/D, I/J e X/Y/Z), sem a posição na curva
+				auto objectTransform = [&](const Geometry& geom, int geomId, float& scale) {
 						glm::mat4 model = glm::mat4(1.0f);
 				
-						// Recupera posição e escala
-						glm::vec3 position = geom.position;
-						float scale = geom.scaleFactor;
+						// Recupera deslocamento e escala
+						glm::vec3 position = glm::vec3(0.0f);
+						scale = geom.scaleFactor;
 				
 						if (objectOffsets.count(geomId)) {
 								position += objectOffsets[geomId];
@@ -392,78 +1336,487 @@ int main()
 								else if (rotateY) model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
 								else if (rotateZ) model = glm::rotate(model, angle, glm::vec3(0.0f, 0.0f, 1.0f));
 						}
+						return model;
+				};
+
+				// Material e texturas de um trecho; trechos ordenados pela textura: a mesma só é ligada uma vez seguida
+				auto bindSubmesh = [&](const Geometry& geom, const GeometrySubmesh& submesh) {
+						// Material: só o índice na tabela, lido pelo fragment shader
+						glVertexAttribI1ui(5, (GLuint)submesh.materialIndex);
+
+						// Aplica textura se houver (no atlas, a camada já vem do atributo por draw)
+						phongUniforms.virtualTextured.set(submesh.virtualTexture >= 0);
+						if (submesh.virtualTexture >= 0) {
+								const VirtualTexture& vt = *virtualTextures[submesh.virtualTexture];
+								if (boundVirtualTexture != submesh.virtualTexture) {
+										glActiveTexture(GL_TEXTURE2);
+										glBindTexture(GL_TEXTURE_2D, vt.pageTable());
+										glActiveTexture(GL_TEXTURE3);
+										glBindTexture(GL_TEXTURE_2D, vt.physical());
+										boundVirtualTexture = submesh.virtualTexture;
+										textureBinds += 2;
+								}
+								phongUniforms.vtSize.set(vt.sizeInfo());
+								phongUniforms.vtPhysical.set(vt.physicalInfo());
+						}
+						else if (!textureBatching && submesh.textureID > 0 && boundTexture != submesh.textureID) {
+								glActiveTexture(GL_TEXTURE0);
+								glBindTexture(GL_TEXTURE_2D, submesh.textureID);
+								boundTexture = submesh.textureID;
+								++textureBinds;
+						}
+						if (textureBatching && geom.submeshes.size() > 1) {
+								// Vários materiais: o atributo vem do valor constante, não do buffer por draw
+								glVertexAttrib4fv(3, glm::value_ptr(submesh.atlasPlacement.uvRect));
+								glVertexAttrib4fv(4, &submesh.atlasPlacement.layer);
+						}
+				};
+
+				// Um objeto: posição na curva (placement) vezes a transformação própria
+				auto renderGeometry = [&](Geometry& geom, int geomId, const glm::mat4& placement, float placementScale) {
+						float scale;
+						glm::mat4 model = placement * objectTransform(geom, geomId, scale);
+						scale *= placementScale;
 				
 						// Envia a matriz model para o shader
-						glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-				
-						// Envia as propriedades do material
-						glUniform3fv(glGetUniformLocation(shaderID, "ka"), 1, glm::value_ptr(geom.ka));
-						glUniform3fv(glGetUniformLocation(shaderID, "kd"), 1, glm::value_ptr(geom.kd));
-						glUniform3fv(glGetUniformLocation(shaderID, "ks"), 1, glm::value_ptr(geom.ks));
-						glUniform3fv(glGetUniformLocation(shaderID, "ke"), 1, glm::value_ptr(geom.ke));
-						glUniform1f(glGetUniformLocation(shaderID, "q"), geom.shininess);
+						phongUniforms.model.set(model);
+						geom.model = model;
 				
-						// Envia luz e câmera
-						glUniform3f(glGetUniformLocation(shaderID, "lightPos"), 0.0f, 2.0f, 0.0f);
-						glUniform3f(glGetUniformLocation(shaderID, "lightColor"), 1.3f, 1.3f, 1.3f);
-						glUniform3fv(glGetUniformLocation(shaderID, "cameraPos"), 1, glm::value_ptr(camera.Position));
+						// Decodificação do layout compacto
+						phongUniforms.quantized.set(geom.quantized);
+						phongUniforms.positionOffset.set(geom.positionOffset);
+						phongUniforms.positionScale.set(geom.positionScale);
 				
-						// Aplica textura se houver
-						glActiveTexture(GL_TEXTURE0);
-						if (geom.textureID > 0)
-								glBindTexture(GL_TEXTURE_2D, geom.textureID);
-						glUniform1i(glGetUniformLocation(shaderID, "colorBuffer"), 0);
-				
-						// Renderiza
+						// Nível de detalhe: erro geométrico projetado na distância até a esfera envolvente
+						glm::vec3 worldCenter = glm::vec3(model * glm::vec4(geom.boundsCenter, 1.0f));
+						float distance = glm::length(worldCenter - camera.Position) - geom.boundsRadius * scale;
+						float pixelsPerUnit = projection[1][1] * 0.5f * height;
+						geom.currentLod = lodSelection ? selectLod(geom, scale, distance, pixelsPerUnit) : 0;
+						lodTrianglesFull += geom.indexCount / 3;
+						const MeshLod& lod = geom.lods[geom.currentLod];
+						lodTrianglesDrawn += lod.indexCount / 3;
+						bool culling = geom.currentLod == 0 && meshletCulling;
+						if (!culling) meshletStats.trianglesDrawn += lod.indexCount / 3;
+						// Câmera e frustum levados para o espaço do objeto
+						glm::mat4 mvp = projection * view * model;
+						glm::vec3 cameraObject = glm::vec3(glm::inverse(model) * glm::vec4(camera.Position, 1.0f));
+
+						// Um VAO para todos os materiais; cada trecho é um draw de intervalo do mesmo EBO
 						glBindVertexArray(geom.VAO);
-						glDrawArrays(GL_TRIANGLES, 0, geom.vertexCount);
+						for (const GeometrySubmesh& submesh : geom.submeshes)
+						{
+								bindSubmesh(geom, submesh);
+
+								// Renderiza
+								const IndexedSubmesh& range = submesh.ranges[geom.currentLod];
+								if (range.indexCount == 0) continue;
+								if (culling && !submesh.meshlets.empty())
+								{
+										cullMeshlets(submesh.meshlets, mvp, cameraObject, visibleRanges, meshletStats);
+
+										rangeCounts.clear();
+										rangeOffsets.clear();
+										for (const MeshletRange& visible : visibleRanges)
+										{
+												rangeCounts.push_back((GLsizei)visible.indexCount);
+												rangeOffsets.push_back(indexOffset(geom, visible.firstIndex));
+										}
+										if (!visibleRanges.empty()) {
+												glMultiDrawElements(GL_TRIANGLES, rangeCounts.data(), geom.indexType, rangeOffsets.data(), (GLsizei)visibleRanges.size());
+												++drawCalls;
+										}
+								}
+								else
+								{
+										if (culling) meshletStats.trianglesDrawn += range.indexCount / 3;
+										glDrawElements(GL_TRIANGLES, range.indexCount, geom.indexType, indexOffset(geom, range.firstIndex));
+										++drawCalls;
+								}
+						}
 						glBindVertexArray(0);
 				};
+
+				// As cópias visíveis de um objeto (o VAO já aponta para elas): um draw instanciado
+				// por trecho, a posição de cada cópia sai da curva no vertex shader. LOD e
+				// meshlets são por objeto, então as cópias usam a malha completa.
+				auto renderInstanced = [&](Geometry& geom, int geomId, float pathTime, int copies) {
+						float scale;
+						glm::mat4 model = objectTransform(geom, geomId, scale);
+						phongUniforms.model.set(model);
+						phongUniforms.pathInstanced.set(true);
+						phongUniforms.pathTime.set(pathTime);
+						// A primeira cópia (sem desvio) é a que o passe de feedback desenha
+						geom.model = glm::translate(glm::mat4(1.0f), pathPosition(bezierCurve, pathTime)) * model;
+						geom.currentLod = 0;
+
+						phongUniforms.quantized.set(geom.quantized);
+						phongUniforms.positionOffset.set(geom.positionOffset);
+						phongUniforms.positionScale.set(geom.positionScale);
+
+						size_t triangles = size_t(geom.indexCount / 3) * copies;
+						lodTrianglesFull += triangles;
+						lodTrianglesDrawn += triangles;
+						meshletStats.trianglesDrawn += triangles;
+						if (copies == 0) {
+							phongUniforms.pathInstanced.set(false);
+							return;
+						}
+
+						glBindVertexArray(geom.VAO);
+						for (const GeometrySubmesh& submesh : geom.submeshes)
+						{
+								bindSubmesh(geom, submesh);
+								const IndexedSubmesh& range = submesh.ranges[0];
+								if (range.indexCount == 0) continue;
+								glDrawElementsInstanced(GL_TRIANGLES, range.indexCount, geom.indexType,
+								                        indexOffset(geom, range.firstIndex), (GLsizei)copies);
+								++drawCalls;
+						}
+						glBindVertexArray(0);
+						phongUniforms.pathInstanced.set(false);
+				};
 			
 				static float timeAccumulator = 0.0f;
 				timeAccumulator += deltaTime * 2.0f;
 
-				for (int i = 0; i < objects.size(); ++i) {
-					// Comprimento da curva
-					float totalLength = bezierCurve.size() - 1;
-				
+				int wantedCopies = pathStressCopies[pathStress];
+				if (wantedCopies != pathCopies) {
+					resizePath(wantedCopies);
+					for (PathTiming& mode : pathTiming) mode = PathTiming();
+				}
+
+				double drawStart = glfwGetTime();
+				bool indirect = pathSubmission == PathIndirect;
+				if (indirect && commandRevision != sceneRevision) rebuildCommands();
+
+				// Esfera de cada cópia no mundo: ponto da curva + desvio + escala da cópia vezes
+				// a esfera do objeto já com a transformação própria. A de todas as cópias
+				// cobre a curva, o maior desvio e a maior escala
+				Frustum frustum = extractFrustum(projection * view);
+				visibleInstances.clear();
+				for (size_t i = 0; i < objects.size(); ++i) {
 					// Offset de tempo único para cada objeto (evita sobreposição)
-					float offsetT = i * 30.0f; // quanto mais alto, maior o espaçamento
-					float t = fmod(timeAccumulator + offsetT, totalLength);
-				
-					int idx = (int)t;
-					float localT = t - idx;
-				
-					// Clamp para evitar ultrapassar limites da curva
-					if (idx >= bezierCurve.size() - 1)
-						idx = bezierCurve.size() - 2;
-				
-					// Interpola posição
-					glm::vec3 p0 = bezierCurve[idx];
-					glm::vec3 p1 = bezierCurve[idx + 1];
-					glm::vec3 pos = glm::mix(p0, p1, localT);
-				
-					objects[i].position = pos;
+					float offsetT = (float)i * 30.0f; // quanto mais alto, maior o espaçamento
+					float pathTime = timeAccumulator + offsetT;
+					pathTimes[i] = pathTime;
+					objects[i].position = pathPosition(bezierCurve, pathTime);
+					copyFirst[i] = (int)visibleInstances.size();
+					copyCount[i] = 0;
+					copiesInPlace[i] = true;
+					if (!objects[i].resident) continue;
+					if (!frustumCulling) {
+						copyCount[i] = pathCopies;
+						frustumStats.tested += pathCopies;
+						frustumStats.visible += pathCopies;
+						continue;
+					}
+					float scale;
+					glm::mat4 model = objectTransform(objects[i], (int)i + 1, scale);
+					glm::vec3 center = glm::vec3(model * glm::vec4(objects[i].boundsCenter, 1.0f));
+					float radius = objects[i].boundsRadius * scale;
+					float allCopies = pathRadius + copyReach + copyMaxScale * (glm::length(center) + radius);
+					int side = classifySphere(frustum, pathCenter, allCopies);
+					if (side != 0) {
+						copyCount[i] = side > 0 ? pathCopies : 0;
+						frustumStats.tested += pathCopies;
+						if (side > 0) {
+							frustumStats.visible += pathCopies;
+							++pathObjectsInside;
+						}
+						else {
+							frustumStats.culled += pathCopies;
+							++pathObjectsOutside;
+						}
+						continue;
+					}
+					++pathObjectsSplit;
+					copiesInPlace[i] = false;
+					copySpheres.clear();
+					copySpheres.reserve(pathInstances.size());
+					for (const PathInstance& copy : pathInstances) {
+						glm::vec3 onPath = pathPosition(bezierCurve, pathTime + copy.start) + glm::vec3(copy.offset);
+						copySpheres.push(onPath + copy.offset.w * center, copy.offset.w * radius);
+					}
+					visibleCopies.clear();
+					copyCount[i] = (int)cullSpheres(frustum, copySpheres, visibleCopies, frustumStats);
+					for (uint32_t c : visibleCopies) visibleInstances.push_back(pathInstances[c]);
+				}
+
+				// Cópias visíveis dos objetos cortados para a GPU: no anel persistente ou, sem
+				// espaço nele, num buffer órfão. Os outros continuam no pathInstanceBuffer
+				GLuint instanceSource = pathInstanceBuffer;
+				GLintptr instanceOffset = 0;
+				if (!visibleInstances.empty() && pathSubmission != PathLoop) {
+					size_t instanceBytes = visibleInstances.size() * sizeof(PathInstance);
+					RingAllocation instanceRange;
+					if (ringFrame) instanceRange = ring->allocate(instanceBytes, ring->bindAlignment());
+					if (instanceRange.data) {
+						std::memcpy(instanceRange.data, visibleInstances.data(), instanceBytes);
+						instanceSource = ring->buffer();
+						instanceOffset = instanceRange.offset;
+					}
+					else {
+						glBindBuffer(GL_ARRAY_BUFFER, visibleInstanceBuffer);
+						glBufferData(GL_ARRAY_BUFFER, instanceBytes, visibleInstances.data(), GL_STREAM_DRAW);
+						glBindBuffer(GL_ARRAY_BUFFER, 0);
+						instanceSource = visibleInstanceBuffer;
+					}
+				}
+
+				for (size_t i = 0; i < objects.size(); ++i) {
+					float pathTime = pathTimes[i];
 				
-					renderGeometry(objects[i], i + 1); // IDs diferentes
+					// Ainda carregando: a vaga fica vazia neste quadro
+					if (!objects[i].resident) continue;
+					if (indirect && drawnIndirect[i]) {
+						// Só a transformação própria e o tempo: o resto já está nos comandos
+						float scale;
+						glm::mat4 model = objectTransform(objects[i], (int)i + 1, scale);
+						sceneObjects[i].model = model;
+						sceneObjects[i].path = glm::vec4(pathTime, objects[i].halfUVs ? 1.0f : 0.0f, 0.0f, 0.0f);
+						sceneObjects[i].positionOffset = glm::vec4(objects[i].positionOffset, 0.0f);
+						sceneObjects[i].positionScale = glm::vec4(objects[i].positionScale, 0.0f);
+						objects[i].model = glm::translate(glm::mat4(1.0f), objects[i].position) * model;
+						objects[i].currentLod = 0;
+						size_t triangles = size_t(objects[i].indexCount / 3) * copyCount[i];
+						lodTrianglesFull += triangles;
+						lodTrianglesDrawn += triangles;
+						meshletStats.trianglesDrawn += triangles;
+						continue;
+					}
+					if (pathSubmission != PathLoop) {
+						if (copiesInPlace[i]) pointInstances(objects[i].VAO, pathInstanceBuffer, 0);
+						else pointInstances(objects[i].VAO, instanceSource, instanceOffset + GLintptr(copyFirst[i] * sizeof(PathInstance)));
+						renderInstanced(objects[i], (int)i + 1, pathTime, copyCount[i]);
+						continue;
+					}
+					// Mesmas cópias do modo instanciado, uma chamada completa por cópia
+					// (a cópia 0, sem desvio e com escala 1, é o objeto sozinho na curva)
+					const PathInstance* copies = copiesInPlace[i] ? pathInstances.data() : visibleInstances.data() + copyFirst[i];
+					for (int c = 0; c < copyCount[i]; ++c) {
+						const PathInstance& copy = copies[c];
+						glm::mat4 placement = glm::translate(glm::mat4(1.0f), pathPosition(bezierCurve, pathTime + copy.start) + glm::vec3(copy.offset));
+						placement = glm::scale(placement, glm::vec3(copy.offset.w));
+						renderGeometry(objects[i], (int)i + 1, placement, copy.offset.w);
+					}
+				}
+				if (indirect && commandCount > 0) {
+					// A cena inteira em um draw por fonte de cópias: objetos, trechos e cópias saem do
+					// gl_DrawID e da instância
+					size_t objectBytes = sceneObjects.size() * sizeof(SceneObject);
+					RingAllocation objectRange;
+					if (ringFrame) objectRange = ring->allocate(objectBytes, ring->bindAlignment());
+					if (objectRange.data) {
+						std::memcpy(objectRange.data, sceneObjects.data(), objectBytes);
+						glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, ring->buffer(), objectRange.offset, objectRange.size);
+					}
+					else {
+						glBindBuffer(GL_SHADER_STORAGE_BUFFER, sceneObjectBuffer);
+						glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, objectBytes, sceneObjects.data());
+						glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+						glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, sceneObjectBuffer);
+					}
+					// Cópias visíveis de cada objeto: a instância i do comando lê a cópia baseInstance + i
+					// (do pathInstanceBuffer, ou das compactadas se o objeto foi testado cópia a cópia)
+					for (size_t c = 0; c < indirectCommands.size(); ++c) {
+						int object = commandObjects[c];
+						indirectCommands[c].instanceCount = (GLuint)copyCount[object];
+						indirectCommands[c].baseInstance = copiesInPlace[object] ? 0u : (GLuint)copyFirst[object];
+					}
+					size_t commandBytes = indirectCommands.size() * sizeof(DrawElementsIndirectCommand);
+					RingAllocation commandRange;
+					if (ringFrame) commandRange = ring->allocate(commandBytes, ring->bindAlignment());
+					if (commandRange.data) {
+						std::memcpy(commandRange.data, indirectCommands.data(), commandBytes);
+						glBindBuffer(GL_DRAW_INDIRECT_BUFFER, ring->buffer());
+					}
+					else {
+						glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+						glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commandBytes, indirectCommands.data());
+					}
+					// Comandos seguidos da mesma arena que leem as cópias do mesmo buffer vão no mesmo
+					// draw: um por tipo de índice se nenhum objeto foi cortado por um plano do frustum
+					indirectProgram->use();
+					auto drawGroup = [&](size_t c) {
+						const Geometry& geom = objects[commandObjects[c]];
+						return arenaIndex(geom) * 2 + (copiesInPlace[commandObjects[c]] ? 1 : 0);
+					};
+					size_t first = 0;
+					while (first < indirectCommands.size()) {
+						int group = drawGroup(first);
+						size_t last = first + 1;
+						while (last < indirectCommands.size() && drawGroup(last) == group) ++last;
+						int k = group / 2;
+						if (copiesInPlace[commandObjects[first]]) pointInstances(arenaVAO[k], pathInstanceBuffer, 0);
+						else pointInstances(arenaVAO[k], instanceSource, instanceOffset);
+						indirectUniforms.drawOffset.set((int)first);
+						glBindVertexArray(arenaVAO[k]);
+						glMultiDrawElementsIndirect(GL_TRIANGLES, arenas[k]->indexType(), (void*)(commandRange.offset + GLintptr(first * sizeof(DrawElementsIndirectCommand))),
+						                            GLsizei(last - first), 0);
+						++drawCalls;
+						first = last;
+					}
+					glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+					glBindVertexArray(0);
+					phong->use();
+				}
+				PathTiming& timing = pathTiming[pathSubmission];
+				timing.cpu += glfwGetTime() - drawStart;
+				timing.frame += deltaTime;
+				++timing.frames;
+
+				// === Feedback das texturas virtuais ===
+				// Cena reduzida só com os objetos de textura virtual; lida no próximo quadro
+				if (!virtualTextures.empty()) {
+					feedback->begin(width, height);
+					feedbackProgram->use();
+					feedbackUniforms.lodBias.set(feedback->lodBias());
+					for (const Geometry& geom : objects) {
+						if (!geom.resident) continue;
+						feedbackUniforms.model.set(geom.model);
+						feedbackUniforms.quantized.set(geom.quantized);
+						feedbackUniforms.positionOffset.set(geom.positionOffset);
+						feedbackUniforms.positionScale.set(geom.positionScale);
+						glBindVertexArray(geom.VAO);
+						for (const GeometrySubmesh& submesh : geom.submeshes) {
+							if (submesh.virtualTexture < 0) continue;
+							const IndexedSubmesh& range = submesh.ranges[0];
+							feedbackUniforms.vtSize.set(virtualTextures[submesh.virtualTexture]->sizeInfo());
+							feedbackUniforms.vtId.set((GLuint)submesh.virtualTexture);
+							glDrawElements(GL_TRIANGLES, range.indexCount, geom.indexType, indexOffset(geom, range.firstIndex));
+						}
+					}
+					glBindVertexArray(0);
+					feedback->end();
 				}
 
-				glUseProgram(curveShaderID);
-				glUniformMatrix4fv(glGetUniformLocation(curveShaderID, "view"), 1, GL_FALSE, glm::value_ptr(view));
-				glUniformMatrix4fv(glGetUniformLocation(curveShaderID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-				glUniform4f(glGetUniformLocation(curveShaderID, "finalColor"), 1.0f, 0.5f, 0.2f, 1.0f); // Laranja
+				// Triângulos desenhados x descartados, uma linha por segundo
+				static float statsTimer = 0.0f;
+				statsTimer += deltaTime;
+				if (statsTimer >= 1.0f)
+				{
+						statsTimer = 0.0f;
+						std::cout << "Meshlets" << (meshletCulling ? "" : " (descarte desligado)") << ": triangulos desenhados "
+						          << meshletStats.trianglesDrawn << ", descartados " << meshletStats.trianglesCulled
+						          << " (frustum " << meshletStats.culledFrustum << ", costas " << meshletStats.culledBackface
+						          << " de " << meshletStats.meshlets << " meshlets)" << std::endl;
+						std::cout << "LOD" << (lodSelection ? "" : " (desligado)") << ": " << lodTrianglesDrawn << " de "
+						          << lodTrianglesFull << " triangulos, economia de " << lodTrianglesFull - lodTrianglesDrawn
+						          << " por quadro (niveis:";
+						for (const Geometry& geom : objects) std::cout << " " << geom.currentLod;
+						std::cout << ")" << std::endl;
+						std::cout << "Texturas" << (textureBatching ? " (atlas)" : "") << ": " << textureBinds
+						          << " binds, " << drawCalls << " draws no ultimo quadro" << std::endl;
+						for (PathTiming& mode : pathTiming) {
+							if (mode.frames == 0) continue;
+							mode.lastFrame = mode.frame / mode.frames * 1000.0;
+							mode.lastCpu = mode.cpu / mode.frames * 1000.0;
+							mode.frame = mode.cpu = 0.0;
+							mode.frames = 0;
+						}
+						const char* modeNames[3] = { "loop", "instanciado", "indireto" };
+						std::cout << "Caminho: " << pathCopies << " copias por malha, envio " << modeNames[pathSubmission];
+						if (indirect) {
+							MeshArenaStats shortStats = arenas[0]->stats(), intStats = arenas[1]->stats();
+							std::cout << " (" << commandCount << " comandos; arenas " << shortStats.meshes << " malhas com indices de 16 bits, "
+							          << intStats.meshes << " de 32, " << (shortStats.vertexBytes + shortStats.indexBytes
+							          + intStats.vertexBytes + intStats.indexBytes) / 1024.0 << " KB)";
+						}
+						for (int mode = 0; mode < 3; ++mode) {
+							if (pathTiming[mode].lastFrame == 0.0) continue;
+							std::cout << "; " << modeNames[mode] << ": quadro " << pathTiming[mode].lastFrame
+							          << " ms, CPU dos draws " << pathTiming[mode].lastCpu << " ms";
+						}
+						std::cout << std::endl;
+						std::cout << "Frustum" << (frustumCulling ? "" : " (desligado)") << " (" << frustumCullPath() << "): "
+						          << frustumStats.visible << " copias visiveis, " << frustumStats.culled << " descartadas de "
+						          << frustumStats.tested << " no ultimo quadro (teste " << frustumStats.seconds * 1000.0 << " ms); objetos "
+						          << pathObjectsInside << " dentro, " << pathObjectsOutside << " fora, " << pathObjectsSplit
+						          << " testados copia a copia" << std::endl;
+						if (ring) {
+							// Espera em glClientWaitSync: tempo em que a CPU ficou parada pela GPU
+							const PersistentRingStats& ringStats = ring->stats();
+							std::cout << "Anel persistente" << (persistentUpload ? "" : " (desligado, glBufferSubData)") << ": "
+							          << ringStats.stalledFrames << " de " << ringStats.frames << " quadros esperaram a GPU ("
+							          << ringStats.stallSeconds * 1000.0 << " ms no total, maximo " << ringStats.maxStallSeconds * 1000.0
+							          << " ms), " << RING_FRAMES << " secoes de " << ring->sectionBytes() / 1024.0 << " KB, pico "
+							          << ringStats.peakBytes / 1024.0 << " KB por quadro";
+							if (ringStats.overflows > 0) std::cout << ", " << ringStats.overflows << " pedidos sem espaco";
+							std::cout << std::endl;
+							ring->resetStats();
+						}
+						for (const auto& vt : virtualTextures) {
+							VirtualTextureStats vtStats = vt->stats();
+							std::cout << "Textura virtual " << vt->path() << ": " << vtStats.resident << "/" << vtStats.capacity
+							          << " paginas residentes, " << vtStats.requested << " pedidas, " << vtStats.pending
+							          << " lendo, " << vtStats.uploads << " enviadas, " << vtStats.evictions << " despejadas; VRAM "
+							          << (vtStats.physicalBytes + vtStats.pageTableBytes) / (1024.0 * 1024.0) << " MB (imagem inteira: "
+							          << vtStats.virtualBytes / (1024.0 * 1024.0) << " MB)" << std::endl;
+						}
+				}
+				textureBinds = 0;
+				drawCalls = 0;
+				meshletStats.reset();
+				frustumStats.reset();
+				pathObjectsInside = pathObjectsOutside = pathObjectsSplit = 0;
+				lodTrianglesFull = lodTrianglesDrawn = 0;
+
+				curveProgram->use();
+				curveUniforms.finalColor.set(glm::vec4(1.0f, 0.5f, 0.2f, 1.0f)); // Laranja
 
 				glBindVertexArray(curveVAO);
 				glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)bezierCurve.size());
 				glBindVertexArray(0);
 
+				// Cerca depois do último draw que lê a seção do anel
+				if (ringFrame) ring->endFrame();
+
 				// === Troca os buffers ===
 				glfwSwapBuffers(window);
+
+				static bool firstFrame = true;
+				if (firstFrame) {
+					firstFrame = false;
+					std::cout << "Primeiro quadro em " << (glfwGetTime() - startTime) * 1000.0 << " ms ("
+					          << loader->pending() << " assets ainda carregando)" << std::endl;
+				}
 		}
 
     // Cleanup
-    glDeleteVertexArrays(1, &suzzane.VAO);
-    glDeleteVertexArrays(1, &cube.VAO);
+    // As leituras de página rodam no pool do loader
+    virtualTextures.clear();
+    feedback.reset();
+    loader.reset();
+    for (const Geometry& geom : objects) {
+        if (geom.resident) {
+            glDeleteVertexArrays(1, &geom.VAO);
+            glDeleteBuffers(1, &geom.VBO);
+            glDeleteBuffers(1, &geom.EBO);
+        }
+        for (const GeometrySubmesh& submesh : geom.submeshes) textures->release(submesh.texture);
+    }
+    textures->release(bgHandle);
+    textures.reset();
+    atlas.reset();
+    materials.reset();
+    glDeleteBuffers(1, &drawBuffer);
+    glDeleteBuffers(1, &pathInstanceBuffer);
+    glDeleteBuffers(1, &pathPointBuffer);
+    for (GLuint vao : arenaVAO) {
+        if (vao) glDeleteVertexArrays(1, &vao);
+    }
+    glDeleteBuffers(1, &commandBuffer);
+    glDeleteBuffers(1, &drawRecordBuffer);
+    glDeleteBuffers(1, &sceneObjectBuffer);
+    glDeleteBuffers(1, &visibleInstanceBuffer);
+    ring.reset();
+    for (std::unique_ptr<MeshArena>& arena : arenas) arena.reset();
+    frameUniforms.reset();
+    phong.reset();
+    bgProgram.reset();
+    curveProgram.reset();
+    feedbackProgram.reset();
+    indirectProgram.reset();
     glfwTerminate();
     return 0;
 }
@@ -481,6 +1834,17 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         if (key == GLFW_KEY_Y) { rotateX = false; rotateY = true; rotateZ = false; }
         if (key == GLFW_KEY_Z) { rotateX = false; rotateY = false; rotateZ = true; }
 
+        if (key == GLFW_KEY_M && action == GLFW_PRESS) meshletCulling = !meshletCulling;
+        if (key == GLFW_KEY_L && action == GLFW_PRESS) lodSelection = !lodSelection;
+        if (key == GLFW_KEY_K && action == GLFW_PRESS) pathStress = (pathStress + 1) % 3;
+        if (key == GLFW_KEY_R && action == GLFW_PRESS) persistentUpload = !persistentUpload;
+        if (key == GLFW_KEY_F && action == GLFW_PRESS) frustumCulling = !frustumCulling;
+        if (key == GLFW_KEY_B && action == GLFW_PRESS)
+        {
+            pathSubmission = PathSubmission((pathSubmission + 1) % 3);
+            if (pathSubmission == PathIndirect && !indirectAvailable) pathSubmission = PathLoop;
+        }
+
         if (selectedObject > 0)
         {
             float moveStep = 0.1f;
@@ -560,320 +1924,410 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
     camera.updateCameraVectors();
 }
 
-int setupShader()
+bool decodeGeometry(GeometryLoad& load)
 {
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-	}
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-	}
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success) {
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+    // Malha soldada e material resolvido vêm do .meshcache ao lado do .obj
+    // (gerado na primeira execução e refeito quando o .obj/.mtl mudar)
+    CachedMesh& mesh = load.mesh;
+    if (!loadMeshCached(load.path, mesh))
+    {
+        std::cerr << "Failed to load geometry: " << load.path << std::endl;
+        return false;
+    }
+
+    QuantizedMesh& packed = load.packed;
+    if (quantizedVertices)
+    {
+        quantizeVertices(mesh.vertices, mesh.header.vertexCount, mesh.boundsMin(), mesh.boundsMax(), packed);
+    }
+
+    // Meshlets (só no LOD 0): os índices são regravados meshlet a meshlet antes de ir para o EBO,
+    // cada material no seu trecho
+    std::vector<uint32_t>& indices = load.indices;
+    indices.resize(mesh.header.indexCount);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        indices[i] = mesh.header.indexSize == 2 ? static_cast<const uint16_t*>(mesh.indices)[i]
+                                                : static_cast<const uint32_t*>(mesh.indices)[i];
+    }
+    vector<vector<Meshlet>> meshlets(mesh.submeshCount());
+    size_t meshletCount = 0;
+    std::vector<uint32_t> baseIndices;
+    for (size_t s = 0; s < mesh.submeshCount(); ++s)
+    {
+        const IndexedSubmesh& range = mesh.submesh(0, s);
+        baseIndices.assign(indices.begin() + range.firstIndex, indices.begin() + range.firstIndex + range.indexCount);
+        buildMeshlets(mesh.vertices, mesh.header.vertexCount, baseIndices, meshlets[s]);
+        std::copy(baseIndices.begin(), baseIndices.end(), indices.begin() + range.firstIndex);
+        for (Meshlet& meshlet : meshlets[s]) meshlet.firstIndex += range.firstIndex;
+        meshletCount += meshlets[s].size();
+    }
+    if (mesh.header.indexSize == 2) load.shortIndices.assign(indices.begin(), indices.end());
+
+    // Comparação com a versão desenrolada: um vértice de 32 bytes e uma execução do VS por canto.
+    // Montado numa string só: outras threads também estão escrevendo no console
+    std::ostringstream report;
+    size_t corners = mesh.lod(0).indexCount;
+    size_t unrolledBytes = corners * 8 * sizeof(GLfloat);
+    size_t vertexBytes = quantizedVertices ? packed.bytes() : mesh.vertexBytes();
+    size_t indexedBytes = vertexBytes + mesh.indexBytes();
+    report << "Geometria " << load.path << (mesh.fromCache ? " (cache)" : " (cache gerado)") << "\n"
+           << "  vertices: " << corners << " -> " << mesh.header.vertexCount << " unicos"
+           << " (indices de " << mesh.header.indexSize * 8 << " bits)\n"
+           << "  VRAM: " << unrolledBytes / 1024.0 << " KB -> " << indexedBytes / 1024.0 << " KB\n"
+           << "  execucoes do vertex shader: " << corners << " -> " << mesh.header.vertexCount
+           << " (minimo, com cache pos-transformacao)\n"
+           << "  cache pos-transformacao (FIFO " << kVertexCacheSize << "): ACMR " << mesh.header.acmrBefore
+           << " -> " << mesh.header.acmrAfter << ", ATVR " << mesh.header.atvrBefore << " -> " << mesh.header.atvrAfter
+           << "\n  materiais: " << mesh.materialCount() << " (um draw de intervalo por material)"
+           << "\n  meshlets: " << meshletCount << " (ate " << kMeshletMaxVertices << " vertices / "
+           << kMeshletMaxTriangles << " triangulos)\n";
+    for (size_t i = 1; i < mesh.lodCount(); ++i)
+    {
+        const MeshLod& lod = mesh.lod(i);
+        report << "  LOD " << i << ": " << lod.indexCount / 3 << " triangulos (" << lod.ratio * 100.0f
+               << "%), erro geometrico " << lod.error << "\n";
+    }
+    if (quantizedVertices)
+    {
+        QuantizationError error = measureQuantizationError(mesh.vertices, mesh.header.vertexCount, packed);
+        report << "  vertice compacto: " << mesh.header.floatsPerVertex * sizeof(GLfloat) << " -> " << sizeof(PackedVertex)
+               << " bytes (uv " << (packed.halfUVs ? "half" : "unorm16") << "), erro max: posicao " << error.position
+               << ", normal " << error.normalDegrees << " graus, uv " << error.uv << "\n";
+    }
+    std::cout << report.str() << std::flush;
+
+    Geometry& geom = load.geom;
+    geom.indexCount = mesh.lod(0).indexCount;
+    geom.indexType = mesh.header.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    geom.indexSize = mesh.header.indexSize;
+    geom.lods.assign(mesh.header.lods, mesh.header.lods + mesh.lodCount());
+    computeBounds(mesh.boundsMin(), mesh.boundsMax(), geom);
+    geom.quantized = quantizedVertices;
+    geom.halfUVs = packed.halfUVs;
+    geom.positionOffset = packed.positionOffset;
+    geom.positionScale = packed.positionScale;
+    string basePath = load.path.substr(0, load.path.find_last_of("/"));
+    geom.path = load.path;
+    geom.mtlPath = mesh.header.mtlLib[0] != '\0' ? basePath + "/" + mesh.header.mtlLib : string();
+    geom.submeshes.resize(mesh.submeshCount());
+    load.virtualTexturePaths.assign(mesh.submeshCount(), string());
+    for (size_t s = 0; s < mesh.submeshCount(); ++s)
+    {
+        GeometrySubmesh& submesh = geom.submeshes[s];
+        for (size_t level = 0; level < mesh.lodCount(); ++level) submesh.ranges.push_back(mesh.submesh(level, s));
+        submesh.meshlets = std::move(meshlets[s]);
+
+        ObjMaterial mat = mesh.material(mesh.submesh(0, s).material);
+        submesh.material = mat.name;
+        submesh.ka = mat.ka;
+        submesh.kd = mat.kd;
+        submesh.ks = mat.ks;
+        submesh.ke = mat.ke;
+        submesh.shininess = mat.shininess;
+        submesh.textureFilePath = mat.diffuseMap;
+        if (mat.diffuseMap.empty()) continue;
+
+        string fullTexturePath = basePath + "/" + mat.diffuseMap;
+        submesh.textureFilePath = fullTexturePath;
+        if (virtualTexturing && std::filesystem::exists(virtualTexturePath(fullTexturePath)))
+        {
+            // Imagem pré-cortada em páginas: nada de decodificar a imagem inteira
+            load.virtualTexturePaths[s] = fullTexturePath;
+            continue;
+        }
+        // Sem a textura o objeto ainda é desenhado, só sem cor da imagem.
+        // Materiais com o mesmo map_Kd (no mesmo ou em outro modelo) recebem a
+        // mesma entrada, decodificada uma vez
+        TextureParams params;
+        params.minFilter = GL_LINEAR;
+        submesh.texture = load.textures->acquire(fullTexturePath, params);
+    }
 
-	return shaderProgram;
+    // Texturas virtuais e texturas soltas precisam de binds por trecho e ficam fora
+    // do envio indireto; as outras malhas moram só na arena
+    load.arenaResident = load.arenas[0] && textureBatching && mesh.header.floatsPerVertex == 8;
+    for (const string& vtPath : load.virtualTexturePaths)
+    {
+        if (!vtPath.empty()) load.arenaResident = false;
+    }
+    return true;
 }
 
-int setupBackgroundShader()
+bool uploadGeometry(GeometryLoad& load)
 {
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &bgVertexShader, NULL);
-    glCompileShader(vertexShader);
-
-    GLint success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cerr << "ERROR::BACKGROUND_VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &bgFragmentShader, NULL);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cerr << "ERROR::BACKGROUND_FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cerr << "ERROR::BACKGROUND_PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    return shaderProgram;
+    // Só texturas: a malha de arenaResident vai para a arena no finish, e a que
+    // cabe nos buffers da versão em cena é escrita neles no finish
+    if (!load.arenaResident)
+    {
+        const void* vertices;
+        const void* indices;
+        size_t vertexBytes, indexBytes;
+        meshBufferData(load, vertices, vertexBytes, indices, indexBytes);
+        load.inPlace = load.previousVBO && load.previousEBO &&
+                       load.previousVertexBytes == vertexBytes && load.previousIndexBytes == indexBytes;
+        if (!load.inPlace) uploadMeshBuffers(load);
+    }
+
+    // Só o primeiro objeto com esta textura cria o objeto na GPU.
+    // No atlas a cópia fica para o finish, na thread dona do array
+    if (!textureBatching)
+    {
+        for (GeometrySubmesh& submesh : load.geom.submeshes) submesh.textureID = load.textures->upload(submesh.texture);
+    }
+    return true;
 }
 
-int setupCurveShader()
+// Vértices (compactos ou float) e índices (16 ou 32 bits) como vão para o VBO/EBO próprios
+void meshBufferData(const GeometryLoad& load, const void*& vertices, size_t& vertexBytes, const void*& indices, size_t& indexBytes)
 {
-    auto compile = [](GLenum type, const char* src) -> GLuint {
-        GLuint shader = glCreateShader(type);
-        glShaderSource(shader, 1, &src, NULL);
-        glCompileShader(shader);
-        GLint success;
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            char log[512];
-            glGetShaderInfoLog(shader, 512, NULL, log);
-            std::cerr << "Shader compile error: " << log << std::endl;
-        }
-        return shader;
-    };
-
-    GLuint vs = compile(GL_VERTEX_SHADER, curveVertexShader);
-    GLuint fs = compile(GL_FRAGMENT_SHADER, curveFragmentShader);
+    const CachedMesh& mesh = load.mesh;
+    vertices = quantizedVertices ? (const void*)load.packed.vertices.data() : (const void*)mesh.vertices;
+    vertexBytes = quantizedVertices ? load.packed.bytes() : mesh.vertexBytes();
+    indices = mesh.header.indexSize == 2 ? (const void*)load.shortIndices.data() : (const void*)load.indices.data();
+    indexBytes = mesh.indexBytes();
+}
 
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
+void uploadMeshBuffers(GeometryLoad& load)
+{
+    const void* vertices;
+    const void* indices;
+    size_t vertexBytes, indexBytes;
+    meshBufferData(load, vertices, vertexBytes, indices, indexBytes);
+
+    // Buffers não têm tipo: o EBO é preenchido pelo alvo GL_ARRAY_BUFFER porque
+    // neste contexto não há VAO ligado para receber o GL_ELEMENT_ARRAY_BUFFER.
+    // No hot reload com outro tamanho os buffers são novos: a versão em cena
+    // continua sendo desenhada com os dela até a troca no finish
+    glGenBuffers(1, &load.VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, load.VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices, GL_STATIC_DRAW);
+    glGenBuffers(1, &load.EBO);
+    glBindBuffer(GL_ARRAY_BUFFER, load.EBO);
+    glBufferData(GL_ARRAY_BUFFER, indexBytes, indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    load.geom.VBO = load.VBO;
+    load.geom.EBO = load.EBO;
+    load.geom.vertexBytes = vertexBytes;
+    load.geom.indexBytes = indexBytes;
+}
 
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetProgramInfoLog(program, 512, NULL, log);
-        std::cerr << "Shader link error: " << log << std::endl;
+void finishGeometry(GeometryLoad& load)
+{
+    if (load.inPlace)
+    {
+        // Hot reload com os mesmos tamanhos: dados novos nos buffers da versão em cena,
+        // aqui na thread principal, no mesmo passo em que VAO, faixas e offset/scale
+        // da quantização são trocados (no upload, quadros intermediários misturariam
+        // a malha nova com as faixas velhas)
+        const void* vertices;
+        const void* indices;
+        size_t vertexBytes, indexBytes;
+        meshBufferData(load, vertices, vertexBytes, indices, indexBytes);
+        // GL_COPY_WRITE_BUFFER: não mexe no GL_ELEMENT_ARRAY_BUFFER de um VAO ligado
+        glBindBuffer(GL_COPY_WRITE_BUFFER, load.previousVBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, vertexBytes, vertices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, load.previousEBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, indexBytes, indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        load.geom.VBO = load.previousVBO;
+        load.geom.EBO = load.previousEBO;
+        load.geom.vertexBytes = vertexBytes;
+        load.geom.indexBytes = indexBytes;
     }
 
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-    return program;
-}
+    std::vector<GeometrySubmesh>& submeshes = load.geom.submeshes;
+    if (textureBatching)
+    {
+        // Imagens repetidas (mesmo caminho ou mesmo conteúdo) caem na mesma entrada do atlas
+        for (GeometrySubmesh& submesh : submeshes) submesh.atlasPlacement = load.textures->place(submesh.texture, *load.atlas);
+    }
+    if (textureBatching && submeshes.size() == 1)
+    {
+        // Vaga desta geometria no buffer de dados por draw, lida pelos atributos 3 e 4 do VAO
+        glBindBuffer(GL_ARRAY_BUFFER, load.drawBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, GLintptr(load.drawSlot) * sizeof(AtlasPlacement), sizeof(AtlasPlacement), &submeshes[0].atlasPlacement);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
 
-int loadTexture(const string& path)
-{
-    GLuint texID;
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        GLenum format = (nrChannels == 3) ? GL_RGB : GL_RGBA;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+    // Envio indireto: a malha no layout dos VBOs próprios, nos buffers compartilhados da
+    // arena do tamanho dos índices dela (locais à malha); o VAO aponta para o baseVertex
+    MeshArena* arena = load.arenaResident ? load.arenas[arenaIndex(load.geom)] : nullptr;
+    if (arena)
+    {
+        const void* vertices;
+        const void* indices;
+        size_t vertexBytes, indexBytes;
+        meshBufferData(load, vertices, vertexBytes, indices, indexBytes);
+        load.geom.arenaSlice = arena->add(vertices, load.mesh.header.vertexCount, indices, (GLuint)load.indices.size());
     }
-    else
+
+    // VAOs não são compartilhados entre contextos: criado aqui, no contexto da janela
+    load.geom.VAO = createGeometryVAO(load.geom, arena, load.drawBuffer, load.drawSlot, load.instanceBuffer);
+
+    for (size_t s = 0; s < submeshes.size(); ++s)
     {
-        cerr << "Failed to load texture: " << path << endl;
+        const string& path = load.virtualTexturePaths[s];
+        if (path.empty()) continue;
+        // Mesma imagem em vários materiais ou modelos: uma textura virtual só
+        std::vector<std::unique_ptr<VirtualTexture>>& list = *load.virtualTextures;
+        for (size_t i = 0; i < list.size() && submeshes[s].virtualTexture < 0; ++i)
+        {
+            if (list[i]->path() == path) submeshes[s].virtualTexture = (int)i;
+        }
+        if (submeshes[s].virtualTexture < 0)
+        {
+            std::unique_ptr<VirtualTexture> vt(new VirtualTexture(*load.pool));
+            if (vt->open(path))
+            {
+                list.push_back(std::move(vt));
+                submeshes[s].virtualTexture = (int)list.size() - 1;
+            }
+        }
     }
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    return texID;
-}
 
+    // Ordem de desenho pela textura: trechos com a mesma imagem (ou camada do
+    // atlas) ficam seguidos e o bind só acontece no primeiro
+    std::stable_sort(submeshes.begin(), submeshes.end(), [](const GeometrySubmesh& a, const GeometrySubmesh& b) {
+        if (a.virtualTexture != b.virtualTexture) return a.virtualTexture < b.virtualTexture;
+        if (textureBatching) return a.atlasPlacement.layer < b.atlasPlacement.layer;
+        return a.textureID < b.textureID;
+    });
+    for (GeometrySubmesh& submesh : submeshes) submesh.materialIndex = load.materials->allocate(gpuMaterialOf(submesh));
 
-bool loadObject(
-	const char* path,
-	std::vector<glm::vec3>& out_vertices,
-	std::vector<glm::vec2>& out_uvs,
-	std::vector<glm::vec3>& out_normals)
+    load.geom.resident = true;
+}
+
+// Arena das malhas com o mesmo tamanho de índice: 0 para 16 bits, 1 para 32
+int arenaIndex(const Geometry& geom)
 {
-	std::ifstream file(path);
-	if (!file)
-	{
-			std::cerr << "Failed to open file: " << path << std::endl;
-			return false;
-	}
-	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-	std::vector<glm::vec3> temp_vertices;
-	std::vector<glm::vec2> temp_uvs;
-	std::vector<glm::vec3> temp_normals;
-	std::string line;
-	while (std::getline(file, line))
-	{
-			std::istringstream iss(line);
-			std::string type;
-			iss >> type;
-
-			if (type == "v") 
-			{
-					glm::vec3 vertex;
-					iss >> vertex.x >> vertex.y >> vertex.z;
-					temp_vertices.push_back(vertex);
-			}
-			else if (type == "vt") 
-			{
-					glm::vec2 uv;
-					iss >> uv.x >> uv.y;
-					temp_uvs.push_back(uv);
-			}
-			else if (type == "vn") 
-			{
-					glm::vec3 normal;
-					iss >> normal.x >> normal.y >> normal.z;
-					temp_normals.push_back(normal);
-			}
-			else if (type == "f")
-			{
-					unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-					char slash;
-
-					for (int i = 0; i < 3; ++i)
-					{
-							iss >> vertexIndex[i] >> slash >> uvIndex[i] >> slash >> normalIndex[i];
-							vertexIndices.push_back(vertexIndex[i]);
-							uvIndices.push_back(uvIndex[i]);
-							normalIndices.push_back(normalIndex[i]);
-					}
-			}
-			else if (type == "mtllib")
-			{
-					iss >> mtlFilePath;
-			}
-	}
-	for (unsigned int i = 0; i < vertexIndices.size(); ++i)
-	{
-			unsigned int vertexIndex = vertexIndices[i];
-			unsigned int uvIndex = uvIndices[i];
-			unsigned int normalIndex = normalIndices[i];
-			glm::vec3 vertex = temp_vertices[vertexIndex - 1];
-			glm::vec2 uv = temp_uvs[uvIndex - 1];
-			glm::vec3 normal = temp_normals[normalIndex - 1];
-			out_vertices.push_back(vertex);
-			out_uvs.push_back(uv);
-			out_normals.push_back(normal);
-	}
-	file.close();
-	return true;
+    return geom.indexSize == sizeof(uint16_t) ? 0 : 1;
 }
 
-Geometry setupGeometry(const char* filepath)
+// VAO de uma geometria sobre os buffers próprios ou, se ela mora na arena, sobre os
+// buffers da arena a partir do baseVertex (refeito quando a arena cresce)
+GLuint createGeometryVAO(const Geometry& geom, const MeshArena* arena, GLuint drawBuffer, int drawSlot, GLuint instanceBuffer)
 {
-    std::vector<GLfloat> vertices;
-    std::vector<glm::vec3> vert;
-    std::vector<glm::vec2> uvs;
-    std::vector<glm::vec3> normals;
-    loadObject(filepath, vert, uvs, normals);
-    vertices.reserve(vert.size() * 8); 
-    for (size_t i = 0; i < vert.size(); ++i)
-    {
-      vertices.insert(vertices.end(), {
-				vert[i].x, vert[i].y, vert[i].z,
-				uvs[i].x, uvs[i].y,
-				normals[i].x, normals[i].y, normals[i].z
-				}
-			);
-    }
-    GLuint VBO, VAO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
+    GLuint VAO;
     glGenVertexArrays(1, &VAO);
     glBindVertexArray(VAO);
+    GLsizei stride = quantizedVertices ? (GLsizei)sizeof(PackedVertex) : GLsizei(8 * sizeof(GLfloat));
+    size_t base = 0;
+    if (arena && geom.arenaSlice.valid())
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, arena->vertexBuffer());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena->indexBuffer());
+        base = size_t(geom.arenaSlice.baseVertex) * stride;
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, geom.VBO);
+        // O EBO fica registrado no VAO
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geom.EBO);
+    }
+
+    if (quantizedVertices)
+    {
+        // Normalizados: a OpenGL entrega posição/uv em [0, 1] e a normal em [-1, 1]
+        GLenum uvType = geom.halfUVs ? GL_HALF_FLOAT : GL_UNSIGNED_SHORT;
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (GLvoid*)(base + offsetof(PackedVertex, position)));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, uvType, geom.halfUVs ? GL_FALSE : GL_TRUE, stride, (GLvoid*)(base + offsetof(PackedVertex, uv)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, stride, (GLvoid*)(base + offsetof(PackedVertex, normal)));
+        glEnableVertexAttribArray(2);
+    }
+    else
+    {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)base);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + 3 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(base + 5 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(2);
+    }
+
+    if (textureBatching && geom.submeshes.size() == 1)
+    {
+        // Vários materiais usam o valor constante do atributo, trocado antes de cada trecho
+        // (sem glDrawElementsBaseInstance na OpenGL 4.0 não dá para apontar outra vaga por draw)
+        GLintptr slot = GLintptr(drawSlot) * sizeof(AtlasPlacement);
+        glBindBuffer(GL_ARRAY_BUFFER, drawBuffer);
+
+        // Divisor máximo: todas as instâncias de um draw (as cópias no caminho) leem a vaga desta geometria
+        const GLuint sameSlot = std::numeric_limits<GLuint>::max();
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(AtlasPlacement), (GLvoid*)(slot + offsetof(AtlasPlacement, uvRect)));
+        glEnableVertexAttribArray(3);
+        glVertexAttribDivisor(3, sameSlot);
+        glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(AtlasPlacement), (GLvoid*)(slot + offsetof(AtlasPlacement, layer)));
+        glEnableVertexAttribArray(4);
+        glVertexAttribDivisor(4, sameSlot);
+    }
+
+    // Cópias no caminho: uma PathInstance por instância
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(PathInstance), (GLvoid*)offsetof(PathInstance, offset));
+    glEnableVertexAttribArray(6);
+    glVertexAttribDivisor(6, 1);
+    glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, sizeof(PathInstance), (GLvoid*)offsetof(PathInstance, start));
+    glEnableVertexAttribArray(7);
+    glVertexAttribDivisor(7, 1);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(2);
-		
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
-    Geometry geom;
-    geom.VAO = VAO;
-    geom.vertexCount = vertices.size() / 6; 
-    string basePath = string(filepath).substr(0, string(filepath).find_last_of("/"));
-    string mtlPath = basePath + "/" + mtlFilePath;
-    Material mat = loadMTL(mtlPath);
-    geom.ka = mat.ka;
-    geom.kd = mat.kd;
-    geom.ks = mat.ks;
-    geom.ke = mat.ke;
-    geom.shininess = mat.shininess;
-    geom.textureFilePath = mat.texturePath;
-    if (!mat.texturePath.empty())
-    {
-        string fullTexturePath = basePath + "/" + mat.texturePath;
-        geom.textureID = loadTexture(fullTexturePath);
-        geom.textureFilePath = fullTexturePath;
-    }
-    return geom;
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    return VAO;
 }
 
-Material loadMTL(const string& path)
+// Offset em bytes do índice firstIndex da malha no EBO do VAO: o próprio, ou o da
+// arena a partir do arenaSlice.firstIndex (0 fora dela)
+const void* indexOffset(const Geometry& geom, GLuint firstIndex)
 {
-	Material mat;
-	ifstream mtlFile(path);
-	if (!mtlFile)
-	{
-			cerr << "Failed to open MTL file: " << path << endl;
-			return mat;
-	}
+    return (const void*)(size_t(geom.arenaSlice.firstIndex + firstIndex) * geom.indexSize);
+}
 
-	string line;
-	while (getline(mtlFile, line))
-	{
-			istringstream iss(line);
-			string keyword;
-			iss >> keyword;
+GpuMaterial gpuMaterialOf(const GeometrySubmesh& submesh)
+{
+    GpuMaterial material;
+    material.ka = glm::vec4(submesh.ka, 1.0f);
+    material.kd = glm::vec4(submesh.kd, 1.0f);
+    material.ks = glm::vec4(submesh.ks, submesh.shininess);
+    material.ke = glm::vec4(submesh.ke, 1.0f);
+    return material;
+}
 
-			if (keyword == "map_Kd")
-			{
-					iss >> mat.texturePath;
-			}
-			else if (keyword == "Ka")
-			{
-					iss >> mat.ka.r >> mat.ka.g >> mat.ka.b;
-			}
-			else if (keyword == "Kd")
-			{
-					iss >> mat.kd.r >> mat.kd.g >> mat.kd.b;
-			}
-			else if (keyword == "Ks")
-			{
-					iss >> mat.ks.r >> mat.ks.g >> mat.ks.b;
-			}
-			else if (keyword == "Ke")
-			{
-					iss >> mat.ke.r >> mat.ke.g >> mat.ke.b;
-			}
-			else if (keyword == "Ns")
-			{
-					iss >> mat.shininess;
-			}
-	}
-	return mat;
+// Nível mais simples cujo erro projetado fica abaixo de lodPixelThreshold.
+// Com histerese: só troca para um nível mais simples com folga abaixo do limite
+// e só volta para um mais detalhado quando o atual passa do limite com folga,
+// para o objeto não ficar alternando entre dois níveis perto da fronteira.
+int selectLod(const Geometry& geom, float scale, float distance, float pixelsPerUnit)
+{
+    if (geom.lods.size() < 2) return 0;
+    if (distance <= 0.0f) return 0;   // câmera dentro da esfera
+
+    auto pixelError = [&](int level) { return geom.lods[level].error * scale * pixelsPerUnit / distance; };
+
+    int current = std::min(geom.currentLod, (int)geom.lods.size() - 1);
+    int level = current;
+    while (level > 0 && pixelError(level) > lodPixelThreshold * (1.0f + lodHysteresis)) --level;
+    if (level == current)
+    {
+        while (level + 1 < (int)geom.lods.size() && pixelError(level + 1) < lodPixelThreshold * (1.0f - lodHysteresis)) ++level;
+    }
+    return level;
 }
 
-GLuint setupBg(GLuint &VAO, GLuint &VBO, const char* imagePath)
+// Esfera com centro no meio da caixa do .meshcache e raio até o canto: um pouco
+// mais folgada que a do vértice mais distante, sem passar pelos vértices de novo
+void computeBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, Geometry& geom)
+{
+    geom.boundsMin = boundsMin;
+    geom.boundsMax = boundsMax;
+    geom.boundsCenter = 0.5f * (boundsMin + boundsMax);
+    geom.boundsRadius = 0.5f * glm::length(boundsMax - boundsMin);
+}
+
+void setupBg(GLuint &VAO, GLuint &VBO)
 {	
     // Vertices do quad (posição 2D + coords textura)
     float quadVertices[] = {
@@ -903,43 +2357,6 @@ GLuint setupBg(GLuint &VAO, GLuint &VBO, const char* imagePath)
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
 
     glBindVertexArray(0);
-
-    int width, height, nrChannels;
-    unsigned char *data = stbi_load(imagePath, &width, &height, &nrChannels, 0);
-    if (!data) {
-        std::cerr << "Falha ao carregar a textura: " << imagePath << std::endl;
-        return 0;
-    }
-    std::cout << "Background texture carregada: " << width << "x" << height << ", canais: " << nrChannels << std::endl;
-
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    GLenum format;
-    if (nrChannels == 1)
-        format = GL_RED;
-    else if (nrChannels == 3)
-        format = GL_RGB;
-    else if (nrChannels == 4)
-        format = GL_RGBA;
-    else {
-        std::cerr << "Formato de textura não suportado: " << nrChannels << " canais\n";
-        stbi_image_free(data);
-        return 0;
-    }
-
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);  
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);  
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-
-    return textureID;
 }
 
 std::vector<glm::vec3> generateControlPointsSet(int nPoints)
@@ -1012,3 +2429,42 @@ std::vector<glm::vec3> generateBezierCurve(const std::vector<glm::vec3>& control
 
     return curvePoints;
 }
+
+// Ponto da curva na posição t (em segmentos), dando a volta no fim
+glm::vec3 pathPosition(const std::vector<glm::vec3>& curve, float t)
+{
+    float totalLength = curve.size() - 1;
+    t = fmod(t, totalLength);
+    if (t < 0.0f) t += totalLength;
+
+    int idx = (int)t;
+    float localT = t - idx;
+
+    // Clamp para evitar ultrapassar limites da curva
+    if (idx >= (int)curve.size() - 1)
+        idx = curve.size() - 2;
+
+    return glm::mix(curve[idx], curve[idx + 1], localT);
+}
+
+// Cópias espalhadas por igual no caminho; a primeira fica exatamente sobre a
+// curva e com escala 1, como o objeto sozinho
+std::vector<PathInstance> generatePathInstances(int count, float pathLength)
+{
+    std::vector<PathInstance> instances(count);
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> jitter(-0.15f, 0.15f);
+    std::uniform_real_distribution<float> scale(0.1f, 0.3f);
+    for (int i = 0; i < count; ++i)
+    {
+        PathInstance& instance = instances[i];
+        instance.start = pathLength * i / count;
+        if (i == 0)
+        {
+            instance.offset = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            continue;
+        }
+        instance.offset = glm::vec4(jitter(rng), jitter(rng), jitter(rng), scale(rng));
+    }
+    return instances;
+}
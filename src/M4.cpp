@@ -9,6 +9,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "ObjLoader.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
@@ -282,82 +283,7 @@ bool loadObject(
 	std::vector<glm::vec2>& out_uvs,
 	std::vector<glm::vec3>& out_normals)
 {
-	std::ifstream file(path);
-
-	if (!file)
-	{
-			std::cerr << "Failed to open file: " << path << std::endl;
-			return false;
-	}
-
-	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-	std::vector<glm::vec3> temp_vertices;
-	std::vector<glm::vec2> temp_uvs;
-	std::vector<glm::vec3> temp_normals;
-
-	std::string line;
-
-	while (std::getline(file, line))
-	{
-			std::istringstream iss(line);
-			std::string type;
-			iss >> type;
-
-			if (type == "v") 
-			{
-					glm::vec3 vertex;
-					iss >> vertex.x >> vertex.y >> vertex.z;
-					temp_vertices.push_back(vertex);
-			}
-			else if (type == "vt") 
-			{
-					glm::vec2 uv;
-					iss >> uv.x >> uv.y;
-					temp_uvs.push_back(uv);
-			}
-			else if (type == "vn") 
-			{
-					glm::vec3 normal;
-					iss >> normal.x >> normal.y >> normal.z;
-					temp_normals.push_back(normal);
-			}
-			else if (type == "f")
-			{
-					unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-					char slash;
-
-					for (int i = 0; i < 3; ++i)
-					{
-							iss >> vertexIndex[i] >> slash >> uvIndex[i] >> slash >> normalIndex[i];
-							vertexIndices.push_back(vertexIndex[i]);
-							uvIndices.push_back(uvIndex[i]);
-							normalIndices.push_back(normalIndex[i]);
-					}
-			}
-			else if (type == "mtllib")
-			{
-					iss >> mtlFilePath;
-			}
-	}
-
-	for (unsigned int i = 0; i < vertexIndices.size(); ++i)
-	{
-			unsigned int vertexIndex = vertexIndices[i];
-			unsigned int uvIndex = uvIndices[i];
-			unsigned int normalIndex = normalIndices[i];
-
-			glm::vec3 vertex = temp_vertices[vertexIndex - 1];
-			glm::vec2 uv = temp_uvs[uvIndex - 1];
-			glm::vec3 normal = temp_normals[normalIndex - 1];
-
-			out_vertices.push_back(vertex);
-			out_uvs.push_back(uv);
-			out_normals.push_back(normal);
-	}
-
-	file.close();
-
-	return true;
+	return loadObjectMapped(path, out_vertices, out_uvs, out_normals, mtlFilePath);
 }
 
 Geometry setupGeometry(const char* filepath)
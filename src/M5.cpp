@@ -9,6 +9,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "MeshCache.h"
+#include "BakedTexture.h"
+#include "TextureUpload.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
@@ -17,7 +20,8 @@ using namespace std;
 struct Geometry
 {
     GLuint VAO;
-    GLuint vertexCount;
+    GLuint indexCount;
+    GLenum indexType;
     GLuint textureID = 0;
     string textureFilePath;
     glm::vec3 position;
@@ -29,16 +33,6 @@ struct Geometry
     float shininess = 32.0f;
 };
 
-struct Material
-{
-    glm::vec3 ka;
-    glm::vec3 kd;
-    glm::vec3 ks;
-    glm::vec3 ke;
-    float shininess;
-    string texturePath;
-};
-
 struct Camera
 {
     glm::vec3 Position;
@@ -101,13 +95,7 @@ void continous_key_press(GLFWwindow* window, Camera& camera, float currentTime);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 int setupShader();
 Geometry setupGeometry(const char* filepath);
-bool loadObject(
-    const char* path,
-    std::vector<glm::vec3>& out_vertices,
-    std::vector<glm::vec2>& out_uvs,
-    std::vector<glm::vec3>& out_normals);
 int loadTexture(const string& path);
-Material loadMTL(const string& path);
 
 const GLchar *vertexShaderSource = R"(
 	#version 400
@@ -252,7 +240,7 @@ int main()
         if (geometry.textureID > 0) glBindTexture(GL_TEXTURE_2D, geometry.textureID);
         glUniform1i(glGetUniformLocation(shaderID, "colorBuffer"), 0); 
         glBindVertexArray(geometry.VAO);
-        glDrawArrays(GL_TRIANGLES, 0, geometry.vertexCount);
+        glDrawElements(GL_TRIANGLES, geometry.indexCount, geometry.indexType, 0);
         glBindVertexArray(0);
         glfwSwapBuffers(window);
     }
@@ -374,6 +362,17 @@ int loadTexture(const string& path)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Com o .mips do objbake a imagem já vem decodificada e com os mipmaps prontos
+    BakedTexture baked;
+    if (loadBakedTexture(path, baked))
+    {
+        // Níveis crus ou BCn (glCompressedTexImage2D), conforme o objbake gravou
+        uploadBakedLevels(baked);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texID;
+    }
+
     int width, height, nrChannels;
     unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
     if (data)
@@ -391,175 +390,76 @@ int loadTexture(const string& path)
     return texID;
 }
 
-bool loadObject(
-	const char* path,
-	std::vector<glm::vec3>& out_vertices,
-	std::vector<glm::vec2>& out_uvs,
-	std::vector<glm::vec3>& out_normals)
-{
-	std::ifstream file(path);
-	if (!file)
-	{
-			std::cerr << "Failed to open file: " << path << std::endl;
-			return false;
-	}
-	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-	std::vector<glm::vec3> temp_vertices;
-	std::vector<glm::vec2> temp_uvs;
-	std::vector<glm::vec3> temp_normals;
-	std::string line;
-	while (std::getline(file, line))
-	{
-			std::istringstream iss(line);
-			std::string type;
-			iss >> type;
-
-			if (type == "v") 
-			{
-					glm::vec3 vertex;
-					iss >> vertex.x >> vertex.y >> vertex.z;
-					temp_vertices.push_back(vertex);
-			}
-			else if (type == "vt") 
-			{
-					glm::vec2 uv;
-					iss >> uv.x >> uv.y;
-					temp_uvs.push_back(uv);
-			}
-			else if (type == "vn") 
-			{
-					glm::vec3 normal;
-					iss >> normal.x >> normal.y >> normal.z;
-					temp_normals.push_back(normal);
-			}
-			else if (type == "f")
-			{
-					unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-					char slash;
-
-					for (int i = 0; i < 3; ++i)
-					{
-							iss >> vertexIndex[i] >> slash >> uvIndex[i] >> slash >> normalIndex[i];
-							vertexIndices.push_back(vertexIndex[i]);
-							uvIndices.push_back(uvIndex[i]);
-							normalIndices.push_back(normalIndex[i]);
-					}
-			}
-			else if (type == "mtllib")
-			{
-					iss >> mtlFilePath;
-			}
-	}
-	for (unsigned int i = 0; i < vertexIndices.size(); ++i)
-	{
-			unsigned int vertexIndex = vertexIndices[i];
-			unsigned int uvIndex = uvIndices[i];
-			unsigned int normalIndex = normalIndices[i];
-			glm::vec3 vertex = temp_vertices[vertexIndex - 1];
-			glm::vec2 uv = temp_uvs[uvIndex - 1];
-			glm::vec3 normal = temp_normals[normalIndex - 1];
-			out_vertices.push_back(vertex);
-			out_uvs.push_back(uv);
-			out_normals.push_back(normal);
-	}
-	file.close();
-	return true;
-}
-
 Geometry setupGeometry(const char* filepath)
 {
-    std::vector<GLfloat> vertices;
-    std::vector<glm::vec3> vert;
-    std::vector<glm::vec2> uvs;
-    std::vector<glm::vec3> normals;
-    loadObject(filepath, vert, uvs, normals);
-    vertices.reserve(vert.size() * 8); 
-    for (size_t i = 0; i < vert.size(); ++i)
+    // Malha soldada e material resolvido vêm do .meshcache ao lado do .obj
+    // (gerado na primeira execução e refeito quando o .obj/.mtl mudar)
+    CachedMesh mesh;
+    if (!loadMeshCached(filepath, mesh))
     {
-      vertices.insert(vertices.end(), {
-				vert[i].x, vert[i].y, vert[i].z,
-				uvs[i].x, uvs[i].y,
-				normals[i].x, normals[i].y, normals[i].z
-				}
-			);
+        std::cerr << "Failed to load geometry: " << filepath << std::endl;
+        return Geometry{};
     }
-    GLuint VBO, VAO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
+    mtlFilePath = mesh.header.mtlLib;
+
+    GLuint VBO, EBO, VAO;
     glGenVertexArrays(1, &VAO);
     glBindVertexArray(VAO);
+
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh.vertexBytes(), mesh.vertices, GL_STATIC_DRAW);
+
+    // O EBO fica registrado no VAO
+    glGenBuffers(1, &EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBytes(), mesh.indices, GL_STATIC_DRAW);
+    GLenum indexType = mesh.header.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)0);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(5 * sizeof(GLfloat)));
     glEnableVertexAttribArray(2);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
     glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // Comparação com a versão desenrolada: um vértice de 32 bytes e uma execução do VS por canto
+    size_t corners = mesh.lod(0).indexCount;
+    size_t unrolledBytes = corners * 8 * sizeof(GLfloat);
+    size_t indexedBytes = mesh.vertexBytes() + mesh.indexBytes();
+    std::cout << "Geometria " << filepath << (mesh.fromCache ? " (cache)" : " (cache gerado)") << "\n"
+              << "  vertices: " << corners << " -> " << mesh.header.vertexCount << " unicos"
+              << " (indices de " << mesh.header.indexSize * 8 << " bits)\n"
+              << "  VRAM: " << unrolledBytes / 1024.0 << " KB -> " << indexedBytes / 1024.0 << " KB\n"
+              << "  execucoes do vertex shader: " << corners << " -> " << mesh.header.vertexCount
+              << " (minimo, com cache pos-transformacao)\n"
+              << "  cache pos-transformacao (FIFO " << kVertexCacheSize << "): ACMR " << mesh.header.acmrBefore
+              << " -> " << mesh.header.acmrAfter << ", ATVR " << mesh.header.atvrBefore << " -> " << mesh.header.atvrAfter
+              << std::endl;
+
     Geometry geom;
     geom.VAO = VAO;
-    geom.vertexCount = vertices.size() / 6;
+    geom.indexCount = mesh.lod(0).indexCount;
+    geom.indexType = indexType;
     string basePath = string(filepath).substr(0, string(filepath).find_last_of("/"));
-    string mtlPath = basePath + "/" + mtlFilePath;
-    Material mat = loadMTL(mtlPath);
+    ObjMaterial mat = mesh.material();
     geom.ka = mat.ka;
     geom.kd = mat.kd;
     geom.ks = mat.ks;
     geom.ke = mat.ke;
     geom.shininess = mat.shininess;
-    geom.textureFilePath = mat.texturePath;
-    if (!mat.texturePath.empty())
+    geom.textureFilePath = mat.diffuseMap;
+    if (!mat.diffuseMap.empty())
     {
-        string fullTexturePath = basePath + "/" + mat.texturePath;
+        string fullTexturePath = basePath + "/" + mat.diffuseMap;
         geom.textureID = loadTexture(fullTexturePath);
         geom.textureFilePath = fullTexturePath;
     }
     return geom;
 }
 
-Material loadMTL(const string& path)
-{
-	Material mat;
-	ifstream mtlFile(path);
-	if (!mtlFile)
-	{
-			cerr << "Failed to open MTL file: " << path << endl;
-			return mat;
-	}
 
-	string line;
-	while (getline(mtlFile, line))
-	{
-			istringstream iss(line);
-			string keyword;
-			iss >> keyword;
-
-			if (keyword == "map_Kd")
-			{
-					iss >> mat.texturePath;
-			}
-			else if (keyword == "Ka")
-			{
-					iss >> mat.ka.r >> mat.ka.g >> mat.ka.b;
-			}
-			else if (keyword == "Kd")
-			{
-					iss >> mat.kd.r >> mat.kd.g >> mat.kd.b;
-			}
-			else if (keyword == "Ks")
-			{
-					iss >> mat.ks.r >> mat.ks.g >> mat.ks.b;
-			}
-			else if (keyword == "Ke")
-			{
-					iss >> mat.ke.r >> mat.ke.g >> mat.ke.b;
-			}
-			else if (keyword == "Ns")
-			{
-					iss >> mat.shininess;
-			}
-	}
-	std::cout << mat.texturePath << std::endl;
-	return mat;
-}
\ No newline at end of file
@@ -9,19 +9,61 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "MeshCache.h"
+#include "BakedTexture.h"
+#include "TextureUpload.h"
+#include "FileWatcher.h"
+#include "ShaderProgram.h"
+#include "FrameUniforms.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include <map>
 #include <random>
 #include <algorithm>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
 
 using namespace std;
 
+// Tamanho e formato da textura na GPU: a imagem nova de um hot reload só é
+// reescrita no mesmo objeto de textura se forem iguais
+struct TextureLayout
+{
+    int width = 0, height = 0, channels = 0;
+    // -1: PNG via stb_image (mipmaps do driver); senão o TextureFormat do .mips
+    int format = -1;
+    uint32_t levels = 0;
+
+    bool operator==(const TextureLayout& other) const
+    {
+        return width == other.width && height == other.height && channels == other.channels &&
+               format == other.format && levels == other.levels;
+    }
+};
+
+// Imagem lida sem OpenGL (qualquer thread): .mips do objbake ou pixels do stb_image
+struct TextureFile
+{
+    BakedTexture baked;
+    bool fromBake = false;
+    vector<unsigned char> pixels;
+    TextureLayout layout;
+};
+
 struct Geometry
 {
-    GLuint VAO;
-    GLuint vertexCount;
+    GLuint VAO = 0;
+    // Buffers e tamanhos guardados para o hot reload reescrever no lugar
+    GLuint VBO = 0, EBO = 0;
+    size_t vertexBytes = 0, indexBytes = 0;
+    // Arquivos observados: .obj, .mtl (vazio se não há) e o material usado
+    string path, mtlPath, material;
+    GLuint indexCount;
+    GLenum indexType;
     GLuint textureID = 0;
+    TextureLayout textureLayout;
     string textureFilePath;
     glm::vec3 position;
     glm::vec3 ka;
@@ -32,16 +74,6 @@ struct Geometry
     float shininess = 32.0f;
 };
 
-struct Material
-{
-    glm::vec3 ka;
-    glm::vec3 kd;
-    glm::vec3 ks;
-    glm::vec3 ke;
-    float shininess;
-    string texturePath;
-};
-
 struct Camera
 {
     glm::vec3 Position;
@@ -99,28 +131,86 @@ struct Camera
     }
 };
 
+// Leitura de hot reload numa thread separada; o quadro só aplica o resultado
+// quando ele já está pronto. Uma mudança que chega durante a leitura dispara
+// outra assim que esta termina.
+template <typename T>
+struct BackgroundReload
+{
+    std::function<T(const string&)> read;
+    std::future<T> result;
+    string queuedPath;
+
+    void start(const string& path)
+    {
+        if (result.valid())
+        {
+            queuedPath = path;
+            return;
+        }
+        result = std::async(std::launch::async, read, path);
+    }
+
+    // Nunca espera: true só no quadro em que a leitura terminou
+    bool poll(T& out)
+    {
+        if (!result.valid() || result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+        out = result.get();
+        if (!queuedPath.empty())
+        {
+            string path = queuedPath;
+            queuedPath.clear();
+            start(path);
+        }
+        return true;
+    }
+};
+
+// Uniforms resolvidos uma vez depois do link (ShaderProgram.h); o quadro só chama set
+struct PhongUniforms
+{
+    Uniform<glm::mat4> model;
+    Uniform<glm::vec3> ka, kd, ks, ke;
+    Uniform<float> q;
+    Uniform<int> colorBuffer;
+
+    void resolve(const ShaderProgram& program)
+    {
+        model = program.uniform<glm::mat4>("model");
+        ka = program.uniform<glm::vec3>("ka");
+        kd = program.uniform<glm::vec3>("kd");
+        ks = program.uniform<glm::vec3>("ks");
+        ke = program.uniform<glm::vec3>("ke");
+        q = program.uniform<float>("q");
+        colorBuffer = program.uniform<int>("colorBuffer");
+    }
+};
+
+struct CurveUniforms
+{
+    Uniform<glm::vec4> finalColor;
+
+    void resolve(const ShaderProgram& program)
+    {
+        finalColor = program.uniform<glm::vec4>("finalColor");
+    }
+};
+
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 void continous_key_press(GLFWwindow* window, Camera& camera, float currentTime);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
-int setupShader();
-int setupBackgroundShader();
-int setupCurveShader();
 Geometry setupGeometry(const char* filepath);
-bool loadObject(
-    const char* path,
-    std::vector<glm::vec3>& out_vertices,
-    std::vector<glm::vec2>& out_uvs,
-    std::vector<glm::vec3>& out_normals);
-int loadTexture(const string& path);
-Material loadMTL(const string& path);
+void uploadMesh(const CachedMesh& mesh, Geometry& geom);
+void applyMaterial(const ObjMaterial& mat, Geometry& geom);
+bool readTexture(const string& path, TextureFile& file);
+GLuint uploadTexture(const TextureFile& file, GLuint current, TextureLayout& layout);
 GLuint setupBg(GLuint& bgVAO, GLuint& bgVBO, const char* texturePath);
 vector<glm::vec3> generateControlPointsSet(int nPoints);
 vector<glm::vec3> generateControlPointsSet();
 std::vector<glm::vec3> generatePointsSet();
 std::vector<glm::vec3> generateBezierCurve(const std::vector<glm::vec3>& controlPoints, int numPoints);
 
-const GLchar *vertexShaderSource = R"(
-	#version 400
+const GLchar *vertexShaderSource = "#version 400\n" FRAME_UNIFORMS_GLSL R"(
 	layout (location = 0) in vec3 position;
 	layout (location = 1) in vec2 tex_coord;
 	layout (location = 2) in vec3 normal;
@@ -128,8 +218,6 @@ const GLchar *vertexShaderSource = R"(
 	out vec3 fragPos;
 	out vec3 fragNormal;
 	uniform mat4 model;
-	uniform mat4 view;
-	uniform mat4 projection;
 	void main()
 	{
 			vec4 worldPos = model * vec4(position, 1.0);
@@ -140,8 +228,7 @@ const GLchar *vertexShaderSource = R"(
 	}
 )";
 
-const GLchar *fragmentShaderSource = R"(
-	#version 400
+const GLchar *fragmentShaderSource = "#version 400\n" FRAME_UNIFORMS_GLSL R"(
 	in vec3 fragNormal;
 	in vec3 fragPos;
 	in vec2 texCoord;
@@ -149,19 +236,12 @@ const GLchar *fragmentShaderSource = R"(
 	uniform vec3 kd;
 	uniform vec3 ks;
 	uniform float q;
-	uniform vec3 lightPos;
-	uniform vec3 lightColor;
-	uniform vec3 cameraPos;
 	uniform sampler2D colorBuffer;
 	out vec4 color;
 	void main()
 	{
 		vec3 N = normalize(fragNormal);
-		vec3 L = normalize(lightPos - fragPos);
 		vec3 V = normalize(cameraPos - fragPos);
-		vec3 R = reflect(-L, N);
-		float distance = length(lightPos - fragPos);
-		float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * distance * distance);
 
 		vec3 texColor = vec3(1.0); // fallback branco
 		// Só usa a textura se a textura tem tamanho válido
@@ -169,15 +249,27 @@ const GLchar *fragmentShaderSource = R"(
 			texColor = texture(colorBuffer, texCoord).rgb;
 		}
 
-		vec3 ambient  = ka * lightColor * texColor * 0.2;
-		float diff    = max(dot(N, L), 0.0);
-		vec3 diffuse  = diff * kd * lightColor * texColor * attenuation;
-		vec3 specular = vec3(0.0);
-		if (diff > 0.0) {
-			float spec = pow(max(dot(R, V), 0.0), q);
-			specular = spec * ks * lightColor * attenuation;
+		// Luzes do bloco Lights (FrameUniforms.h)
+		vec3 result = vec3(0.0);
+		for (int i = 0; i < lightCount; ++i) {
+			if (lights[i].position.w == 0.0) continue;
+			vec3 lightColor = lights[i].color.rgb;
+			vec3 L = normalize(lights[i].position.xyz - fragPos);
+			vec3 R = reflect(-L, N);
+			float distance = length(lights[i].position.xyz - fragPos);
+			vec3 k = lights[i].attenuation.xyz;
+			float attenuation = 1.0 / (k.x + k.y * distance + k.z * distance * distance);
+
+			vec3 ambient  = ka * lightColor * texColor * 0.2;
+			float diff    = max(dot(N, L), 0.0);
+			vec3 diffuse  = diff * kd * lightColor * texColor * attenuation;
+			vec3 specular = vec3(0.0);
+			if (diff > 0.0) {
+				float spec = pow(max(dot(R, V), 0.0), q);
+				specular = spec * ks * lightColor * attenuation;
+			}
+			result += ambient + diffuse + specular;
 		}
-		vec3 result = ambient + diffuse + specular;
 		color = vec4(result, 1.0);
 	}
 )";
@@ -205,11 +297,8 @@ const GLchar *bgFragmentShader = R"(
 	}
 )";
 
-const GLchar *curveVertexShader = R"(
-	#version 400
+const GLchar *curveVertexShader = "#version 400\n" FRAME_UNIFORMS_GLSL R"(
 	layout (location = 0) in vec3 position;
-	uniform mat4 view;
-	uniform mat4 projection;
 	void main()
 	{
 			gl_Position = projection * view * vec4(position, 1.0);
@@ -277,8 +366,34 @@ int main()
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
 
-    GLuint shaderID = setupShader();
-    glUseProgram(shaderID);
+    // === Shaders ===
+    // Compilados, linkados e refletidos uma vez; apagados antes do glfwTerminate
+    std::unique_ptr<ShaderProgram> phong(new ShaderProgram);
+    std::unique_ptr<ShaderProgram> bgProgram(new ShaderProgram);
+    std::unique_ptr<ShaderProgram> curveProgram(new ShaderProgram);
+    if (!phong->build("phong", vertexShaderSource, fragmentShaderSource) ||
+        !bgProgram->build("background", bgVertexShader, bgFragmentShader) ||
+        !curveProgram->build("curve", curveVertexShader, curveFragmentShader)) {
+        std::cerr << "Erro ao compilar os shaders" << std::endl;
+        return -1;
+    }
+    PhongUniforms phongUniforms;
+    phongUniforms.resolve(*phong);
+    CurveUniforms curveUniforms;
+    curveUniforms.resolve(*curveProgram);
+
+    // Câmera e luzes num UBO só, lido por todos os programas (FrameUniforms.h)
+    FrameUniforms::attach(*phong);
+    FrameUniforms::attach(*curveProgram);
+    std::unique_ptr<FrameUniforms> frameUniforms(new FrameUniforms);
+    frameUniforms->lights.count = 1;
+    frameUniforms->lights.lights[0].position = glm::vec4(0.0f, 2.0f, 0.0f, 1.0f);
+    frameUniforms->lights.lights[0].color = glm::vec4(1.3f, 1.3f, 1.3f, 1.0f);
+    frameUniforms->lights.lights[0].attenuation = glm::vec4(1.0f, 0.09f, 0.032f, 0.0f);
+    bgProgram->use();
+    bgProgram->uniform<int>("background").set(0);
+    phong->use();
+    phongUniforms.colorBuffer.set(0);
 
 		// === Background ===
 		GLuint bgVAO, bgVBO;
@@ -288,32 +403,63 @@ int main()
 			return -1;
 		}
 
-		GLuint bgShaderID = setupBackgroundShader();
-		if (bgShaderID == 0) {
-			std::cerr << "Erro ao compilar shader background" << std::endl;
-			return -1;
-		}
-
     // === Geometrias ===
     Geometry suzzane = setupGeometry("D:/ComputacaoGrafica/RepoAulas/repo-prof/CGCCHibrido/assets/Modelos3D/SuzanneSubdiv1.obj");
 
     suzzane.position = glm::vec3(-1.0f, 0.0f, -3.0f);
 
-    // === Uniform Locations ===
-    GLint modelLoc = glGetUniformLocation(shaderID, "model");
-    GLint viewLoc  = glGetUniformLocation(shaderID, "view");
-    GLint projLoc  = glGetUniformLocation(shaderID, "projection");
+    // === Hot reload ===
+    // Só o arquivo que mudou é lido de novo, numa thread separada; o quadro
+    // aplica o resultado quando ele fica pronto e nunca espera pelo disco
+    FileWatcher watcher;
+    if (!suzzane.path.empty()) watcher.watch(suzzane.path);
+    if (!suzzane.mtlPath.empty()) watcher.watch(suzzane.mtlPath);
+    if (!suzzane.textureFilePath.empty()) watcher.watch(suzzane.textureFilePath);
+
+    BackgroundReload<CachedMesh> meshReload;
+    meshReload.read = [](const string& path) {
+        CachedMesh mesh;
+        if (!loadMeshCached(path, mesh)) mesh.header.vertexCount = 0;
+        return mesh;
+    };
+    BackgroundReload<vector<ObjMaterial>> materialReload;
+    materialReload.read = [](const string& path) {
+        vector<ObjMaterial> library;
+        parseMtlLibrary(path.c_str(), library);
+        return library;
+    };
+    BackgroundReload<TextureFile> textureReload;
+    textureReload.read = [](const string& path) {
+        TextureFile file;
+        readTexture(path, file);
+        return file;
+    };
+
+    // map_Kd trocado no .mtl: a imagem nova passa a ser observada e é lida como as outras
+    auto useTexture = [&](const ObjMaterial& mat) {
+        string basePath = suzzane.path.substr(0, suzzane.path.find_last_of("/"));
+        string path = mat.diffuseMap.empty() ? string() : basePath + "/" + mat.diffuseMap;
+        if (path == suzzane.textureFilePath) return;
+        suzzane.textureFilePath = path;
+        if (path.empty()) {
+            glDeleteTextures(1, &suzzane.textureID);
+            suzzane.textureID = 0;
+            suzzane.textureLayout = TextureLayout();
+            return;
+        }
+        watcher.watch(path);
+        textureReload.start(path);
+    };
 
     // === Matriz de projeção inicial ===
     glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / height, 0.1f, 100.0f);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+    frameUniforms->frame.projection = projection;
 
 
 		// === Curva parametrica
 		std::vector<glm::vec3> controlPoints = generatePointsSet();
 		std::vector<glm::vec3> bezierCurve = generateBezierCurve(controlPoints, 100);
 
-		GLuint curveShaderID = setupCurveShader();
 		std::vector<glm::vec3> curvePoints = generatePointsSet();
 
 		GLuint curveVAO, curveVBO;
@@ -345,25 +491,55 @@ int main()
 				glfwPollEvents();
 				continous_key_press(window, camera, deltaTime);
 
+				// === Hot reload ===
+				for (const string& changedPath : watcher.poll()) {
+						std::cout << "Recarregando " << changedPath << std::endl;
+						if (changedPath == suzzane.path) meshReload.start(changedPath);
+						else if (changedPath == suzzane.mtlPath) materialReload.start(changedPath);
+						else if (changedPath == suzzane.textureFilePath) textureReload.start(changedPath);
+				}
+				// Leituras que falharam (arquivo inválido) deixam a versão em cena
+				CachedMesh reloadedMesh;
+				if (meshReload.poll(reloadedMesh) && reloadedMesh.header.vertexCount > 0) {
+						uploadMesh(reloadedMesh, suzzane);
+						// O .meshcache refeito já traz o .mtl atual
+						ObjMaterial mat = reloadedMesh.material();
+						applyMaterial(mat, suzzane);
+						useTexture(mat);
+				}
+				vector<ObjMaterial> library;
+				if (materialReload.poll(library) && !library.empty()) {
+						const ObjMaterial* mat = findMaterial(library, suzzane.material);
+						applyMaterial(*mat, suzzane);
+						useTexture(*mat);
+				}
+				TextureFile reloadedTexture;
+				if (textureReload.poll(reloadedTexture) && reloadedTexture.layout.width > 0) {
+						suzzane.textureID = uploadTexture(reloadedTexture, suzzane.textureID, suzzane.textureLayout);
+				}
+
 				// === Limpa a tela (ANTES de desenhar) ===
 				glClearColor(0.05f, 0.05f, 0.1f, 1.0f);
 				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 				// === Renderiza background ===
 				glDisable(GL_DEPTH_TEST);
-				glUseProgram(bgShaderID);
+				bgProgram->use();
 				glActiveTexture(GL_TEXTURE0);
 				glBindTexture(GL_TEXTURE_2D, bgTexture);
-				GLint loc = glGetUniformLocation(bgShaderID, "background");
 				glBindVertexArray(bgVAO);
 				glDrawArrays(GL_TRIANGLES, 0, 6);
 				glBindVertexArray(0);
 
 				// === Renderiza objetos 3D ===
-				glUseProgram(shaderID);
+				phong->use();
 
+				// Câmera do quadro: um envio para todos os programas
 				glm::mat4 view = camera.GetViewMatrix();
-				glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+				frameUniforms->frame.view = view;
+				frameUniforms->frame.cameraPos = camera.Position;
+				frameUniforms->frame.time = currentFrame;
+				frameUniforms->upload();
 
 				auto renderGeometry = [&](const Geometry& geom, int geomId) {
 						glm::mat4 model = glm::mat4(1.0f);
@@ -393,29 +569,23 @@ int main()
 						}
 				
 						// Envia a matriz model para o shader
-						glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+						phongUniforms.model.set(model);
 				
 						// Envia as propriedades do material
-						glUniform3fv(glGetUniformLocation(shaderID, "ka"), 1, glm::value_ptr(geom.ka));
-						glUniform3fv(glGetUniformLocation(shaderID, "kd"), 1, glm::value_ptr(geom.kd));
-						glUniform3fv(glGetUniformLocation(shaderID, "ks"), 1, glm::value_ptr(geom.ks));
-						glUniform3fv(glGetUniformLocation(shaderID, "ke"), 1, glm::value_ptr(geom.ke));
-						glUniform1f(glGetUniformLocation(shaderID, "q"), geom.shininess);
-				
-						// Envia luz e câmera
-						glUniform3f(glGetUniformLocation(shaderID, "lightPos"), 0.0f, 2.0f, 0.0f);
-						glUniform3f(glGetUniformLocation(shaderID, "lightColor"), 1.3f, 1.3f, 1.3f);
-						glUniform3fv(glGetUniformLocation(shaderID, "cameraPos"), 1, glm::value_ptr(camera.Position));
+						phongUniforms.ka.set(geom.ka);
+						phongUniforms.kd.set(geom.kd);
+						phongUniforms.ks.set(geom.ks);
+						phongUniforms.ke.set(geom.ke);
+						phongUniforms.q.set(geom.shininess);
 				
-						// Aplica textura se houver
+						// Aplica textura se houver (colorBuffer fica na unidade 0)
 						glActiveTexture(GL_TEXTURE0);
 						if (geom.textureID > 0)
 								glBindTexture(GL_TEXTURE_2D, geom.textureID);
-						glUniform1i(glGetUniformLocation(shaderID, "colorBuffer"), 0);
 				
 						// Renderiza
 						glBindVertexArray(geom.VAO);
-						glDrawArrays(GL_TRIANGLES, 0, geom.vertexCount);
+						glDrawElements(GL_TRIANGLES, geom.indexCount, geom.indexType, 0);
 						glBindVertexArray(0);
 				};
 			
@@ -434,10 +604,8 @@ int main()
 
 				renderGeometry(suzzane, 1);
 
-				glUseProgram(curveShaderID);
-				glUniformMatrix4fv(glGetUniformLocation(curveShaderID, "view"), 1, GL_FALSE, glm::value_ptr(view));
-				glUniformMatrix4fv(glGetUniformLocation(curveShaderID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-				glUniform4f(glGetUniformLocation(curveShaderID, "finalColor"), 1.0f, 0.5f, 0.2f, 1.0f); // Laranja
+				curveProgram->use();
+				curveUniforms.finalColor.set(glm::vec4(1.0f, 0.5f, 0.2f, 1.0f)); // Laranja
 
 				glBindVertexArray(curveVAO);
 				glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)bezierCurve.size());
@@ -449,6 +617,13 @@ int main()
 
     // Cleanup
     glDeleteVertexArrays(1, &suzzane.VAO);
+    glDeleteBuffers(1, &suzzane.VBO);
+    glDeleteBuffers(1, &suzzane.EBO);
+    glDeleteTextures(1, &suzzane.textureID);
+    frameUniforms.reset();
+    phong.reset();
+    bgProgram.reset();
+    curveProgram.reset();
     glfwTerminate();
     return 0;
 }
@@ -545,315 +720,186 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
     camera.updateCameraVectors();
 }
 
-int setupShader()
+bool readTexture(const string& path, TextureFile& file)
 {
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-	}
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-	}
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success) {
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	return shaderProgram;
-}
+    // Com o .mips do objbake a imagem já vem decodificada e com os mipmaps prontos
+    TextureLayout& layout = file.layout;
+    if (loadBakedTexture(path, file.baked))
+    {
+        file.fromBake = true;
+        layout.width = file.baked.header.levels[0].width;
+        layout.height = file.baked.header.levels[0].height;
+        layout.channels = file.baked.header.channels;
+        layout.format = int(file.baked.format());
+        layout.levels = file.baked.header.levelCount;
+        return true;
+    }
 
-int setupBackgroundShader()
-{
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &bgVertexShader, NULL);
-    glCompileShader(vertexShader);
-
-    GLint success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cerr << "ERROR::BACKGROUND_VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &bgFragmentShader, NULL);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cerr << "ERROR::BACKGROUND_FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cerr << "ERROR::BACKGROUND_PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    return shaderProgram;
+    unsigned char* data = stbi_load(path.c_str(), &layout.width, &layout.height, &layout.channels, 0);
+    if (!data)
+    {
+        cerr << "Failed to load texture: " << path << endl;
+        return false;
+    }
+    file.pixels.assign(data, data + size_t(layout.width) * layout.height * layout.channels);
+    stbi_image_free(data);
+    return true;
 }
 
-int setupCurveShader()
+GLuint uploadTexture(const TextureFile& file, GLuint current, TextureLayout& layout)
 {
-    auto compile = [](GLenum type, const char* src) -> GLuint {
-        GLuint shader = glCreateShader(type);
-        glShaderSource(shader, 1, &src, NULL);
-        glCompileShader(shader);
-        GLint success;
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            char log[512];
-            glGetShaderInfoLog(shader, 512, NULL, log);
-            std::cerr << "Shader compile error: " << log << std::endl;
-        }
-        return shader;
-    };
-
-    GLuint vs = compile(GL_VERTEX_SHADER, curveVertexShader);
-    GLuint fs = compile(GL_FRAGMENT_SHADER, curveFragmentShader);
-
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
+    // Hot reload com o mesmo tamanho e formato: texels novos no mesmo objeto,
+    // o id que a geometria guarda continua valendo
+    bool inPlace = current != 0 && file.layout == layout;
+    GLuint texID = current;
+    if (!inPlace)
+    {
+        glGenTextures(1, &texID);
+        glBindTexture(GL_TEXTURE_2D, texID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    else
+    {
+        glBindTexture(GL_TEXTURE_2D, texID);
+    }
 
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetProgramInfoLog(program, 512, NULL, log);
-        std::cerr << "Shader link error: " << log << std::endl;
+    if (file.fromBake)
+    {
+        // Níveis crus ou BCn (glCompressedTexImage2D), conforme o objbake gravou
+        if (inPlace) updateBakedLevels(file.baked);
+        else uploadBakedLevels(file.baked);
     }
+    else
+    {
+        GLenum format = (file.layout.channels == 3) ? GL_RGB : GL_RGBA;
+        if (inPlace) glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, file.layout.width, file.layout.height, format, GL_UNSIGNED_BYTE, file.pixels.data());
+        else glTexImage2D(GL_TEXTURE_2D, 0, format, file.layout.width, file.layout.height, 0, format, GL_UNSIGNED_BYTE, file.pixels.data());
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
 
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-    return program;
+    // Outro tamanho/formato: a textura nova substitui a antiga de uma vez
+    if (!inPlace && current != 0) glDeleteTextures(1, &current);
+    layout = file.layout;
+    return texID;
 }
 
-int loadTexture(const string& path)
+void uploadMesh(const CachedMesh& mesh, Geometry& geom)
 {
-    GLuint texID;
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-    if (data)
+    GLenum indexType = mesh.header.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    if (geom.VAO && geom.vertexBytes == mesh.vertexBytes() && geom.indexBytes == mesh.indexBytes())
     {
-        GLenum format = (nrChannels == 3) ? GL_RGB : GL_RGBA;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        // Hot reload com os mesmos tamanhos: dados novos nos mesmos buffers, o VAO continua valendo
+        glBindBuffer(GL_ARRAY_BUFFER, geom.VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, mesh.vertexBytes(), mesh.vertices);
+        // Sem VAO ligado, o EBO é preenchido pelo alvo GL_ARRAY_BUFFER
+        glBindBuffer(GL_ARRAY_BUFFER, geom.EBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, mesh.indexBytes(), mesh.indices);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
     else
     {
-        cerr << "Failed to load texture: " << path << endl;
+        // Outros tamanhos: buffers e VAO novos trocam de lugar com os antigos
+        if (geom.VAO)
+        {
+            glDeleteVertexArrays(1, &geom.VAO);
+            glDeleteBuffers(1, &geom.VBO);
+            glDeleteBuffers(1, &geom.EBO);
+        }
+
+        GLuint VBO, EBO, VAO;
+        glGenVertexArrays(1, &VAO);
+        glBindVertexArray(VAO);
+
+        glGenBuffers(1, &VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, mesh.vertexBytes(), mesh.vertices, GL_STATIC_DRAW);
+
+        // O EBO fica registrado no VAO
+        glGenBuffers(1, &EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBytes(), mesh.indices, GL_STATIC_DRAW);
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(5 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(2);
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        geom.VAO = VAO;
+        geom.VBO = VBO;
+        geom.EBO = EBO;
     }
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    return texID;
+    geom.vertexBytes = mesh.vertexBytes();
+    geom.indexBytes = mesh.indexBytes();
+    geom.indexCount = mesh.lod(0).indexCount;
+    geom.indexType = indexType;
 }
 
-bool loadObject(
-	const char* path,
-	std::vector<glm::vec3>& out_vertices,
-	std::vector<glm::vec2>& out_uvs,
-	std::vector<glm::vec3>& out_normals)
+void applyMaterial(const ObjMaterial& mat, Geometry& geom)
 {
-	std::ifstream file(path);
-	if (!file)
-	{
-			std::cerr << "Failed to open file: " << path << std::endl;
-			return false;
-	}
-	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-	std::vector<glm::vec3> temp_vertices;
-	std::vector<glm::vec2> temp_uvs;
-	std::vector<glm::vec3> temp_normals;
-	std::string line;
-	while (std::getline(file, line))
-	{
-			std::istringstream iss(line);
-			std::string type;
-			iss >> type;
-
-			if (type == "v") 
-			{
-					glm::vec3 vertex;
-					iss >> vertex.x >> vertex.y >> vertex.z;
-					temp_vertices.push_back(vertex);
-			}
-			else if (type == "vt") 
-			{
-					glm::vec2 uv;
-					iss >> uv.x >> uv.y;
-					temp_uvs.push_back(uv);
-			}
-			else if (type == "vn") 
-			{
-					glm::vec3 normal;
-					iss >> normal.x >> normal.y >> normal.z;
-					temp_normals.push_back(normal);
-			}
-			else if (type == "f")
-			{
-					unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-					char slash;
-
-					for (int i = 0; i < 3; ++i)
-					{
-							iss >> vertexIndex[i] >> slash >> uvIndex[i] >> slash >> normalIndex[i];
-							vertexIndices.push_back(vertexIndex[i]);
-							uvIndices.push_back(uvIndex[i]);
-							normalIndices.push_back(normalIndex[i]);
-					}
-			}
-			else if (type == "mtllib")
-			{
-					iss >> mtlFilePath;
-			}
-	}
-	for (unsigned int i = 0; i < vertexIndices.size(); ++i)
-	{
-			unsigned int vertexIndex = vertexIndices[i];
-			unsigned int uvIndex = uvIndices[i];
-			unsigned int normalIndex = normalIndices[i];
-			glm::vec3 vertex = temp_vertices[vertexIndex - 1];
-			glm::vec2 uv = temp_uvs[uvIndex - 1];
-			glm::vec3 normal = temp_normals[normalIndex - 1];
-			out_vertices.push_back(vertex);
-			out_uvs.push_back(uv);
-			out_normals.push_back(normal);
-	}
-	file.close();
-	return true;
+    geom.material = mat.name;
+    geom.ka = mat.ka;
+    geom.kd = mat.kd;
+    geom.ks = mat.ks;
+    geom.ke = mat.ke;
+    geom.shininess = mat.shininess;
 }
 
 Geometry setupGeometry(const char* filepath)
 {
-    std::vector<GLfloat> vertices;
-    std::vector<glm::vec3> vert;
-    std::vector<glm::vec2> uvs;
-    std::vector<glm::vec3> normals;
-    loadObject(filepath, vert, uvs, normals);
-    vertices.reserve(vert.size() * 8); 
-    for (size_t i = 0; i < vert.size(); ++i)
+    // Malha soldada e material resolvido vêm do .meshcache ao lado do .obj
+    // (gerado na primeira execução e refeito quando o .obj/.mtl mudar)
+    CachedMesh mesh;
+    if (!loadMeshCached(filepath, mesh))
     {
-      vertices.insert(vertices.end(), {
-				vert[i].x, vert[i].y, vert[i].z,
-				uvs[i].x, uvs[i].y,
-				normals[i].x, normals[i].y, normals[i].z
-				}
-			);
+        std::cerr << "Failed to load geometry: " << filepath << std::endl;
+        return Geometry{};
     }
-    GLuint VBO, VAO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(2);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    mtlFilePath = mesh.header.mtlLib;
+
     Geometry geom;
-    geom.VAO = VAO;
-    geom.vertexCount = vertices.size() / 6;
+    uploadMesh(mesh, geom);
+
+    // Comparação com a versão desenrolada: um vértice de 32 bytes e uma execução do VS por canto
+    size_t corners = mesh.lod(0).indexCount;
+    size_t unrolledBytes = corners * 8 * sizeof(GLfloat);
+    size_t indexedBytes = mesh.vertexBytes() + mesh.indexBytes();
+    std::cout << "Geometria " << filepath << (mesh.fromCache ? " (cache)" : " (cache gerado)") << "\n"
+              << "  vertices: " << corners << " -> " << mesh.header.vertexCount << " unicos"
+              << " (indices de " << mesh.header.indexSize * 8 << " bits)\n"
+              << "  VRAM: " << unrolledBytes / 1024.0 << " KB -> " << indexedBytes / 1024.0 << " KB\n"
+              << "  execucoes do vertex shader: " << corners << " -> " << mesh.header.vertexCount
+              << " (minimo, com cache pos-transformacao)\n"
+              << "  cache pos-transformacao (FIFO " << kVertexCacheSize << "): ACMR " << mesh.header.acmrBefore
+              << " -> " << mesh.header.acmrAfter << ", ATVR " << mesh.header.atvrBefore << " -> " << mesh.header.atvrAfter
+              << std::endl;
+
     string basePath = string(filepath).substr(0, string(filepath).find_last_of("/"));
-    string mtlPath = basePath + "/" + mtlFilePath;
-    Material mat = loadMTL(mtlPath);
-    geom.ka = mat.ka;
-    geom.kd = mat.kd;
-    geom.ks = mat.ks;
-    geom.ke = mat.ke;
-    geom.shininess = mat.shininess;
-    geom.textureFilePath = mat.texturePath;
-    if (!mat.texturePath.empty())
+    geom.path = filepath;
+    geom.mtlPath = mesh.header.mtlLib[0] != '\0' ? basePath + "/" + mesh.header.mtlLib : string();
+    ObjMaterial mat = mesh.material();
+    applyMaterial(mat, geom);
+    geom.textureFilePath = mat.diffuseMap;
+    if (!mat.diffuseMap.empty())
     {
-        string fullTexturePath = basePath + "/" + mat.texturePath;
-        geom.textureID = loadTexture(fullTexturePath);
+        string fullTexturePath = basePath + "/" + mat.diffuseMap;
+        TextureFile texture;
+        if (readTexture(fullTexturePath, texture)) geom.textureID = uploadTexture(texture, 0, geom.textureLayout);
         geom.textureFilePath = fullTexturePath;
     }
     return geom;
 }
 
-Material loadMTL(const string& path)
-{
-	Material mat;
-	ifstream mtlFile(path);
-	if (!mtlFile)
-	{
-			cerr << "Failed to open MTL file: " << path << endl;
-			return mat;
-	}
-
-	string line;
-	while (getline(mtlFile, line))
-	{
-			istringstream iss(line);
-			string keyword;
-			iss >> keyword;
 
-			if (keyword == "map_Kd")
-			{
-					iss >> mat.texturePath;
-			}
-			else if (keyword == "Ka")
-			{
-					iss >> mat.ka.r >> mat.ka.g >> mat.ka.b;
-			}
-			else if (keyword == "Kd")
-			{
-					iss >> mat.kd.r >> mat.kd.g >> mat.kd.b;
-			}
-			else if (keyword == "Ks")
-			{
-					iss >> mat.ks.r >> mat.ks.g >> mat.ks.b;
-			}
-			else if (keyword == "Ke")
-			{
-					iss >> mat.ke.r >> mat.ke.g >> mat.ke.b;
-			}
-			else if (keyword == "Ns")
-			{
-					iss >> mat.shininess;
-			}
-	}
-	return mat;
-}
 
 GLuint setupBg(GLuint &VAO, GLuint &VBO, const char* imagePath)
 {	
@@ -0,0 +1,386 @@
+/*
+ *  objbake: pré-processamento offline dos modelos, sem janela nem contexto OpenGL.
+ *
+ *  Para cada .obj encontrado:
+ *   - lê, solda os vértices, reordena triângulos/vértices (MeshOptimize.cpp),
+ *     gera os LODs (MeshSimplify.cpp) e resolve o .mtl, gravando
+ *     <modelo>.obj.meshcache (vértices indexados, LODs, bounds e constantes do
+ *     material; ver MeshCache.cpp)
+ *   - decodifica a textura difusa de cada material e grava <imagem>.mips com toda
+ *     a cadeia de mipmaps (ver BakedTexture.cpp), por padrão comprimida em
+ *     BC1 (sem alfa) ou BC3 (com alfa); ver TextureCompress.cpp. As linhas
+ *     dos níveis grandes são divididas entre as threads (laço aninhado no pool)
+ *   - imagens com mais de --virtual texels no maior lado também viram
+ *     <imagem>.vtex, a cadeia crua cortada em páginas para a textura virtual
+ *     (ver VirtualTextureFile.cpp); "--virtual off" desliga
+ *
+ *  O setupGeometry/loadTexture dos exercícios usa esses arquivos direto, então
+ *  a inicialização não lê texto, não decodifica PNG e não chama glGenerateMipmap.
+ *  Arquivos já atualizados são mantidos; --force refaz tudo.
+ *
+ *  Uso: objbake [--force] [--threads N] [--lods 0.5,0.25,0.125] [--format auto|raw|bc1|bc3|bc7]
+ *               [--filter box|kaiser] [--virtual N|off] [pasta|arquivo.obj ...]
+ *  Sem caminhos, processa ../assets. Pastas são percorridas recursivamente e
+ *  os modelos (e depois as texturas) são processados em paralelo.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "MeshCache.h"
+#include "BakedTexture.h"
+#include "TextureCompress.h"
+#include "ThreadPool.h"
+#include "VirtualTextureFile.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct MeshJob
+{
+    string path;
+    bool ok = false;
+    bool upToDate = false;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    float acmrBefore = 0.0f, acmrAfter = 0.0f;
+    // Triângulos por LOD, do original ao mais simples
+    vector<uint32_t> lodTriangles;
+    size_t materialCount = 0;
+    vector<string> texturePaths;
+    double ms = 0.0;
+};
+
+struct TextureJob
+{
+    string path;
+    bool ok = false;
+    bool upToDate = false;
+    int width = 0, height = 0, channels = 0;
+    size_t levelCount = 0;
+    TextureFormat format = TextureFormat::Raw;
+    size_t bytes = 0;
+    // Mesma cadeia sem compressão, para o relatório
+    size_t rawBytes = 0;
+    // Também gravada em páginas (.vtex)
+    bool virtualTexture = false;
+    size_t virtualTiles = 0;
+    double ms = 0.0;
+};
+
+// Formato pedido em --format ("auto" escolhe por imagem) e filtro dos mipmaps
+struct FormatOption
+{
+    bool automatic = true;
+    TextureFormat format = TextureFormat::BC1;
+    MipFilter filter = MipFilter::Box;
+    // Maior lado a partir do qual a imagem vira textura virtual (0 = nunca)
+    int virtualThreshold = 4096;
+};
+
+// Páginas do .vtex atual da imagem, ou 0 se não existir ou estiver desatualizado
+size_t virtualTileCount(const string& path)
+{
+    VirtualTextureFile file;
+    if (!loadVirtualTextureFile(path, file)) return 0;
+    size_t tiles = 0;
+    for (uint32_t i = 0; i < file.header.levelCount; ++i) tiles += size_t(file.header.levels[i].tilesX) * file.header.levels[i].tilesY;
+    return tiles;
+}
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+void bakeMesh(MeshJob& job, bool force, const vector<float>& lodRatios)
+{
+    auto start = chrono::steady_clock::now();
+    if (force)
+    {
+        error_code ec;
+        fs::remove(meshCachePath(job.path), ec);
+    }
+
+    CachedMesh mesh;
+    job.ok = loadMeshCached(job.path, mesh, lodRatios);
+    if (job.ok)
+    {
+        job.upToDate = mesh.fromCache;
+        job.vertexCount = mesh.header.vertexCount;
+        job.indexCount = mesh.lod(0).indexCount;
+        for (size_t i = 0; i < mesh.lodCount(); ++i) job.lodTriangles.push_back(mesh.lod(i).indexCount / 3);
+        job.acmrBefore = mesh.header.acmrBefore;
+        job.acmrAfter = mesh.header.acmrAfter;
+        job.materialCount = mesh.materialCount();
+        for (size_t i = 0; i < mesh.materialCount(); ++i)
+        {
+            string diffuseMap = mesh.material(i).diffuseMap;
+            if (!diffuseMap.empty()) job.texturePaths.push_back((fs::path(job.path).parent_path() / diffuseMap).string());
+        }
+    }
+    job.ms = elapsedMs(start);
+}
+
+void bakeTexture(TextureJob& job, bool force, const FormatOption& option, ThreadPool& pool)
+{
+    auto start = chrono::steady_clock::now();
+    if (!force)
+    {
+        BakedTexture baked;
+        TextureFormat format = TextureFormat::Raw;
+        bool matches = false;
+        if (loadBakedTexture(job.path, baked))
+        {
+            format = baked.format();
+            matches = option.automatic ? (format == TextureFormat::BC1 || format == TextureFormat::BC3)
+                                       : format == option.format;
+            int largest = (int)max(baked.header.levels[0].width, baked.header.levels[0].height);
+            if (matches && option.virtualThreshold > 0 && largest > option.virtualThreshold)
+            {
+                job.virtualTiles = virtualTileCount(job.path);
+                job.virtualTexture = matches = job.virtualTiles > 0;
+            }
+        }
+        if (matches)
+        {
+            job.ok = job.upToDate = true;
+            job.width = baked.header.levels[0].width;
+            job.height = baked.header.levels[0].height;
+            job.channels = baked.header.channels;
+            job.levelCount = baked.header.levelCount;
+            job.format = format;
+            for (uint32_t i = 0; i < baked.header.levelCount; ++i)
+            {
+                const BakedTextureLevel& level = baked.header.levels[i];
+                job.bytes += level.size;
+                job.rawBytes += textureLevelBytes(TextureFormat::Raw, level.width, level.height, job.channels);
+            }
+            job.ms = elapsedMs(start);
+            return;
+        }
+    }
+
+    unsigned char* data = stbi_load(job.path.c_str(), &job.width, &job.height, &job.channels, 0);
+    if (data)
+    {
+        // Mesmo critério do loadTexture: 3 canais vira GL_RGB, o resto GL_RGBA
+        int channels = job.channels == 3 ? 3 : 4;
+        if (channels != job.channels)
+        {
+            stbi_image_free(data);
+            data = stbi_load(job.path.c_str(), &job.width, &job.height, &job.channels, channels);
+            job.channels = channels;
+        }
+    }
+    if (!data)
+    {
+        job.ms = elapsedMs(start);
+        return;
+    }
+
+    job.format = option.format;
+    if (option.automatic)
+    {
+        // Alfa só entra no BC3 se alguma parte da imagem não for opaca
+        bool hasAlpha = false;
+        for (size_t i = 3; job.channels == 4 && i < size_t(job.width) * job.height * 4 && !hasAlpha; i += 4)
+        {
+            hasAlpha = data[i] != 255;
+        }
+        job.format = hasAlpha ? TextureFormat::BC3 : TextureFormat::BC1;
+    }
+
+    vector<MipLevel> levels;
+    generateMips(data, job.width, job.height, job.channels, levels, option.filter, &pool);
+    stbi_image_free(data);
+
+    // Páginas a partir da cadeia crua, antes da compressão abaixo trocar os níveis
+    if (option.virtualThreshold > 0 && max(job.width, job.height) > option.virtualThreshold)
+    {
+        job.virtualTexture = writeVirtualTexture(job.path, job.channels, levels);
+        job.virtualTiles = job.virtualTexture ? virtualTileCount(job.path) : 0;
+        if (!job.virtualTexture)
+        {
+            job.ms = elapsedMs(start);
+            return;
+        }
+    }
+
+    // Cada nível comprimido a partir do nível cru, depois do filtro de caixa
+    vector<unsigned char> blocks;
+    for (MipLevel& level : levels)
+    {
+        job.rawBytes += level.pixels.size();
+        if (job.format == TextureFormat::Raw) continue;
+        compressTexture(level.pixels.data(), level.width, level.height, job.channels, job.format, blocks);
+        level.pixels.swap(blocks);
+    }
+
+    job.ok = writeBakedTexture(job.path, job.channels, levels, job.format);
+    job.levelCount = levels.size();
+    for (const MipLevel& level : levels) job.bytes += level.pixels.size();
+    job.ms = elapsedMs(start);
+}
+
+int main(int argc, char** argv)
+{
+    bool force = false;
+    unsigned threads = 0;
+    vector<float> lodRatios = defaultLodRatios();
+    FormatOption textureFormat;
+    vector<string> inputs;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--force") force = true;
+        else if (arg == "--threads" && i + 1 < argc) threads = (unsigned)max(1, atoi(argv[++i]));
+        else if (arg == "--lods" && i + 1 < argc)
+        {
+            // Frações separadas por vírgula; "--lods none" desliga a geração
+            lodRatios.clear();
+            string list = argv[++i];
+            for (size_t pos = 0; pos < list.size() && list != "none";)
+            {
+                size_t comma = list.find(',', pos);
+                if (comma == string::npos) comma = list.size();
+                float ratio = (float)atof(list.substr(pos, comma - pos).c_str());
+                if (ratio > 0.0f && ratio < 1.0f) lodRatios.push_back(ratio);
+                pos = comma + 1;
+            }
+        }
+        else if (arg == "--format" && i + 1 < argc)
+        {
+            string name = argv[++i];
+            textureFormat.automatic = name == "auto";
+            if (name == "raw") textureFormat.format = TextureFormat::Raw;
+            else if (name == "bc1") textureFormat.format = TextureFormat::BC1;
+            else if (name == "bc3") textureFormat.format = TextureFormat::BC3;
+            else if (name == "bc7") textureFormat.format = TextureFormat::BC7;
+            else if (name != "auto")
+            {
+                cerr << "Formato desconhecido: " << name << " (auto, raw, bc1, bc3 ou bc7)" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            string name = argv[++i];
+            if (name == "kaiser") textureFormat.filter = MipFilter::Kaiser;
+            else if (name == "box") textureFormat.filter = MipFilter::Box;
+            else
+            {
+                cerr << "Filtro desconhecido: " << name << " (box ou kaiser)" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--virtual" && i + 1 < argc)
+        {
+            string value = argv[++i];
+            textureFormat.virtualThreshold = value == "off" ? 0 : max(0, atoi(value.c_str()));
+        }
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) inputs.push_back("../assets");
+
+    // === Coleta dos .obj ===
+    vector<MeshJob> meshes;
+    for (const string& input : inputs)
+    {
+        error_code ec;
+        if (fs::is_directory(input, ec))
+        {
+            for (const fs::directory_entry& entry : fs::recursive_directory_iterator(input, ec))
+            {
+                if (entry.is_regular_file() && entry.path().extension() == ".obj")
+                {
+                    meshes.emplace_back();
+                    meshes.back().path = entry.path().string();
+                }
+            }
+        }
+        else if (fs::is_regular_file(input, ec))
+        {
+            meshes.emplace_back();
+            meshes.back().path = input;
+        }
+        else
+        {
+            cerr << "Caminho nao encontrado: " << input << endl;
+        }
+    }
+    sort(meshes.begin(), meshes.end(), [](const MeshJob& a, const MeshJob& b) { return a.path < b.path; });
+    if (meshes.empty())
+    {
+        cerr << "Nenhum .obj encontrado" << endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    auto start = chrono::steady_clock::now();
+
+    // === Modelos ===
+    pool.parallelFor(meshes.size(), [&](size_t i) { bakeMesh(meshes[i], force, lodRatios); });
+
+    // === Texturas (uma vez cada, mesmo se compartilhadas entre modelos) ===
+    set<string> uniqueTextures;
+    for (const MeshJob& mesh : meshes)
+    {
+        if (mesh.ok) uniqueTextures.insert(mesh.texturePaths.begin(), mesh.texturePaths.end());
+    }
+    vector<TextureJob> textures(uniqueTextures.size());
+    size_t t = 0;
+    for (const string& path : uniqueTextures) textures[t++].path = path;
+    pool.parallelFor(textures.size(), [&](size_t i) { bakeTexture(textures[i], force, textureFormat, pool); });
+
+    double totalMs = elapsedMs(start);
+
+    // === Relatório ===
+    int failures = 0;
+    cout << fixed << setprecision(2);
+    cout << left << setw(48) << "modelo" << right << setw(10) << "vertices" << setw(10) << "indices"
+         << setw(16) << "ACMR" << setw(24) << "triangulos por LOD" << setw(11) << "materiais" << setw(10) << "ms" << "  estado" << endl;
+    for (const MeshJob& mesh : meshes)
+    {
+        if (!mesh.ok) ++failures;
+        string acmr = to_string(mesh.acmrBefore).substr(0, 4) + " -> " + to_string(mesh.acmrAfter).substr(0, 4);
+        string lods;
+        for (uint32_t triangles : mesh.lodTriangles) lods += (lods.empty() ? "" : "/") + to_string(triangles);
+        cout << left << setw(48) << mesh.path << right << setw(10) << mesh.vertexCount << setw(10) << mesh.indexCount
+             << setw(16) << acmr << setw(24) << lods << setw(11) << mesh.materialCount << setw(10) << mesh.ms << "  " << (!mesh.ok ? "FALHOU" : mesh.upToDate ? "atualizado" : "gerado") << endl;
+    }
+
+    if (!textures.empty())
+    {
+        cout << endl << left << setw(48) << "textura" << right << setw(12) << "tamanho" << setw(8) << "niveis"
+             << setw(9) << "formato" << setw(10) << "KB" << setw(10) << "KB cru" << setw(9) << "reducao"
+             << setw(10) << "ms" << "  estado" << endl;
+        for (const TextureJob& tex : textures)
+        {
+            if (!tex.ok) ++failures;
+            string size = to_string(tex.width) + "x" + to_string(tex.height);
+            string ratio = tex.bytes ? to_string(double(tex.rawBytes) / tex.bytes).substr(0, 4) + "x" : "-";
+            cout << left << setw(48) << tex.path << right << setw(12) << size << setw(8) << tex.levelCount
+                 << setw(9) << textureFormatName(tex.format) << setw(10) << tex.bytes / 1024.0
+                 << setw(10) << tex.rawBytes / 1024.0 << setw(9) << ratio << setw(10) << tex.ms << "  "
+                 << (!tex.ok ? "FALHOU" : tex.upToDate ? "atualizado" : "gerado") << endl;
+            if (tex.virtualTexture)
+            {
+                cout << "  virtual: " << tex.virtualTiles << " paginas de " << kVirtualTileSize << "x" << kVirtualTileSize
+                     << " em " << virtualTexturePath(tex.path) << endl;
+            }
+        }
+    }
+
+    cout << endl << meshes.size() << " modelos, " << textures.size() << " texturas em " << totalMs << " ms ("
+         << pool.size() << " threads)" << endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,276 @@
+/*
+ *  Benchmark dos leitores de .OBJ do repositório.
+ *
+ *  Compara, para cada arquivo:
+ *   - loadObject (std::istringstream por linha, como em GB.cpp/M6.cpp)
+ *   - loadSimpleOBJ (CodeSnippets/LoadSimpleOBJ.cpp, inclui o envio do VBO)
+ *   - loadObjectMapped (CodeSnippets/ObjLoader.cpp, mmap + std::from_chars)
+ *
+ *  Em seguida mede a leitura paralela (parseObj em blocos) com 1, 2, 4, ...
+ *  threads até o número de núcleos, conferindo a saída contra loadObject,
+ *  o efeito da solda de vértices (buildIndexedMesh) no tamanho dos buffers
+ *  e o ACMR/ATVR (cache pós-transformação) antes e depois de optimizeMesh.
+ *
+ *  Uso: ObjBench [iteracoes] [arquivo.obj ...]
+ *  Sem arquivos, mede os modelos de assets/Modelos3D.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "LoadSimpleObj.h"
+#include "ObjLoader.h"
+#include "MeshOptimize.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+bool loadObject(
+    const char* path,
+    std::vector<glm::vec3>& out_vertices,
+    std::vector<glm::vec2>& out_uvs,
+    std::vector<glm::vec3>& out_normals);
+
+string mtlFilePath = "";
+
+// Menor tempo (ms) entre as iterações, para descontar ruído de cache/SO
+double measure(int iterations, const function<void()>& fn)
+{
+    double best = 1e30;
+    for (int i = 0; i < iterations; ++i)
+    {
+        auto start = chrono::high_resolution_clock::now();
+        fn();
+        auto end = chrono::high_resolution_clock::now();
+        best = min(best, chrono::duration<double, milli>(end - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? max(1, atoi(argv[1])) : 10;
+    vector<string> files;
+    for (int i = 2; i < argc; ++i) files.push_back(argv[i]);
+    if (files.empty())
+    {
+        files = {
+            "../assets/Modelos3D/Cube.obj",
+            "../assets/Modelos3D/Suzanne.obj",
+            "../assets/Modelos3D/SuzanneSubdiv1.obj"
+        };
+    }
+
+    // loadSimpleOBJ cria VAO/VBO, então precisa de um contexto (janela oculta)
+    glfwInit();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "ObjBench", nullptr, nullptr);
+    bool hasGL = window != nullptr;
+    if (hasGL)
+    {
+        glfwMakeContextCurrent(window);
+        hasGL = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) != 0;
+    }
+    if (!hasGL) cerr << "Sem contexto OpenGL: loadSimpleOBJ nao sera medido" << endl;
+
+    cout << fixed << setprecision(3);
+    cout << left << setw(40) << "arquivo" << right
+         << setw(14) << "loadObject" << setw(14) << "loadSimpleOBJ" << setw(14) << "mapped"
+         << setw(10) << "ganho" << "  saida" << endl;
+
+    for (const string& file : files)
+    {
+        vector<glm::vec3> refV, refN, v, n;
+        vector<glm::vec2> refUV, uv;
+
+        double tStream = measure(iterations, [&]() {
+            refV.clear(); refUV.clear(); refN.clear();
+            loadObject(file.c_str(), refV, refUV, refN);
+        });
+
+        double tSimple = -1.0;
+        if (hasGL)
+        {
+            tSimple = measure(iterations, [&]() {
+                int nVertices;
+                GLuint VAO = loadSimpleOBJ(file, nVertices);
+                glDeleteVertexArrays(1, &VAO);
+            });
+        }
+
+        double tMapped = measure(iterations, [&]() {
+            v.clear(); uv.clear(); n.clear();
+            string mtl;
+            loadObjectMapped(file.c_str(), v, uv, n, mtl, 1);
+        });
+
+        bool same = refV == v && refUV == uv && refN == n;
+
+        cout << left << setw(40) << file << right
+             << setw(14) << tStream << setw(14) << tSimple << setw(14) << tMapped
+             << setw(9) << tStream / max(tMapped, 1e-6) << "x"
+             << "  " << (same ? "identica" : "DIFERENTE") << endl;
+    }
+
+    // Escalabilidade da leitura em blocos
+    vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < ThreadPool::defaultThreadCount(); t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(ThreadPool::defaultThreadCount());
+
+    cout << endl << left << setw(40) << "arquivo" << right << setw(10) << "threads"
+         << setw(14) << "parse+expand" << setw(10) << "speedup" << "  saida" << endl;
+    for (const string& file : files)
+    {
+        vector<glm::vec3> refV, refN;
+        vector<glm::vec2> refUV;
+        loadObject(file.c_str(), refV, refUV, refN);
+
+        double base = 0.0;
+        for (unsigned threads : threadCounts)
+        {
+            vector<glm::vec3> v, n;
+            vector<glm::vec2> uv;
+            double ms = measure(iterations, [&]() {
+                v.clear(); uv.clear(); n.clear();
+                ObjData data;
+                parseObj(file.c_str(), data, threads);
+                expandObj(data, v, uv, n);
+            });
+            if (threads == 1) base = ms;
+            bool same = refV == v && refUV == uv && refN == n;
+
+            cout << left << setw(40) << file << right << setw(10) << threads
+                 << setw(14) << ms << setw(9) << base / max(ms, 1e-6) << "x"
+                 << "  " << (same ? "identica" : "DIFERENTE") << endl;
+        }
+    }
+
+    // Solda de vértices: geometria desenrolada x indexada
+    cout << endl << left << setw(40) << "arquivo" << right << setw(10) << "cantos" << setw(10) << "unicos"
+         << setw(14) << "KB desenr." << setw(14) << "KB index." << setw(12) << "solda ms" << endl;
+    for (const string& file : files)
+    {
+        ObjData data;
+        parseObj(file.c_str(), data, 1);
+        IndexedMesh mesh;
+        double ms = measure(iterations, [&]() { buildIndexedMesh(data, mesh); });
+
+        size_t indexSize = mesh.fitsUint16() ? sizeof(uint16_t) : sizeof(uint32_t);
+        double unrolledKB = data.corners.size() * kObjFloatsPerVertex * sizeof(float) / 1024.0;
+        double indexedKB = (mesh.vertices.size() * sizeof(float) + mesh.indices.size() * indexSize) / 1024.0;
+
+        cout << left << setw(40) << file << right << setw(10) << data.corners.size() << setw(10) << mesh.vertexCount()
+             << setw(14) << unrolledKB << setw(14) << indexedKB << setw(12) << ms << endl;
+    }
+
+    // Ordem dos triângulos: cache pós-transformação antes/depois de optimizeMesh
+    cout << endl << left << setw(40) << "arquivo" << right << setw(10) << "ACMR" << setw(10) << "ACMR opt"
+         << setw(10) << "ATVR" << setw(10) << "ATVR opt" << setw(10) << "grupos" << setw(12) << "otimiz. ms" << endl;
+    for (const string& file : files)
+    {
+        ObjData data;
+        parseObj(file.c_str(), data, 1);
+        IndexedMesh welded;
+        buildIndexedMesh(data, welded);
+
+        MeshOptimizeStats stats;
+        double ms = measure(iterations, [&]() {
+            IndexedMesh mesh = welded;
+            optimizeMesh(mesh, &stats);
+        });
+
+        cout << left << setw(40) << file << right << setw(10) << stats.before.acmr << setw(10) << stats.after.acmr
+             << setw(10) << stats.before.atvr << setw(10) << stats.after.atvr << setw(10) << stats.clusters
+             << setw(12) << ms << endl;
+    }
+
+    if (window) glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
+
+// Cópia do loadObject de GB.cpp antes da troca pelo leitor mapeado (referência do benchmark)
+bool loadObject(
+	const char* path,
+	std::vector<glm::vec3>& out_vertices,
+	std::vector<glm::vec2>& out_uvs,
+	std::vector<glm::vec3>& out_normals)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+			std::cerr << "Failed to open file: " << path << std::endl;
+			return false;
+	}
+	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
+	std::vector<glm::vec3> temp_vertices;
+	std::vector<glm::vec2> temp_uvs;
+	std::vector<glm::vec3> temp_normals;
+	std::string line;
+	while (std::getline(file, line))
+	{
+			std::istringstream iss(line);
+			std::string type;
+			iss >> type;
+
+			if (type == "v")
+			{
+					glm::vec3 vertex;
+					iss >> vertex.x >> vertex.y >> vertex.z;
+					temp_vertices.push_back(vertex);
+			}
+			else if (type == "vt")
+			{
+					glm::vec2 uv;
+					iss >> uv.x >> uv.y;
+					temp_uvs.push_back(uv);
+			}
+			else if (type == "vn")
+			{
+					glm::vec3 normal;
+					iss >> normal.x >> normal.y >> normal.z;
+					temp_normals.push_back(normal);
+			}
+			else if (type == "f")
+			{
+					unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
+					char slash;
+
+					for (int i = 0; i < 3; ++i)
+					{
+							iss >> vertexIndex[i] >> slash >> uvIndex[i] >> slash >> normalIndex[i];
+							vertexIndices.push_back(vertexIndex[i]);
+							uvIndices.push_back(uvIndex[i]);
+							normalIndices.push_back(normalIndex[i]);
+					}
+			}
+			else if (type == "mtllib")
+			{
+					iss >> mtlFilePath;
+			}
+	}
+	for (unsigned int i = 0; i < vertexIndices.size(); ++i)
+	{
+			unsigned int vertexIndex = vertexIndices[i];
+			unsigned int uvIndex = uvIndices[i];
+			unsigned int normalIndex = normalIndices[i];
+			glm::vec3 vertex = temp_vertices[vertexIndex - 1];
+			glm::vec2 uv = temp_uvs[uvIndex - 1];
+			glm::vec3 normal = temp_normals[normalIndex - 1];
+			out_vertices.push_back(vertex);
+			out_uvs.push_back(uv);
+			out_normals.push_back(normal);
+	}
+	file.close();
+	return true;
+}
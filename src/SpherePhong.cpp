@@ -27,6 +27,10 @@ using namespace std;
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <vector>
+#include "ObjLoader.h"
+#include "VertexQuantize.h"
+
 using namespace glm;
 
 #include <cmath>
@@ -40,8 +44,11 @@ int setupGeometry();
 GLuint loadTexture(string filePath, int &width, int &height);
 
 void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, float angle, int nVertices, vec3 color= vec3(1.0,0.0,0.0), vec3 axis = (vec3(0.0, 0.0, 1.0)));
-GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVertices);
- 
+GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVertices, vec3 &positionOffset, vec3 &positionScale);
+
+// true = vértices de 16 bytes (VertexQuantize.h), false = 8 floats por vértice
+bool quantizedVertices = true;
+
 // Dimensões da janela (pode ser alterado em tempo de execução)
 const GLuint WIDTH = 800, HEIGHT = 800;
 
@@ -49,24 +56,40 @@ const GLuint WIDTH = 800, HEIGHT = 800;
 const GLchar *vertexShaderSource = R"(
 #version 400
 layout (location = 0) in vec3 position;
-layout (location = 1) in vec3 color;
 layout (location = 2) in vec3 normal;
 layout (location = 3) in vec2 texc;
 
 uniform mat4 projection;
 uniform mat4 model;
+uniform vec3 objectColor;
+
+// Layout compacto (VertexQuantize.h): posição UNORM16 na caixa da esfera, normal octaédrica
+uniform bool quantized;
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
 
 out vec2 texCoord;
 out vec3 vNormal;
 out vec4 fragPos; 
 out vec4 vColor;
+
+vec3 octDecode(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
 void main()
 {
-   	gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
-	fragPos = model * vec4(position.x, position.y, position.z, 1.0);
+	vec3 objPos = quantized ? positionOffset + position * positionScale : position;
+   	gl_Position = projection * model * vec4(objPos, 1.0);
+	fragPos = model * vec4(objPos, 1.0);
 	texCoord = texc;
-	vNormal = normal;
-	vColor = vec4(color,1.0);
+	vNormal = quantized ? octDecode(normal.xy) : normal;
+	vColor = vec4(objectColor,1.0);
 })";
 
 // Código fonte do Fragment Shader (em GLSL): ainda hardcoded
@@ -160,7 +183,8 @@ int main()
 
 	// Gerando um buffer simples, com a geometria de um triângulo
 	int nVertices;
-	GLuint VAO = generateSphere(0.5, 16, 16, nVertices);
+	vec3 positionOffset, positionScale;
+	GLuint VAO = generateSphere(0.5, 16, 16, nVertices, positionOffset, positionScale);
 
 	// Carregando uma textura e armazenando seu id
 	int imgWidth, imgHeight;
@@ -183,6 +207,11 @@ int main()
 	glUniform3f(glGetUniformLocation(shaderID, "lightPos"), lightPos.x,lightPos.y,lightPos.z);
 	glUniform3f(glGetUniformLocation(shaderID, "camPos"), camPos.x,camPos.y,camPos.z);
 
+	// Decodificação do layout compacto
+	glUniform1i(glGetUniformLocation(shaderID, "quantized"), quantizedVertices);
+	glUniform3f(glGetUniformLocation(shaderID, "positionOffset"), positionOffset.x, positionOffset.y, positionOffset.z);
+	glUniform3f(glGetUniformLocation(shaderID, "positionScale"), positionScale.x, positionScale.y, positionScale.z);
+
 	//Ativando o primeiro buffer de textura da OpenGL
 	glActiveTexture(GL_TEXTURE0);
 	
@@ -404,16 +433,14 @@ void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, f
 	model = scale(model, dimensions);
 	glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
 
-	//glUniform4f(glGetUniformLocation(shaderID, "inputColor"), color.r, color.g, color.b, 1.0f); // enviando cor para variável uniform inputColor
+	glUniform3f(glGetUniformLocation(shaderID, "objectColor"), color.r, color.g, color.b); // cor constante do objeto (antes repetida em cada vértice)
 																								//  Chamada de desenho - drawcall
 																								//  Poligono Preenchido - GL_TRIANGLES
 	glDrawArrays(GL_TRIANGLES, 0, nVertices);
 }
 
-GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVertices) {
-    vector<GLfloat> vBuffer; // Posição + Cor + Normal + UV
-
-    vec3 color = vec3(1.0f, 0.0f, 0.0f); // Laranja
+GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVertices, vec3 &positionOffset, vec3 &positionScale) {
+    vector<GLfloat> vBuffer; // Posição + UV + Normal (mesmo layout dos .obj); a cor vem do uniform objectColor
 
     auto calcPosUVNormal = [&](int lat, int lon, vec3& pos, vec2& uv, vec3& normal) {
         float theta = lat * pi<float>() / latSegments;
@@ -446,17 +473,19 @@ GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVert
             calcPosUVNormal(i + 1, j + 1, v3, uv3, n3);
 
             // Primeiro triângulo
-            vBuffer.insert(vBuffer.end(), { v0.x, v0.y, v0.z, color.r, color.g, color.b, n0.x, n0.y, n0.z, uv0.x, uv0.y });
-            vBuffer.insert(vBuffer.end(), { v1.x, v1.y, v1.z, color.r, color.g, color.b, n1.x, n1.y, n1.z, uv1.x, uv1.y });
-            vBuffer.insert(vBuffer.end(), { v2.x, v2.y, v2.z, color.r, color.g, color.b, n2.x, n2.y, n2.z, uv2.x, uv2.y });
+            vBuffer.insert(vBuffer.end(), { v0.x, v0.y, v0.z, uv0.x, uv0.y, n0.x, n0.y, n0.z });
+            vBuffer.insert(vBuffer.end(), { v1.x, v1.y, v1.z, uv1.x, uv1.y, n1.x, n1.y, n1.z });
+            vBuffer.insert(vBuffer.end(), { v2.x, v2.y, v2.z, uv2.x, uv2.y, n2.x, n2.y, n2.z });
 
             // Segundo triângulo
-            vBuffer.insert(vBuffer.end(), { v1.x, v1.y, v1.z, color.r, color.g, color.b, n1.x, n1.y, n1.z, uv1.x, uv1.y });
-            vBuffer.insert(vBuffer.end(), { v3.x, v3.y, v3.z, color.r, color.g, color.b, n3.x, n3.y, n3.z, uv3.x, uv3.y });
-            vBuffer.insert(vBuffer.end(), { v2.x, v2.y, v2.z, color.r, color.g, color.b, n2.x, n2.y, n2.z, uv2.x, uv2.y });
+            vBuffer.insert(vBuffer.end(), { v1.x, v1.y, v1.z, uv1.x, uv1.y, n1.x, n1.y, n1.z });
+            vBuffer.insert(vBuffer.end(), { v3.x, v3.y, v3.z, uv3.x, uv3.y, n3.x, n3.y, n3.z });
+            vBuffer.insert(vBuffer.end(), { v2.x, v2.y, v2.z, uv2.x, uv2.y, n2.x, n2.y, n2.z });
         }
     }
 
+    nVertices = vBuffer.size() / kObjFloatsPerVertex; // 8 floats por vértice
+
     // Criar VAO e VBO
     GLuint VAO, VBO;
     glGenVertexArrays(1, &VAO);
@@ -465,27 +494,44 @@ GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVert
     glBindVertexArray(VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
-
-    // Layout da posição (location 0)
-glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(0));
-glEnableVertexAttribArray(0);
-
-// Layout da cor (location 1)
-glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-glEnableVertexAttribArray(1);
 
-// Layout da normal (location 2)
-glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
-glEnableVertexAttribArray(2);
-
-// Layout da UV (location 3)
-glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(9 * sizeof(GLfloat)));
-glEnableVertexAttribArray(3);
+    if (quantizedVertices)
+    {
+        // 16 bytes por vértice, contra 44 do layout antigo (com cor) e 32 do layout em float
+        QuantizedMesh packed;
+        quantizeVertices(vBuffer.data(), nVertices, vec3(-radius), vec3(radius), packed);
+        glBufferData(GL_ARRAY_BUFFER, packed.bytes(), packed.vertices.data(), GL_STATIC_DRAW);
+        positionOffset = packed.positionOffset;
+        positionScale = packed.positionScale;
+
+        GLenum uvType = packed.halfUVs ? GL_HALF_FLOAT : GL_UNSIGNED_SHORT;
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, position));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(3, 2, uvType, packed.halfUVs ? GL_FALSE : GL_TRUE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, uv));
+        glEnableVertexAttribArray(3);
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
+        positionOffset = vec3(0.0f);
+        positionScale = vec3(1.0f);
+
+        // Layout da posição (location 0)
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(0));
+        glEnableVertexAttribArray(0);
+
+        // Layout da normal (location 2)
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(5 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(2);
+
+        // Layout da UV (location 3)
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(3);
+    }
 
     glBindVertexArray(0);
 
-    nVertices = vBuffer.size() / 11; // Cada vértice agora tem 11 floats!
-
     return VAO;
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+/*
+ *  Cena com centenas de props instanciados a partir de poucos modelos: compara
+ *  carregar a textura de cada prop por conta própria (um decode e uma textura
+ *  por objeto, como o loadTexture dos exercícios) com o TextureCache.
+ *
+ *  Para cada modo mostra decodes, texturas criadas, memória de textura na GPU
+ *  e tempo total (decode + upload). No fim confere que os releases apagaram
+ *  todas as texturas do cache.
+ *
+ *  Uso: TextureCacheBench [props] [arquivo.obj ...]
+ *  Sem arquivos, distribui os props entre os modelos de assets/Modelos3D.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "MeshCache.h"
+#include "TextureCache.h"
+
+using namespace std;
+
+struct BenchResult
+{
+    size_t decodes = 0;
+    size_t textures = 0;
+    size_t bytes = 0;
+    double ms = 0.0;
+};
+
+static double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Cada prop decodifica e cria a própria textura
+static BenchResult loadWithoutCache(const vector<string>& propTextures)
+{
+    BenchResult result;
+    vector<GLuint> ids;
+    auto start = chrono::steady_clock::now();
+    for (const string& path : propTextures)
+    {
+        TextureData data;
+        if (!decodeTexture(path, data)) continue;
+        ++result.decodes;
+        result.bytes += textureBytes(data);
+        uploadTexture(data, TextureParams());
+        ids.push_back(data.textureID);
+    }
+    glFinish();
+    result.ms = elapsedMs(start);
+    result.textures = ids.size();
+    glDeleteTextures((GLsizei)ids.size(), ids.data());
+    return result;
+}
+
+// Todos os props pedem ao mesmo cache
+static BenchResult loadWithCache(const vector<string>& propTextures, TextureCacheStats& stats)
+{
+    TextureCache cache;
+    vector<TextureHandle> handles;
+    auto start = chrono::steady_clock::now();
+    for (const string& path : propTextures)
+    {
+        TextureHandle handle = cache.acquire(path);
+        if (!handle) continue;
+        cache.upload(handle);
+        handles.push_back(handle);
+    }
+    glFinish();
+
+    BenchResult result;
+    result.ms = elapsedMs(start);
+    stats = cache.stats();
+    result.decodes = stats.decodes;
+    result.textures = stats.textures;
+    result.bytes = stats.bytesResident;
+
+    for (TextureHandle handle : handles) cache.release(handle);
+    if (cache.stats().textures != 0)
+    {
+        cerr << "Texturas ainda vivas depois de soltar todas as referencias: " << cache.stats().textures << endl;
+    }
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int props = argc > 1 ? max(1, atoi(argv[1])) : 300;
+    vector<string> files;
+    for (int i = 2; i < argc; ++i) files.push_back(argv[i]);
+    if (files.empty())
+    {
+        files = {
+            "../assets/Modelos3D/Cube.obj",
+            "../assets/Modelos3D/Suzanne.obj",
+            "../assets/Modelos3D/SuzanneSubdiv1.obj"
+        };
+    }
+
+    // map_Kd de cada modelo, resolvido como no setupGeometry
+    vector<string> modelTextures;
+    for (const string& file : files)
+    {
+        CachedMesh mesh;
+        if (!loadMeshCached(file, mesh)) continue;
+        ObjMaterial mat = mesh.material();
+        if (mat.diffuseMap.empty()) continue;
+        modelTextures.push_back(file.substr(0, file.find_last_of("/")) + "/" + mat.diffuseMap);
+    }
+    if (modelTextures.empty())
+    {
+        cerr << "Nenhum modelo com textura" << endl;
+        return 1;
+    }
+    vector<string> propTextures;
+    for (int i = 0; i < props; ++i) propTextures.push_back(modelTextures[i % modelTextures.size()]);
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "TextureCacheBench", nullptr, nullptr);
+    if (!window)
+    {
+        cerr << "Nao foi possivel criar o contexto OpenGL" << endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        cerr << "Failed to initialize GLAD" << endl;
+        return 1;
+    }
+
+    BenchResult without = loadWithoutCache(propTextures);
+    TextureCacheStats stats;
+    BenchResult with = loadWithCache(propTextures, stats);
+
+    cout << props << " props, " << modelTextures.size() << " texturas distintas nos modelos" << endl << endl;
+    cout << fixed << setprecision(2);
+    cout << left << setw(12) << "modo" << right << setw(10) << "decodes" << setw(10) << "texturas"
+         << setw(12) << "MB na GPU" << setw(12) << "ms" << endl;
+    cout << left << setw(12) << "sem cache" << right << setw(10) << without.decodes << setw(10) << without.textures
+         << setw(12) << without.bytes / (1024.0 * 1024.0) << setw(12) << without.ms << endl;
+    cout << left << setw(12) << "com cache" << right << setw(10) << with.decodes << setw(10) << with.textures
+         << setw(12) << with.bytes / (1024.0 * 1024.0) << setw(12) << with.ms << endl;
+    cout << endl << "decodes evitados: " << stats.pathHits << " pelo caminho, " << stats.contentHits
+         << " imagens repetidas em arquivos diferentes" << endl;
+    cout << "memoria de textura economizada: " << stats.bytesSaved / (1024.0 * 1024.0) << " MB" << endl;
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
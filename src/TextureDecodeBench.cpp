@@ -0,0 +1,175 @@
+/*
+ *  Vazão de decodificação de texturas (PNG/JPG via stb_image + mipmaps na CPU),
+ *  sem janela nem contexto OpenGL.
+ *
+ *  Compara o caminho serial de hoje (uma imagem depois da outra na thread
+ *  principal) com o pool de threads:
+ *   - serial, só stbi_load (o que o loadTexture faz antes do glGenerateMipmap)
+ *   - serial, stbi_load + mipmaps
+ *   - paralelo entre texturas (uma imagem por tarefa)
+ *   - paralelo entre texturas e, dentro de cada uma, as linhas de cada nível
+ *     divididas entre as threads (ajuda quando há poucas imagens grandes)
+ *  MB/s contam os bytes decodificados do nível 0.
+ *
+ *  Uso: TextureDecodeBench [--threads N] [--repeat R] [--filter box|kaiser] [imagem ...]
+ *  Sem imagens, usa os .png/.jpg de ../assets.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "BakedTexture.h"
+#include "ThreadPool.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct DecodeResult
+{
+    size_t images = 0;
+    size_t bytes = 0;
+    double ms = 0.0;
+};
+
+static double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Uma imagem: decodifica (mesmo critério de canais do loadTexture) e gera os mipmaps
+static size_t decodeImage(const string& path, bool mips, MipFilter filter, ThreadPool* rowPool)
+{
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 0);
+    if (pixels && channels != 3 && channels != 4)
+    {
+        stbi_image_free(pixels);
+        pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        channels = 4;
+    }
+    if (!pixels) return 0;
+
+    if (mips)
+    {
+        vector<MipLevel> levels;
+        generateMips(pixels, width, height, channels, levels, filter, rowPool);
+    }
+    stbi_image_free(pixels);
+    return size_t(width) * height * channels;
+}
+
+static DecodeResult runSerial(const vector<string>& images, bool mips, MipFilter filter)
+{
+    DecodeResult result;
+    auto start = chrono::steady_clock::now();
+    for (const string& path : images)
+    {
+        size_t bytes = decodeImage(path, mips, filter, nullptr);
+        result.bytes += bytes;
+        result.images += bytes ? 1 : 0;
+    }
+    result.ms = elapsedMs(start);
+    return result;
+}
+
+static DecodeResult runParallel(const vector<string>& images, MipFilter filter, ThreadPool& pool, bool splitRows)
+{
+    vector<size_t> bytes(images.size(), 0);
+    auto start = chrono::steady_clock::now();
+    pool.parallelFor(images.size(), [&](size_t i) {
+        bytes[i] = decodeImage(images[i], true, filter, splitRows ? &pool : nullptr);
+    });
+
+    DecodeResult result;
+    result.ms = elapsedMs(start);
+    for (size_t b : bytes)
+    {
+        result.bytes += b;
+        result.images += b ? 1 : 0;
+    }
+    return result;
+}
+
+static void printRow(const string& mode, const DecodeResult& result, double serialMs)
+{
+    double mb = result.bytes / (1024.0 * 1024.0);
+    cout << left << setw(44) << mode << right << setw(8) << result.images << setw(10) << mb << setw(12) << result.ms
+         << setw(10) << (result.ms > 0.0 ? mb / (result.ms / 1000.0) : 0.0) << setw(10)
+         << (result.ms > 0.0 ? serialMs / result.ms : 0.0) << "x" << endl;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned threads = 0;
+    int repeat = 4;
+    MipFilter filter = MipFilter::Box;
+    vector<string> inputs;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) threads = (unsigned)max(1, atoi(argv[++i]));
+        else if (arg == "--repeat" && i + 1 < argc) repeat = max(1, atoi(argv[++i]));
+        else if (arg == "--filter" && i + 1 < argc) filter = string(argv[++i]) == "kaiser" ? MipFilter::Kaiser : MipFilter::Box;
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty())
+    {
+        error_code ec;
+        for (const fs::directory_entry& entry : fs::recursive_directory_iterator("../assets", ec))
+        {
+            string ext = entry.path().extension().string();
+            if (entry.is_regular_file() && (ext == ".png" || ext == ".jpg")) inputs.push_back(entry.path().string());
+        }
+        sort(inputs.begin(), inputs.end());
+    }
+    if (inputs.empty())
+    {
+        cerr << "Nenhuma imagem encontrada" << endl;
+        return 1;
+    }
+
+    // Repetidas para a medida não ficar dominada por uma imagem só
+    vector<string> images;
+    for (int r = 0; r < repeat; ++r) images.insert(images.end(), inputs.begin(), inputs.end());
+
+    ThreadPool pool(threads);
+    cout << images.size() << " imagens (" << inputs.size() << " x " << repeat << "), " << pool.size()
+         << " threads, filtro " << (filter == MipFilter::Kaiser ? "kaiser" : "caixa") << endl << endl;
+
+    cout << fixed << setprecision(2);
+    cout << left << setw(44) << "modo" << right << setw(8) << "imagens" << setw(10) << "MB" << setw(12) << "ms"
+         << setw(10) << "MB/s" << setw(11) << "ganho" << endl;
+
+    DecodeResult decodeOnly = runSerial(images, false, filter);
+    DecodeResult serial = runSerial(images, true, filter);
+    printRow("serial, so stbi_load", decodeOnly, serial.ms);
+    printRow("serial, stbi_load + mipmaps", serial, serial.ms);
+    printRow("paralelo entre texturas", runParallel(images, filter, pool, false), serial.ms);
+    printRow("paralelo entre texturas e linhas", runParallel(images, filter, pool, true), serial.ms);
+
+    // Uma imagem só: aqui só a divisão das linhas ajuda
+    vector<string> largest(1, inputs[0]);
+    size_t largestSize = 0;
+    for (const string& path : inputs)
+    {
+        int w, h, c;
+        if (stbi_info(path.c_str(), &w, &h, &c) && size_t(w) * h > largestSize)
+        {
+            largestSize = size_t(w) * h;
+            largest[0] = path;
+        }
+    }
+    cout << endl << "maior imagem: " << largest[0] << endl;
+    DecodeResult single = runSerial(largest, true, filter);
+    printRow("serial", single, single.ms);
+    printRow("linhas divididas no pool", runParallel(largest, filter, pool, true), single.ms);
+    return 0;
+}
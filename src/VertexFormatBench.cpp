@@ -0,0 +1,370 @@
+/*
+ *  Comparação do layout de vértices em float (32 bytes) com o compacto (16 bytes,
+ *  VertexQuantize.h) no mesmo shader Phong de GB.cpp.
+ *
+ *  Para cada modelo:
+ *   - renderiza a mesma cena com os dois layouts num framebuffer fora da tela
+ *     e compara as imagens (diferença máxima/média por canal, pixels diferentes, PSNR)
+ *   - mede o tempo de GPU (GL_TIME_ELAPSED) de muitas cópias pequenas da malha,
+ *     situação limitada pela leitura de vértices, e estima os bytes lidos por quadro
+ *
+ *  Uso: VertexFormatBench [quadros] [arquivo.obj ...]
+ *  Sem arquivos, mede os modelos de assets/Modelos3D.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "MeshCache.h"
+#include "VertexQuantize.h"
+
+using namespace std;
+
+const int kImageSize = 512;
+// Cópias por quadro na medição de tempo (grade kGrid x kGrid)
+const int kGrid = 32;
+
+// Mesmo vertex/fragment shader de GB.cpp (sem textura)
+const GLchar* vertexShaderSource = R"(
+	#version 400
+	layout (location = 0) in vec3 position;
+	layout (location = 1) in vec2 tex_coord;
+	layout (location = 2) in vec3 normal;
+	out vec2 texCoord;
+	out vec3 fragPos;
+	out vec3 fragNormal;
+	uniform mat4 model;
+	uniform mat4 view;
+	uniform mat4 projection;
+	uniform bool quantized;
+	uniform vec3 positionOffset;
+	uniform vec3 positionScale;
+	vec3 octDecode(vec2 e)
+	{
+			vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+			float t = max(-n.z, 0.0);
+			n.x += n.x >= 0.0 ? -t : t;
+			n.y += n.y >= 0.0 ? -t : t;
+			return normalize(n);
+	}
+	void main()
+	{
+			vec3 objPos = quantized ? positionOffset + position * positionScale : position;
+			vec3 objNormal = quantized ? octDecode(normal.xy) : normal;
+			vec4 worldPos = model * vec4(objPos, 1.0);
+			gl_Position = projection * view * worldPos;
+			texCoord = vec2(tex_coord.x, 1.0 - tex_coord.y);
+			fragPos = vec3(worldPos);
+			fragNormal = mat3(transpose(inverse(model))) * objNormal;
+	}
+)";
+
+const GLchar* fragmentShaderSource = R"(
+	#version 400
+	in vec3 fragNormal;
+	in vec3 fragPos;
+	in vec2 texCoord;
+	uniform vec3 lightPos;
+	uniform vec3 cameraPos;
+	out vec4 color;
+	void main()
+	{
+		vec3 N = normalize(fragNormal);
+		vec3 L = normalize(lightPos - fragPos);
+		vec3 V = normalize(cameraPos - fragPos);
+		vec3 R = reflect(-L, N);
+		float diff = max(dot(N, L), 0.0);
+		float spec = diff > 0.0 ? pow(max(dot(R, V), 0.0), 64.0) : 0.0;
+		vec3 checker = vec3(0.6 + 0.4 * step(0.5, fract(texCoord.x * 8.0)));
+		color = vec4(checker * (0.1 + diff) + vec3(spec), 1.0);
+	}
+)";
+
+struct LayoutBuffers
+{
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    size_t stride = 0;
+    size_t vertexBytes = 0;
+    bool quantized = false;
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    glm::vec3 positionScale = glm::vec3(1.0f);
+};
+
+GLuint compileProgram()
+{
+    GLint success;
+    GLchar infoLog[512];
+    GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vs, 1, &vertexShaderSource, NULL);
+    glCompileShader(vs);
+    glGetShaderiv(vs, GL_COMPILE_STATUS, &success);
+    if (!success) { glGetShaderInfoLog(vs, 512, NULL, infoLog); cerr << "Vertex shader:\n" << infoLog << endl; }
+    GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fs, 1, &fragmentShaderSource, NULL);
+    glCompileShader(fs);
+    glGetShaderiv(fs, GL_COMPILE_STATUS, &success);
+    if (!success) { glGetShaderInfoLog(fs, 512, NULL, infoLog); cerr << "Fragment shader:\n" << infoLog << endl; }
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) { glGetProgramInfoLog(program, 512, NULL, infoLog); cerr << "Link:\n" << infoLog << endl; }
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    return program;
+}
+
+LayoutBuffers createLayout(const CachedMesh& mesh, GLuint EBO, bool quantized)
+{
+    LayoutBuffers layout;
+    layout.quantized = quantized;
+    glGenVertexArrays(1, &layout.VAO);
+    glBindVertexArray(layout.VAO);
+    glGenBuffers(1, &layout.VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, layout.VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    if (quantized)
+    {
+        QuantizedMesh packed;
+        quantizeVertices(mesh.vertices, mesh.header.vertexCount, mesh.boundsMin(), mesh.boundsMax(), packed);
+        glBufferData(GL_ARRAY_BUFFER, packed.bytes(), packed.vertices.data(), GL_STATIC_DRAW);
+        layout.stride = sizeof(PackedVertex);
+        layout.vertexBytes = packed.bytes();
+        layout.positionOffset = packed.positionOffset;
+        layout.positionScale = packed.positionScale;
+
+        GLenum uvType = packed.halfUVs ? GL_HALF_FLOAT : GL_UNSIGNED_SHORT;
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, position));
+        glVertexAttribPointer(1, 2, uvType, packed.halfUVs ? GL_FALSE : GL_TRUE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, uv));
+        glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, normal));
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, mesh.vertexBytes(), mesh.vertices, GL_STATIC_DRAW);
+        layout.stride = 8 * sizeof(GLfloat);
+        layout.vertexBytes = mesh.vertexBytes();
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(5 * sizeof(GLfloat)));
+    }
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return layout;
+}
+
+// Desenha uma grade grid x grid de cópias que cobre a imagem inteira
+void drawScene(GLuint program, const CachedMesh& mesh, const LayoutBuffers& layout, int grid)
+{
+    glm::vec3 center = 0.5f * (mesh.boundsMin() + mesh.boundsMax());
+    glm::vec3 extent = mesh.boundsMax() - mesh.boundsMin();
+    float size = max(extent.x, max(extent.y, extent.z));
+
+    glm::vec3 cameraPos(0.0f, 0.0f, 3.0f);
+    glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 10.0f);
+
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform3f(glGetUniformLocation(program, "lightPos"), 1.0f, 2.0f, 3.0f);
+    glUniform3fv(glGetUniformLocation(program, "cameraPos"), 1, glm::value_ptr(cameraPos));
+    glUniform1i(glGetUniformLocation(program, "quantized"), layout.quantized);
+    glUniform3fv(glGetUniformLocation(program, "positionOffset"), 1, glm::value_ptr(layout.positionOffset));
+    glUniform3fv(glGetUniformLocation(program, "positionScale"), 1, glm::value_ptr(layout.positionScale));
+    GLint modelLoc = glGetUniformLocation(program, "model");
+    GLenum indexType = mesh.header.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    glBindVertexArray(layout.VAO);
+    float cell = 2.0f / grid;
+    for (int y = 0; y < grid; ++y)
+    {
+        for (int x = 0; x < grid; ++x)
+        {
+            glm::mat4 model(1.0f);
+            model = glm::translate(model, glm::vec3(-1.0f + cell * (x + 0.5f), -1.0f + cell * (y + 0.5f), 0.0f));
+            model = glm::rotate(model, glm::radians(25.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            model = glm::scale(model, glm::vec3(0.9f * cell / size));
+            model = glm::translate(model, -center);
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+            glDrawElements(GL_TRIANGLES, mesh.lod(0).indexCount, indexType, 0);
+        }
+    }
+    glBindVertexArray(0);
+}
+
+vector<unsigned char> renderImage(GLuint program, const CachedMesh& mesh, const LayoutBuffers& layout)
+{
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    drawScene(program, mesh, layout, 1);
+    vector<unsigned char> pixels(kImageSize * kImageSize * 4);
+    glReadPixels(0, 0, kImageSize, kImageSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+// Tempo médio de GPU (ms) por quadro de kGrid x kGrid cópias
+double gpuFrameMs(GLuint program, const CachedMesh& mesh, const LayoutBuffers& layout, int frames)
+{
+    GLuint query;
+    glGenQueries(1, &query);
+    drawScene(program, mesh, layout, kGrid); // aquecimento
+    glFinish();
+
+    double totalMs = 0.0;
+    for (int i = 0; i < frames; ++i)
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        drawScene(program, mesh, layout, kGrid);
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+        totalMs += ns / 1.0e6;
+    }
+    glDeleteQueries(1, &query);
+    return totalMs / frames;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = argc > 1 ? max(1, atoi(argv[1])) : 50;
+    vector<string> files;
+    for (int i = 2; i < argc; ++i) files.push_back(argv[i]);
+    if (files.empty())
+    {
+        files = {
+            "../assets/Modelos3D/Cube.obj",
+            "../assets/Modelos3D/Suzanne.obj",
+            "../assets/Modelos3D/SuzanneSubdiv1.obj"
+        };
+    }
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "VertexFormatBench", nullptr, nullptr);
+    if (!window)
+    {
+        cerr << "Nao foi possivel criar o contexto OpenGL" << endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        cerr << "Failed to initialize GLAD" << endl;
+        return 1;
+    }
+    cout << "Renderer: " << glGetString(GL_RENDERER) << endl << endl;
+
+    // Framebuffer fora da tela, do mesmo tamanho para os dois layouts
+    GLuint FBO, colorRB, depthRB;
+    glGenFramebuffers(1, &FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glGenRenderbuffers(1, &colorRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, kImageSize, kImageSize);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRB);
+    glGenRenderbuffers(1, &depthRB);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRB);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, kImageSize, kImageSize);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRB);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        cerr << "Framebuffer incompleto" << endl;
+        return 1;
+    }
+    glViewport(0, 0, kImageSize, kImageSize);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glEnable(GL_DEPTH_TEST);
+
+    GLuint program = compileProgram();
+
+    cout << fixed << setprecision(3);
+    cout << left << setw(40) << "arquivo" << right << setw(8) << "layout" << setw(8) << "B/vert"
+         << setw(12) << "VBO KB" << setw(14) << "MB lidos/q" << setw(12) << "GPU ms/q"
+         << setw(10) << "dif max" << setw(10) << "dif med" << setw(12) << "pixels>1" << setw(10) << "PSNR" << endl;
+
+    for (const string& file : files)
+    {
+        CachedMesh mesh;
+        if (!loadMeshCached(file, mesh)) continue;
+
+        GLuint EBO;
+        glGenBuffers(1, &EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBytes(), mesh.indices, GL_STATIC_DRAW);
+
+        LayoutBuffers layouts[2] = { createLayout(mesh, EBO, false), createLayout(mesh, EBO, true) };
+        vector<unsigned char> reference = renderImage(program, mesh, layouts[0]);
+
+        for (const LayoutBuffers& layout : layouts)
+        {
+            vector<unsigned char> image = renderImage(program, mesh, layout);
+
+            // Diferença por canal contra o layout em float
+            int maxDiff = 0;
+            double sumDiff = 0.0, sumSquared = 0.0;
+            size_t differentPixels = 0;
+            for (size_t p = 0; p < image.size(); p += 4)
+            {
+                int pixelDiff = 0;
+                for (int c = 0; c < 3; ++c)
+                {
+                    int d = abs(int(image[p + c]) - int(reference[p + c]));
+                    pixelDiff = max(pixelDiff, d);
+                    sumDiff += d;
+                    sumSquared += double(d) * d;
+                }
+                maxDiff = max(maxDiff, pixelDiff);
+                if (pixelDiff > 1) ++differentPixels;
+            }
+            size_t samples = image.size() / 4 * 3;
+            double mse = sumSquared / samples;
+            string psnr = mse == 0.0 ? "inf" : to_string(10.0 * log10(255.0 * 255.0 / mse)).substr(0, 6);
+
+            // Limite inferior: cada vértice lido uma vez por cópia (cache pós-transformação perfeito)
+            double fetchedMB = double(layout.vertexBytes) * kGrid * kGrid / (1024.0 * 1024.0);
+            double ms = gpuFrameMs(program, mesh, layout, frames);
+
+            cout << left << setw(40) << file << right << setw(8) << (layout.quantized ? "16b" : "float")
+                 << setw(8) << layout.stride << setw(12) << layout.vertexBytes / 1024.0 << setw(14) << fetchedMB
+                 << setw(12) << ms << setw(10) << maxDiff << setw(10) << sumDiff / samples
+                 << setw(12) << differentPixels << setw(10) << psnr << endl;
+        }
+
+        for (LayoutBuffers& layout : layouts)
+        {
+            glDeleteVertexArrays(1, &layout.VAO);
+            glDeleteBuffers(1, &layout.VBO);
+        }
+        glDeleteBuffers(1, &EBO);
+    }
+
+    glDeleteRenderbuffers(1, &colorRB);
+    glDeleteRenderbuffers(1, &depthRB);
+    glDeleteFramebuffers(1, &FBO);
+    glDeleteProgram(program);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
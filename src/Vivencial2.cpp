@@ -6,19 +6,21 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "ObjLoader.h"
+#include "ShaderProgram.h"
+#include "FrameUniforms.h"
+#include <memory>
 #include <vector>
 #include <sstream>
 #include <fstream>
 
 using namespace std;
 
-const GLchar *vertexShaderSource = R"(
-#version 400
+const GLchar *vertexShaderSource = "#version 400\n" FRAME_UNIFORMS_GLSL R"(
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 color;
 layout (location = 2) in vec3 normal;
 layout (location = 3) in vec2 texc;
-uniform mat4 projection;
 uniform mat4 model;
 out vec2 texCoord;
 out vec3 vNormal;
@@ -26,7 +28,7 @@ out vec4 fragPos;
 out vec4 vColor;
 void main()
 {
-	gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
+	gl_Position = projection * view * model * vec4(position.x, position.y, position.z, 1.0);
 	fragPos = model * vec4(position.x, position.y, position.z, 1.0);
 	texCoord = texc;
 	vNormal = normal;
@@ -34,19 +36,10 @@ void main()
 }
 )";
 
-const GLchar *fragmentShaderSource = R"(
-#version 400
+const GLchar *fragmentShaderSource = "#version 400\n" FRAME_UNIFORMS_GLSL R"(
 in vec2 texCoord;
 uniform sampler2D texBuff;
-uniform vec3 lightPos;
-uniform vec3 fillLightPos;    
-uniform vec3 fillLightColor;
-uniform int keyLightOn;
-uniform int fillLightOn;
-uniform vec3 backLightPos;
-uniform vec3 backLightColor;
-uniform int backLightOn;
-uniform vec3 camPos;
+// Luzes no bloco Lights (FrameUniforms.h): 0 principal, 1 de preenchimento, 2 de fundo
 uniform float ka;
 uniform float kd;
 uniform float ks;
@@ -57,7 +50,7 @@ in vec3 vNormal;
 in vec4 vColor;
 void main()
 {
-	vec3 lightColor = vec3(1.0,1.0,1.0);
+	vec3 lightColor = lights[0].color.rgb;
 	vec4 objectColor = vColor;
 	vec3 ambient = ka * lightColor;
 	vec3 N = normalize(vNormal);
@@ -65,29 +58,29 @@ void main()
 	vec3 diffuseFill = vec3(0.0);
 	vec3 specular = vec3(0.0);
 	vec3 diffuseBack = vec3(0.0);
-	if (keyLightOn == 1) {
-			vec3 L = normalize(lightPos - vec3(fragPos));
+	if (lights[0].position.w != 0.0) {
+			vec3 L = normalize(lights[0].position.xyz - vec3(fragPos));
 			float diff = max(dot(N, L), 0.0);
 			diffuse = kd * diff * lightColor;
 			vec3 R = normalize(reflect(-L, N));
-			vec3 V = normalize(camPos - vec3(fragPos));
+			vec3 V = normalize(cameraPos - vec3(fragPos));
 			float spec = max(dot(R, V), 0.0);
 			spec = pow(spec, q);
 			specular = ks * spec * lightColor;
 	}
-	if (fillLightOn == 1) {
-			vec3 Lfill = normalize(fillLightPos - vec3(fragPos));
+	if (lights[1].position.w != 0.0) {
+			vec3 Lfill = normalize(lights[1].position.xyz - vec3(fragPos));
 			float diffFill = max(dot(N, Lfill), 0.0);
-			float distFill = length(fillLightPos - vec3(fragPos));
+			float distFill = length(lights[1].position.xyz - vec3(fragPos));
 			float attenuationFill = 1.0 / (distFill * distFill);
-			diffuseFill = kd * diffFill * fillLightColor * attenuationFill;
+			diffuseFill = kd * diffFill * lights[1].color.rgb * attenuationFill;
 	}
-	if (backLightOn == 1) {
-		vec3 Lback = normalize(backLightPos - vec3(fragPos));
+	if (lights[2].position.w != 0.0) {
+		vec3 Lback = normalize(lights[2].position.xyz - vec3(fragPos));
 		float diffBack = max(dot(N, Lback), 0.0);
-		float distBack = length(backLightPos - vec3(fragPos));
+		float distBack = length(lights[2].position.xyz - vec3(fragPos));
 		float attenuationBack = 1.0 / (distBack * distBack);
-		diffuseBack = kd * diffBack * backLightColor * attenuationBack;
+		diffuseBack = kd * diffBack * lights[2].color.rgb * attenuationBack;
 	}
 	vec3 result = ambient * vec3(objectColor) + diffuse * vec3(objectColor) + diffuseFill + specular + diffuseBack;
 	color = vec4(result,1.0);
@@ -101,12 +94,11 @@ struct Geometry {
 	string textureFilePath;
 };
 
-int setupShader();
 Geometry setupGeometry(const char* filepath);
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 bool loadObject(const char* path, vector<glm::vec3>& out_vertices, vector<glm::vec2>& out_uvs, vector<glm::vec3>& out_normals);
 void drawGeometry(
-	GLuint shaderID, 
+	const Uniform<glm::mat4>& modelUniform, 
 	GLuint VAO, 
 	glm::vec3 position, 
 	glm::vec3 dimensions, 
@@ -142,7 +134,11 @@ int main (){
 	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 
-	GLuint shaderID = setupShader();
+	std::unique_ptr<ShaderProgram> program(new ShaderProgram);
+	if (!program->build("vivencial2", vertexShaderSource, fragmentShaderSource))
+	{
+		return -1;
+	}
 	Geometry geom = setupGeometry("D:/ComputacaoGrafica/RepoAulas/repo-prof/CGCCHibrido/assets/Modelos3D/SuzanneSubdiv1.obj");
 
 	lightPos = glm::vec3(0.6, 1.2, -0.5);
@@ -154,30 +150,36 @@ int main (){
 	glm::vec3 fillLightColor 	= glm::vec3(0.0f, 0.0f, 1.0f);
 	glm::vec3 backLightPos 		= glm::vec3(-1.0f, 1.0f, -1.0f);
 	glm::vec3 backLightColor 	= glm::vec3(0.0f, 1.0f, 0.0f);
-	glm::vec3 camPos 					= cameraPos;
 
-	glUseProgram(shaderID);
+	program->use();
 
 	glm::mat4 model = glm::mat4(1);
-	GLint modelLoc = glGetUniformLocation(shaderID, "model");
-
-	glUniform1i(glGetUniformLocation(shaderID, "texBuff"), 0);
-	glUniform1f(glGetUniformLocation(shaderID, "ka"), ka);
-	glUniform1f(glGetUniformLocation(shaderID, "kd"), kd);
-	glUniform1f(glGetUniformLocation(shaderID, "ks"), ks);
-	glUniform1f(glGetUniformLocation(shaderID, "q"), q);
-	glUniform3f(glGetUniformLocation(shaderID, "lightPos"), lightPos.x,lightPos.y,lightPos.z);
-	glUniform3f(glGetUniformLocation(shaderID, "fillLightPos"), fillLightPos.x,fillLightPos.y,fillLightPos.z);
-	glUniform3f(glGetUniformLocation(shaderID, "fillLightColor"), fillLightColor.x,fillLightColor.y,fillLightColor.z);
-	glUniform3f(glGetUniformLocation(shaderID, "backLightPos"), backLightPos.x,backLightPos.y,backLightPos.z);
-	glUniform3f(glGetUniformLocation(shaderID, "backLightColor"), backLightColor.x,backLightColor.y,backLightColor.z);
-	glUniform3f(glGetUniformLocation(shaderID, "camPos"), camPos.x,camPos.y,camPos.z);
-	glActiveTexture(GL_TEXTURE0);
+	Uniform<glm::mat4> modelUniform = program->uniform<glm::mat4>("model");
 
-	glm::mat4 projection = glm::ortho(-1.0, 1.0, -1.0, 1.0, -3.0, 3.0);
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+	program->uniform<int>("texBuff").set(0);
+	program->uniform<float>("ka").set(ka);
+	program->uniform<float>("kd").set(kd);
+	program->uniform<float>("ks").set(ks);
+	program->uniform<float>("q").set(q);
+	glActiveTexture(GL_TEXTURE0);
 
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
+	// Câmera e luzes no UBO compartilhado (FrameUniforms.h); a posição da luz
+	// principal e os liga/desliga vão num envio só por quadro
+	FrameUniforms::attach(*program);
+	std::unique_ptr<FrameUniforms> frameUniforms(new FrameUniforms);
+	frameUniforms->frame.projection = glm::ortho(-1.0, 1.0, -1.0, 1.0, -3.0, 3.0);
+	frameUniforms->frame.cameraPos = cameraPos;
+	LightsBlock& lights = frameUniforms->lights;
+	lights.count = 3;
+	lights.lights[0].color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	lights.lights[1].position = glm::vec4(fillLightPos, 1.0f);
+	lights.lights[1].color = glm::vec4(fillLightColor, 1.0f);
+	lights.lights[1].attenuation = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+	lights.lights[2].position = glm::vec4(backLightPos, 1.0f);
+	lights.lights[2].color = glm::vec4(backLightColor, 1.0f);
+	lights.lights[2].attenuation = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+
+	modelUniform.set(model);
 
 	glEnable(GL_DEPTH_TEST);
 
@@ -187,14 +189,15 @@ int main (){
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glUniform3f(glGetUniformLocation(shaderID, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
-		glUniform1i(glGetUniformLocation(shaderID, "keyLightOn"), keyLightOn);
-		glUniform1i(glGetUniformLocation(shaderID, "fillLightOn"), fillLightOn);
-		glUniform1i(glGetUniformLocation(shaderID, "backLightOn"), backLightOn);
+		lights.lights[0].position = glm::vec4(lightPos, keyLightOn ? 1.0f : 0.0f);
+		lights.lights[1].position.w = fillLightOn ? 1.0f : 0.0f;
+		lights.lights[2].position.w = backLightOn ? 1.0f : 0.0f;
+		frameUniforms->frame.time = (float)glfwGetTime();
+		frameUniforms->upload();
 
 		glBindVertexArray(geom.VAO);
 		drawGeometry(
-			shaderID, 
+			modelUniform, 
 			geom.VAO, 
 			glm::vec3(0, 0, 0), 
 			glm::vec3(0.3, 0.3, 0.3), 
@@ -206,51 +209,12 @@ int main (){
 		glfwSwapBuffers(window);
 	}
 	glDeleteVertexArrays(1, &geom.VAO);
+	frameUniforms.reset();
+	program.reset();
 	glfwTerminate();
 	return 0;
 }
 
-int setupShader()
-{
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success)
-	{
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	return shaderProgram;
-}
-
 Geometry setupGeometry(const char* filepath)
 {
     std::vector<GLfloat> vertices;
@@ -304,87 +268,17 @@ bool loadObject(
 	std::vector<glm::vec2>& out_uvs,
 	std::vector<glm::vec3>& out_normals)
 {
-	std::ifstream file(path);
-
-	if (!file)
-	{
-			std::cerr << "Failed to open file: " << path << std::endl;
-			return false;
-	}
-
-	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-	std::vector<glm::vec3> temp_vertices;
-	std::vector<glm::vec2> temp_uvs;
-	std::vector<glm::vec3> temp_normals;
-
-	std::string line;
-
-	while (std::getline(file, line))
-	{
-			std::istringstream iss(line);
-			std::string type;
-			iss >> type;
-
-			if (type == "v")
-			{
-					glm::vec3 vertex;
-					iss >> vertex.x >> vertex.y >> vertex.z;
-					temp_vertices.push_back(vertex);
-			}
-			else if (type == "vt") 
-			{
-					glm::vec2 uv;
-					iss >> uv.x >> uv.y;
-					temp_uvs.push_back(uv);
-			}
-			else if (type == "vn") 
-			{
-					glm::vec3 normal;
-					iss >> normal.x >> normal.y >> normal.z;
-					temp_normals.push_back(normal);
-			}
-			else if (type == "f") 
-			{
-					unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-					char slash;
-
-					for (int i = 0; i < 3; ++i)
-					{
-							iss >> vertexIndex[i] >> slash >> uvIndex[i] >> slash >> normalIndex[i];
-							vertexIndices.push_back(vertexIndex[i]);
-							uvIndices.push_back(uvIndex[i]);
-							normalIndices.push_back(normalIndex[i]);
-					}
-			}
-	}
-
-	for (unsigned int i = 0; i < vertexIndices.size(); ++i)
-	{
-			unsigned int vertexIndex = vertexIndices[i];
-			unsigned int uvIndex = uvIndices[i];
-			unsigned int normalIndex = normalIndices[i];
-
-			glm::vec3 vertex = temp_vertices[vertexIndex - 1];
-			glm::vec2 uv = temp_uvs[uvIndex - 1];
-			glm::vec3 normal = temp_normals[normalIndex - 1];
-
-			out_vertices.push_back(vertex);
-			out_uvs.push_back(uv);
-			out_normals.push_back(normal);
-	}
-
-	file.close();
-
-	return true;
+	string mtlLib;
+	return loadObjectMapped(path, out_vertices, out_uvs, out_normals, mtlLib);
 }
 
-void drawGeometry(GLuint shaderID, GLuint VAO, glm::vec3 position, glm::vec3 dimensions, float angle, GLuint nVertices, glm::vec3 color, glm::vec3 axis)
+void drawGeometry(const Uniform<glm::mat4>& modelUniform, GLuint VAO, glm::vec3 position, glm::vec3 dimensions, float angle, GLuint nVertices, glm::vec3 color, glm::vec3 axis)
 {
 	glm::mat4 model = glm::mat4(1.0f); 
 	model = translate(model, position);
 	model = rotate(model, glm::radians(angle), axis);
 	model = scale(model, dimensions);
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
+	modelUniform.set(model);
 	glDrawArrays(GL_TRIANGLES, 0, nVertices);
 }
 